@@ -0,0 +1,91 @@
+/**
+ * @file circular_string_bench.cpp
+ * @brief CircularString 写入与查找性能基准
+ *
+ * 对 4KB ~ 10MB 的缓冲区分别测量：
+ * - push_back：以 1500 字节分段写满缓冲区
+ * - find：在整个缓冲区中查找不存在的字符
+ * - find_nth：查找分布在数据中的分隔符
+ * 数据在物理上跨越回绕点，以覆盖两段的情况；Heap 与 Mirrored 两种存储各测一遍。
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include "../include/tools/CircularString.h"
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+double elapsedNs(Clock::time_point start) {
+    return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+}
+
+void runBenchmark(size_t capacity, CircularString::Backing backing) {
+    const size_t kSegment = 1500;
+    std::string segment(kSegment, '\0');
+    for (size_t i = 0; i < kSegment; ++i) {
+        segment[i] = static_cast<char>('a' + rand() % 26);
+    }
+    segment[kSegment - 2] = '\r';
+    segment[kSegment - 1] = '\n';
+
+    CircularString ring(capacity, backing);
+    // 先写入半个缓冲区再删除，使后续数据跨越回绕点
+    ring.push_back(std::string(capacity / 2, 'x'));
+    ring.erase_up_to(capacity / 2 - 1);
+
+    const int rounds = static_cast<int>(std::max<size_t>(1, (64u << 20) / capacity));
+
+    // push_back
+    Clock::time_point start = Clock::now();
+    size_t written = 0;
+    for (int r = 0; r < rounds; ++r) {
+        for (size_t n = 0; n < capacity; n += kSegment) {
+            ring.push_back(segment);
+            written += kSegment;
+        }
+    }
+    double push_ns = elapsedNs(start);
+
+    // find（找不到，扫描全部数据）
+    start = Clock::now();
+    size_t sink = 0;
+    for (int r = 0; r < rounds; ++r) {
+        sink += ring.find(0, ring.size(), '#');
+    }
+    double find_ns = elapsedNs(start);
+
+    // find_nth（第 8 个分隔符）
+    start = Clock::now();
+    for (int r = 0; r < rounds; ++r) {
+        try {
+            sink += ring.find_nth("\r\n", 8);
+        } catch (const std::out_of_range&) {
+        }
+    }
+    double nth_ns = elapsedNs(start);
+
+    std::printf("%-8s %10zu B | push_back %8.3f GB/s | find %8.3f GB/s | find_nth %10.1f ns/call | %zu\n",
+                backing == CircularString::Backing::Heap ? "heap" : "mirrored",
+                capacity,
+                written / push_ns,
+                (static_cast<double>(ring.size()) * rounds) / find_ns,
+                nth_ns / rounds,
+                sink & 1);
+}
+
+} // namespace
+
+int main() {
+    std::printf("===== CircularString 基准 =====\n");
+    const size_t sizes[] = {4u << 10, 64u << 10, 1u << 20, 10u << 20};
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); ++i) {
+        runBenchmark(sizes[i], CircularString::Backing::Heap);
+        runBenchmark(sizes[i], CircularString::Backing::Mirrored);
+    }
+    return 0;
+}
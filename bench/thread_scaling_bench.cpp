@@ -0,0 +1,237 @@
+/**
+ * @file thread_scaling_bench.cpp
+ * @brief 插件多线程扩展性基准（负载生成器）
+ *
+ * 每个工作线程以自己的 TASK::Thread 编号调用 Filter，循环发送一组合成的
+ * 查询/响应对（每个线程使用不同的客户端地址和域名），统计 1 到 32 个线程下
+ * 的总吞吐和相对单线程的加速比。线程状态按编号分片后，加速比应接近线程数，
+ * 直到受限于物理核数。
+ *
+ * 以 DNS_PARSER_ALLOC_TRACKING=ON 构建时另外输出每个数据包的平均堆分配次数和字节数；
+ * 给出第三个参数时，任一轮的每包平均分配次数超过该值即以非零状态退出，
+ * 用作防止数据路径重新引入堆分配的门禁。
+ *
+ * 用法：bench_thread_scaling [最大线程数] [每线程数据包数] [每包分配次数上限]
+ */
+
+#include <arpa/inet.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+#include "../include/plugin/plugin.h"
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+// 每个线程循环使用的不同查询/响应对数量
+const size_t kDistinctPairs = 1024;
+
+void putU16(std::string& out, uint16_t value) {
+    out.push_back(static_cast<char>(value >> 8));
+    out.push_back(static_cast<char>(value & 0xFF));
+}
+
+void putName(std::string& out, const std::string& name) {
+    size_t start = 0;
+    while (start < name.size()) {
+        size_t dot = name.find('.', start);
+        if (dot == std::string::npos) {
+            dot = name.size();
+        }
+        out.push_back(static_cast<char>(dot - start));
+        out.append(name, start, dot - start);
+        start = dot + 1;
+    }
+    out.push_back('\0');
+}
+
+// 构造 name 的 A 查询；answer 非零时构造带一条 A 记录的响应
+std::string buildMessage(uint16_t id, const std::string& name, uint32_t answer) {
+    std::string out;
+    putU16(out, id);
+    putU16(out, answer ? 0x8180 : 0x0100);
+    putU16(out, 1);
+    putU16(out, answer ? 1 : 0);
+    putU16(out, 0);
+    putU16(out, 0);
+    putName(out, name);
+    putU16(out, 1);
+    putU16(out, 1);
+    if (answer) {
+        putU16(out, 0xC00C);
+        putU16(out, 1);
+        putU16(out, 1);
+        putU16(out, 0);
+        putU16(out, 300);
+        putU16(out, 4);
+        out.append(reinterpret_cast<const char*>(&answer), 4);
+    }
+    return out;
+}
+
+struct Packet {
+    std::string data;
+    bool query;
+};
+
+// 生成一个线程的负载：同一客户端地址下交替的查询和响应
+std::vector<Packet> buildWorkload(unsigned short thread) {
+    std::vector<Packet> packets;
+    packets.reserve(kDistinctPairs * 2);
+    for (size_t i = 0; i < kDistinctPairs; ++i) {
+        char name[64];
+        std::snprintf(name, sizeof(name), "host%zu.t%u.bench.example.com", i, static_cast<unsigned>(thread));
+        uint16_t id = static_cast<uint16_t>(i);
+        uint32_t addr = htonl(0x0A000000u | (static_cast<uint32_t>(thread) << 16) | static_cast<uint32_t>(i));
+        Packet query = { buildMessage(id, name, 0), true };
+        Packet response = { buildMessage(id, name, addr), false };
+        packets.push_back(query);
+        packets.push_back(response);
+    }
+    return packets;
+}
+
+void fillTask(TASK& task, unsigned short thread, const Packet& packet, uint16_t port) {
+    std::memset(&task, 0, sizeof(task));
+    task.Inform = 0x12;
+    task.Thread = thread;
+    ENTITY client;
+    ENTITY server;
+    std::memset(&client, 0, sizeof(client));
+    std::memset(&server, 0, sizeof(server));
+    client.Role = 'C';
+    client.IPvN = 4;
+    client.IPv4 = htonl(0xC0A80000u | thread);
+    client.Port = port;
+    server.Role = 'S';
+    server.IPvN = 4;
+    server.IPv4 = htonl(0x08080808u);
+    server.Port = 53;
+    task.Source = packet.query ? client : server;
+    task.Target = packet.query ? server : client;
+    task.Buffer = reinterpret_cast<unsigned char*>(const_cast<char*>(packet.data.data()));
+    task.Length = static_cast<unsigned int>(packet.data.size());
+    task.Volume = task.Length;
+}
+
+// 以 threads 个线程各发送 perThread 个数据包，返回总耗时（秒）
+double run(unsigned short threads, size_t perThread) {
+    std::vector<std::vector<Packet> > workloads;
+    for (unsigned short t = 0; t < threads; ++t) {
+        workloads.push_back(buildWorkload(t));
+        Single(t, nullptr);
+    }
+
+    std::atomic<unsigned> ready(0);
+    std::atomic<bool> go(false);
+    std::vector<std::thread> workers;
+    for (unsigned short t = 0; t < threads; ++t) {
+        workers.push_back(std::thread([t, perThread, &workloads, &ready, &go]() {
+            const std::vector<Packet>& packets = workloads[t];
+            TASK task;
+            TASK* exported = nullptr;
+            ready.fetch_add(1);
+            while (!go.load(std::memory_order_acquire)) {
+                std::this_thread::yield();
+            }
+            for (size_t i = 0; i < perThread; ++i) {
+                const Packet& packet = packets[i % packets.size()];
+                fillTask(task, t, packet, static_cast<uint16_t>(10000 + (i / 2) % 64));
+                Filter(&task, &exported);
+            }
+        }));
+    }
+    while (ready.load() < threads) {
+        std::this_thread::yield();
+    }
+
+    Clock::time_point start = Clock::now();
+    go.store(true, std::memory_order_release);
+    for (size_t i = 0; i < workers.size(); ++i) {
+        workers[i].join();
+    }
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    unsigned maxThreads = argc > 1 ? static_cast<unsigned>(std::atoi(argv[1])) : 32;
+    size_t perThread = argc > 2 ? static_cast<size_t>(std::atoll(argv[2])) : 200000;
+    double allocLimit = argc > 3 ? std::atof(argv[3]) : -1;
+    if (maxThreads == 0 || maxThreads > 256) {
+        maxThreads = 32;
+    }
+
+    // 关闭逐包输出，避免测到的是终端吞吐；关闭过载降级，每个数据包都完整解析
+    char configPath[] = "/tmp/dns_parser_bench_XXXXXX";
+    int fd = mkstemp(configPath);
+    if (fd < 0) {
+        std::perror("mkstemp");
+        return 1;
+    }
+    close(fd);
+    {
+        std::ofstream config(configPath);
+        config << "[Logging]\nlog_level = error\n[Shedding]\nenabled = false\n";
+    }
+
+    std::printf("===== 插件多线程扩展性基准（每线程 %zu 个数据包，%u 个 CPU）=====\n", perThread,
+                std::thread::hardware_concurrency());
+    std::printf("%8s %12s %12s %10s %10s %12s %12s\n", "threads", "seconds", "Mpps", "speedup", "efficiency",
+                "allocs/pkt", "bytes/pkt");
+
+    double baseline = 0;
+    bool overLimit = false;
+    for (unsigned threads = 1; threads <= maxThreads; threads *= 2) {
+        SetConfigFilePath(configPath);
+        // 插件的初始化和清理输出与结果无关，临时重定向到 /dev/null
+        std::cout.flush();
+        std::fflush(stdout);
+        int saved = dup(STDOUT_FILENO);
+        int devnull = open("/dev/null", O_WRONLY);
+        dup2(devnull, STDOUT_FILENO);
+        close(devnull);
+        Create(1, 0, nullptr);
+        double seconds = run(static_cast<unsigned short>(threads), perThread);
+        ALLOC_STATS allocStats;
+        bool tracked = AllocStats(&allocStats, -1) == 0 && allocStats.Packets;
+        Remove();
+        std::cout.flush();
+        dup2(saved, STDOUT_FILENO);
+        close(saved);
+
+        double mpps = threads * perThread / seconds / 1e6;
+        if (threads == 1) {
+            baseline = mpps;
+        }
+        std::printf("%8u %12.3f %12.3f %10.2f %9.0f%%", threads, seconds, mpps, mpps / baseline,
+                    100.0 * mpps / baseline / threads);
+        if (tracked) {
+            double allocsPerPacket = static_cast<double>(allocStats.Allocations) / allocStats.Packets;
+            std::printf(" %12.2f %12.1f\n", allocsPerPacket,
+                        static_cast<double>(allocStats.Bytes) / allocStats.Packets);
+            if (allocLimit >= 0 && allocsPerPacket > allocLimit) {
+                overLimit = true;
+            }
+        } else {
+            std::printf(" %12s %12s\n", "-", "-");
+        }
+    }
+    unlink(configPath);
+    if (overLimit) {
+        std::printf("每包平均分配次数超过上限 %.2f\n", allocLimit);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,192 @@
+#ifndef DNS_PARSER_PASSIVE_DNS_H
+#define DNS_PARSER_PASSIVE_DNS_H
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "../tools/types.h"
+#include "../tools/flat_hash_map.h"
+#include "../tools/name_interner.h"
+#include "../tools/timer_wheel.h"
+
+namespace dns_parser {
+
+/**
+ * @brief 被动 DNS 存储
+ *
+ * 把响应中的 A/AAAA/CNAME 记录整理成双向映射：
+ * - 反查：某个 IP 最近由哪些域名解析得到
+ * - 正查：某个域名当前解析到哪些 IP / 别名
+ *
+ * 域名保存在驻留表中并以 32 位 ID 引用；IPv4 与 IPv6 键分别放在独立的扁平哈希表中；
+ * 每条映射按记录自身的 TTL 通过时间轮过期，总条数受 max_mappings 限制。
+ * 本类不是线程安全的，多线程使用时由调用方负责同步。
+ */
+class PassiveDNS {
+public:
+    static const uint32_t kInvalidId = 0xFFFFFFFFu;
+    static const size_t kExpireStepBudget = 64;   // 每次 expire 默认最多处理的定时器数
+
+    typedef std::array<uint8_t, 16> IPv6Address;
+
+    /**
+     * @brief 正查结果
+     */
+    struct Resolution {
+        std::vector<uint32_t> ipv4;       // IPv4 地址（网络字节序）
+        std::vector<IPv6Address> ipv6;    // IPv6 地址
+        std::vector<std::string> cnames;  // 别名目标
+    };
+
+    /**
+     * @brief 构造函数
+     * @param max_mappings 映射条数上限，超出后新映射被丢弃
+     * @param max_ttl TTL 上限（秒），更大的 TTL 会被截断
+     * @param interner 域名驻留表，默认使用全局驻留表
+     */
+    explicit PassiveDNS(size_t max_mappings = 1 << 20, uint32_t max_ttl = 86400,
+                        NameInterner& interner = NameInterner::global());
+
+    /**
+     * @brief 记录一个已解析的响应
+     * @param message 解析后的消息结构（CNAME 目标使用解码时已解压缩的域名）
+     * @param now 当前时间（秒）
+     */
+    void observe(const Message& message, uint32_t now);
+
+    /**
+     * @brief 推进时间轮，删除已过期的映射
+     *
+     * 每次最多处理 max_work 个定时器，大批映射同时过期时分摊到之后的调用中删除，
+     * 单个数据包的处理时间不会因此出现尖峰。
+     *
+     * @param now 当前时间（秒）
+     * @param max_work 本次最多处理的定时器数
+     * @return 所有到期的映射都已处理时返回 true
+     */
+    bool expire(uint32_t now, size_t max_work = kExpireStepBudget);
+
+    /**
+     * @brief 把另一个分片的有效映射合并进来，用于从各线程的分片构建汇总视图
+     *
+     * 同一映射在多个分片中都存在时保留最晚的过期时间；分片的丢弃计数一并累加。
+     * 分片使用其他驻留表时按名字文本重新驻留，分片在合并期间不能被修改。
+     *
+     * @param shard 源分片
+     * @param now 当前时间（秒），已过期的映射不合并
+     */
+    void merge(const PassiveDNS& shard, uint32_t now);
+
+    /**
+     * @brief 回收驻留表：清空后只重新驻留仍有映射的名字，并改写映射中的 ID
+     *
+     * 用于驻留表写满时。仍被引用的名字超过驻留表容量的一半时，回收之后很快又会写满，
+     * 此时连同所有映射一起清空。驻留表必须由本实例独占，持有其中 ID 的其他结构
+     * （如缓存的消息）需由调用方一并清空。
+     */
+    void compactNames();
+
+    /**
+     * @brief 查询最近解析到指定 IPv4 地址的域名
+     * @param addr IPv4 地址（网络字节序，与 ENTITY::IPv4 一致）
+     * @return 域名列表
+     */
+    std::vector<std::string> namesForIPv4(uint32_t addr) const;
+
+    /**
+     * @brief 查询最近解析到指定 IPv6 地址的域名
+     * @param addr 16 字节 IPv6 地址
+     * @return 域名列表
+     */
+    std::vector<std::string> namesForIPv6(const uint8_t* addr) const;
+
+    /**
+     * @brief 查询域名当前的解析结果
+     * @param name 域名（大小写不敏感）
+     * @return 解析结果
+     */
+    Resolution resolve(const std::string& name) const;
+
+    /**
+     * @brief 获取当前有效映射数量
+     */
+    size_t size() const noexcept;
+
+    /**
+     * @brief 获取当前有映射的域名数量
+     */
+    size_t nameCount() const noexcept;
+
+    /**
+     * @brief 获取因容量上限而被丢弃的映射数量
+     */
+    uint64_t dropped() const noexcept;
+
+private:
+    // 映射类型
+    enum Kind : uint8_t {
+        KIND_A = 0,
+        KIND_AAAA = 1,
+        KIND_CNAME = 2
+    };
+
+    // 单条映射，24 字节
+    struct Entry {
+        uint32_t name;        // 域名 ID
+        uint32_t addr;        // IPv4 地址 / IPv6 地址池下标 / CNAME 目标域名 ID
+        uint32_t expire;      // 过期时间（秒）
+        uint32_t next_addr;   // 同一地址下的下一条映射（空闲时作为空闲链表指针）
+        uint32_t next_name;   // 同一域名下的下一条映射
+        uint8_t kind;         // 映射类型
+        uint8_t live;         // 是否有效
+    };
+
+    // IPv6 地址池槽位
+    struct IPv6Slot {
+        IPv6Address addr;
+        uint32_t head;
+    };
+
+    struct IPv6Hash {
+        size_t operator()(const IPv6Address& addr) const;
+    };
+
+    size_t max_mappings;
+    uint32_t max_ttl;
+    size_t live_count;
+    uint64_t dropped_count;
+
+    // 映射存储与空闲链表
+    std::vector<Entry> entries;
+    uint32_t free_entry;
+
+    // 地址/域名索引：键 -> 链表头
+    FlatHashMap<uint32_t, uint32_t> ipv4_index;
+    FlatHashMap<IPv6Address, uint32_t, IPv6Hash> ipv6_index;   // 值为地址池下标
+    FlatHashMap<uint32_t, uint32_t> cname_index;               // 目标域名 ID -> 链表头
+    FlatHashMap<uint32_t, uint32_t> name_index;                // 域名 ID -> 链表头
+    std::vector<IPv6Slot> ipv6_pool;
+    std::vector<uint32_t> ipv6_free;
+
+    // 域名驻留表
+    NameInterner& names;
+
+    // 分层时间轮，刻度为 1 秒；刷新过期时间时不改动定时器，到期时再按新时间重新挂入
+    TimerWheel timers;
+    bool wheel_started;
+
+    uint32_t internName(const Message& message, const DNSResourceRecord& rr);
+    uint32_t translateName(const PassiveDNS& shard, uint32_t id);
+    void clearMappings();
+
+    void record(Kind kind, uint32_t name, uint32_t addr, const uint8_t* addr6, uint32_t ttl, uint32_t now,
+                bool keep_later = false);
+    uint32_t* addressHead(Kind kind, uint32_t addr);
+    void removeEntry(uint32_t index);
+    void schedule(uint32_t index);
+};
+
+} // namespace dns_parser
+
+#endif // DNS_PARSER_PASSIVE_DNS_H
@@ -0,0 +1,205 @@
+#ifndef DNS_PARSER_PROTOCOL_STATS_H
+#define DNS_PARSER_PROTOCOL_STATS_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include "../flows/dns_parser.h"
+#include "../flows/header_classifier.h"
+#include "../tools/name_check.h"
+
+namespace dns_parser {
+
+/**
+ * @brief 按线程的协议计数，由所属线程写入，其他线程通过顺序锁读取快照
+ *
+ * 计数器是原子整数，只用 relaxed 读写，写入方在每次更新前后各递增一次序号（更新期间为奇数），
+ * 读取方逐项读取整个计数结构，序号在读取前后一致且为偶数时快照有效，否则重试。
+ * 写入方从不等待读取方，数据路径上没有原子读改写指令。
+ *
+ * 头部相关的计数直接从线格式的 12 字节头部和问题区类型取得，不依赖完整解析，
+ * 过载降级时也保持精确。
+ */
+class ProtocolStats {
+public:
+    static const size_t kQtypeSlots = 257;      // 0-255 各占一项，其余类型计入最后一项
+    static const size_t kRcodes = 16;
+    static const size_t kOpcodes = 16;
+    static const size_t kSections = 4;          // 问题、应答、权威、附加
+    static const size_t kSectionBuckets = 7;    // 0、1、2、3-4、5-8、9-16、17 及以上
+    static const size_t kSizeBuckets = 8;       // 64、128、256、512、1232、1500、4096 字节以内及更大
+    static const size_t kParseErrors = static_cast<size_t>(ParseError::Count);
+    static const size_t kRejectReasons = static_cast<size_t>(HeaderCheck::Count);
+
+    /**
+     * @brief 头部标志位
+     */
+    enum Flag {
+        FLAG_AA = 0,
+        FLAG_TC,
+        FLAG_RD,
+        FLAG_RA,
+        FLAG_AD,
+        FLAG_CD,
+        FLAG_COUNT
+    };
+
+    /**
+     * @brief EDNS 计数项
+     */
+    enum Edns {
+        EDNS_PRESENT = 0,   // 带 OPT 伪记录
+        EDNS_DO,            // DO 位置位
+        EDNS_COOKIE,        // 带 Cookie 选项
+        EDNS_SUBNET,        // 带合法的客户端子网选项
+        EDNS_MALFORMED,     // OPT 选项序列不合法
+        EDNS_COUNT
+    };
+
+    /**
+     * @brief 域名检查计数项，第 i 项对应 NameFlag 的第 i 位
+     */
+    enum Names {
+        NAMES_UPPERCASE = 0,    // 含大写字母
+        NAMES_NON_LDH,          // 含非 LDH 标签
+        NAMES_IDN,              // 含国际化域名标签
+        NAMES_BAD_LENGTH,       // 标签长度不合法
+        NAMES_COUNT
+    };
+
+    /**
+     * @brief 计数字段：T 为 uint64_t 时是快照，为 std::atomic<uint64_t> 时是线程内的计数
+     */
+    template <typename T>
+    struct Fields {
+        T packets;                          // Filter 收到的数据包
+        T messages;                         // DNS 消息（含流式重组得到的）
+        T queries;                          // QR=0 的消息
+        T responses;                        // QR=1 的消息
+        T short_messages;                   // 不足 12 字节、无法计入头部计数的消息
+        T parse_failures[kParseErrors];     // 按原因的解析失败数（下标为 ParseError）
+        T rejected[kRejectReasons];         // 解析前头部检查拒绝的报文数（下标为 HeaderCheck，不计入 messages）
+        T qtypes[kQtypeSlots];              // 第一个问题的类型
+        T rcodes[kRcodes];                  // 响应码（只统计响应）
+        T opcodes[kOpcodes];
+        T flags[FLAG_COUNT];                // 各标志位置位的消息数
+        T sections[kSections][kSectionBuckets];  // 各区段记录数的分布
+        T sizes[kSizeBuckets];              // 消息长度分布
+        T edns[EDNS_COUNT];                 // EDNS 各项的消息数（只统计完整解析的消息）
+        T names[NAMES_COUNT];               // 第一个问题的域名命中各项检查的消息数（开启域名规范化时）
+    };
+
+    /**
+     * @brief 计数快照
+     */
+    struct Counters : Fields<uint64_t> {
+        Counters();
+
+        /**
+         * @brief 累加另一个快照
+         */
+        void merge(const Counters& other);
+
+        uint64_t parseFailures() const;
+    };
+
+    ProtocolStats();
+
+    ProtocolStats(const ProtocolStats&) = delete;
+    ProtocolStats& operator=(const ProtocolStats&) = delete;
+
+    /**
+     * @brief 记录一个数据包
+     */
+    void recordPacket() {
+        beginWrite();
+        bump(counters.packets);
+        endWrite();
+    }
+
+    /**
+     * @brief 按线格式记录一条 DNS 消息的头部计数
+     * @param data DNS 消息（不含 TCP 长度前缀）
+     * @param length 消息长度
+     */
+    void recordMessage(const uint8_t* data, size_t length);
+
+    /**
+     * @brief 记录一个被头部检查拒绝的报文
+     */
+    void recordRejected(HeaderCheck check) {
+        beginWrite();
+        bump(counters.rejected[static_cast<size_t>(check) < kRejectReasons ? static_cast<size_t>(check) : 0]);
+        endWrite();
+    }
+
+    /**
+     * @brief 记录一次解析失败
+     */
+    void recordFailure(ParseError error) {
+        beginWrite();
+        bump(counters.parse_failures[static_cast<size_t>(error) < kParseErrors ? static_cast<size_t>(error) : 0]);
+        endWrite();
+    }
+
+    /**
+     * @brief 记录一条完整解析的消息中的 OPT 伪记录
+     * @param opt Message::opt() 的结果
+     */
+    void recordEdns(const RData& opt);
+
+    /**
+     * @brief 记录一条消息第一个问题的域名检查结果
+     * @param flags DNSQuestion::name_flags
+     */
+    void recordName(uint8_t flags) {
+        // 绝大多数域名没有命中任何一项，不进入写入区
+        if (!flags) {
+            return;
+        }
+        beginWrite();
+        for (size_t i = 0; i < NAMES_COUNT; ++i) {
+            bump(counters.names[i], (flags >> i) & 1);
+        }
+        endWrite();
+    }
+
+    /**
+     * @brief 读取一致的快照（可在任意线程调用）
+     * @param out 输出快照
+     */
+    void snapshot(Counters& out) const;
+
+    /**
+     * @brief 区段记录数所在的桶
+     */
+    static size_t sectionBucket(uint16_t count) noexcept;
+
+    /**
+     * @brief 消息长度所在的桶
+     */
+    static size_t sizeBucket(size_t length) noexcept;
+
+private:
+    // 只有所属线程写入，不需要原子读改写
+    static void bump(std::atomic<uint64_t>& counter, uint64_t n = 1) {
+        counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
+    void beginWrite() {
+        uint32_t value = sequence.load(std::memory_order_relaxed);
+        sequence.store(value + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+    }
+
+    void endWrite() {
+        sequence.store(sequence.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    std::atomic<uint32_t> sequence;     // 奇数表示写入中
+    Fields<std::atomic<uint64_t> > counters;
+};
+
+} // namespace dns_parser
+
+#endif // DNS_PARSER_PROTOCOL_STATS_H
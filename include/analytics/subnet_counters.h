@@ -0,0 +1,107 @@
+#ifndef DNS_PARSER_SUBNET_COUNTERS_H
+#define DNS_PARSER_SUBNET_COUNTERS_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "../tools/types.h"
+
+namespace dns_parser {
+
+/**
+ * @brief 按 EDNS 客户端子网（ECS）聚合的单线程查询/响应计数
+ *
+ * 共享递归服务器后面的不同客户在 ECS 中携带各自的子网，按子网计数即可得到
+ * 按客户的流量视图。子网先截断到聚合前缀（默认 IPv4 /24、IPv6 /56），
+ * 再计入固定容量的开放寻址表；表满后新子网只计入溢出数。
+ *
+ * 表在第一次遇到 ECS 时才分配，之后不再扩容：只有所属线程写入，
+ * 槽位的键在发布占用标记之前写好，其他线程可以随时读取快照。
+ */
+class SubnetCounters {
+public:
+    /**
+     * @brief 聚合后的子网
+     */
+    struct Subnet {
+        uint8_t family;         // 4 或 6
+        uint8_t prefix;         // 前缀长度
+        uint8_t address[16];    // 前缀之外的位已清零，IPv4 占前 4 字节
+    };
+
+    struct Entry {
+        Subnet subnet;
+        uint64_t queries;
+        uint64_t responses;
+    };
+
+    /**
+     * @brief 构造函数
+     * @param max_subnets 最多记录的子网数（创建后不变）
+     * @param ipv4_prefix IPv4 聚合前缀
+     * @param ipv6_prefix IPv6 聚合前缀
+     */
+    explicit SubnetCounters(size_t max_subnets = 4096, uint8_t ipv4_prefix = 24, uint8_t ipv6_prefix = 56);
+
+    SubnetCounters(const SubnetCounters&) = delete;
+    SubnetCounters& operator=(const SubnetCounters&) = delete;
+
+    /**
+     * @brief 修改聚合前缀，只影响之后记录的子网（只能由所属线程调用）
+     */
+    void setAggregation(uint8_t ipv4_prefix, uint8_t ipv6_prefix);
+
+    /**
+     * @brief 记录一条带 ECS 的消息
+     * @param opt 解码后的 OPT 伪记录，没有 ECS 时忽略
+     * @param query 是否是查询
+     * @return 是否计入（没有 ECS 或表满时返回 false）
+     */
+    bool record(const OPTData& opt, bool query);
+
+    /**
+     * @brief 把所有子网的计数追加到 out（可在任意线程调用）
+     */
+    void snapshot(std::vector<Entry>& out) const;
+
+    size_t size() const noexcept {
+        return live.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief 因表满而没有计入的消息数
+     */
+    uint64_t overflows() const noexcept {
+        return overflow_count.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief 合并多个快照中相同的子网，按查询和响应总数降序保留前 n 个
+     */
+    static void top(std::vector<Entry>& entries, size_t n);
+
+private:
+    struct Slot {
+        std::atomic<bool> used;
+        Subnet subnet;
+        std::atomic<uint64_t> queries;
+        std::atomic<uint64_t> responses;
+
+        Slot() : used(false), subnet(), queries(0), responses(0) {}
+    };
+
+    size_t max_subnets;
+    size_t mask;                            // 槽位数 - 1
+    uint8_t ipv4_prefix;
+    uint8_t ipv6_prefix;
+    std::unique_ptr<Slot[]> storage;        // 由所属线程持有
+    std::atomic<Slot*> slots;               // 发布给读取方的槽位
+    std::atomic<size_t> live;
+    std::atomic<uint64_t> overflow_count;
+};
+
+} // namespace dns_parser
+
+#endif // DNS_PARSER_SUBNET_COUNTERS_H
@@ -0,0 +1,183 @@
+#ifndef DNS_PARSER_CONFIG_STORE_H
+#define DNS_PARSER_CONFIG_STORE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "runtime_config.h"
+
+namespace dns_parser {
+
+/**
+ * @brief RCU 风格的配置快照发布点
+ *
+ * 当前快照通过一个原子指针发布，读者不加锁。旧快照的回收采用 QSBR
+ * （静止状态回收）：
+ * - 读者（工作线程）用 acquire() 取得快照，在一次 Filter 内使用，
+ *   处理完后调用 quiescent() 宣告自己不再持有任何快照指针
+ * - 写者 publish() 替换指针并推进纪元，旧快照挂到待回收列表，
+ *   所有在线读者都越过该纪元后才释放
+ *
+ * 读者每包的额外开销只有一次 acquire 读和一次 release 写，x86 上都是普通 mov。
+ * 长时间不处理数据的在线线程会推迟回收，但不影响读写；线程退出前应调用 offline()。
+ * 每个读者独占一个槽位，编号不小于 kMaxReaders 的读者被拒绝，不与其他读者共用槽位
+ * （共用时一个读者宣告静止会让写者释放另一个读者仍在使用的快照）。
+ */
+class ConfigStore {
+public:
+    // 读者编号上限（TASK::Thread 必须小于该值）
+    static const unsigned short kMaxReaders = 256;
+
+    /**
+     * @brief 构造函数，初始快照为默认配置
+     */
+    ConfigStore();
+
+    /**
+     * @brief 析构函数，调用时所有读者必须已停止
+     */
+    ~ConfigStore();
+
+    ConfigStore(const ConfigStore&) = delete;
+    ConfigStore& operator=(const ConfigStore&) = delete;
+
+    // ------------------------------ 读者接口 ------------------------------
+
+    /**
+     * @brief 获取当前快照，离线的读者会先自动上线
+     * @param reader 读者编号
+     * @return 快照指针，在该读者下一次 quiescent()/offline() 之前有效；
+     *         读者编号不小于 kMaxReaders 时返回 nullptr
+     */
+    const RuntimeConfig* acquire(unsigned short reader);
+
+    /**
+     * @brief 宣告读者已不再持有快照指针（编号无效时忽略）
+     * @param reader 读者编号
+     */
+    void quiescent(unsigned short reader);
+
+    /**
+     * @brief 读者下线，不再参与回收判断（编号无效时忽略）
+     * @param reader 读者编号
+     */
+    void offline(unsigned short reader);
+
+    // ------------------------------ 写者接口 ------------------------------
+
+    /**
+     * @brief 发布新快照（接管所有权），随后尝试回收旧快照
+     * @param next 新快照
+     */
+    void publish(RuntimeConfig* next);
+
+    /**
+     * @brief 释放所有读者都已越过的旧快照
+     * @return 仍在等待回收的快照数
+     */
+    size_t reclaim();
+
+    /**
+     * @brief 复制当前快照（加写者锁，供控制面使用，不要在数据路径调用）
+     */
+    RuntimeConfig snapshot() const;
+
+    /**
+     * @brief 获取已发布的版本号（每次 publish 加一）
+     */
+    uint64_t version() const noexcept;
+
+private:
+    // 离线读者的纪元，大于任何真实纪元
+    static const uint64_t kOffline = UINT64_MAX;
+
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> epoch;
+        Slot() : epoch(kOffline) {}
+    };
+
+    struct Retired {
+        RuntimeConfig* config;
+        uint64_t epoch;         // 读者越过该纪元后可释放
+    };
+
+    std::atomic<const RuntimeConfig*> current;
+    std::atomic<uint64_t> epoch;
+    Slot* slots;
+
+    // 写者之间互斥，读者不使用
+    mutable std::mutex write_mutex;
+    std::vector<Retired> retired;
+
+    size_t reclaimLocked();
+};
+
+/**
+ * @brief 配置文件监视线程
+ *
+ * 按快照中的 reload_interval_ms 轮询配置文件及其引用的策略规则、黑白名单文件的
+ * 修改时间和大小，任一变化时重新解析并发布新快照（策略随快照重新编译），同时回收旧快照。文件不存在或无法读取时保留当前快照。
+ */
+class ConfigWatcher {
+public:
+    /**
+     * @brief 构造函数
+     * @param store 发布目标
+     * @param path 配置文件路径
+     */
+    ConfigWatcher(ConfigStore& store, const std::string& path);
+
+    /**
+     * @brief 析构函数，自动停止监视线程
+     */
+    ~ConfigWatcher();
+
+    ConfigWatcher(const ConfigWatcher&) = delete;
+    ConfigWatcher& operator=(const ConfigWatcher&) = delete;
+
+    /**
+     * @brief 立即加载一次并启动监视线程
+     * @return 首次加载是否成功（失败时仍会启动线程等待文件出现）
+     */
+    bool start();
+
+    /**
+     * @brief 停止监视线程
+     */
+    void stop();
+
+    /**
+     * @brief 文件有变化时重新加载（监视线程周期性调用，也可手动调用）
+     * @return 是否发布了新快照
+     */
+    bool poll();
+
+    /**
+     * @brief 获取成功重新加载的次数
+     */
+    uint64_t reloads() const noexcept;
+
+private:
+    ConfigStore& store;
+    std::string path;
+    std::thread worker;
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool running;
+
+    // 上次加载时的文件状态，由 mutex 保护
+    bool loaded;
+    uint64_t last_stamp;        // 配置文件及其引用文件的修改时间和大小指纹
+
+    std::atomic<uint64_t> reload_count;
+
+    void run();
+};
+
+} // namespace dns_parser
+
+#endif // DNS_PARSER_CONFIG_STORE_H
@@ -0,0 +1,120 @@
+#ifndef DNS_PARSER_RUNTIME_CONFIG_H
+#define DNS_PARSER_RUNTIME_CONFIG_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include "config_parser.h"
+#include "../flows/policy_engine.h"
+#include "../flows/public_suffix.h"
+#include "../flows/load_shedder.h"
+
+namespace dns_parser {
+
+/**
+ * @brief 日志级别
+ */
+enum class LogLevel {
+    Debug,
+    Info,
+    Warning,
+    Error
+};
+
+/**
+ * @brief 强类型的运行时配置快照
+ *
+ * 由 ConfigParser 读出的字符串键值一次性转换为具体类型，发布后不再修改。
+ * Filter 只读取这里的字段，数据路径上不再有字符串查找和类型转换。
+ */
+struct RuntimeConfig {
+    // [Buffer]
+    size_t c2s_buffer_size;         // C2S 方向流缓冲区上限（字节，向下取整为 2 的幂）
+    size_t s2c_buffer_size;         // S2C 方向流缓冲区上限（字节，向下取整为 2 的幂）
+    size_t memory_budget;           // 所有流缓冲区的总字节预算，0 表示不限制
+    bool huge_pages;                // 大块缓冲区是否使用大页
+
+    // [Flow]
+    uint32_t flow_timeout_ms;       // 流超时时间（毫秒）
+    size_t max_flows;               // 最大流数量
+    uint32_t query_timeout_ms;      // 查询等待响应的超时时间（毫秒）
+    size_t max_pending_queries;     // 每个线程最多跟踪的未应答查询数
+
+    // [Performance]
+    bool enable_threading;          // 是否启用多线程
+    unsigned short thread_count;    // 工作线程数量
+
+    // [Logging]
+    LogLevel log_level;             // 日志级别
+    std::string log_file;           // 日志文件路径
+
+    // [Lists]
+    std::string blocklist_path;     // 域名黑名单文件路径
+    std::string allowlist_path;     // 域名白名单文件路径
+    std::string public_suffix_path; // 公共后缀列表（PSL）文件路径
+
+    // 由公共后缀列表编译出的后缀表，随快照一起发布；未配置时为空
+    std::shared_ptr<const PublicSuffixList> public_suffixes;
+
+    // [Policy]
+    std::string policy_path;        // 策略规则文件路径
+    SyntheticResponse sinkhole;     // 合成响应的黑洞地址和 TTL（kind 由命中的规则决定）
+
+    // 由规则文件和黑白名单编译出的策略，随快照一起发布；没有任何来源时为空
+    std::shared_ptr<const PolicyEngine> policy;
+
+    // [Shedding]
+    ShedPolicy shedding;            // 过载降级的阈值和抽样率
+
+    // [EDNS]
+    size_t max_subnets;             // 每个线程最多按客户端子网计数的子网数（线程状态创建时确定）
+    uint8_t subnet_ipv4_prefix;     // IPv4 客户端子网的聚合前缀
+    uint8_t subnet_ipv6_prefix;     // IPv6 客户端子网的聚合前缀
+
+    // [DNSSEC]
+    bool skip_dnssec;               // 解析时只记下 DNSSEC 记录的位置，不解压缩也不复制
+
+    // [Names]
+    bool normalize_names;           // 解析时把域名转为小写并检查标签字符和长度
+    size_t max_names;               // 每个线程驻留表的容量，写满时回收（线程状态创建时确定）
+
+    // [Diagnostics]
+    bool stage_timing;              // 是否记录各处理阶段的耗时直方图
+
+    // [Reload]
+    uint32_t reload_interval_ms;    // 配置文件变更检查间隔（毫秒）
+
+    // 发布版本号，由 ConfigStore::publish 填写
+    uint64_t version;
+
+    /**
+     * @brief 默认配置（与 config.ini 中的默认值一致）
+     */
+    RuntimeConfig();
+
+    /**
+     * @brief 从已解析的键值表构建快照，缺失或无效的键保留默认值
+     * @param parser 已加载的配置解析器
+     * @return 配置快照
+     */
+    static RuntimeConfig fromParser(const ConfigParser& parser);
+
+    /**
+     * @brief 从配置文件加载快照，并编译其中引用的策略规则、黑白名单和公共后缀列表
+     * @param filename 配置文件路径
+     * @param out 输出的配置快照
+     * @return 文件能否打开
+     */
+    static bool loadFromFile(const std::string& filename, RuntimeConfig& out);
+
+    /**
+     * @brief 解析日志级别名称（debug/info/warning/error，不区分大小写）
+     * @param name 级别名称
+     * @param fallback 无法识别时返回的级别
+     */
+    static LogLevel parseLogLevel(const std::string& name, LogLevel fallback = LogLevel::Info);
+};
+
+} // namespace dns_parser
+
+#endif // DNS_PARSER_RUNTIME_CONFIG_H
@@ -0,0 +1,76 @@
+#ifndef DNS_PARSER_DNS_ENCODER_H
+#define DNS_PARSER_DNS_ENCODER_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace dns_parser {
+
+/**
+ * @brief 合成响应的类型
+ */
+enum class SyntheticKind : uint8_t {
+    None = 0,       // 不合成响应
+    NXDomain,       // 域名不存在（rcode 3）
+    Refused,        // 拒绝（rcode 5）
+    Sinkhole        // 把 A/AAAA 查询解析到指定的黑洞地址，其他类型返回 NOERROR 空应答
+};
+
+/**
+ * @brief 合成响应的参数
+ */
+struct SyntheticResponse {
+    SyntheticKind kind;
+    uint32_t ttl;           // 黑洞记录的 TTL（秒）
+    bool has_ipv4;
+    bool has_ipv6;
+    uint8_t ipv4[4];        // 黑洞 IPv4 地址（网络字节序）
+    uint8_t ipv6[16];       // 黑洞 IPv6 地址
+
+    SyntheticResponse();
+};
+
+/**
+ * @brief 零分配的 DNS 响应编码器
+ *
+ * 直接在查询报文的线格式上生成响应：复制事务 ID、操作码、RD/CD 位和问题区，
+ * 回答区的所有者名用指向问题区域名（偏移 12）的压缩指针。输出缓冲区可以
+ * 与查询缓冲区相同（原地改写），编码过程不做任何堆分配。
+ *
+ * 只接受标准查询（QR=0、OPCODE=0、恰好一个问题、问题域名不含压缩指针），
+ * 查询中的附加区（如 EDNS OPT）不会带入响应。
+ */
+class DNSEncoder {
+public:
+    // 响应头部 + 问题区 + 两条黑洞记录的最大长度
+    static const size_t kMaxResponseSize = 12 + 255 + 4 + 2 * (12 + 16);
+
+    /**
+     * @brief 计算查询对应的合成响应长度
+     * @param query 查询报文
+     * @param length 查询长度
+     * @param response 合成参数
+     * @return 响应长度，查询不符合要求时返回 0
+     */
+    static size_t responseSize(const uint8_t* query, size_t length, const SyntheticResponse& response);
+
+    /**
+     * @brief 编码合成响应
+     * @param query 查询报文
+     * @param length 查询长度
+     * @param response 合成参数
+     * @param out 输出缓冲区，可以与 query 相同
+     * @param capacity 输出缓冲区容量
+     * @return 写入的字节数；查询不符合要求或容量不足时返回 0，且不修改输出缓冲区
+     */
+    static size_t encode(const uint8_t* query, size_t length, const SyntheticResponse& response,
+                         uint8_t* out, size_t capacity);
+
+private:
+    // 校验查询并返回问题区结束位置和问题类型，不符合要求时返回 0
+    static size_t questionEnd(const uint8_t* query, size_t length, uint16_t& qtype);
+};
+
+} // namespace dns_parser
+
+#endif // DNS_PARSER_DNS_ENCODER_H
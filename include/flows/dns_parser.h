@@ -3,20 +3,101 @@
 
 #include <string>
 #include <vector>
+#include "../tools/name_hash.h"
 #include "../tools/types.h"
 
 namespace dns_parser {
 
+class NameInterner;
+class PublicSuffixList;
+class StageRecorder;
+
+/**
+ * @brief 解析失败的原因
+ */
+enum class ParseError : uint8_t {
+    None = 0,
+    ShortHeader,        // 不足 12 字节的头部
+    BadName,            // 域名压缩指针环路或长度超过 255
+    TruncatedQuestion,  // 问题区在类型/类之前截断
+    TruncatedRecord,    // 资源记录的固定字段或 RDATA 截断
+    Count
+};
+
+/**
+ * @brief 解析选项
+ */
+struct ParseOptions {
+    bool intern_names;   // 域名写入驻留表，只填 name_id 而不复制到消息字节区
+    bool questions_only; // 只解析头部和问题区，跳过资源记录（过载降级时使用）
+    bool skip_dnssec;    // DNSSEC 记录只记下类型、TTL、所有者域名和资源数据在报文中的位置，不解压缩也不复制
+    bool normalize_names;   // 域名转为小写后再驻留或复制，检查结果写入 name_flags
+    NameInterner* interner;     // intern_names 使用的驻留表，为空时使用全局驻留表
+    const PublicSuffixList* public_suffixes;    // 非空时为每个问题求可注册域名的起始位置
+    StageRecorder* stages;  // 非空时记录头部、问题区、资源记录各阶段的耗时
+    ParseError* error;      // 非空时在解析失败时写入失败原因
+
+    ParseOptions()
+        : intern_names(false), questions_only(false), skip_dnssec(false), normalize_names(false),
+          interner(nullptr), public_suffixes(nullptr), stages(nullptr), error(nullptr) {}
+};
+
+/**
+ * @brief 按需解码的 RRSIG 记录
+ *
+ * 签名者域名按 RFC 4034 不压缩，签名本身只给出在原始报文中的位置
+ */
+struct RRSIGData {
+    uint16_t type_covered;      // 被签名的记录类型
+    uint8_t algorithm;
+    uint8_t labels;
+    uint32_t original_ttl;
+    uint32_t expiration;        // 签名过期时间（UNIX 秒，按 RFC 1982 序列号比较）
+    uint32_t inception;         // 签名生效时间
+    uint16_t key_tag;
+    std::string signer;         // 签名者域名
+    uint16_t signature_offset;  // 签名在原始报文中的偏移
+    uint16_t signature_length;
+};
+
+/**
+ * @brief 按需解码的 DNSKEY 记录
+ */
+struct DNSKEYData {
+    uint16_t flags;             // 0x0100 为区域密钥，0x0001 为 SEP（KSK）
+    uint8_t protocol;           // 固定为 3
+    uint8_t algorithm;
+    uint16_t key_tag;           // 按 RFC 4034 附录 B 计算，与 RRSIG/DS 中的 key_tag 对应
+    uint16_t key_offset;        // 公钥在原始报文中的偏移
+    uint16_t key_length;
+};
+
 class DNSParser {
 public:
+    // 域名文本形式的最大长度
+    static const size_t kMaxNameLength = 255;
+
     /**
      * @brief 解析 DNS 查询包
+     *
+     * 问题区之后的资源记录（通常只有附加区的 OPT）尽力解析，截断或格式错误
+     * 只会让 message 中缺少这些记录，不影响查询本身的解析结果
+     *
      * @param data 原始数据
-     * @param message 解析后的消息结构
+     * @param message 解析后的消息结构（先被清空，可重复使用以保留已分配的容量）
      * @return 是否解析成功
      */
     static bool parseQuery(const std::string& data, Message& message);
 
+    /**
+     * @brief 按指定选项解析 DNS 查询包
+     * @param data 原始数据
+     * @param message 解析后的消息结构
+     * @param options 解析选项
+     * @return 是否解析成功
+     */
+    static bool parseQuery(const std::string& data, Message& message, const ParseOptions& options);
+
     /**
      * @brief 解析 DNS 响应包
      * @param data 原始数据
@@ -24,6 +105,15 @@ public:
      * @return 是否解析成功
      */
     static bool parseResponse(const std::string& data, Message& message);
+
+    /**
+     * @brief 按指定选项解析 DNS 响应包
+     * @param data 原始数据
+     * @param message 解析后的消息结构
+     * @param options 解析选项
+     * @return 是否解析成功
+     */
+    static bool parseResponse(const std::string& data, Message& message, const ParseOptions& options);
     
     /**
      * @brief 输出 DNS 消息的详细信息
@@ -31,6 +121,14 @@ public:
      * @param isQuery 是否是查询包
      */
     static void printMessageDetails(const Message& message, bool isQuery);
+
+    /**
+     * @brief 以指定事务 ID 输出 DNS 消息的详细信息（用于复用缓存的解析结果）
+     * @param message DNS 消息结构
+     * @param isQuery 是否是查询包
+     * @param transactionId 实际报文的事务 ID
+     */
+    static void printMessageDetails(const Message& message, bool isQuery, uint16_t transactionId);
     
     /**
      * @brief 输出 DNS 头部信息
@@ -40,16 +138,70 @@ public:
     
     /**
      * @brief 输出 DNS 查询问题信息
-     * @param questions DNS 查询问题列表
+     * @param message 问题所属的消息
      */
-    static void printQuestions(const std::vector<DNSQuestion>& questions);
+    static void printQuestions(const Message& message);
     
     /**
      * @brief 输出 DNS 资源记录信息
-     * @param records DNS 资源记录列表
+     * @param message 记录所属的消息
+     * @param records 一个区段的资源记录
      * @param recordType 记录类型名称（如“应答”、“权威”、“附加”）
      */
-    static void printResourceRecords(const std::vector<DNSResourceRecord>& records, const std::string& recordType);
+    static void printResourceRecords(const Message& message, const RecordSpan& records, const std::string& recordType);
+
+    /**
+     * @brief 从报文指定偏移处解码域名（支持压缩指针）
+     * @param data 原始数据
+     * @param offset 域名起始偏移
+     * @return 解析出的域名
+     */
+    static std::string decodeDomainName(const std::string& data, size_t offset);
+
+    /**
+     * @brief 解码域名，同一遍内计算整个域名和各级后缀的哈希（大小写不敏感）
+     * @param data 原始数据
+     * @param offset 域名起始偏移
+     * @param hash 输出的哈希，与 hashNameText(返回值) 一致
+     * @return 解析出的域名，失败时为空且 hash 为根域
+     */
+    static std::string decodeDomainName(const std::string& data, size_t offset, NameHash& hash);
+
+    /**
+     * @brief 是否是 skip_dnssec 跳过的类型（DS、RRSIG、NSEC、DNSKEY、NSEC3、NSEC3PARAM）
+     */
+    static bool isDnssecType(uint16_t type) {
+        return type == static_cast<uint16_t>(DNSType::DS) || type == static_cast<uint16_t>(DNSType::RRSIG) ||
+               type == static_cast<uint16_t>(DNSType::NSEC) || type == static_cast<uint16_t>(DNSType::DNSKEY) ||
+               type == static_cast<uint16_t>(DNSType::NSEC3) || type == static_cast<uint16_t>(DNSType::NSEC3PARAM);
+    }
+
+    /**
+     * @brief 取得记录的所有者域名，跳过的记录从原始报文中解压缩
+     * @param data 解析 message 时的原始数据
+     * @param message 记录所属的消息
+     * @param rr 资源记录
+     * @return 所有者域名
+     */
+    static std::string ownerName(const std::string& data, const Message& message, const DNSResourceRecord& rr);
+
+    /**
+     * @brief 按需解码 RRSIG 记录（是否跳过均可），从原始报文读取
+     * @param data 解析 rr 时的原始数据
+     * @param rr 类型为 RRSIG 的记录
+     * @param out 输出的解码结果
+     * @return 资源数据是否合法
+     */
+    static bool decodeRRSIG(const std::string& data, const DNSResourceRecord& rr, RRSIGData& out);
+
+    /**
+     * @brief 按需解码 DNSKEY 记录（是否跳过均可），从原始报文读取
+     * @param data 解析 rr 时的原始数据
+     * @param rr 类型为 DNSKEY 的记录
+     * @param out 输出的解码结果
+     * @return 资源数据是否合法
+     */
+    static bool decodeDNSKEY(const std::string& data, const DNSResourceRecord& rr, DNSKEYData& out);
 
 private:
     /**
@@ -62,21 +214,129 @@ private:
     static bool parseHeader(const std::string& data, size_t& offset, DNSHeader& header);
 
     /**
-     * @brief 解析域名
+     * @brief 解析头部声明数量的查询问题
      * @param data 原始数据
      * @param offset 当前偏移量
-     * @return 解析出的域名
+     * @param message 消息结构，问题追加到 questions
+     * @param options 解析选项
+     * @return 是否解析成功
+     */
+    static bool parseQuestions(const std::string& data, size_t& offset, Message& message,
+                               const ParseOptions& options);
+
+    /**
+     * @brief 依次解析应答、权威和附加区段，记录区段边界
+     * @param data 原始数据
+     * @param offset 当前偏移量
+     * @param message 消息结构
+     * @param options 解析选项
+     * @return 是否解析成功
+     */
+    static bool parseSections(const std::string& data, size_t& offset, Message& message,
+                              const ParseOptions& options);
+
+    /**
+     * @brief 解析一个区段的资源记录
+     * @param data 原始数据
+     * @param offset 当前偏移量
+     * @param count 记录数
+     * @param message 消息结构，记录追加到 records
+     * @param options 解析选项
+     * @return 是否解析成功
+     */
+    static bool parseRecords(const std::string& data, size_t& offset, uint16_t count, Message& message,
+                             const ParseOptions& options);
+
+    /**
+     * @brief 解析域名到调用方提供的缓冲区（不分配内存）
+     * @param data 原始数据
+     * @param offset 当前偏移量，成功后指向域名之后
+     * @param out 输出缓冲区，至少 kMaxNameLength 字节
+     * @param length 输出域名长度
+     * @param hash 非空时在复制标签的同一遍内计算各级后缀哈希
+     * @return 是否解析成功（指针环路、名字过长视为失败；截断时保留已解析部分）
+     */
+    static bool readDomainName(const std::string& data, size_t& offset, char* out, size_t& length,
+                               NameHash* hash = nullptr);
+
+    /**
+     * @brief 解析域名并按选项追加到消息字节区或写入驻留 ID
+     * @param data 原始数据
+     * @param offset 当前偏移量
+     * @param message 消息结构，域名追加到 bytes
+     * @param name_id 输出域名驻留 ID
+     * @param name_length 输出追加到字节区的域名长度
+     * @param name_flags 输出域名检查结果（NameFlag 的组合，未开启 normalize_names 时为 0）
+     * @param options 解析选项
+     * @param registrable_offset 非空且选项带公共后缀列表时，输出可注册域名在文本中的起始位置
+     * @return 是否解析成功
      */
-    static std::string parseDomainName(const std::string& data, size_t& offset);
+    static bool parseName(const std::string& data, size_t& offset, Message& message, uint32_t& name_id,
+                          uint8_t& name_length, uint8_t& name_flags, const ParseOptions& options,
+                          uint8_t* registrable_offset = nullptr);
+
+    /**
+     * @brief 解析查询问题
+     * @param data 原始数据
+     * @param offset 当前偏移量
+     * @param message 消息结构
+     * @param question 查询问题结构
+     * @param options 解析选项
+     * @return 是否解析成功
+     */
+    static bool parseQuestion(const std::string& data, size_t& offset, Message& message, DNSQuestion& question,
+                              const ParseOptions& options);
 
     /**
      * @brief 解析资源记录
      * @param data 原始数据
      * @param offset 当前偏移量
+     * @param message 消息结构，域名、资源数据和内嵌域名追加到 bytes
+     * @param rr 资源记录结构
+     * @param value 输出的资源数据解码结果
+     * @param options 解析选项
+     * @return 是否解析成功
+     */
+    static bool parseResourceRecord(const std::string& data, size_t& offset, Message& message,
+                                    DNSResourceRecord& rr, RData& value, const ParseOptions& options);
+
+    /**
+     * @brief 跳过一个域名，不跟随压缩指针也不复制
+     * @param data 原始数据
+     * @param offset 当前偏移量，成功后指向域名之后
+     * @return 域名是否完整
+     */
+    static bool skipName(const std::string& data, size_t& offset);
+
+    /**
+     * @brief 按记录类型解码资源数据，内嵌域名按整个报文解压缩
+     * @param data 原始数据
+     * @param message 消息结构，资源数据已追加到 bytes，内嵌域名继续追加
      * @param rr 资源记录结构
+     * @param value 输出的解码结果，格式不合法时为 RDataKind::Malformed
+     */
+    static void decodeRData(const std::string& data, Message& message, const DNSResourceRecord& rr, RData& value);
+
+    /**
+     * @brief 解码 OPT 伪记录：UDP 负载长度、扩展响应码、DO 位、Cookie 和客户端子网
+     * @param data 原始数据
+     * @param rr OPT 记录
+     * @param raw 资源数据在消息字节区中的偏移
+     * @param opt 输出的解码结果
+     * @return 选项序列是否合法
+     */
+    static bool decodeOpt(const std::string& data, const DNSResourceRecord& rr, uint32_t raw, OPTData& opt);
+
+    /**
+     * @brief 解压缩资源数据中的一个域名并追加到消息字节区
+     * @param data 原始数据
+     * @param offset 当前偏移量，成功后指向域名之后
+     * @param end 资源数据的结束偏移，域名不能越过
+     * @param message 消息结构
+     * @param ref 输出的域名位置
      * @return 是否解析成功
      */
-    static bool parseResourceRecord(const std::string& data, size_t& offset, DNSResourceRecord& rr);
+    static bool decodeName(const std::string& data, size_t& offset, size_t end, Message& message, ByteRef& ref);
 };
 
 } // namespace dns_parser
@@ -0,0 +1,237 @@
+#ifndef DNS_PARSER_FLOW_TABLE_H
+#define DNS_PARSER_FLOW_TABLE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "../tools/CircularString.h"
+#include "../tools/buffer_pool.h"
+#include "../tools/flat_hash_map.h"
+#include "../tools/timer_wheel.h"
+#include "../tools/types.h"
+
+namespace dns_parser {
+
+/**
+ * @brief 四元组哈希函数对象
+ */
+struct FourTupleHash {
+    size_t operator()(const FourTuple& key) const;
+};
+
+/**
+ * @brief 流缓冲区写入结果
+ */
+enum class AppendResult : uint8_t {
+    Ok,             // 写入成功
+    OverLimit,      // 超过该方向的容量上限，与内存预算无关
+    NoBudget        // 扩容时缓冲池预算不足
+};
+
+/**
+ * @brief 单方向的可增长流缓冲区
+ *
+ * 初始不占内存，首次写入时从缓冲池取最小的合适块，写满时换成更大的块
+ * （数据线性化搬迁），直到达到该方向的上限。
+ */
+class FlowBuffer {
+public:
+    FlowBuffer();
+
+    /**
+     * @brief 追加数据，必要时扩容
+     * @param pool 缓冲池
+     * @param max_size 该方向的容量上限
+     * @param data 数据起始地址
+     * @param len 数据长度
+     * @return 写入结果；失败时不写入任何字节
+     */
+    AppendResult append(BufferPool& pool, size_t max_size, const char* data, size_t len);
+
+    /**
+     * @brief 获取底层环形字符串，未分配时返回 nullptr
+     */
+    CircularString* stream() noexcept;
+
+    /**
+     * @brief 丢弃前 n 个字节
+     */
+    void consume(size_t n);
+
+    /**
+     * @brief 把块归还缓冲池，缓冲区中的数据一并丢弃
+     * @return 归还的字节数
+     */
+    size_t release(BufferPool& pool) noexcept;
+
+    size_t size() const noexcept;
+    size_t capacity() const noexcept;
+
+private:
+    std::unique_ptr<CircularString> ring;
+    char* block;            // 从缓冲池取得的块
+    size_t block_size;      // 块大小，未分配时为 0
+};
+
+/**
+ * @brief 流表
+ *
+ * 以客户端到服务端方向的四元组为键，保存 DNS over TCP 等流式传输的重组缓冲区。
+ * 流对象存放在连续数组中按下标引用，哈希表只保存键到下标的映射。
+ * 所有流按最近活动顺序串在侵入式双向链表上，流数量达到上限时 O(1) 淘汰链表头部
+ * 最久未活动的流。缓冲池预算不足时从最久未活动的流开始回收缓冲区（流本身保留）：
+ * 没有未处理数据的缓冲区直接归还，只有空闲超过 kReclaimIdleMs 的流才丢弃
+ * 其中不完整的消息，活跃连接的重组数据不受影响。写入超过方向上限只是该流
+ * 自身的溢出，不触发回收。
+ *
+ * 超时由线程共享的时间轮驱动：每个流只挂一个定时器，活动时只更新 last_seen，
+ * 定时器到期时若流期间有过活动则按 last_seen 重新挂入，否则删除流。
+ *
+ * 每个工作线程持有一个实例，本类不是线程安全的。
+ */
+class FlowTable {
+public:
+    // 活动顺序链表的空指针
+    static const uint32_t kNoFlow = 0xFFFFFFFFu;
+
+    /**
+     * @brief 流对象
+     */
+    struct Flow {
+        FourTuple key;          // 客户端到服务端方向的四元组
+        uint64_t last_seen;     // 最近一次活动时间（毫秒）
+        TimerWheel::Handle timer;   // 超时定时器
+        uint32_t older;         // 活动顺序链表中更早活动的流
+        uint32_t newer;         // 活动顺序链表中更晚活动的流
+        bool live;              // 槽位是否在用
+        bool stream;            // 是否为带 2 字节长度前缀的流式传输
+        FlowBuffer c2s;         // 客户端到服务端方向缓冲区
+        FlowBuffer s2c;         // 服务端到客户端方向缓冲区
+
+        Flow()
+            : last_seen(0), timer(TimerWheel::kInvalidHandle), older(kNoFlow), newer(kNoFlow), live(false),
+              stream(false) {}
+    };
+
+    /**
+     * @brief 统计快照
+     */
+    struct Stats {
+        size_t flows;               // 当前流数量
+        uint64_t created;           // 新建流数
+        uint64_t evicted;           // 因流数量达到上限被淘汰的流数
+        uint64_t timeouts;          // 超时删除的流数
+        uint64_t reclaimed_bytes;   // 因预算不足从空闲流回收的字节数
+        uint64_t overflows;         // 写入失败（超过上限或预算不足）的次数
+    };
+
+    // 时间轮用户数据的类别标记（高 8 位），低位为流下标
+    static const uint64_t kTimerTag = uint64_t(1) << 56;
+
+    // 预算不足时，空闲超过该时长（毫秒）的流中不完整的消息才会被丢弃
+    static const uint64_t kReclaimIdleMs = 1000;
+
+    /**
+     * @brief 构造函数
+     * @param pool 缓冲池
+     * @param timers 时间轮（刻度为毫秒）
+     * @param max_flows 最大流数量
+     * @param c2s_max C2S 方向缓冲区上限（字节）
+     * @param s2c_max S2C 方向缓冲区上限（字节）
+     * @param timeout_ms 流空闲超时（毫秒）
+     */
+    FlowTable(BufferPool& pool, TimerWheel& timers, size_t max_flows, size_t c2s_max, size_t s2c_max,
+              uint32_t timeout_ms);
+    ~FlowTable();
+
+    FlowTable(const FlowTable&) = delete;
+    FlowTable& operator=(const FlowTable&) = delete;
+
+    /**
+     * @brief 更新上限（配置热加载后调用），已有的缓冲区不会缩小
+     */
+    void setLimits(size_t max_flows, size_t c2s_max, size_t s2c_max, uint32_t timeout_ms);
+
+    /**
+     * @brief 查找流
+     * @return 流指针，不存在时返回 nullptr；在下一次 touch 之前有效
+     */
+    Flow* find(const FourTuple& key);
+
+    /**
+     * @brief 查找流，不存在时创建
+     * @param key 客户端到服务端方向的四元组
+     * @param now_ms 当前时间（毫秒）
+     * @return 流引用，在下一次 touch 之前有效
+     */
+    Flow& touch(const FourTuple& key, uint64_t now_ms);
+
+    /**
+     * @brief 向流的某个方向追加数据，预算不足时先回收其他流的缓冲区
+     * @param flow 目标流（由本次 touch 取得，last_seen 即当前时间）
+     * @param c2s 是否为客户端到服务端方向
+     * @param data 数据起始地址
+     * @param len 数据长度
+     * @return 是否写入成功
+     */
+    bool append(Flow& flow, bool c2s, const char* data, size_t len);
+
+    /**
+     * @brief 删除流并归还其缓冲区
+     * @return 流是否存在
+     */
+    bool remove(const FourTuple& key);
+
+    /**
+     * @brief 从最久未活动的流开始回收缓冲区，直到回收至少 bytes 字节
+     *
+     * 没有未处理数据的缓冲区总是可以回收；仍有数据的缓冲区只在所属流空闲
+     * 超过 kReclaimIdleMs 时回收。不分配内存，沿活动顺序链表遍历。
+     *
+     * @param bytes 需要回收的字节数
+     * @param now_ms 当前时间（毫秒）
+     * @param keep 不参与回收的流（可为 nullptr）
+     * @return 实际回收的字节数
+     */
+    size_t reclaimIdle(size_t bytes, uint64_t now_ms, const Flow* keep);
+
+    /**
+     * @brief 处理时间轮回调
+     * @param data 定时器用户数据（kTimerTag | 流下标）
+     * @param now_ms 当前时间（毫秒）
+     */
+    void onTimer(uint64_t data, uint64_t now_ms);
+
+    size_t size() const noexcept;
+    Stats stats() const noexcept;
+
+private:
+    BufferPool& pool;
+    TimerWheel& timers;
+    size_t max_flows;
+    size_t c2s_max;
+    size_t s2c_max;
+    uint32_t timeout_ms;
+
+    std::vector<Flow> flows;
+    std::vector<uint32_t> free_slots;
+    uint32_t oldest;        // 活动顺序链表头（最久未活动）
+    uint32_t newest;        // 活动顺序链表尾（最近活动）
+    FlatHashMap<FourTuple, uint32_t, FourTupleHash> index;
+
+    uint64_t created_count;
+    uint64_t evicted_count;
+    uint64_t timeout_count;
+    uint64_t reclaimed_bytes;
+    uint64_t overflow_count;
+
+    void releaseSlot(uint32_t slot);
+    void evictOldest();
+    void linkNewest(uint32_t slot);
+    void unlink(uint32_t slot);
+};
+
+} // namespace dns_parser
+
+#endif // DNS_PARSER_FLOW_TABLE_H
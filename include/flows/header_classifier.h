@@ -0,0 +1,64 @@
+#ifndef DNS_PARSER_HEADER_CLASSIFIER_H
+#define DNS_PARSER_HEADER_CLASSIFIER_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace dns_parser {
+
+/**
+ * @brief 解析前头部检查的结果
+ */
+enum class HeaderCheck : uint8_t {
+    Ok = 0,
+    TooShort,           // 不足 12 字节
+    BadOpcode,          // 未分配的操作码（3、7-15）
+    WrongDirection,     // QR 位与发送方角色不符
+    CountsExceedLength, // 各区段声明的记录数在报文长度内放不下
+    Count
+};
+
+/**
+ * @brief 只看 12 字节头部和报文长度，判断数据是否可能是 DNS 消息
+ *
+ * 端口 53 上的非 DNS 流量和垃圾数据在这里被拒绝，不进入解析、缓存和统计。
+ * 每个问题至少 5 字节（根域名加类型和类），每条记录至少 11 字节（根域名加
+ * 固定字段），声明的数量按这个下限换算后超过报文长度的一定不是合法消息。
+ * 几项检查互不依赖，合法报文只经过一次合并后的判断。
+ *
+ * @param data 报文（流式传输时不含长度前缀），不足 12 字节时只读取 length 字节
+ * @param length 报文长度
+ * @param from_client 是否由客户端发出（应为 QR=0）
+ * @return 检查结果，同时命中多项时按枚举顺序返回第一项
+ */
+inline HeaderCheck classifyHeader(const uint8_t* data, size_t length, bool from_client) noexcept {
+    if (length < 12) {
+        return HeaderCheck::TooShort;
+    }
+    // QUERY、IQUERY、STATUS、NOTIFY、UPDATE、DSO
+    const uint32_t kValidOpcodes = 0x77;
+    uint32_t opcode = (data[2] >> 3) & 0x0F;
+    bool response = (data[2] & 0x80) != 0;
+    uint64_t questions = (static_cast<uint32_t>(data[4]) << 8) | data[5];
+    uint64_t records = ((static_cast<uint32_t>(data[6]) << 8) | data[7]) +
+                       ((static_cast<uint32_t>(data[8]) << 8) | data[9]) +
+                       ((static_cast<uint32_t>(data[10]) << 8) | data[11]);
+
+    bool bad_opcode = ((kValidOpcodes >> opcode) & 1) == 0;
+    bool wrong_direction = response == from_client;
+    bool overflow = 12 + questions * 5 + records * 11 > length;
+    if (!(bad_opcode | wrong_direction | overflow)) {
+        return HeaderCheck::Ok;
+    }
+    return bad_opcode ? HeaderCheck::BadOpcode
+                      : (wrong_direction ? HeaderCheck::WrongDirection : HeaderCheck::CountsExceedLength);
+}
+
+/**
+ * @brief 检查结果的名称，用于日志
+ */
+const char* headerCheckName(HeaderCheck check);
+
+} // namespace dns_parser
+
+#endif // DNS_PARSER_HEADER_CLASSIFIER_H
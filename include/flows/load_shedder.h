@@ -0,0 +1,114 @@
+#ifndef DNS_PARSER_LOAD_SHEDDER_H
+#define DNS_PARSER_LOAD_SHEDDER_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace dns_parser {
+
+/**
+ * @brief 降级级别，同时表示单个数据包的处理深度
+ */
+enum class ShedLevel : uint8_t {
+    Full = 0,       // 完整解析
+    Questions = 1,  // 只解析头部和问题区
+    Sampling = 2    // 只计数；按 1/N 抽样的数据包解析头部和问题区
+};
+
+/**
+ * @brief 降级控制参数
+ */
+struct ShedPolicy {
+    bool enabled;               // 默认关闭，需要在配置中显式启用
+    uint32_t latency_high_ns;   // 当前级别的处理时延（EWMA）超过该值时降一级
+    uint32_t latency_low_ns;    // 上一级的处理时延低于该值时才允许恢复
+    uint8_t pressure_high;      // 宿主队列占用（百分比）超过该值时降一级
+    uint8_t pressure_low;       // 队列占用低于该值时才允许恢复
+    uint32_t sample_rate;       // 降级后每 N 个数据包按上一级深度处理一个
+    uint32_t hold_ms;           // 两次级别变化的最小间隔（数据包时间，毫秒）
+
+    ShedPolicy();
+};
+
+/**
+ * @brief 按线程的过载降级控制器
+ *
+ * 每个数据包先调用 admit() 取得处理深度，处理完后用 observe() 报告耗时和宿主
+ * 队列占用。级别按 完整解析 -> 头部+问题 -> 抽样计数 逐级变化，两次变化之间
+ * 至少间隔 hold_ms，降级和恢复使用不同的阈值，避免在阈值附近来回切换。
+ *
+ * 降级后每 N 个数据包中有一个按上一级深度处理：抽样级别下这就是 1/N 抽样，
+ * 同时让上一级的时延估计保持更新，恢复条件用的是上一级自己的时延，
+ * 不会因为当前级别更轻而过早恢复。
+ *
+ * 每个工作线程持有一个实例，本类不是线程安全的。
+ */
+class LoadShedder {
+public:
+    static const size_t kLevels = 3;
+
+    /**
+     * @brief 一次级别变化
+     */
+    struct Transition {
+        ShedLevel from;
+        ShedLevel to;
+        uint32_t latency_ns;    // 触发变化时当前级别的时延估计
+        uint8_t pressure;       // 触发变化时的队列占用
+    };
+
+    /**
+     * @brief 统计快照
+     */
+    struct Stats {
+        ShedLevel level;
+        uint64_t transitions;           // 级别变化次数
+        uint64_t packets[kLevels];      // 按各处理深度处理的数据包数
+        uint32_t latency_ns[kLevels];   // 各处理深度的时延估计（EWMA）
+    };
+
+    LoadShedder(const ShedPolicy& policy, uint64_t now_ms);
+
+    /**
+     * @brief 更新控制参数（配置热加载后调用），关闭时立即回到完整解析
+     */
+    void setPolicy(const ShedPolicy& policy);
+
+    /**
+     * @brief 取得下一个数据包的处理深度
+     */
+    ShedLevel admit() noexcept;
+
+    /**
+     * @brief 报告一个数据包的处理结果，必要时改变级别
+     * @param depth 该数据包的处理深度（admit 的返回值）
+     * @param latency_ns 处理耗时（纳秒）
+     * @param pressure 宿主队列占用百分比，未知时为 0
+     * @param now_ms 数据包时间（毫秒）
+     * @param change 级别变化时写入变化详情，可为 nullptr
+     * @return 级别是否变化
+     */
+    bool observe(ShedLevel depth, uint64_t latency_ns, uint8_t pressure, uint64_t now_ms, Transition* change);
+
+    ShedLevel level() const noexcept;
+    Stats stats() const noexcept;
+
+    /**
+     * @brief 级别名称，用于日志
+     */
+    static const char* levelName(ShedLevel level);
+
+private:
+    ShedPolicy policy;
+    ShedLevel current;
+    uint32_t counter;               // 抽样计数
+    uint64_t last_change_ms;
+    uint64_t transitions;
+    uint64_t packets[kLevels];
+    uint32_t latency[kLevels];      // EWMA，权重 1/8
+    bool sampled[kLevels];          // 该深度是否已有时延样本
+};
+
+} // namespace dns_parser
+
+#endif // DNS_PARSER_LOAD_SHEDDER_H
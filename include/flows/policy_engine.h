@@ -0,0 +1,201 @@
+#ifndef DNS_PARSER_POLICY_ENGINE_H
+#define DNS_PARSER_POLICY_ENGINE_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "dns_encoder.h"
+#include "../tools/flat_hash_map.h"
+#include "../tools/types.h"
+
+namespace dns_parser {
+
+/**
+ * @brief 策略动作，取值与 TASK::Action 一致
+ */
+enum class PolicyAction : uint8_t {
+    None = 0,               // 没有规则命中，保持宿主默认处理
+    Acknowledge = 0x21,     // 知晓：插件已处理，宿主不再转发（拦截）
+    Forward = 0x22          // 转发
+};
+
+/**
+ * @brief IP 前缀
+ */
+struct IpPrefix {
+    uint8_t version;        // 4 或 6
+    uint8_t length;         // 前缀长度（位）
+    uint8_t addr[16];       // 地址（网络字节序），前缀之外的位为 0
+
+    /**
+     * @brief 解析 "10.0.0.0/8"、"2001:db8::/32" 或不带长度的单个地址
+     * @return 格式是否有效
+     */
+    static bool parse(const std::string& text, IpPrefix& out);
+};
+
+/**
+ * @brief 单条策略规则
+ *
+ * 各字段之间为"与"，同一字段的多个取值之间为"或"，空字段表示不限制。
+ */
+struct PolicyRule {
+    PolicyAction action;
+    SyntheticKind respond;              // 拦截查询时代为应答的方式
+    std::vector<std::string> qnames;    // 问题域名后缀（example.com 同时匹配其子域名）
+    std::vector<uint16_t> qtypes;       // 问题类型
+    std::vector<uint8_t> rcodes;        // 响应码（只匹配响应）
+    std::vector<IpPrefix> clients;      // 客户端地址前缀
+    std::vector<IpPrefix> answers;      // 任一 A/AAAA 应答地址落在前缀内
+
+    PolicyRule() : action(PolicyAction::None), respond(SyntheticKind::None) {}
+};
+
+/**
+ * @brief 一次判定的输入
+ */
+struct PolicyRequest {
+    const uint8_t* data;        // DNS 消息（不含 TCP 长度前缀）
+    size_t length;
+    const Message* message;     // 已解析的消息，用于匹配应答地址，可为 nullptr
+    uint8_t client_version;     // 客户端地址版本 4/6，0 表示未知
+    const uint8_t* client;      // 客户端地址（网络字节序）
+};
+
+/**
+ * @brief 编译后的 DNS 策略
+ *
+ * 加载时把规则编译成扁平的判定表（位向量分类）：每个字段按取值建一张哈希表，
+ * 值为"该取值命中的规则集合"位图，字段不限制的规则放在该字段的通配位图中。
+ * 判定时每个字段做一次（前缀字段按出现过的前缀长度各做一次）查表，
+ * 把各字段的位图按位与，最低位的规则即为命中规则，规则按书写顺序优先。
+ *
+ * 域名后缀直接在报文的线格式标签上计算，不构造字符串；后缀以 64 位哈希
+ * 作为键，不做字符串回查。
+ *
+ * 编译后只读，可以被多个线程同时使用。
+ *
+ * 规则文件每行一条规则，# 开头为注释：
+ *   block qname=ads.example.com,tracker.net qtype=A,AAAA
+ *   forward client=10.0.0.0/8
+ *   block rcode=NXDOMAIN answer=0.0.0.0/8
+ *   block qname=malware.test respond=sinkhole
+ *   default forward
+ * 动作 block/drop 对应 Acknowledge，forward/allow 对应 Forward。block 规则可以带
+ * respond=nxdomain|refused|sinkhole，表示由插件合成响应代为应答被拦截的查询。
+ */
+class PolicyEngine {
+public:
+    // 规则数上限
+    static const size_t kMaxRules = 1024;
+
+    /**
+     * @brief 判定结果
+     */
+    struct Decision {
+        PolicyAction action;
+        SyntheticKind respond;  // 命中规则要求的合成响应
+        int rule;               // 命中的规则下标，-1 表示使用默认动作
+    };
+
+    /**
+     * @brief 编译规则
+     * @param rules 按优先级排列的规则，超过 kMaxRules 的部分被忽略
+     * @param default_action 没有规则命中时的动作
+     */
+    explicit PolicyEngine(const std::vector<PolicyRule>& rules,
+                          PolicyAction default_action = PolicyAction::None);
+
+    /**
+     * @brief 对一条 DNS 消息做判定
+     */
+    Decision evaluate(const PolicyRequest& request) const;
+
+    size_t ruleCount() const noexcept;
+    PolicyAction defaultAction() const noexcept;
+
+    /**
+     * @brief 解析规则文本（规则文件格式）
+     * @param text 规则文本
+     * @param rules 追加解析出的规则
+     * @param default_action 遇到 default 行时写入
+     * @param error 出错时写入的错误描述（含行号），可为 nullptr
+     * @return 是否全部解析成功；失败时 rules 保持不变
+     */
+    static bool parseRules(const std::string& text, std::vector<PolicyRule>& rules, PolicyAction& default_action,
+                           std::string* error);
+
+    /**
+     * @brief 从规则文件和域名名单加载并编译策略
+     *
+     * 名单每行一个域名，也接受 hosts 文件格式；白名单编译为一条 forward 规则，排在规则文件之前；黑名单编译为一条 block 规则，
+     * 排在规则文件之后。路径为空的来源被跳过，文件无法读取或规则有误时输出警告并跳过该来源。
+     *
+     * @return 编译后的策略，所有来源都为空时返回 nullptr
+     */
+    static std::shared_ptr<const PolicyEngine> load(const std::string& rules_path, const std::string& allowlist_path,
+                                                    const std::string& blocklist_path);
+
+private:
+    // 字段编号
+    enum Field {
+        FIELD_QNAME = 0,
+        FIELD_QTYPE,
+        FIELD_RCODE,
+        FIELD_CLIENT,
+        FIELD_ANSWER,
+        FIELD_COUNT
+    };
+
+    static const uint32_t kNoRow = 0xFFFFFFFFu;
+    static const size_t kMaxWords = kMaxRules / 64;
+
+    typedef std::array<uint8_t, 16> IPv6Key;
+
+    struct IPv6KeyHash {
+        size_t operator()(const IPv6Key& key) const;
+    };
+
+    // 同一前缀长度的 IPv4 / IPv6 前缀表，键为按长度截断后的地址
+    struct IPv4Group {
+        uint8_t length;
+        FlatHashMap<uint32_t, uint32_t> rows;
+    };
+    struct IPv6Group {
+        uint8_t length;
+        FlatHashMap<IPv6Key, uint32_t, IPv6KeyHash> rows;
+    };
+    struct PrefixTable {
+        std::vector<IPv4Group> v4;
+        std::vector<IPv6Group> v6;
+    };
+
+    std::vector<PolicyAction> actions;  // 各规则的动作
+    std::vector<SyntheticKind> responds;  // 各规则的合成响应方式
+    PolicyAction default_action;
+    size_t words;                       // 位图的 64 位字数
+    unsigned used_fields;               // 至少有一条规则限制的字段
+
+    // 位图行：前 FIELD_COUNT 行是各字段的通配位图，其余行由各字段的表引用
+    std::vector<uint64_t> rows;
+
+    FlatHashMap<uint64_t, uint32_t> qname_rows;     // 域名后缀哈希 -> 位图行
+    FlatHashMap<uint32_t, uint32_t> qtype_rows;     // 问题类型 -> 位图行
+    uint32_t rcode_rows[16];                        // 响应码 -> 位图行
+    PrefixTable client_rows;
+    PrefixTable answer_rows;
+
+    uint32_t newRow();
+    void setBit(uint32_t row, size_t rule);
+    void addPrefix(PrefixTable& table, const IpPrefix& prefix, size_t rule);
+    void orPrefixes(const PrefixTable& table, uint8_t version, const uint8_t* addr, uint64_t* acc) const;
+    void orRow(uint32_t row, uint64_t* acc) const;
+    static void andInto(uint64_t* acc, const uint64_t* mask, size_t words);
+};
+
+} // namespace dns_parser
+
+#endif // DNS_PARSER_POLICY_ENGINE_H
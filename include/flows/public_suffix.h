@@ -0,0 +1,89 @@
+#ifndef DNS_PARSER_PUBLIC_SUFFIX_H
+#define DNS_PARSER_PUBLIC_SUFFIX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include "../tools/flat_hash_map.h"
+#include "../tools/name_hash.h"
+
+namespace dns_parser {
+
+/**
+ * @brief 公共后缀列表（Public Suffix List），用于求域名的可注册部分（eTLD+1）
+ *
+ * 规则按后缀哈希编译成扁平的字典树：每条规则的每一级后缀都是一个节点，
+ * 节点上标记该后缀本身是规则、其下一级都是规则（"*.ck"）或是例外（"!www.ck"）。
+ * 查找直接使用解码域名时算好的各级后缀哈希，从顶级域向左逐级查表，遇到不存在的
+ * 节点即停止，不分配内存也不再读取域名文本。
+ *
+ * 匹配按 PSL 的约定：例外规则优先，其次取标签最多的规则，没有规则命中时
+ * 顶级域本身是公共后缀（默认规则 "*"）。节点只按 64 位哈希比较，不保存文本。
+ */
+class PublicSuffixList {
+public:
+    static const size_t npos = static_cast<size_t>(-1);
+
+    PublicSuffixList();
+
+    /**
+     * @brief 加入一条规则，如 "com"、"*.ck"、"!www.ck"，Unicode 标签转为 "xn--" 形式
+     * @return 规则格式是否有效
+     */
+    bool addRule(const std::string& rule);
+
+    /**
+     * @brief 解析 PSL 文件内容：每行第一个词是规则，"//" 开头的行和空行被跳过
+     * @return 加入的规则数（无效的行被跳过）
+     */
+    size_t parse(const std::string& text);
+
+    /**
+     * @brief 从 PSL 文件加载
+     * @param path 文件路径
+     * @return 编译后的列表，路径为空时返回 nullptr，文件无法读取时输出警告并返回 nullptr
+     */
+    static std::shared_ptr<const PublicSuffixList> load(const std::string& path);
+
+    /**
+     * @brief 公共后缀的标签数
+     * @param hash 解码域名时计算的哈希
+     * @return 根域返回 0
+     */
+    size_t suffixLabels(const NameHash& hash) const;
+
+    /**
+     * @brief 可注册域名在文本中的起始位置
+     * @param hash 解码域名时计算的哈希
+     * @return 域名本身是公共后缀或根域时返回 npos
+     */
+    size_t registrableOffset(const NameHash& hash) const;
+
+    /**
+     * @brief 按文本形式的域名求可注册域名的起始位置（先计算后缀哈希）
+     */
+    size_t registrableOffset(const char* name, size_t length) const;
+
+    /**
+     * @brief 规则数
+     */
+    size_t size() const noexcept {
+        return rules;
+    }
+
+private:
+    // 节点标记，节点存在本身表示有更长的规则以它为后缀
+    enum NodeFlag : uint8_t {
+        NODE_RULE = 0x01,           // 后缀本身是规则
+        NODE_WILDCARD = 0x02,       // 后缀的下一级都是规则
+        NODE_EXCEPTION = 0x04       // 后缀是例外规则，公共后缀是它的上一级
+    };
+
+    FlatHashMap<uint64_t, uint8_t> nodes;   // 后缀哈希 -> 节点标记
+    size_t rules;
+};
+
+} // namespace dns_parser
+
+#endif // DNS_PARSER_PUBLIC_SUFFIX_H
@@ -0,0 +1,122 @@
+#ifndef DNS_PARSER_QUERY_TRACKER_H
+#define DNS_PARSER_QUERY_TRACKER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "../tools/flat_hash_map.h"
+#include "../tools/timer_wheel.h"
+#include "../tools/types.h"
+
+namespace dns_parser {
+
+/**
+ * @brief 查询/响应关联表
+ *
+ * 以（客户端到服务端四元组, 事务 ID）为键记录未应答的查询，响应到达时
+ * 计算往返时延；超过 timeout_ms 仍未应答的查询由时间轮触发删除并计入超时。
+ *
+ * 每个工作线程持有一个实例，本类不是线程安全的。
+ */
+class QueryTracker {
+public:
+    /**
+     * @brief 统计快照
+     */
+    struct Stats {
+        size_t pending;             // 未应答的查询数
+        uint64_t matched;           // 已匹配的响应数
+        uint64_t timeouts;          // 超时未应答的查询数
+        uint64_t unmatched;         // 找不到对应查询的响应数
+        uint64_t dropped;           // 因容量上限未记录的查询数
+        uint64_t total_rtt_ms;      // 已匹配响应的往返时延之和（毫秒）
+    };
+
+    // 时间轮用户数据的类别标记（高 8 位），低位为表项下标
+    static const uint64_t kTimerTag = uint64_t(2) << 56;
+
+    /**
+     * @brief 构造函数
+     * @param timers 时间轮（刻度为毫秒）
+     * @param max_pending 最多同时跟踪的查询数
+     * @param timeout_ms 查询超时（毫秒）
+     */
+    QueryTracker(TimerWheel& timers, size_t max_pending, uint32_t timeout_ms);
+    ~QueryTracker();
+
+    QueryTracker(const QueryTracker&) = delete;
+    QueryTracker& operator=(const QueryTracker&) = delete;
+
+    /**
+     * @brief 更新上限（配置热加载后调用）
+     */
+    void setLimits(size_t max_pending, uint32_t timeout_ms);
+
+    /**
+     * @brief 记录一个查询，重传的查询刷新发送时间
+     * @param key 客户端到服务端方向的四元组
+     * @param id 事务 ID
+     * @param now_ms 当前时间（毫秒）
+     */
+    void onQuery(const FourTuple& key, uint16_t id, uint64_t now_ms);
+
+    /**
+     * @brief 匹配一个响应
+     * @param key 客户端到服务端方向的四元组
+     * @param id 事务 ID
+     * @param now_ms 当前时间（毫秒）
+     * @param rtt_ms 输出往返时延（可为 nullptr）
+     * @return 是否找到对应的查询
+     */
+    bool onResponse(const FourTuple& key, uint16_t id, uint64_t now_ms, uint64_t* rtt_ms = nullptr);
+
+    /**
+     * @brief 处理时间轮回调
+     * @param data 定时器用户数据（kTimerTag | 表项下标）
+     */
+    void onTimer(uint64_t data);
+
+    size_t size() const noexcept;
+    Stats stats() const noexcept;
+
+private:
+    struct Key {
+        FourTuple tuple;
+        uint16_t id;
+
+        bool operator==(const Key& other) const {
+            return id == other.id && tuple == other.tuple;
+        }
+    };
+
+    struct KeyHash {
+        size_t operator()(const Key& key) const;
+    };
+
+    struct Entry {
+        Key key;
+        uint64_t sent_ms;
+        TimerWheel::Handle timer;
+        bool live;
+    };
+
+    TimerWheel& timers;
+    size_t max_pending;
+    uint32_t timeout_ms;
+
+    std::vector<Entry> entries;
+    std::vector<uint32_t> free_entries;
+    FlatHashMap<Key, uint32_t, KeyHash> index;
+
+    uint64_t matched_count;
+    uint64_t timeout_count;
+    uint64_t unmatched_count;
+    uint64_t dropped_count;
+    uint64_t total_rtt;
+
+    void removeEntry(uint32_t slot);
+};
+
+} // namespace dns_parser
+
+#endif // DNS_PARSER_QUERY_TRACKER_H
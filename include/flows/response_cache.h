@@ -0,0 +1,127 @@
+#ifndef DNS_PARSER_RESPONSE_CACHE_H
+#define DNS_PARSER_RESPONSE_CACHE_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "../tools/types.h"
+
+namespace dns_parser {
+
+/**
+ * @brief 响应去重缓存
+ *
+ * 繁忙的解析器会反复返回除事务 ID 外逐字节相同的响应。本缓存以屏蔽前两个字节后的
+ * 报文哈希为键，映射到已解析好的只读消息，命中时调用方可以完全跳过 parseResponse。
+ *
+ * - 4 路组相联，容量固定，不随流量增长
+ * - 条目按缓存消息中最短的 TTL 过期，无记录的响应使用 negative_ttl
+ * - 命中前会逐字节比对报文，哈希碰撞不会返回错误的结果
+ *
+ * 每个工作线程持有一个实例，本类不是线程安全的；统计计数可被其他线程读取。
+ */
+class ResponseCache {
+public:
+    /**
+     * @brief 统计快照
+     */
+    struct Stats {
+        uint64_t hits;          // 命中次数
+        uint64_t misses;        // 未命中次数
+        uint64_t inserts;       // 插入次数
+        uint64_t evictions;     // 因组满被淘汰的有效条目数
+        uint64_t expirations;   // 因 TTL 到期失效的条目数
+
+        /**
+         * @brief 命中率（0~1）
+         */
+        double hitRatio() const {
+            uint64_t total = hits + misses;
+            return total ? static_cast<double>(hits) / total : 0.0;
+        }
+    };
+
+    /**
+     * @brief 构造函数
+     * @param capacity 缓存条目数（向上取整为 4 的倍数且组数为 2 的幂）
+     * @param negative_ttl 不含资源记录的响应的缓存时间（秒）
+     * @param max_ttl 缓存时间上限（秒）
+     */
+    explicit ResponseCache(size_t capacity = 4096, uint32_t negative_ttl = 30, uint32_t max_ttl = 300);
+
+    /**
+     * @brief 计算报文哈希（跳过前两个字节的事务 ID）
+     * @param data 报文
+     * @param len 报文长度
+     * @return 64 位哈希
+     */
+    static uint64_t hashPacket(const char* data, size_t len);
+
+    /**
+     * @brief 查找与报文相同的已解析响应
+     * @param packet 原始报文
+     * @param now 当前时间（秒）
+     * @return 缓存的消息（事务 ID 为首次缓存时的值），未命中返回 nullptr；
+     *         指针在下一次 insert 之前有效
+     */
+    const Message* lookup(const std::string& packet, uint32_t now);
+
+    /**
+     * @brief 缓存一个解析成功的响应
+     * @param packet 原始报文
+     * @param message 解析后的消息结构
+     * @param now 当前时间（秒）
+     */
+    void insert(const std::string& packet, const Message& message, uint32_t now);
+
+    /**
+     * @brief 清空所有条目（缓存的消息所依赖的驻留表或解析选项变化时调用）
+     */
+    void clear();
+
+    /**
+     * @brief 获取统计快照（可在其他线程调用）
+     */
+    Stats stats() const;
+
+    /**
+     * @brief 获取当前有效条目数
+     */
+    size_t size() const noexcept;
+
+private:
+    static const size_t kWays = 4;
+
+    struct Entry {
+        uint64_t hash;
+        uint32_t expire;
+        std::string payload;                    // 去掉事务 ID 的报文
+        std::unique_ptr<const Message> message;
+    };
+
+    std::vector<Entry> entries;
+    size_t set_mask;
+    uint32_t negative_ttl;
+    uint32_t max_ttl;
+    size_t live;
+
+    // 只由所属线程写入，其他线程以 relaxed 方式读取
+    std::atomic<uint64_t> hit_count;
+    std::atomic<uint64_t> miss_count;
+    std::atomic<uint64_t> insert_count;
+    std::atomic<uint64_t> eviction_count;
+    std::atomic<uint64_t> expiration_count;
+
+    static void bump(std::atomic<uint64_t>& counter) {
+        counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    uint32_t cacheTtl(const Message& message) const;
+    void release(Entry& entry);
+};
+
+} // namespace dns_parser
+
+#endif // DNS_PARSER_RESPONSE_CACHE_H
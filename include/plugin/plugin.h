@@ -72,6 +72,81 @@ typedef struct {
     unsigned int Volume;   // 容　　限
 } TASK;
 
+// 响应缓存统计结构体
+typedef struct {
+    unsigned long long Hits;        // 命中次数
+    unsigned long long Misses;      // 未命中次数
+    unsigned long long Inserts;     // 插入次数
+    unsigned long long Evictions;   // 淘汰次数
+    unsigned long long Expirations; // 过期次数
+} CACHE_STATS;
+
+// DNS 协议计数的数组长度
+#define DNS_STATS_PARSE_ERRORS 5        // 未知、头部过短、域名无效、问题截断、记录截断
+#define DNS_STATS_QTYPES 257            // 类型 0-255 各占一项，其余类型计入最后一项
+#define DNS_STATS_SECTION_BUCKETS 7     // 记录数 0、1、2、3-4、5-8、9-16、17 及以上
+#define DNS_STATS_SIZE_BUCKETS 8        // 长度 64、128、256、512、1232、1500、4096 字节以内及更大
+#define DNS_STATS_REJECT_REASONS 5      // 未知、头部过短、操作码无效、QR 与方向不符、记录数超出长度
+#define DNS_STATS_EDNS 5                // 带 OPT、DO 置位、带 Cookie、带客户端子网、OPT 格式错误
+#define DNS_STATS_NAMES 4               // 含大写字母、含非 LDH 标签、含国际化域名标签、标签长度不合法
+
+// DNS 协议计数结构体
+typedef struct {
+    unsigned long long Packets;         // 数据包数
+    unsigned long long Messages;        // DNS 消息数（含流式重组得到的）
+    unsigned long long Queries;         // 查询（QR=0）
+    unsigned long long Responses;       // 响应（QR=1）
+    unsigned long long ShortMessages;   // 不足 12 字节的消息
+    unsigned long long ParseFailures[DNS_STATS_PARSE_ERRORS];       // 按原因的解析失败数
+    unsigned long long Rejected[DNS_STATS_REJECT_REASONS];          // 解析前被头部检查拒绝的报文数（不计入 Messages）
+    unsigned long long Qtypes[DNS_STATS_QTYPES];                    // 第一个问题的类型
+    unsigned long long Rcodes[16];      // 响应码（只统计响应）
+    unsigned long long Opcodes[16];     // 操作码
+    unsigned long long Flags[6];        // AA、TC、RD、RA、AD、CD 置位的消息数
+    unsigned long long Sections[4][DNS_STATS_SECTION_BUCKETS];      // 问题/应答/权威/附加区记录数分布
+    unsigned long long Sizes[DNS_STATS_SIZE_BUCKETS];               // 消息长度分布
+    unsigned long long Edns[DNS_STATS_EDNS];                        // EDNS 各项的消息数（只统计完整解析的消息）
+    unsigned long long Names[DNS_STATS_NAMES];                      // 第一个问题的域名命中各项检查的消息数（开启域名规范化时）
+} DNS_STATS;
+
+// 按 EDNS 客户端子网聚合的计数结构体
+typedef struct {
+    unsigned char Family;               // 4 或 6
+    unsigned char Prefix;               // 聚合后的前缀长度
+    unsigned char Address[16];          // 网络地址，IPv4 占前 4 字节
+    unsigned long long Queries;         // 查询数
+    unsigned long long Responses;       // 响应数
+} SUBNET_STATS;
+
+// 处理阶段数量：取得任务、头部解析、问题解析、资源记录解析、分析、输出
+#define STAGE_COUNT 6
+
+// 处理阶段耗时统计结构体（纳秒）
+typedef struct {
+    unsigned long long Count;   // 经过该阶段的数据包数
+    unsigned long long Total;   // 总耗时
+    unsigned long long Min;     // 最小耗时
+    unsigned long long Max;     // 最大耗时
+    unsigned long long P50;     // 中位数
+    unsigned long long P90;     // 90 分位
+    unsigned long long P99;     // 99 分位
+    unsigned long long P999;    // 99.9 分位
+} STAGE_STATS;
+
+// 堆分配统计结构体（只在以 DNS_PARSER_ALLOC_TRACKING 构建时有数据）
+typedef struct {
+    unsigned long long Packets;                         // 计入的数据包数
+    unsigned long long Allocations;                     // operator new 次数
+    unsigned long long Bytes;                           // operator new 申请的字节数
+    unsigned long long Frees;                           // operator delete 次数
+    unsigned long long ArenaBlocks;                     // 流缓冲池向系统申请的新块数
+    unsigned long long ArenaBytes;                      // 流缓冲池向系统申请的字节数
+    unsigned long long StageAllocations[STAGE_COUNT];   // 各处理阶段的分配次数
+    unsigned long long StageBytes[STAGE_COUNT];         // 各处理阶段的分配字节数
+    unsigned long long MaxPerPacket;                    // 单个数据包的最多分配次数
+    unsigned long long P99PerPacket;                    // 单个数据包分配次数的 99 分位
+} ALLOC_STATS;
+
 // 全局变量声明
 
 #ifdef __cplusplus
@@ -108,6 +183,10 @@ DLL_PUBLIC int Single(unsigned short Thread, const char *Option);
  * 
  * 处理每个数据包，解析IMAP协议内容并进行关键词检测
  * 
+ * 配置了策略（[Policy] rules 或 [Lists] 黑白名单）时，命中规则的数据包的
+ * Action 被设置为 0x21（知晓，宿主应拦截）或 0x22（转发）；没有规则命中时
+ * 保持原样
+ * 
  * @param Import 输入的数据包任务
  * @param Export 输出的数据包任务
  * @return 处理结果，0表示成功
@@ -129,6 +208,86 @@ DLL_PUBLIC void Remove();
  */
 DLL_PUBLIC void SetConfigFilePath(const char* path);
 
+/**
+ * @brief 获取响应去重缓存统计
+ * 
+ * 汇总所有工作线程的缓存命中/未命中等计数，可在任意线程调用
+ * 
+ * @param Stats 输出的统计结构体
+ */
+DLL_PUBLIC void CacheStats(CACHE_STATS *Stats);
+
+/**
+ * @brief 获取 DNS 协议计数
+ * 
+ * 各工作线程用不带原子操作的计数器记录，这里通过顺序锁读取每个线程的一致
+ * 快照后合并；读取方从不阻塞工作线程，可在任意线程随时轮询。头部相关的计数
+ * 直接取自线格式，过载降级时也保持精确。
+ * 
+ * @param Stats 输出的统计结构体
+ */
+DLL_PUBLIC void DnsStats(DNS_STATS *Stats);
+
+/**
+ * @brief 获取各处理阶段的耗时统计
+ * 
+ * 配置 [Diagnostics] stage_timing = true 时，每个数据包在各阶段的耗时记入
+ * 按线程的对数-线性直方图（相对误差不超过 1/16），这里汇总所有线程并换算为
+ * 纳秒。编译时关闭 DNS_PARSER_STAGE_TIMING 则不记录。可在任意线程调用。
+ * 
+ * @param Stats 输出数组，按阶段顺序共 STAGE_COUNT 项
+ * @param Reset 非 0 时在读取后清空直方图（各线程处理下一个数据包时生效）
+ */
+DLL_PUBLIC void StageStats(STAGE_STATS *Stats, int Reset);
+
+/**
+ * @brief 获取按 EDNS 客户端子网聚合的流量计数
+ * 
+ * 合并所有线程的子网计数，按查询和响应总数降序输出。子网按配置的聚合前缀
+ * （[EDNS] subnet_ipv4_prefix / subnet_ipv6_prefix）截断后计数，可与 Filter 并发调用。
+ * 
+ * @param Stats 输出数组
+ * @param Max 数组容量
+ * @return 写入的子网数
+ */
+DLL_PUBLIC int SubnetStats(SUBNET_STATS *Stats, int Max);
+
+/**
+ * @brief 获取 Filter 内的堆分配统计
+ * 
+ * 以 DNS_PARSER_ALLOC_TRACKING=ON 构建时，插件替换全局 operator new/delete，
+ * 在各处理阶段的计时点上把本线程的分配次数和字节数计入对应阶段，并记录
+ * 每个数据包的分配次数分布。阶段计时的重置（StageStats 的 Reset）同时清空这里的统计。
+ * 
+ * @param Stats 输出的统计结构体
+ * @param Thread 线程编号，-1 表示汇总所有线程
+ * @return 0 表示成功；未启用分配统计或线程不存在时返回 -1
+ */
+DLL_PUBLIC int AllocStats(ALLOC_STATS *Stats, int Thread);
+
+/**
+ * @brief 设置线程当前处理的数据包时间
+ * 
+ * 流超时、查询超时和 TTL 过期都按数据包时间推进，宿主在调用 Filter 前
+ * 传入抓包时间戳即可让回放结果可复现；从未设置时插件使用单调时钟。
+ * 
+ * @param Thread 线程编号，不小于 256 时调用被忽略
+ * @param Milliseconds 数据包时间（毫秒），0 表示恢复使用单调时钟
+ */
+DLL_PUBLIC void SetPacketTime(unsigned short Thread, unsigned long long Milliseconds);
+
+/**
+ * @brief 报告线程输入队列的占用
+ * 
+ * 与处理时延一起驱动过载降级（[Shedding] 配置，默认关闭）：占用持续偏高时插件逐级
+ * 降为只解析头部和问题、再降为按 1/N 抽样，数据包计数始终精确，
+ * 每次级别变化输出到标准错误。宿主不报告时只按处理时延降级。
+ * 
+ * @param Thread 线程编号，不小于 256 时调用被忽略
+ * @param Percent 队列占用百分比（0-100）
+ */
+DLL_PUBLIC void SetQueuePressure(unsigned short Thread, unsigned int Percent);
+
 #ifdef __cplusplus
 }
 #endif
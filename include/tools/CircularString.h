@@ -1,7 +1,7 @@
 #ifndef CIRCULAR_STRING_H
 #define CIRCULAR_STRING_H
 
-#include <vector>
+#include <cstddef>
 #include <string>
 #include <stdexcept>
 #include <algorithm>
@@ -11,13 +11,43 @@
  *
  * 该类实现了一个环形缓冲区，当缓冲区满时，新添加的元素会覆盖最旧的元素。
  * 主要用于需要保留最近N个字符的场景，如日志记录、数据流处理等。
+ *
+ * 支持两种底层存储：
+ * - Heap：普通堆内存，跨越回绕点的区间由两个片段组成
+ * - Mirrored：同一块 memfd 内存被连续映射两次，任意逻辑区间都是一段连续内存，
+ *   容量向上取整为 2 的幂（且不小于页大小），下标换算使用掩码而不是取模
+ * - External：由调用方（如 BufferPool）提供并负责释放的内存，可通过 rebind() 换成更大的块
  */
 class CircularString {
+public:
+    /**
+     * @brief 底层存储方式
+     */
+    enum class Backing {
+        Heap,       // 堆内存
+        Mirrored,   // 双重映射的虚拟内存
+        External    // 调用方提供的内存
+    };
+
+    /**
+     * @brief 一段连续的只读内存
+     */
+    struct Segment {
+        const char* data;   // 起始地址
+        size_t length;      // 字节数
+    };
+
 private:
-    std::vector<char> buffer;  // 底层存储
+    char* buffer;              // 底层存储
     size_t capacity;           // 缓冲区总容量
+    size_t mask;               // 容量为 2 的幂时为 capacity - 1，否则为 0
     size_t head;               // 逻辑起始位置（物理索引）
     size_t count;              // 当前有效元素数量
+    Backing backing;           // 存储方式
+
+    // 分配/释放底层存储
+    void allocate();
+    void release() noexcept;
 
     // 将逻辑索引转换为物理索引
     size_t physical_index(size_t logical_index) const;
@@ -32,12 +62,94 @@ public:
      */
     explicit CircularString(size_t size);
 
+    /**
+     * @brief 构造函数，创建指定容量和存储方式的环形字符串
+     * @param size 环形缓冲区的容量（Mirrored 模式下会向上取整）
+     * @param backing 存储方式
+     * @throw std::invalid_argument 如果容量为0
+     * @throw std::runtime_error 如果双重映射失败
+     */
+    CircularString(size_t size, Backing backing);
+
+    /**
+     * @brief 构造函数，使用调用方提供的内存（External 模式）
+     * @param storage 底层存储，生命周期由调用方管理
+     * @param size 存储容量
+     * @throw std::invalid_argument 如果存储为空或容量为0
+     */
+    CircularString(char* storage, size_t size);
+
+    /**
+     * @brief 复制构造函数，External 模式的副本改用堆内存
+     */
+    CircularString(const CircularString& other);
+    CircularString(CircularString&& other) noexcept;
+    CircularString& operator=(CircularString other) noexcept;
+    ~CircularString();
+
+    /**
+     * @brief 交换两个环形字符串的内容
+     */
+    void swap(CircularString& other) noexcept;
+
     /**
      * @brief 在末尾插入字符串
      * @param str 要插入的字符串
      */
     void push_back(const std::string& str);
 
+    /**
+     * @brief 在末尾插入一段字节（最多两次 memcpy）
+     * @param data 数据起始地址
+     * @param len 数据长度，超过容量时只保留最后 capacity 个字节
+     */
+    void push_back(const char* data, size_t len);
+
+    /**
+     * @brief 获取逻辑区间[start, start + length)对应的连续内存片段
+     * @param start 起始索引
+     * @param length 区间长度
+     * @param out 输出片段数组，至少 2 个元素
+     * @return 片段数量（0、1 或 2，跨越回绕点时为 2）
+     * @throw std::out_of_range 如果区间超出有效范围
+     */
+    size_t segments(size_t start, size_t length, Segment out[2]) const;
+
+    /**
+     * @brief 获取全部可读数据对应的连续内存片段
+     * @param out 输出片段数组，至少 2 个元素
+     * @return 片段数量（0、1 或 2）
+     */
+    size_t readable_segments(Segment out[2]) const noexcept;
+
+    /**
+     * @brief 获取逻辑区间[start, start + length)的连续指针
+     *
+     * Mirrored 模式下总能返回连续指针；Heap 模式下区间跨越回绕点时返回 nullptr，
+     * 调用方应改用 segments()。
+     *
+     * @param start 起始索引
+     * @param length 区间长度
+     * @return 连续内存指针或 nullptr
+     * @throw std::out_of_range 如果区间超出有效范围
+     */
+    const char* contiguous(size_t start, size_t length) const;
+
+    /**
+     * @brief 把数据线性化搬到新的外部存储（仅 External 模式）
+     * @param storage 新的底层存储
+     * @param size 新存储容量，不得小于 size()
+     * @return 原来的底层存储，由调用方归还
+     * @throw std::logic_error 如果不是 External 模式
+     * @throw std::invalid_argument 如果新容量不足
+     */
+    char* rebind(char* storage, size_t size);
+
+    /**
+     * @brief 获取存储方式
+     */
+    Backing backing_mode() const noexcept;
+
     /**
      * @brief 查找第n次出现的字符串（从1开始计数）
      * @param target 要查找的字符串
@@ -92,6 +204,27 @@ public:
      * @throw std::out_of_range 如果索引范围无效
      */
     size_t find(size_t start_index, size_t end_index, const char target);
+
+    /**
+     * @brief 在一至两个连续片段组成的数据中查找字符
+     * @param parts 片段数组
+     * @param num 片段数量
+     * @param target 待查找字符
+     * @return 相对于第一个片段起点的索引，找不到返回(size_t)(-1)
+     */
+    static size_t find_in_segments(const Segment* parts, size_t num, char target);
+
+    /**
+     * @brief 在一至两个连续片段组成的数据中查找第n次出现的字符串（从1开始计数）
+     * @param parts 片段数组
+     * @param num 片段数量
+     * @param target 要查找的字符串
+     * @param n 第几次出现
+     * @return 相对于第一个片段起点的索引
+     * @throw std::out_of_range 如果字符串没有出现足够次数
+     */
+    static size_t find_nth_in_segments(const Segment* parts, size_t num,
+                                       const std::string& target, size_t n);
 };
 
 #endif // CIRCULAR_STRING_H
\ No newline at end of file
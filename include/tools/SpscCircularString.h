@@ -0,0 +1,151 @@
+#ifndef SPSC_CIRCULAR_STRING_H
+#define SPSC_CIRCULAR_STRING_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "CircularString.h"
+
+/**
+ * @brief 单生产者/单消费者无锁环形字符串
+ *
+ * 用于把采集线程收到的原始流字节交给解析线程，全程不加互斥锁：
+ * - 生产者：reserve(n) 取得可写片段 -> 写入 -> commit(n) 一次性发布
+ * - 消费者：沿用 CircularString 的 find/find_nth/substring 接口读取，
+ *           处理完后 release(n) / erase_up_to(k) 批量归还空间
+ *
+ * 读写位置是单调递增的 64 位计数，各自独占一条缓存行；双方各缓存一份对端位置，
+ * 只有缓存值不够用时才去读对端的原子变量，减少缓存行往返。
+ * 与 CircularString 不同，缓冲区满时生产者不会覆盖未读数据，而是写入失败。
+ *
+ * 对象内部按缓存行对齐，堆上创建时应使用 dns_parser::alignedNewArray。
+ */
+class SpscCircularString {
+public:
+    typedef CircularString::Segment Segment;
+
+    /**
+     * @brief 一段连续的可写内存
+     */
+    struct MutableSegment {
+        char* data;         // 起始地址
+        size_t length;      // 字节数
+    };
+
+    /**
+     * @brief 构造函数
+     * @param size 容量（向上取整为 2 的幂）
+     * @throw std::invalid_argument 如果容量为0
+     */
+    explicit SpscCircularString(size_t size);
+    ~SpscCircularString();
+
+    SpscCircularString(const SpscCircularString&) = delete;
+    SpscCircularString& operator=(const SpscCircularString&) = delete;
+
+    // ------------------------------ 生产者接口 ------------------------------
+
+    /**
+     * @brief 获取当前可写字节数
+     */
+    size_t writable() const noexcept;
+
+    /**
+     * @brief 预留 n 个字节的写入空间
+     * @param n 字节数
+     * @param out 输出可写片段数组，至少 2 个元素
+     * @return 片段数量，空间不足时返回 0
+     */
+    size_t reserve(size_t n, MutableSegment out[2]) noexcept;
+
+    /**
+     * @brief 发布已写入的 n 个字节，消费者随后可见
+     * @param n 字节数（不超过上一次 reserve 的大小）
+     */
+    void commit(size_t n) noexcept;
+
+    /**
+     * @brief 写入一段数据（reserve + memcpy + commit）
+     * @param data 数据起始地址
+     * @param len 数据长度
+     * @return 是否写入成功，空间不足时不写入任何字节
+     */
+    bool push_back(const char* data, size_t len) noexcept;
+    bool push_back(const std::string& str) noexcept;
+
+    // ------------------------------ 消费者接口 ------------------------------
+
+    /**
+     * @brief 获取当前可读字节数
+     */
+    size_t size() const noexcept;
+
+    /**
+     * @brief 获取缓冲区总容量
+     */
+    size_t cap() const noexcept;
+
+    /**
+     * @brief 获取全部可读数据对应的连续内存片段
+     * @param out 输出片段数组，至少 2 个元素
+     * @return 片段数量（0、1 或 2）
+     */
+    size_t readable_segments(Segment out[2]) const noexcept;
+
+    /**
+     * @brief 查找第n次出现的字符串（从1开始计数）
+     * @throw std::out_of_range 如果字符串没有出现足够次数
+     */
+    size_t find_nth(const std::string& target, size_t n) const;
+
+    /**
+     * @brief 获取子字符串[m, n]
+     * @throw std::out_of_range 如果索引范围无效
+     */
+    std::string substring(size_t m, size_t n) const;
+
+    /**
+     * @brief 从[start_index, end_index)范围内寻找指定字符
+     * @return 找到则返回字符首次出现时的索引，否则返回(size_t)(-1)
+     * @throw std::out_of_range 如果索引范围无效
+     */
+    size_t find(size_t start_index, size_t end_index, const char target) const;
+
+    /**
+     * @brief 根据索引获取元素值
+     * @throw std::out_of_range 如果索引超出范围
+     */
+    char at(size_t index) const;
+
+    /**
+     * @brief 归还前 n 个已读字节
+     * @throw std::out_of_range 如果 n 超过可读字节数
+     */
+    void release(size_t n);
+
+    /**
+     * @brief 删除k及之前的所有元素（等价于 release(k + 1)）
+     * @throw std::out_of_range 如果索引超出范围
+     */
+    void erase_up_to(size_t k);
+
+private:
+    // 只读共享字段
+    char* buffer;
+    size_t capacity;
+    size_t mask;
+
+    // 生产者独占
+    alignas(64) std::atomic<uint64_t> write_pos;
+    uint64_t cached_read_pos;
+
+    // 消费者独占
+    alignas(64) std::atomic<uint64_t> read_pos;
+    mutable uint64_t cached_write_pos;
+
+    // 消费者视角下的可读片段
+    size_t segments(size_t start, size_t length, Segment out[2]) const;
+};
+
+#endif // SPSC_CIRCULAR_STRING_H
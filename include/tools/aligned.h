@@ -0,0 +1,89 @@
+#ifndef DNS_PARSER_ALIGNED_H
+#define DNS_PARSER_ALIGNED_H
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <utility>
+
+namespace dns_parser {
+
+// 缓存行大小
+const size_t kCacheLineSize = 64;
+
+/**
+ * @brief 按对象自身对齐要求分配并构造数组
+ *
+ * C++11 的 new 不保证超过 16 字节的对齐，按缓存行对齐的类型需要通过本函数创建。
+ *
+ * @param n 元素个数
+ * @return 数组首地址
+ * @throw std::bad_alloc 分配失败
+ */
+template <typename T>
+T* alignedNewArray(size_t n) {
+    void* mem = nullptr;
+    size_t alignment = alignof(T) < sizeof(void*) ? sizeof(void*) : alignof(T);
+    if (posix_memalign(&mem, alignment, sizeof(T) * n) != 0) {
+        throw std::bad_alloc();
+    }
+    T* array = static_cast<T*>(mem);
+    for (size_t i = 0; i < n; ++i) {
+        new (array + i) T();
+    }
+    return array;
+}
+
+/**
+ * @brief 析构并释放 alignedNewArray 创建的数组
+ * @param array 数组首地址
+ * @param n 元素个数
+ */
+template <typename T>
+void alignedDeleteArray(T* array, size_t n) {
+    if (!array) {
+        return;
+    }
+    for (size_t i = n; i > 0; --i) {
+        array[i - 1].~T();
+    }
+    free(array);
+}
+
+/**
+ * @brief 按对象自身对齐要求分配并构造单个对象
+ * @param args 构造参数
+ * @return 对象地址
+ * @throw std::bad_alloc 分配失败
+ */
+template <typename T, typename... Args>
+T* alignedNew(Args&&... args) {
+    void* mem = nullptr;
+    size_t alignment = alignof(T) < sizeof(void*) ? sizeof(void*) : alignof(T);
+    if (posix_memalign(&mem, alignment, sizeof(T)) != 0) {
+        throw std::bad_alloc();
+    }
+    try {
+        return new (mem) T(std::forward<Args>(args)...);
+    } catch (...) {
+        free(mem);
+        throw;
+    }
+}
+
+/**
+ * @brief 析构并释放 alignedNew 创建的对象
+ * @param object 对象地址
+ */
+template <typename T>
+void alignedDelete(T* object) {
+    if (!object) {
+        return;
+    }
+    object->~T();
+    free(object);
+}
+
+} // namespace dns_parser
+
+#endif // DNS_PARSER_ALIGNED_H
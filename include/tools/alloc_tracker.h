@@ -0,0 +1,57 @@
+#ifndef DNS_PARSER_ALLOC_TRACKER_H
+#define DNS_PARSER_ALLOC_TRACKER_H
+
+#include <cstddef>
+#include <cstdint>
+
+// 编译期开关：为 1 时替换全局 operator new/delete，按线程统计堆分配
+#ifndef DNS_PARSER_ALLOC_TRACKING
+#define DNS_PARSER_ALLOC_TRACKING 0
+#endif
+
+namespace dns_parser {
+
+/**
+ * @brief 线程累计的分配计数
+ */
+struct AllocTally {
+    uint64_t allocations;   // operator new 次数
+    uint64_t bytes;         // operator new 申请的字节数
+    uint64_t frees;         // operator delete 次数（空指针除外）
+    uint64_t arena_blocks;  // 缓冲池向系统申请的新块数（不含复用）
+    uint64_t arena_bytes;   // 缓冲池向系统申请的字节数
+};
+
+#if DNS_PARSER_ALLOC_TRACKING
+// 本线程的累计计数，由替换后的 operator new/delete 和缓冲池钩子更新
+extern thread_local AllocTally threadAllocTally;
+#endif
+
+/**
+ * @brief 本线程到目前为止的累计分配计数；未启用分配统计时全为 0
+ */
+inline AllocTally currentAllocTally() noexcept {
+#if DNS_PARSER_ALLOC_TRACKING
+    return threadAllocTally;
+#else
+    AllocTally tally = { 0, 0, 0, 0, 0 };
+    return tally;
+#endif
+}
+
+/**
+ * @brief 缓冲池钩子：记录一次向系统申请新块
+ * @param bytes 块大小
+ */
+inline void noteArenaBlock(size_t bytes) noexcept {
+#if DNS_PARSER_ALLOC_TRACKING
+    ++threadAllocTally.arena_blocks;
+    threadAllocTally.arena_bytes += bytes;
+#else
+    (void)bytes;
+#endif
+}
+
+} // namespace dns_parser
+
+#endif // DNS_PARSER_ALLOC_TRACKER_H
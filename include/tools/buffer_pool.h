@@ -0,0 +1,142 @@
+#ifndef DNS_PARSER_BUFFER_POOL_H
+#define DNS_PARSER_BUFFER_POOL_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace dns_parser {
+
+/**
+ * @brief 进程级内存预算
+ *
+ * 所有线程的缓冲池共享同一个预算，按字节记账。预算为 0 表示不限制。
+ */
+class MemoryBudget {
+public:
+    /**
+     * @brief 构造函数
+     * @param limit 字节上限，0 表示不限制
+     */
+    explicit MemoryBudget(size_t limit = 0);
+
+    /**
+     * @brief 申请记账 n 个字节
+     * @return 是否在预算之内（失败时不记账）
+     */
+    bool tryCharge(size_t n) noexcept;
+
+    /**
+     * @brief 归还 n 个字节
+     */
+    void credit(size_t n) noexcept;
+
+    /**
+     * @brief 修改上限（已记账的字节不受影响）
+     */
+    void setLimit(size_t limit) noexcept;
+
+    size_t used() const noexcept;
+    size_t limit() const noexcept;
+
+private:
+    std::atomic<size_t> used_bytes;
+    std::atomic<size_t> limit_bytes;
+};
+
+/**
+ * @brief 按大小分级的流缓冲池
+ *
+ * 块大小为 2 的幂，从 min_block 到 max_block。小于 kMapThreshold 的块归还后
+ * 放入该级的空闲链表优先复用，每个池缓存的总字节数不超过 kMaxCachedBytes。
+ * 预算只计正在使用的块：归还时立即归还预算，复用时重新记账，空闲块不会占住
+ * 其他线程的预算。不小于 kMapThreshold 的块直接 mmap、归还时立即 munmap，
+ * 开启 huge_pages 时优先使用 MAP_HUGETLB，失败时退回普通映射并建议内核使用透明大页。
+ *
+ * 每个工作线程持有一个实例，本类不是线程安全的；预算对象可以在线程间共享。
+ */
+class BufferPool {
+public:
+    /**
+     * @brief 统计快照
+     */
+    struct Stats {
+        uint64_t allocations;   // 向系统申请的块数
+        uint64_t reuses;        // 从空闲链表复用的块数
+        uint64_t denials;       // 因预算不足失败的申请次数
+        uint64_t huge_blocks;   // 以 MAP_HUGETLB 映射的块数
+        size_t cached_bytes;    // 空闲链表中的字节数
+    };
+
+    /**
+     * @brief 构造函数
+     * @param budget 共享的内存预算
+     * @param min_block 最小块大小（向上取整为 2 的幂）
+     * @param max_block 最大块大小（向上取整为 2 的幂）
+     * @param huge_pages 大块是否使用大页
+     */
+    BufferPool(MemoryBudget& budget, size_t min_block = 4096, size_t max_block = 16 << 20,
+               bool huge_pages = false);
+    ~BufferPool();
+
+    BufferPool(const BufferPool&) = delete;
+    BufferPool& operator=(const BufferPool&) = delete;
+
+    /**
+     * @brief 计算能容纳 n 个字节的块大小（不超过 max_block）
+     */
+    size_t classSize(size_t n) const noexcept;
+
+    /**
+     * @brief 申请一个块
+     * @param size 块大小，必须是 classSize() 的返回值
+     * @return 块地址，预算不足时返回 nullptr
+     */
+    char* acquire(size_t size);
+
+    /**
+     * @brief 归还一个块
+     * @param block 块地址
+     * @param size 申请时的块大小
+     */
+    void release(char* block, size_t size) noexcept;
+
+    /**
+     * @brief 把所有空闲块还给系统（空闲块不占预算）
+     * @return 释放的字节数
+     */
+    size_t trim() noexcept;
+
+    Stats stats() const noexcept;
+    size_t maxBlock() const noexcept;
+
+    // 大于等于该大小的块使用 mmap
+    static const size_t kMapThreshold = 2 << 20;
+
+private:
+    // 每级最多缓存的空闲块数
+    static const size_t kMaxCachedPerClass = 16;
+    // 每个池最多缓存的空闲字节数
+    static const size_t kMaxCachedBytes = 4 << 20;
+
+    MemoryBudget& budget;
+    size_t min_shift;
+    size_t max_shift;
+    bool huge_pages;
+    std::vector<std::vector<char*> > free_lists;
+
+    uint64_t allocation_count;
+    uint64_t reuse_count;
+    uint64_t denial_count;
+    uint64_t huge_count;
+    size_t cached;
+
+    size_t classIndex(size_t size) const noexcept;
+    char* allocateBlock(size_t size);
+    static void freeBlock(char* block, size_t size) noexcept;
+};
+
+} // namespace dns_parser
+
+#endif // DNS_PARSER_BUFFER_POOL_H
@@ -0,0 +1,226 @@
+#ifndef DNS_PARSER_FLAT_HASH_MAP_H
+#define DNS_PARSER_FLAT_HASH_MAP_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+#include "hash.h"
+
+namespace dns_parser {
+
+/**
+ * @brief 开放寻址（线性探测）的扁平哈希表
+ *
+ * 所有槽位存放在一块连续内存中，没有逐节点的堆分配，适合存放数千万条
+ * 小键值对。容量始终是 2 的幂，负载超过 7/8 时翻倍扩容；删除采用
+ * 反向移位（backward shift），不会留下墓碑。
+ *
+ * @tparam K 键类型
+ * @tparam V 值类型
+ * @tparam Hash 哈希函数对象，结果会再经过 mix64 混淆
+ * @tparam Eq 键比较函数对象
+ */
+template <typename K, typename V, typename Hash = std::hash<K>, typename Eq = std::equal_to<K> >
+class FlatHashMap {
+private:
+    struct Slot {
+        K key;
+        V value;
+    };
+
+    std::vector<Slot> slots;      // 键值槽位
+    std::vector<uint8_t> used;    // 槽位占用标记
+    size_t mask;                  // 容量 - 1
+    size_t count;                 // 当前元素数量
+    Hash hasher;
+    Eq equal;
+
+    size_t home(const K& key) const {
+        return static_cast<size_t>(mix64(static_cast<uint64_t>(hasher(key)))) & mask;
+    }
+
+    // 查找键所在槽位，不存在时返回容量值
+    size_t locate(const K& key) const {
+        size_t i = home(key);
+        while (used[i]) {
+            if (equal(slots[i].key, key)) {
+                return i;
+            }
+            i = (i + 1) & mask;
+        }
+        return slots.size();
+    }
+
+    void rehash(size_t new_capacity) {
+        std::vector<Slot> old_slots;
+        std::vector<uint8_t> old_used;
+        old_slots.swap(slots);
+        old_used.swap(used);
+
+        slots.resize(new_capacity);
+        used.assign(new_capacity, 0);
+        mask = new_capacity - 1;
+
+        for (size_t i = 0; i < old_slots.size(); ++i) {
+            if (!old_used[i]) {
+                continue;
+            }
+            size_t j = home(old_slots[i].key);
+            while (used[j]) {
+                j = (j + 1) & mask;
+            }
+            slots[j] = std::move(old_slots[i]);
+            used[j] = 1;
+        }
+    }
+
+    static size_t roundUp(size_t n) {
+        size_t capacity = 16;
+        while (capacity < n) {
+            capacity <<= 1;
+        }
+        return capacity;
+    }
+
+public:
+    /**
+     * @brief 构造函数
+     * @param initial_capacity 初始槽位数量（会向上取整为 2 的幂）
+     */
+    explicit FlatHashMap(size_t initial_capacity = 16)
+        : mask(0), count(0) {
+        size_t capacity = roundUp(initial_capacity);
+        slots.resize(capacity);
+        used.assign(capacity, 0);
+        mask = capacity - 1;
+    }
+
+    /**
+     * @brief 查找键对应的值
+     * @param key 键
+     * @return 值指针，不存在时返回 nullptr
+     */
+    V* find(const K& key) {
+        size_t i = locate(key);
+        return i == slots.size() ? nullptr : &slots[i].value;
+    }
+
+    const V* find(const K& key) const {
+        size_t i = locate(key);
+        return i == slots.size() ? nullptr : &slots[i].value;
+    }
+
+    /**
+     * @brief 插入键值对，键已存在时保留原值
+     * @param key 键
+     * @param value 值
+     * @return (值指针, 是否新插入)
+     */
+    std::pair<V*, bool> insert(const K& key, const V& value) {
+        if ((count + 1) * 8 > slots.size() * 7) {
+            rehash(slots.size() * 2);
+        }
+        size_t i = home(key);
+        while (used[i]) {
+            if (equal(slots[i].key, key)) {
+                return std::make_pair(&slots[i].value, false);
+            }
+            i = (i + 1) & mask;
+        }
+        slots[i].key = key;
+        slots[i].value = value;
+        used[i] = 1;
+        ++count;
+        return std::make_pair(&slots[i].value, true);
+    }
+
+    /**
+     * @brief 获取键对应的值，不存在时插入默认值
+     */
+    V& operator[](const K& key) {
+        return *insert(key, V()).first;
+    }
+
+    /**
+     * @brief 删除键
+     * @param key 键
+     * @return 键是否存在
+     */
+    bool erase(const K& key) {
+        size_t i = locate(key);
+        if (i == slots.size()) {
+            return false;
+        }
+
+        // 反向移位：把后续探测链上的元素前移填补空位
+        size_t j = i;
+        while (true) {
+            j = (j + 1) & mask;
+            if (!used[j]) {
+                break;
+            }
+            size_t ideal = home(slots[j].key);
+            if (((j - ideal) & mask) >= ((j - i) & mask)) {
+                slots[i] = std::move(slots[j]);
+                i = j;
+            }
+        }
+        used[i] = 0;
+        slots[i] = Slot();
+        --count;
+        return true;
+    }
+
+    /**
+     * @brief 预留至少容纳 n 个元素的空间
+     */
+    void reserve(size_t n) {
+        size_t capacity = roundUp(n + n / 7 + 1);
+        if (capacity > slots.size()) {
+            rehash(capacity);
+        }
+    }
+
+    /**
+     * @brief 清空所有元素（保留容量）
+     */
+    void clear() {
+        for (size_t i = 0; i < slots.size(); ++i) {
+            if (used[i]) {
+                slots[i] = Slot();
+                used[i] = 0;
+            }
+        }
+        count = 0;
+    }
+
+    /**
+     * @brief 遍历所有元素
+     * @param fn 回调 fn(const K&, const V&)
+     */
+    template <typename F>
+    void forEach(F fn) const {
+        for (size_t i = 0; i < slots.size(); ++i) {
+            if (used[i]) {
+                fn(slots[i].key, slots[i].value);
+            }
+        }
+    }
+
+    size_t size() const noexcept { return count; }
+    bool empty() const noexcept { return count == 0; }
+    size_t capacity() const noexcept { return slots.size(); }
+
+    /**
+     * @brief 估算槽位数组占用的字节数
+     */
+    size_t memoryUsage() const noexcept {
+        return slots.size() * (sizeof(Slot) + sizeof(uint8_t));
+    }
+};
+
+} // namespace dns_parser
+
+#endif // DNS_PARSER_FLAT_HASH_MAP_H
@@ -0,0 +1,55 @@
+#ifndef DNS_PARSER_HASH_H
+#define DNS_PARSER_HASH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace dns_parser {
+
+/**
+ * @brief 64 位整数混淆函数（murmur3 finalizer）
+ * @param x 输入值
+ * @return 混淆后的值
+ */
+inline uint64_t mix64(uint64_t x) {
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return x;
+}
+
+/**
+ * @brief 按 8 字节块计算任意字节序列的 64 位哈希
+ * @param data 数据起始地址
+ * @param len 数据长度
+ * @param seed 哈希种子
+ * @return 64 位哈希值
+ */
+inline uint64_t hashBytes(const void* data, size_t len, uint64_t seed = 0) {
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    uint64_t h = seed ^ (len * 0x9e3779b97f4a7c15ULL);
+
+    while (len >= 8) {
+        uint64_t word;
+        std::memcpy(&word, p, 8);
+        h = (h ^ mix64(word)) * 0x9fb21c651e98df25ULL;
+        p += 8;
+        len -= 8;
+    }
+
+    // 处理剩余不足 8 字节的尾部
+    uint64_t tail = 0;
+    for (size_t i = 0; i < len; ++i) {
+        tail |= static_cast<uint64_t>(p[i]) << (i * 8);
+    }
+    h ^= mix64(tail + len);
+
+    return mix64(h);
+}
+
+} // namespace dns_parser
+
+#endif // DNS_PARSER_HASH_H
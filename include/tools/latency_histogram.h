@@ -0,0 +1,111 @@
+#ifndef DNS_PARSER_LATENCY_HISTOGRAM_H
+#define DNS_PARSER_LATENCY_HISTOGRAM_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace dns_parser {
+
+/**
+ * @brief 对数-线性（HDR 风格）延迟直方图
+ *
+ * 小于 16 的值各占一个桶；更大的值按 2 的幂分段，每段再线性分为 16 个子桶，
+ * 因此任意值的相对误差不超过 1/16，覆盖整个 64 位取值范围只需 976 个桶。
+ *
+ * 只允许一个线程写入（record/reset），其他线程可以随时调用 snapshot/merge
+ * 读取：计数器是只做 relaxed 读写的原子量，在 x86 上与普通内存访问相同。
+ */
+class LatencyHistogram {
+public:
+    static const unsigned kSubBucketBits = 4;
+    static const size_t kSubBuckets = size_t(1) << kSubBucketBits;
+    static const size_t kBuckets = (64 - kSubBucketBits + 1) * kSubBuckets;
+
+    /**
+     * @brief 只读快照，可以合并多个线程的直方图后计算分位数
+     */
+    struct Snapshot {
+        uint64_t count;
+        uint64_t total;
+        uint64_t min;
+        uint64_t max;
+        uint64_t buckets[kBuckets];
+
+        Snapshot();
+
+        /**
+         * @brief 合并另一个快照
+         */
+        void merge(const Snapshot& other);
+
+        /**
+         * @brief 计算分位数
+         * @param percentile 百分位（0-100）
+         * @return 分位数所在桶的上界（不超过 max），没有样本时返回 0
+         */
+        uint64_t valueAt(double percentile) const;
+    };
+
+    LatencyHistogram();
+
+    LatencyHistogram(const LatencyHistogram&) = delete;
+    LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+    /**
+     * @brief 记录一个样本
+     */
+    void record(uint64_t value) noexcept {
+        bump(buckets[bucketOf(value)]);
+        bump(count);
+        bump(total, value);
+        if (value < min.load(std::memory_order_relaxed)) {
+            min.store(value, std::memory_order_relaxed);
+        }
+        if (value > max.load(std::memory_order_relaxed)) {
+            max.store(value, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @brief 清空所有样本
+     */
+    void reset() noexcept;
+
+    /**
+     * @brief 把当前样本累加到快照
+     */
+    void snapshot(Snapshot& out) const;
+
+    /**
+     * @brief 值所在的桶
+     */
+    static size_t bucketOf(uint64_t value) noexcept {
+        if (value < kSubBuckets) {
+            return static_cast<size_t>(value);
+        }
+        unsigned exponent = 63 - static_cast<unsigned>(__builtin_clzll(value));
+        unsigned shift = exponent - kSubBucketBits;
+        return (shift + 1) * kSubBuckets + static_cast<size_t>((value >> shift) - kSubBuckets);
+    }
+
+    /**
+     * @brief 桶内最大的值
+     */
+    static uint64_t bucketUpperBound(size_t bucket) noexcept;
+
+private:
+    static void bump(std::atomic<uint64_t>& counter, uint64_t n = 1) noexcept {
+        counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
+    std::atomic<uint64_t> count;
+    std::atomic<uint64_t> total;
+    std::atomic<uint64_t> min;
+    std::atomic<uint64_t> max;
+    std::atomic<uint64_t> buckets[kBuckets];
+};
+
+} // namespace dns_parser
+
+#endif // DNS_PARSER_LATENCY_HISTOGRAM_H
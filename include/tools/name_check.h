@@ -0,0 +1,51 @@
+#ifndef DNS_PARSER_NAME_CHECK_H
+#define DNS_PARSER_NAME_CHECK_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace dns_parser {
+
+/**
+ * @brief 域名检查结果的标志位，可以组合
+ */
+enum NameFlag : uint8_t {
+    NAME_UPPERCASE = 0x01,      // 含大写字母（如 0x20 随机化的查询）
+    NAME_NON_LDH = 0x02,        // 有标签含字母、数字、连字符以外的字节（包括 '_'），或以连字符开头或结尾
+    NAME_IDN = 0x04,            // 有标签是 "xn--" 开头的 A-label，或含非 ASCII 字节
+    NAME_BAD_LENGTH = 0x08      // 有标签为空或超过 63 字节
+};
+
+/**
+ * @brief 把文本形式的域名原地转为小写，同一遍内检查标签字符和长度
+ *
+ * 逐块取得大写、非 LDH、非 ASCII 字节以及 '.'、'-' 等字节的位置掩码，再用按位运算一次检查
+ * 所有标签的长度、首尾连字符和 "xn--" 前缀。运行时按 CPU 选择 AVX2 或 SSE2
+ * 实现，非 x86 平台使用逐字节实现，各实现结果相同。
+ * 标签本身含 '.' 的名字在文本形式中无法区分，按多个标签检查。
+ *
+ * @param name 以 '.' 分隔、不含结尾 '.' 的域名，空串表示根域
+ * @param length 长度，不超过 255
+ * @return NameFlag 的组合，合法的小写主机名返回 0
+ */
+uint8_t normalizeName(char* name, size_t length);
+
+/**
+ * @brief 运行时选中的实现（"avx2"、"sse2" 或 "scalar"）
+ */
+const char* nameCheckImplementation();
+
+namespace detail {
+
+// 各实现单独导出，供测试逐一对照；AVX2 实现只能在 cpuHasAvx2() 为真时调用
+uint8_t normalizeNameScalar(char* name, size_t length);
+uint8_t normalizeNameSse2(char* name, size_t length);
+uint8_t normalizeNameAvx2(char* name, size_t length);
+bool cpuHasSse2();
+bool cpuHasAvx2();
+
+} // namespace detail
+
+} // namespace dns_parser
+
+#endif // DNS_PARSER_NAME_CHECK_H
@@ -0,0 +1,154 @@
+#ifndef DNS_PARSER_NAME_HASH_H
+#define DNS_PARSER_NAME_HASH_H
+
+#include <cstddef>
+#include <cstdint>
+#include "hash.h"
+
+namespace dns_parser {
+
+/**
+ * @brief 域名哈希：根域的哈希值，也是后缀哈希链的起点
+ *
+ * 域名哈希按标签组合：每个标签按 ASCII 小写单独哈希，后缀哈希 =
+ * hashSuffix(标签哈希, 父域后缀哈希)，整个域名的哈希就是最左一级的后缀哈希。
+ * 标签哈希互不依赖，解码时可以按从左到右的顺序逐个计算，结束后再从根向下
+ * 组合出各级后缀；文本形式和线格式算出的结果相同（标签内含 '.' 的名字除外）。
+ */
+const uint64_t kNameHashSeed = 0x5bd1e9955bd1e995ULL;
+
+inline uint8_t foldByte(uint8_t c) {
+    return static_cast<uint8_t>(c - 'A') < 26 ? static_cast<uint8_t>(c | 0x20) : c;
+}
+
+/**
+ * @brief 单个标签的哈希（大小写不敏感）
+ *
+ * 逐字节折叠后按 8 字节一组直接混入哈希，不经过中间缓冲区，结果与 hashBytes
+ * 作用于小写标签相同（小端序）。out 不为 nullptr 时在同一遍内把原文复制过去，
+ * 解码时标签只读一次。
+ *
+ * @param label 标签内容，不含长度字节
+ * @param len 标签长度
+ * @param out 原文的复制目标，可为 nullptr
+ */
+inline uint64_t hashLabel(const uint8_t* label, size_t len, uint8_t* out = nullptr) {
+    uint64_t h = len * 0x9e3779b97f4a7c15ULL;
+    uint64_t word = 0;
+    for (size_t i = 0; i < len; ++i) {
+        uint8_t c = label[i];
+        if (out) {
+            out[i] = c;
+        }
+        word |= static_cast<uint64_t>(foldByte(c)) << ((i & 7) * 8);
+        if ((i & 7) == 7) {
+            h = (h ^ mix64(word)) * 0x9fb21c651e98df25ULL;
+            word = 0;
+        }
+    }
+    h ^= mix64(word + (len & 7));
+    return mix64(h);
+}
+
+/**
+ * @brief 在父域后缀哈希上加一级标签
+ */
+inline uint64_t hashSuffix(uint64_t label_hash, uint64_t parent) {
+    return mix64(label_hash + parent * 0x9fb21c651e98df25ULL);
+}
+
+/**
+ * @brief 文本形式域名的哈希，标签从右向左组合，不需要额外存储
+ * @param name 以 '.' 分隔的域名，空串表示根域
+ * @param len 长度
+ */
+inline uint64_t hashNameText(const char* name, size_t len) {
+    const uint8_t* text = reinterpret_cast<const uint8_t*>(name);
+    uint64_t hash = kNameHashSeed;
+    size_t end = len;
+    for (size_t i = len; i > 0; --i) {
+        if (text[i - 1] == '.') {
+            hash = hashSuffix(hashLabel(text + i, end - i), hash);
+            end = i - 1;
+        }
+    }
+    if (len) {
+        hash = hashSuffix(hashLabel(text, end), hash);
+    }
+    return hash;
+}
+
+/**
+ * @brief 解码域名时顺带计算的哈希
+ *
+ * suffixes[i] 是从左数第 i 个标签开始的后缀的哈希，suffixes[0] 即整个域名的哈希；
+ * offsets[i] 是该标签在解码出的文本中的起始位置，用于从后缀定位到文本。
+ */
+struct NameHash {
+    static const size_t kMaxLabels = 128;   // 255 字节的文本最多 128 个标签
+
+    uint64_t full;                      // 整个域名的哈希，根域为 kNameHashSeed
+    size_t labels;                      // 标签数
+    uint64_t suffixes[kMaxLabels];
+    uint8_t offsets[kMaxLabels];
+
+    NameHash() : full(kNameHashSeed), labels(0) {}
+
+    void reset() {
+        full = kNameHashSeed;
+        labels = 0;
+    }
+
+    /**
+     * @brief 按从左到右的顺序加入一个标签
+     * @param out 不为 nullptr 时在哈希的同一遍内把标签原文复制过去
+     */
+    void addLabel(const uint8_t* label, size_t len, size_t offset, uint8_t* out = nullptr) {
+        suffixes[labels] = hashLabel(label, len, out);
+        offsets[labels] = static_cast<uint8_t>(offset);
+        ++labels;
+    }
+
+    /**
+     * @brief 所有标签加入后，从根向下把标签哈希组合成各级后缀哈希
+     */
+    void finish() {
+        uint64_t hash = kNameHashSeed;
+        for (size_t i = labels; i > 0; --i) {
+            hash = hashSuffix(suffixes[i - 1], hash);
+            suffixes[i - 1] = hash;
+        }
+        full = hash;
+    }
+
+    /**
+     * @brief 从文本形式的域名计算（用于没有经过解码的名字）
+     * @param name 以 '.' 分隔的域名，空串表示根域
+     * @param len 长度
+     * @return 长度超过 255 时返回 false，结果为根域
+     */
+    bool assign(const char* name, size_t len) {
+        reset();
+        if (len > 255) {
+            return false;
+        }
+        const uint8_t* text = reinterpret_cast<const uint8_t*>(name);
+        size_t start = 0;
+        for (size_t i = 0; len && i <= len; ++i) {
+            if (i == len || text[i] == '.') {
+                if (labels == kMaxLabels) {
+                    reset();
+                    return false;
+                }
+                addLabel(text + start, i - start, start);
+                start = i + 1;
+            }
+        }
+        finish();
+        return true;
+    }
+};
+
+} // namespace dns_parser
+
+#endif // DNS_PARSER_NAME_HASH_H
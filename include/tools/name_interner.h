@@ -0,0 +1,159 @@
+#ifndef DNS_PARSER_NAME_INTERNER_H
+#define DNS_PARSER_NAME_INTERNER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "types.h"
+
+namespace dns_parser {
+
+/**
+ * @brief 域名驻留表
+ *
+ * 每个不同的域名（按 ASCII 小写规范化）只保存一次，并分配一个 32 位 ID，
+ * 之后的比较、缓存和输出都可以直接使用 ID。ID 只在同一个实例内、两次 clear()
+ * 之间有意义，不同实例的 ID 不能比较，需要按名字文本转换。
+ *
+ * 共享实例（shared = true，如全局驻留表）可以跨线程使用：
+ * - 读（find / name / data）完全无锁：开放寻址表的槽位是原子的 64 位值
+ * - 写（intern）按哈希分段加锁，同名插入落在同一段内，不同段互不阻塞
+ * 私有实例（shared = false）只由一个线程使用：写入不加锁、不做 CAS，
+ * 只有一个 slab 分段，slab 也更小。
+ *
+ * 名字保存在只追加的 slab 中，返回的指针在 clear() 之前一直有效。
+ * 容量在构造时确定，写满后 intern 返回 kInvalidNameId。全局驻留表从不回收；
+ * 随机子域名等流量会把它永久写满，长期运行的组件应使用各自私有的实例，
+ * 写满时用 clear() 整体回收后重新驻留仍在使用的名字（ID 随之重新编号）。
+ */
+class NameInterner {
+public:
+    static const uint32_t kInvalidId = kInvalidNameId;
+    static const size_t kMaxNameLength = 255;
+
+    /**
+     * @brief 构造函数
+     * @param max_names 最多可驻留的域名数量
+     * @param shared 是否允许多个线程并发写入；为 false 时只能由一个线程使用
+     */
+    explicit NameInterner(size_t max_names = 1 << 20, bool shared = true);
+    ~NameInterner();
+
+    NameInterner(const NameInterner&) = delete;
+    NameInterner& operator=(const NameInterner&) = delete;
+
+    /**
+     * @brief 获取进程级全局驻留表
+     */
+    static NameInterner& global();
+
+    /**
+     * @brief 驻留域名，已存在时直接返回原 ID
+     * @param name 域名
+     * @param len 域名长度
+     * @return 域名 ID，容量已满或名字过长时返回 kInvalidId
+     */
+    uint32_t intern(const char* name, size_t len);
+    uint32_t intern(const std::string& name);
+
+    /**
+     * @brief 用已算好的哈希驻留域名（解码时顺带计算，省去一次哈希）
+     * @param name 域名
+     * @param len 域名长度
+     * @param hash hashNameText(name, len) 的值，大小写不敏感
+     * @param lowercase 名字已是小写（如解析时已规范化）时为 true，跳过大小写折叠
+     * @return 域名 ID，容量已满或名字过长时返回 kInvalidId
+     */
+    uint32_t intern(const char* name, size_t len, uint64_t hash, bool lowercase = false);
+
+    /**
+     * @brief 无锁查找域名 ID
+     * @param name 域名
+     * @param len 域名长度
+     * @return 域名 ID，不存在时返回 kInvalidId
+     */
+    uint32_t find(const char* name, size_t len) const;
+    uint32_t find(const std::string& name) const;
+
+    /**
+     * @brief 获取 ID 对应的名字（指向 slab 内部，无需复制）
+     * @param id 域名 ID
+     * @param len 输出名字长度
+     * @return 名字指针，ID 无效时返回 nullptr
+     */
+    const char* data(uint32_t id, size_t* len) const;
+
+    /**
+     * @brief 获取 ID 对应的名字副本
+     * @param id 域名 ID
+     * @return 域名，ID 无效时返回空字符串
+     */
+    std::string name(uint32_t id) const;
+
+    /**
+     * @brief 获取已驻留的域名数量
+     */
+    size_t size() const noexcept;
+
+    /**
+     * @brief 获取容量（最多可驻留的域名数量）
+     */
+    size_t maxNames() const noexcept;
+
+    /**
+     * @brief 是否已写满，写满后新名字无法驻留
+     */
+    bool full() const noexcept;
+
+    /**
+     * @brief 清空所有名字并释放 slab 和目录块，之前分配的 ID 和名字指针全部失效
+     *
+     * 不是线程安全的：调用期间及之后，其他线程不能再持有或访问本实例的 ID 和指针，
+     * 只适用于单个线程私有的驻留表。
+     */
+    void clear();
+
+    /**
+     * @brief 估算占用的字节数（哈希表 + 目录 + slab）
+     */
+    size_t memoryUsage() const noexcept;
+
+private:
+    static const size_t kStripes = 64;
+    static const size_t kChunkBits = 16;
+    static const size_t kChunkSize = size_t(1) << kChunkBits;
+    static const size_t kSlabSize = 1 << 16;
+    static const size_t kLocalSlabSize = 1 << 12;     // 私有实例的 slab 大小
+
+    // 写入分段，填充到独立缓存行避免伪共享
+    struct alignas(64) Stripe {
+        std::mutex lock;
+        char* cursor;
+        size_t remaining;
+        std::vector<char*> slabs;
+    };
+
+    size_t capacity;                                  // 最大域名数量
+    size_t mask;                                      // 哈希表槽位数 - 1
+    std::atomic<uint64_t>* slots;                     // (哈希标签 << 32) | (ID + 1)
+    std::atomic<std::atomic<const char*>*>* chunks;   // ID -> 记录指针的两级目录
+    size_t chunk_count;
+    std::atomic<uint32_t> next_id;
+    std::atomic<size_t> slab_bytes;
+    bool shared;                                      // 是否允许并发写入
+    size_t stripe_count;                              // 共享实例为 kStripes，私有实例为 1
+    size_t slab_size;
+    Stripe* stripes;
+
+    uint32_t lookup(const char* name, size_t len, uint64_t hash) const;
+    const char* record(uint32_t id) const;
+    void publish(uint32_t id, const char* rec);
+    char* allocate(Stripe& stripe, size_t bytes);
+};
+
+} // namespace dns_parser
+
+#endif // DNS_PARSER_NAME_INTERNER_H
@@ -0,0 +1,104 @@
+#ifndef DNS_PARSER_SHARDED_H
+#define DNS_PARSER_SHARDED_H
+
+#include <atomic>
+#include <utility>
+#include "aligned.h"
+
+namespace dns_parser {
+
+/**
+ * @brief 按工作线程分片的对象表
+ *
+ * 每个分片由所属线程（TASK::Thread）在首次使用时创建，按缓存行对齐单独分配，
+ * 不同线程的可变状态不会落在同一缓存行上。数据路径上只读取本线程的槽位指针，
+ * 没有任何跨线程写入；汇总视图由 forEach 在合并步骤中遍历所有分片构建。
+ *
+ * 约定：
+ * - 同一分片只由一个线程调用 local()
+ * - forEach 可以与 local() 并发，遍历到的对象只能读取其中的原子字段；
+ *   读取其他字段（如合并哈希表）需要在工作线程停止后进行
+ * - clear() 只能在所有工作线程停止后调用
+ * - 编号不小于 kMaxShards 的分片被拒绝，不与其他线程共用槽位
+ */
+template <typename T>
+class Sharded {
+public:
+    // 分片数上限
+    static const unsigned short kMaxShards = 256;
+
+    Sharded() {
+        for (unsigned short i = 0; i < kMaxShards; ++i) {
+            slots[i].store(nullptr, std::memory_order_relaxed);
+        }
+    }
+
+    ~Sharded() {
+        clear();
+    }
+
+    Sharded(const Sharded&) = delete;
+    Sharded& operator=(const Sharded&) = delete;
+
+    /**
+     * @brief 获取分片，不存在或编号超出上限时返回 nullptr
+     * @param shard 分片编号
+     */
+    T* find(unsigned short shard) const noexcept {
+        return shard < kMaxShards ? slots[shard].load(std::memory_order_acquire) : nullptr;
+    }
+
+    /**
+     * @brief 获取分片，不存在时用给定参数创建
+     * @param shard 分片编号
+     * @param args 构造参数
+     * @return 分片对象，编号超出上限时返回 nullptr
+     */
+    template <typename... Args>
+    T* local(unsigned short shard, Args&&... args) {
+        if (shard >= kMaxShards) {
+            return nullptr;
+        }
+        std::atomic<T*>& slot = slots[shard];
+        T* object = slot.load(std::memory_order_acquire);
+        if (!object) {
+            object = alignedNew<T>(std::forward<Args>(args)...);
+            slot.store(object, std::memory_order_release);
+        }
+        return object;
+    }
+
+    /**
+     * @brief 遍历所有已创建的分片
+     * @param fn 回调，参数为分片编号和对象引用
+     */
+    template <typename Fn>
+    void forEach(Fn fn) const {
+        for (unsigned short i = 0; i < kMaxShards; ++i) {
+            T* object = slots[i].load(std::memory_order_acquire);
+            if (object) {
+                fn(i, *object);
+            }
+        }
+    }
+
+    /**
+     * @brief 销毁所有分片
+     */
+    void clear() {
+        for (unsigned short i = 0; i < kMaxShards; ++i) {
+            alignedDelete(slots[i].exchange(nullptr));
+        }
+    }
+
+private:
+    // 槽位指针只在分片创建时写入一次，之后各线程只读，不会产生伪共享
+    std::atomic<T*> slots[kMaxShards];
+};
+
+template <typename T>
+const unsigned short Sharded<T>::kMaxShards;
+
+} // namespace dns_parser
+
+#endif // DNS_PARSER_SHARDED_H
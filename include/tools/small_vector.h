@@ -0,0 +1,192 @@
+#ifndef DNS_PARSER_SMALL_VECTOR_H
+#define DNS_PARSER_SMALL_VECTOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <type_traits>
+
+namespace dns_parser {
+
+/**
+ * @brief 带内联存储的小向量，只用于可平凡复制的元素
+ *
+ * 前 N 个元素存放在对象内部，不产生堆分配；超出后按容量翻倍转到堆上。
+ * 元素按字节复制和移动，不调用构造和析构函数。clear() 保留已有容量，
+ * 对象被重复使用时不会反复分配。
+ *
+ * @tparam T 元素类型，必须可平凡复制
+ * @tparam N 内联容量
+ */
+template <typename T, size_t N>
+class SmallVector {
+    static_assert(std::is_trivially_copyable<T>::value, "SmallVector 只能存放可平凡复制的类型");
+    static_assert(N > 0, "内联容量不能为 0");
+
+public:
+    typedef T value_type;
+    typedef T* iterator;
+    typedef const T* const_iterator;
+
+    SmallVector() noexcept : items(inlineItems()), count(0), capacity_(N) {}
+
+    SmallVector(const SmallVector& other) : items(inlineItems()), count(0), capacity_(N) {
+        assign(other.items, other.count);
+    }
+
+    SmallVector& operator=(const SmallVector& other) {
+        if (this != &other) {
+            count = 0;
+            assign(other.items, other.count);
+        }
+        return *this;
+    }
+
+    ~SmallVector() {
+        if (items != inlineItems()) {
+            ::operator delete(items);
+        }
+    }
+
+    size_t size() const noexcept {
+        return count;
+    }
+
+    size_t capacity() const noexcept {
+        return capacity_;
+    }
+
+    bool empty() const noexcept {
+        return count == 0;
+    }
+
+    /**
+     * @brief 是否仍在使用内联存储
+     */
+    bool isInline() const noexcept {
+        return items == inlineItems();
+    }
+
+    T* data() noexcept {
+        return items;
+    }
+
+    const T* data() const noexcept {
+        return items;
+    }
+
+    T& operator[](size_t i) noexcept {
+        return items[i];
+    }
+
+    const T& operator[](size_t i) const noexcept {
+        return items[i];
+    }
+
+    T& back() noexcept {
+        return items[count - 1];
+    }
+
+    const T& back() const noexcept {
+        return items[count - 1];
+    }
+
+    iterator begin() noexcept {
+        return items;
+    }
+
+    iterator end() noexcept {
+        return items + count;
+    }
+
+    const_iterator begin() const noexcept {
+        return items;
+    }
+
+    const_iterator end() const noexcept {
+        return items + count;
+    }
+
+    void clear() noexcept {
+        count = 0;
+    }
+
+    void push_back(const T& value) {
+        if (count == capacity_) {
+            // value 可能引用本向量中的元素，扩容前先复制
+            T copy = value;
+            grow(count + 1);
+            items[count++] = copy;
+            return;
+        }
+        items[count++] = value;
+    }
+
+    /**
+     * @brief 在末尾追加 n 个元素
+     */
+    void append(const T* values, size_t n) {
+        if (count + n > capacity_) {
+            grow(count + n);
+        }
+        std::memcpy(items + count, values, n * sizeof(T));
+        count += n;
+    }
+
+    /**
+     * @brief 把大小改为 n，新增的元素不初始化
+     */
+    void resize(size_t n) {
+        if (n > capacity_) {
+            grow(n);
+        }
+        count = n;
+    }
+
+    void reserve(size_t n) {
+        if (n > capacity_) {
+            grow(n);
+        }
+    }
+
+private:
+    T* items;
+    size_t count;
+    size_t capacity_;
+    typename std::aligned_storage<sizeof(T) * N, alignof(T)>::type storage;
+
+    T* inlineItems() noexcept {
+        return reinterpret_cast<T*>(&storage);
+    }
+
+    const T* inlineItems() const noexcept {
+        return reinterpret_cast<const T*>(&storage);
+    }
+
+    void assign(const T* values, size_t n) {
+        if (n > capacity_) {
+            grow(n);
+        }
+        std::memcpy(items, values, n * sizeof(T));
+        count = n;
+    }
+
+    void grow(size_t needed) {
+        size_t new_capacity = capacity_ * 2;
+        if (new_capacity < needed) {
+            new_capacity = needed;
+        }
+        T* grown = static_cast<T*>(::operator new(new_capacity * sizeof(T)));
+        std::memcpy(grown, items, count * sizeof(T));
+        if (items != inlineItems()) {
+            ::operator delete(items);
+        }
+        items = grown;
+        capacity_ = new_capacity;
+    }
+};
+
+} // namespace dns_parser
+
+#endif // DNS_PARSER_SMALL_VECTOR_H
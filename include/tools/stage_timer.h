@@ -0,0 +1,229 @@
+#ifndef DNS_PARSER_STAGE_TIMER_H
+#define DNS_PARSER_STAGE_TIMER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include "alloc_tracker.h"
+#include "latency_histogram.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// 编译期开关：为 0 时所有计时点都是空的内联函数，不产生任何指令
+#ifndef DNS_PARSER_STAGE_TIMING
+#define DNS_PARSER_STAGE_TIMING 1
+#endif
+
+namespace dns_parser {
+
+/**
+ * @brief 数据包处理阶段
+ */
+enum class Stage : uint8_t {
+    Intake = 0,     // 取得任务：配置快照、线程状态、流键、推进时间轮
+    Header,         // 解析 DNS 头部
+    Question,       // 解析问题区
+    Records,        // 解析资源记录
+    Analytics,      // 查询关联、响应缓存、被动 DNS、策略判定
+    Output,         // 输出消息详情、设置动作、合成响应
+    Count
+};
+
+/**
+ * @brief 计时源：x86 上为 rdtsc，其他平台为 CLOCK_MONOTONIC（纳秒）
+ */
+class CycleClock {
+public:
+    static inline uint64_t now() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#else
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + ts.tv_nsec;
+#endif
+    }
+
+    /**
+     * @brief 每个计时单位对应的纳秒数，首次调用时用单调时钟校准（约 10 毫秒）
+     */
+    static double nanosPerTick();
+};
+
+/**
+ * @brief 按阶段记录单个线程的处理耗时
+ *
+ * 每个数据包开始时调用 begin()，之后在每个阶段结束处调用 lap(stage)：
+ * 距上一个计时点的耗时计入该阶段，同一阶段在一个数据包内可以出现多次
+ * （如分析和输出交替进行），finish() 把每个经过的阶段的累计耗时作为
+ * 一个样本写入该阶段的直方图。每个计时点只读一次时钟。
+ *
+ * 运行期未启用时每个计时点只有一次分支；编译期关闭（DNS_PARSER_STAGE_TIMING=0）
+ * 时什么都不做。直方图只由所属线程写入，其他线程可以随时读取快照。
+ *
+ * 启用分配统计的构建（DNS_PARSER_ALLOC_TRACKING=1）中，同样的计时点还把
+ * 两个计时点之间本线程的堆分配次数和字节数计入该阶段，不受运行期计时开关影响；
+ * 每个数据包的分配次数另外记入一个直方图。
+ */
+class StageRecorder {
+public:
+    static const size_t kStages = static_cast<size_t>(Stage::Count);
+
+    /**
+     * @brief 分配统计快照
+     */
+    struct AllocStats {
+        uint64_t packets;               // 计入的数据包数
+        uint64_t frees;
+        uint64_t arena_blocks;
+        uint64_t arena_bytes;
+        uint64_t allocations[kStages];  // 各阶段的分配次数
+        uint64_t bytes[kStages];        // 各阶段的分配字节数
+    };
+
+    StageRecorder() : active(false), visited(0), last(0), alloc_last(), alloc_begin(), alloc_packets(0), alloc_frees(0),
+                      arena_blocks(0), arena_bytes(0) {
+        for (size_t i = 0; i < kStages; ++i) {
+            pending[i] = 0;
+            alloc_pending[i] = 0;
+            bytes_pending[i] = 0;
+            stage_allocations[i].store(0, std::memory_order_relaxed);
+            stage_bytes[i].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    StageRecorder(const StageRecorder&) = delete;
+    StageRecorder& operator=(const StageRecorder&) = delete;
+
+    /**
+     * @brief 开始一个数据包
+     * @param enabled 运行期开关
+     * @param start 数据包开始处理的时刻（CycleClock::now()）
+     */
+    void begin(bool enabled, uint64_t start) noexcept {
+#if DNS_PARSER_STAGE_TIMING
+        active = enabled;
+        last = start;
+#else
+        (void)enabled;
+        (void)start;
+#endif
+#if DNS_PARSER_ALLOC_TRACKING
+        alloc_last = currentAllocTally();
+        alloc_begin = alloc_last;
+#endif
+    }
+
+    /**
+     * @brief 结束一个阶段
+     */
+    void lap(Stage stage) noexcept {
+#if DNS_PARSER_STAGE_TIMING
+        if (active) {
+            uint64_t now = CycleClock::now();
+            size_t index = static_cast<size_t>(stage);
+            pending[index] += now - last;
+            visited |= 1u << index;
+            last = now;
+        }
+#else
+        (void)stage;
+#endif
+#if DNS_PARSER_ALLOC_TRACKING
+        AllocTally now_tally = currentAllocTally();
+        alloc_pending[static_cast<size_t>(stage)] += now_tally.allocations - alloc_last.allocations;
+        bytes_pending[static_cast<size_t>(stage)] += now_tally.bytes - alloc_last.bytes;
+        alloc_last = now_tally;
+#endif
+    }
+
+    /**
+     * @brief 结束一个数据包，把各阶段耗时写入直方图
+     */
+    void finish() noexcept {
+#if DNS_PARSER_STAGE_TIMING
+        if (active) {
+            for (size_t i = 0; i < kStages; ++i) {
+                if (visited & (1u << i)) {
+                    histograms[i].record(pending[i]);
+                    pending[i] = 0;
+                }
+            }
+            visited = 0;
+            active = false;
+        }
+#endif
+#if DNS_PARSER_ALLOC_TRACKING
+        finishAllocations();
+#endif
+    }
+
+    /**
+     * @brief 清空直方图（只能由所属线程调用）
+     */
+    void reset() noexcept;
+
+    const LatencyHistogram& histogram(Stage stage) const {
+        return histograms[static_cast<size_t>(stage)];
+    }
+
+    /**
+     * @brief 每个数据包的分配次数分布（只在启用分配统计的构建中有数据）
+     */
+    const LatencyHistogram& allocationsPerPacket() const {
+        return per_packet;
+    }
+
+    /**
+     * @brief 读取分配统计（可在任意线程调用）
+     */
+    AllocStats allocStats() const noexcept;
+
+    /**
+     * @brief 阶段名称，用于日志
+     */
+    static const char* stageName(Stage stage);
+
+private:
+    bool active;
+    unsigned visited;               // 本数据包经过的阶段位图
+    uint64_t last;                  // 上一个计时点
+    uint64_t pending[kStages];      // 本数据包各阶段的累计耗时
+    LatencyHistogram histograms[kStages];
+
+    // 分配统计：本数据包各阶段的待计入量和跨线程可读的累计量
+    AllocTally alloc_last;
+    AllocTally alloc_begin;
+    uint64_t alloc_pending[kStages];
+    uint64_t bytes_pending[kStages];
+    std::atomic<uint64_t> stage_allocations[kStages];
+    std::atomic<uint64_t> stage_bytes[kStages];
+    std::atomic<uint64_t> alloc_packets;
+    std::atomic<uint64_t> alloc_frees;
+    std::atomic<uint64_t> arena_blocks;
+    std::atomic<uint64_t> arena_bytes;
+    LatencyHistogram per_packet;
+
+    void finishAllocations() noexcept;
+};
+
+/**
+ * @brief 在指针非空时结束一个阶段，用于可选的计时点
+ */
+inline void lapStage(StageRecorder* recorder, Stage stage) noexcept {
+#if DNS_PARSER_STAGE_TIMING || DNS_PARSER_ALLOC_TRACKING
+    if (recorder) {
+        recorder->lap(stage);
+    }
+#else
+    (void)recorder;
+    (void)stage;
+#endif
+}
+
+} // namespace dns_parser
+
+#endif // DNS_PARSER_STAGE_TIMER_H
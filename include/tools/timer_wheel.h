@@ -0,0 +1,166 @@
+#ifndef DNS_PARSER_TIMER_WHEEL_H
+#define DNS_PARSER_TIMER_WHEEL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace dns_parser {
+
+/**
+ * @brief 分层时间轮
+ *
+ * 4 层，每层 256 个槽位，覆盖 2^32 个刻度；更远的定时器挂在最高层最后一个槽位，
+ * 轮转到时重新计算。插入和取消都是 O(1)（侵入式双向链表），到期时高层槽位
+ * 逐级下放到低层。每层有一个 256 位的占用位图，推进时直接跳过空槽位，
+ * 长时间无事件的跨度不会逐刻度空转。
+ *
+ * 刻度的含义由调用方决定（毫秒、秒等），时间轮本身不读取任何时钟，
+ * 由数据包时间戳驱动，回放时结果可复现。
+ *
+ * 本类不是线程安全的，每个工作线程持有自己的实例。
+ */
+class TimerWheel {
+public:
+    typedef uint64_t Handle;
+
+    // 无效句柄
+    static const Handle kInvalidHandle = 0;
+
+    /**
+     * @brief 构造函数
+     * @param now 起始刻度
+     */
+    explicit TimerWheel(uint64_t now = 0);
+
+    /**
+     * @brief 重置起始刻度（仅在没有定时器时有效）
+     * @param now 新的起始刻度
+     */
+    void reset(uint64_t now);
+
+    /**
+     * @brief 添加定时器
+     * @param expire 到期刻度，早于当前刻度时在下一次推进时立即到期
+     * @param data 到期时回传的用户数据
+     * @return 定时器句柄
+     */
+    Handle schedule(uint64_t expire, uint64_t data);
+
+    /**
+     * @brief 取消定时器
+     * @param handle 定时器句柄（已到期或已取消的句柄会被忽略）
+     * @return 是否取消了一个有效定时器
+     */
+    bool cancel(Handle handle);
+
+    /**
+     * @brief 修改定时器的到期刻度
+     * @param handle 定时器句柄
+     * @param expire 新的到期刻度
+     * @return 句柄是否有效
+     */
+    bool reschedule(Handle handle, uint64_t expire);
+
+    /**
+     * @brief 推进到指定刻度，触发到期的定时器
+     *
+     * 每次调用最多做 max_work 个单位的工作（到期回调和槽位下放各计一个单位），
+     * 未做完的部分留到下一次调用，适合在 Filter 中小步均摊。回调中可以
+     * 添加或取消定时器。
+     *
+     * @param now 当前刻度
+     * @param max_work 本次最多处理的工作量
+     * @param on_expire 回调，参数为定时器的用户数据
+     * @return 触发的定时器数量
+     */
+    template <typename Callback>
+    size_t advance(uint64_t now, size_t max_work, Callback on_expire) {
+        size_t work = 0;
+        size_t fired = 0;
+        while (work < max_work && current <= now) {
+            if (count == 0) {
+                current = now + 1;
+                cascaded = false;
+                break;
+            }
+            uint64_t tick = cascaded ? current : nextEventTick();
+            if (tick > now) {
+                current = now + 1;
+                break;
+            }
+            if (!cascaded) {
+                current = tick;
+                work += cascade(tick);
+                cascaded = true;
+            }
+
+            // 逐个摘下当前槽位的定时器再回调，回调里新增的定时器不会落回该槽位
+            uint32_t& head = heads[tick & kSlotMask];
+            firing = true;
+            while (head != kNil && work < max_work) {
+                uint32_t index = head;
+                uint64_t data = nodes[index].data;
+                release(index);
+                on_expire(data);
+                ++fired;
+                ++work;
+            }
+            firing = false;
+            if (head != kNil) {
+                break;
+            }
+            current = tick + 1;
+            cascaded = false;
+        }
+        return fired;
+    }
+
+    /**
+     * @brief 获取下一个待处理的刻度
+     */
+    uint64_t now() const noexcept;
+
+    /**
+     * @brief 获取有效定时器数量
+     */
+    size_t size() const noexcept;
+
+private:
+    static const unsigned kLevels = 4;
+    static const unsigned kSlotBits = 8;
+    static const unsigned kSlots = 1u << kSlotBits;
+    static const uint64_t kSlotMask = kSlots - 1;
+    static const uint32_t kNil = 0xFFFFFFFFu;
+
+    struct Node {
+        uint64_t expire;        // 到期刻度
+        uint64_t data;          // 用户数据
+        uint32_t prev;          // 槽位链表前驱
+        uint32_t next;          // 槽位链表后继（空闲时作为空闲链表指针）
+        uint32_t generation;    // 代数，复用槽位时递增，防止旧句柄误操作
+        uint16_t slot;          // 所在槽位（层号 * 256 + 槽号）
+        bool live;              // 是否有效
+    };
+
+    std::vector<Node> nodes;
+    uint32_t free_node;
+    uint32_t heads[kLevels * kSlots];
+    uint64_t occupied[kLevels][kSlots / 64];
+    uint64_t current;       // 下一个待处理的刻度
+    size_t count;
+    bool cascaded;          // current 刻度是否已完成下放
+    bool firing;            // 是否正在触发 current 刻度的定时器
+
+    void link(uint32_t index);
+    void unlink(uint32_t index);
+    void release(uint32_t index);
+    size_t cascade(uint64_t tick);
+    uint64_t nextEventTick() const;
+    int findSlot(unsigned level, unsigned from) const;
+    Node* lookup(Handle handle);
+};
+
+} // namespace dns_parser
+
+#endif // DNS_PARSER_TIMER_WHEEL_H
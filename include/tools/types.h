@@ -4,6 +4,46 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <cstdint>
+#include "small_vector.h"
+
+namespace dns_parser {
+class NameInterner;
+}
+
+/**
+ * @brief 无效的域名驻留 ID
+ */
+const uint32_t kInvalidNameId = 0xFFFFFFFFu;
+
+// 没有可注册域名（域名本身是公共后缀或未计算）
+const uint8_t kNoRegistrableOffset = 0xFF;
+
+/**
+ * @brief DNS 查询类型枚举
+ */
+enum class DNSType : uint16_t {
+    A = 1,          // IPv4 地址
+    NS = 2,         // 权威名称服务器
+    CNAME = 5,      // 规范名
+    SOA = 6,        // 起始授权机构
+    PTR = 12,       // 指针记录
+    MX = 15,        // 邮件交换记录
+    TXT = 16,       // 文本记录
+    AAAA = 28,      // IPv6 地址
+    SRV = 33,       // 服务记录
+    OPT = 41,       // EDNS 伪记录
+    DS = 43,        // 委派签名者
+    RRSIG = 46,     // 资源记录集签名
+    NSEC = 47,      // 下一个安全记录
+    DNSKEY = 48,    // DNS 公钥
+    NSEC3 = 50,     // 散列的下一个安全记录
+    NSEC3PARAM = 51, // NSEC3 参数
+    SVCB = 64,      // 服务绑定
+    HTTPS = 65,     // HTTPS 服务绑定
+    ANY = 255,      // 任意类型
+    CAA = 257       // 证书颁发机构授权
+};
 
 /**
  * @brief DNS 报文头部结构
@@ -18,51 +58,263 @@ struct DNSHeader {
 };
 
 /**
- * @brief DNS 查询问题结构
+ * @brief DNS 查询问题结构（16 字节）
+ *
+ * 域名文本存放在所属 Message 的字节区中，用 Message::name() 取得
  */
 struct DNSQuestion {
-    std::string domain_name;    // 查询的域名
+    uint32_t name_id = kInvalidNameId;  // 域名驻留 ID
+    uint32_t name_offset;       // 域名在消息字节区中的偏移
     uint16_t type;             // 查询类型(A、AAAA等)
     uint16_t class_;           // 查询类(通常为IN)
+    uint8_t name_length;        // 域名长度（按 ID 驻留时为 0）
+    uint8_t name_flags = 0;     // 域名检查结果（NameFlag 的组合）
+    uint8_t registrable_offset = kNoRegistrableOffset;  // 可注册域名（eTLD+1）在域名文本中的起始位置
 };
 
 /**
- * @brief DNS 资源记录结构
+ * @brief DNS 资源记录结构（24 字节）
+ *
+ * 域名和资源数据依次存放在所属 Message 的字节区中（域名在前，资源数据紧随其后），
+ * 用 Message::name() 和 Message::rdata() 取得
  */
 struct DNSResourceRecord {
-    std::string name;          // 域名
+    uint32_t name_id = kInvalidNameId;  // 域名驻留 ID
+    uint32_t data_offset;     // 域名在消息字节区中的偏移
+    uint32_t ttl;             // 生存时间
     uint16_t type;            // 记录类型
     uint16_t class_;          // 类
-    uint32_t ttl;             // 生存时间
     uint16_t rdlength;        // 资源数据长度
-    std::string rdata;        // 资源数据
+    uint16_t rdata_offset;    // 资源数据在原始报文中的偏移
+    uint8_t name_length;      // 域名长度（按 ID 驻留时为 0）
+    uint8_t name_flags = 0;   // 域名检查结果（NameFlag 的组合）
 };
 
+static_assert(sizeof(DNSQuestion) <= 16, "DNSQuestion 应保持紧凑");
+static_assert(sizeof(DNSResourceRecord) <= 24, "DNSResourceRecord 应保持紧凑");
+
 /**
- * @brief DNS 消息结构
+ * @brief 消息字节区中的一段数据
  */
-struct Message {
-    DNSHeader header;                              // DNS 报文头部
-    std::vector<DNSQuestion> questions;            // 查询问题区域
-    std::vector<DNSResourceRecord> answers;        // 回答区域
-    std::vector<DNSResourceRecord> authorities;    // 权威名称服务器区域
-    std::vector<DNSResourceRecord> additionals;    // 附加信息区域
+struct ByteRef {
+    uint32_t offset;    // 在消息字节区中的偏移
+    uint16_t length;    // 长度
 };
 
 /**
- * @brief DNS 查询类型枚举
+ * @brief 资源数据的解码类型
  */
-enum class DNSType : uint16_t {
-    A = 1,          // IPv4 地址
-    NS = 2,         // 权威名称服务器
-    CNAME = 5,      // 规范名
-    SOA = 6,        // 起始授权机构
-    PTR = 12,       // 指针记录
-    MX = 15,        // 邮件交换记录
-    TXT = 16,       // 文本记录
-    AAAA = 28,      // IPv6 地址
-    SRV = 33,       // 服务记录
-    ANY = 255       // 任意类型
+enum class RDataKind : uint8_t {
+    None = 0,       // 不解码的类型，只有原始字节
+    Malformed,      // 长度或内嵌域名不合法
+    Address,        // A / AAAA
+    Name,           // CNAME / NS / PTR
+    MX,
+    SOA,
+    SRV,
+    TXT,
+    CAA,
+    SVCB,           // SVCB / HTTPS
+    OPT,            // EDNS(0) 伪记录
+    Skipped         // 按 ParseOptions::skip_dnssec 跳过的 DNSSEC 记录，资源数据只留在原始报文中
+};
+
+struct MXData {
+    uint16_t preference;
+    ByteRef exchange;
+};
+
+struct SOAData {
+    ByteRef mname;
+    ByteRef rname;
+    uint32_t serial;
+    uint32_t refresh;
+    uint32_t retry;
+    uint32_t expire;
+    uint32_t minimum;
+};
+
+struct SRVData {
+    uint16_t priority;
+    uint16_t weight;
+    uint16_t port;
+    ByteRef target;
+};
+
+struct TXTData {
+    uint16_t count;     // 字符串个数
+    ByteRef strings;    // 带长度前缀的原始字符串序列
+};
+
+struct CAAData {
+    uint8_t flags;
+    ByteRef tag;
+    ByteRef value;
+};
+
+struct SVCBData {
+    uint16_t priority;  // 0 表示别名模式
+    ByteRef target;
+    ByteRef params;     // 原始的 SvcParams 序列
+};
+
+/**
+ * @brief EDNS(0) OPT 伪记录
+ */
+struct OPTData {
+    uint16_t udp_size;          // 请求方可接收的 UDP 负载长度
+    uint16_t flags;             // 扩展标志，最高位为 DO
+    uint8_t extended_rcode;     // 扩展响应码的高 8 位
+    uint8_t version;            // EDNS 版本
+    uint8_t ecs_family;         // 客户端子网的地址族：0 表示没有，1 为 IPv4，2 为 IPv6
+    uint8_t ecs_source;         // 客户端子网的源前缀长度
+    uint8_t ecs_scope;          // 客户端子网的作用域前缀长度（响应中有效）
+    uint8_t ecs_address[16];    // 客户端子网地址，源前缀之外的位已清零
+    ByteRef cookie;             // 客户端 Cookie 及可选的服务器 Cookie，没有时长度为 0
+
+    static const uint16_t kDnssecOk = 0x8000;
+};
+
+/**
+ * @brief 解码后的资源数据（固定布局）
+ *
+ * 内嵌域名按整个报文解压缩后存放在消息字节区中，字符串和参数引用字节区中的
+ * 原始资源数据，读取时不需要再次解码。
+ */
+struct RData {
+    RDataKind kind;
+    union {
+        uint8_t address[16];    // A 为前 4 字节
+        ByteRef name;
+        MXData mx;
+        SOAData soa;
+        SRVData srv;
+        TXTData txt;
+        CAAData caa;
+        SVCBData svcb;
+        OPTData opt;
+        uint16_t owner;         // 跳过的记录：所有者域名在原始报文中的偏移
+    };
+};
+
+static_assert(sizeof(RData) <= 40, "RData 应保持紧凑");
+
+/**
+ * @brief 一个区段内连续存放的资源记录
+ */
+struct RecordSpan {
+    const DNSResourceRecord* first;
+    size_t count;
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    const DNSResourceRecord& operator[](size_t i) const { return first[i]; }
+    const DNSResourceRecord* begin() const { return first; }
+    const DNSResourceRecord* end() const { return first + count; }
+};
+
+/**
+ * @brief DNS 消息结构
+ *
+ * 所有记录按应答、权威、附加的顺序存放在一个数组中，域名和资源数据存放在
+ * 同一个字节区中，记录只保存偏移和长度。问题、记录和字节区都带内联存储，
+ * 常见的 1 个问题、不超过 4 条记录、不超过 256 字节文本的消息解析时不产生堆分配。
+ */
+struct Message {
+    DNSHeader header;                                       // DNS 报文头部
+    dns_parser::SmallVector<DNSQuestion, 1> questions;      // 查询问题区域
+    dns_parser::SmallVector<DNSResourceRecord, 4> records;  // 应答、权威、附加区域的记录
+    uint16_t answer_count = 0;                              // 已解析的应答记录数
+    uint16_t authority_count = 0;                           // 已解析的权威记录数
+    dns_parser::SmallVector<RData, 4> values;               // 与 records 一一对应的解码结果
+    dns_parser::SmallVector<char, 256> bytes;               // 域名、资源数据和解码出的内嵌域名
+    const dns_parser::NameInterner* names = nullptr;        // 按 ID 驻留的域名所在的驻留表
+
+    RecordSpan answers() const {
+        RecordSpan span = { records.data(), answer_count };
+        return span;
+    }
+
+    RecordSpan authorities() const {
+        RecordSpan span = { records.data() + answer_count, authority_count };
+        return span;
+    }
+
+    RecordSpan additionals() const {
+        size_t before = static_cast<size_t>(answer_count) + authority_count;
+        RecordSpan span = { records.data() + before, records.size() - before };
+        return span;
+    }
+
+    /**
+     * @brief 问题的域名（按 ID 驻留时为空）
+     */
+    std::string name(const DNSQuestion& question) const {
+        return std::string(bytes.data() + question.name_offset, question.name_length);
+    }
+
+    /**
+     * @brief 记录的域名（按 ID 驻留时为空）
+     */
+    std::string name(const DNSResourceRecord& rr) const {
+        return std::string(nameData(rr), rr.name_length);
+    }
+
+    const char* nameData(const DNSResourceRecord& rr) const {
+        return bytes.data() + rr.data_offset;
+    }
+
+    /**
+     * @brief 记录的资源数据，长度为 rr.rdlength（跳过的 DNSSEC 记录没有复制，
+     *        用 rr.rdata_offset 从原始报文中读取）
+     */
+    const uint8_t* rdata(const DNSResourceRecord& rr) const {
+        return reinterpret_cast<const uint8_t*>(bytes.data() + rr.data_offset + rr.name_length);
+    }
+
+    /**
+     * @brief 记录的解码结果，rr 必须是本消息 records 中的元素
+     */
+    const RData& decoded(const DNSResourceRecord& rr) const {
+        return values[static_cast<size_t>(&rr - records.data())];
+    }
+
+    /**
+     * @brief 附加区中 OPT 伪记录的解码结果（kind 为 OPT 或 Malformed），没有时返回 nullptr
+     */
+    const RData* opt() const {
+        RecordSpan extra = additionals();
+        for (size_t i = 0; i < extra.size(); ++i) {
+            if (extra[i].type == static_cast<uint16_t>(DNSType::OPT)) {
+                return &decoded(extra[i]);
+            }
+        }
+        return nullptr;
+    }
+
+    /**
+     * @brief 字节区中的一段数据
+     */
+    std::string text(const ByteRef& ref) const {
+        return std::string(bytes.data() + ref.offset, ref.length);
+    }
+
+    const char* data(const ByteRef& ref) const {
+        return bytes.data() + ref.offset;
+    }
+
+    /**
+     * @brief 清空内容，保留已分配的容量
+     */
+    void clear() {
+        questions.clear();
+        records.clear();
+        values.clear();
+        answer_count = 0;
+        authority_count = 0;
+        bytes.clear();
+        names = nullptr;
+    }
 };
 
 /**
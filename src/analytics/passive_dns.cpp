@@ -0,0 +1,367 @@
+#include "../../include/analytics/passive_dns.h"
+#include "../../include/tools/hash.h"
+#include <algorithm>
+#include <cstring>
+
+namespace dns_parser {
+
+const uint32_t PassiveDNS::kInvalidId;
+const size_t PassiveDNS::kExpireStepBudget;
+
+size_t PassiveDNS::IPv6Hash::operator()(const IPv6Address& addr) const {
+    return static_cast<size_t>(hashBytes(addr.data(), addr.size()));
+}
+
+PassiveDNS::PassiveDNS(size_t max_mappings, uint32_t max_ttl, NameInterner& interner)
+    : max_mappings(max_mappings), max_ttl(max_ttl), live_count(0), dropped_count(0),
+      free_entry(kInvalidId), names(interner), wheel_started(false) {
+}
+
+void PassiveDNS::observe(const Message& message, uint32_t now) {
+    expire(now);
+
+    RecordSpan answers = message.answers();
+    for (size_t i = 0; i < answers.size(); ++i) {
+        const DNSResourceRecord& rr = answers[i];
+        if (rr.class_ != static_cast<uint16_t>(DNSClass::IN)) {
+            continue;
+        }
+
+        // 先按类型筛选，只有会被记录的名字才驻留，跳过的 DNSSEC 记录等不会填充驻留表
+        Kind kind;
+        const RData* target = nullptr;
+        if (rr.type == static_cast<uint16_t>(DNSType::A) && rr.rdlength == 4) {
+            kind = KIND_A;
+        } else if (rr.type == static_cast<uint16_t>(DNSType::AAAA) && rr.rdlength == 16) {
+            kind = KIND_AAAA;
+        } else if (rr.type == static_cast<uint16_t>(DNSType::CNAME)) {
+            target = &message.decoded(rr);
+            if (target->kind != RDataKind::Name || target->name.length == 0) {
+                continue;
+            }
+            kind = KIND_CNAME;
+        } else {
+            continue;
+        }
+
+        uint32_t ttl = std::min(rr.ttl, max_ttl);
+        uint32_t name = internName(message, rr);
+        if (name == kInvalidId) {
+            continue;
+        }
+        if (kind == KIND_A) {
+            uint32_t addr;
+            std::memcpy(&addr, message.rdata(rr), 4);
+            record(KIND_A, name, addr, nullptr, ttl, now);
+        } else if (kind == KIND_AAAA) {
+            record(KIND_AAAA, name, 0, message.rdata(rr), ttl, now);
+        } else {
+            uint32_t target_id = names.intern(message.data(target->name), target->name.length);
+            if (target_id == kInvalidId) {
+                continue;
+            }
+            record(KIND_CNAME, name, target_id, nullptr, ttl, now);
+        }
+    }
+}
+
+bool PassiveDNS::expire(uint32_t now, size_t max_work) {
+    if (!wheel_started) {
+        timers.reset(now);
+        wheel_started = true;
+        return true;
+    }
+
+    timers.advance(now, max_work, [this, now](uint64_t data) {
+        uint32_t index = static_cast<uint32_t>(data);
+        if (entries[index].expire <= now) {
+            removeEntry(index);
+        } else {
+            // 期间被刷新过的映射按新的过期时间重新挂入
+            schedule(index);
+        }
+    });
+    return timers.now() > now;
+}
+
+void PassiveDNS::merge(const PassiveDNS& shard, uint32_t now) {
+    expire(now);
+    dropped_count += shard.dropped_count;
+    for (size_t i = 0; i < shard.entries.size(); ++i) {
+        const Entry& e = shard.entries[i];
+        if (!e.live || e.expire <= now) {
+            continue;
+        }
+        uint32_t name = translateName(shard, e.name);
+        uint32_t addr = e.kind == KIND_CNAME ? translateName(shard, e.addr) : e.addr;
+        if (name == kInvalidId || addr == kInvalidId) {
+            continue;
+        }
+        const uint8_t* addr6 = e.kind == KIND_AAAA ? shard.ipv6_pool[e.addr].addr.data() : nullptr;
+        record(static_cast<Kind>(e.kind), name, addr, addr6, e.expire - now, now, true);
+    }
+}
+
+void PassiveDNS::compactNames() {
+    // 先取出仍被引用的名字：有映射的域名和 CNAME 目标
+    std::vector<uint32_t> ids;
+    std::vector<std::string> texts;
+    FlatHashMap<uint32_t, uint32_t> remap(name_index.size() + cname_index.size());
+    auto keep = [&](uint32_t id, uint32_t) {
+        if (remap.insert(id, static_cast<uint32_t>(ids.size())).second) {
+            ids.push_back(id);
+            texts.push_back(names.name(id));
+        }
+    };
+    name_index.forEach(keep);
+    cname_index.forEach(keep);
+
+    names.clear();
+    if (texts.size() * 2 > names.maxNames()) {
+        clearMappings();
+        return;
+    }
+    for (size_t i = 0; i < ids.size(); ++i) {
+        *remap.find(ids[i]) = names.intern(texts[i]);
+    }
+
+    // 链表结构不变，只改写 ID 并按新 ID 重建两个索引
+    for (size_t i = 0; i < entries.size(); ++i) {
+        Entry& e = entries[i];
+        if (!e.live) {
+            continue;
+        }
+        e.name = *remap.find(e.name);
+        if (e.kind == KIND_CNAME) {
+            e.addr = *remap.find(e.addr);
+        }
+    }
+    FlatHashMap<uint32_t, uint32_t> names_by_id(name_index.size());
+    name_index.forEach([&](uint32_t id, uint32_t head) { names_by_id.insert(*remap.find(id), head); });
+    FlatHashMap<uint32_t, uint32_t> cnames_by_id(cname_index.size());
+    cname_index.forEach([&](uint32_t id, uint32_t head) { cnames_by_id.insert(*remap.find(id), head); });
+    std::swap(name_index, names_by_id);
+    std::swap(cname_index, cnames_by_id);
+}
+
+std::vector<std::string> PassiveDNS::namesForIPv4(uint32_t addr) const {
+    std::vector<std::string> result;
+    const uint32_t* head = ipv4_index.find(addr);
+    for (uint32_t i = head ? *head : kInvalidId; i != kInvalidId; i = entries[i].next_addr) {
+        result.push_back(names.name(entries[i].name));
+    }
+    return result;
+}
+
+std::vector<std::string> PassiveDNS::namesForIPv6(const uint8_t* addr) const {
+    std::vector<std::string> result;
+    IPv6Address key;
+    std::memcpy(key.data(), addr, key.size());
+    const uint32_t* slot = ipv6_index.find(key);
+    if (!slot) {
+        return result;
+    }
+    for (uint32_t i = ipv6_pool[*slot].head; i != kInvalidId; i = entries[i].next_addr) {
+        result.push_back(names.name(entries[i].name));
+    }
+    return result;
+}
+
+PassiveDNS::Resolution PassiveDNS::resolve(const std::string& name) const {
+    Resolution result;
+    uint32_t id = names.find(name);
+    if (id == kInvalidId) {
+        return result;
+    }
+    const uint32_t* head = name_index.find(id);
+    for (uint32_t i = head ? *head : kInvalidId; i != kInvalidId; i = entries[i].next_name) {
+        const Entry& e = entries[i];
+        switch (e.kind) {
+            case KIND_A: result.ipv4.push_back(e.addr); break;
+            case KIND_AAAA: result.ipv6.push_back(ipv6_pool[e.addr].addr); break;
+            case KIND_CNAME: result.cnames.push_back(names.name(e.addr)); break;
+        }
+    }
+    return result;
+}
+
+size_t PassiveDNS::size() const noexcept {
+    return live_count;
+}
+
+size_t PassiveDNS::nameCount() const noexcept {
+    return name_index.size();
+}
+
+uint64_t PassiveDNS::dropped() const noexcept {
+    return dropped_count;
+}
+
+uint32_t PassiveDNS::internName(const Message& message, const DNSResourceRecord& rr) {
+    if (rr.name_id == kInvalidNameId) {
+        return names.intern(message.nameData(rr), rr.name_length);
+    }
+    // 解析时驻留到本存储的驻留表时直接复用 ID，驻留到其他表时按文本重新驻留
+    if (message.names == &names) {
+        return rr.name_id;
+    }
+    size_t len = 0;
+    const char* text = message.names ? message.names->data(rr.name_id, &len) : nullptr;
+    return text ? names.intern(text, len) : kInvalidId;
+}
+
+uint32_t PassiveDNS::translateName(const PassiveDNS& shard, uint32_t id) {
+    if (&shard.names == &names) {
+        return id;
+    }
+    size_t len = 0;
+    const char* text = shard.names.data(id, &len);
+    return text ? names.intern(text, len) : kInvalidId;
+}
+
+void PassiveDNS::clearMappings() {
+    entries.clear();
+    free_entry = kInvalidId;
+    live_count = 0;
+    ipv4_index.clear();
+    ipv6_index.clear();
+    cname_index.clear();
+    name_index.clear();
+    ipv6_pool.clear();
+    ipv6_free.clear();
+    // 旧的定时器指向已清空的映射，整个时间轮从当前刻度重新开始
+    timers = TimerWheel(timers.now());
+}
+
+void PassiveDNS::record(Kind kind, uint32_t name, uint32_t addr, const uint8_t* addr6, uint32_t ttl, uint32_t now,
+                        bool keep_later) {
+    uint32_t expire_at = now + std::max<uint32_t>(ttl, 1);
+
+    // 已有相同映射时只刷新过期时间
+    IPv6Address key;
+    const uint32_t* head = nullptr;
+    if (kind == KIND_AAAA) {
+        std::memcpy(key.data(), addr6, key.size());
+        const uint32_t* slot = ipv6_index.find(key);
+        if (slot) {
+            addr = *slot;
+            head = &ipv6_pool[addr].head;
+        }
+    } else {
+        head = addressHead(kind, addr);
+    }
+    for (uint32_t i = head ? *head : kInvalidId; i != kInvalidId; i = entries[i].next_addr) {
+        if (entries[i].name == name) {
+            if (!keep_later || entries[i].expire < expire_at) {
+                entries[i].expire = expire_at;
+            }
+            return;
+        }
+    }
+
+    if (live_count >= max_mappings) {
+        ++dropped_count;
+        return;
+    }
+
+    // 新建地址键
+    if (!head) {
+        if (kind == KIND_A) {
+            ipv4_index.insert(addr, kInvalidId);
+        } else if (kind == KIND_CNAME) {
+            cname_index.insert(addr, kInvalidId);
+        } else {
+            IPv6Slot slot;
+            slot.addr = key;
+            slot.head = kInvalidId;
+            if (ipv6_free.empty()) {
+                addr = static_cast<uint32_t>(ipv6_pool.size());
+                ipv6_pool.push_back(slot);
+            } else {
+                addr = ipv6_free.back();
+                ipv6_free.pop_back();
+                ipv6_pool[addr] = slot;
+            }
+            ipv6_index.insert(key, addr);
+        }
+    }
+
+    // 分配映射
+    uint32_t index;
+    if (free_entry != kInvalidId) {
+        index = free_entry;
+        free_entry = entries[index].next_addr;
+    } else {
+        index = static_cast<uint32_t>(entries.size());
+        entries.push_back(Entry());
+    }
+
+    Entry& e = entries[index];
+    e.name = name;
+    e.addr = addr;
+    e.expire = expire_at;
+    e.kind = kind;
+    e.live = 1;
+
+    uint32_t* addr_head = addressHead(kind, addr);
+    e.next_addr = *addr_head;
+    *addr_head = index;
+
+    uint32_t* name_head = name_index.insert(name, kInvalidId).first;
+    e.next_name = *name_head;
+    *name_head = index;
+
+    ++live_count;
+    schedule(index);
+}
+
+uint32_t* PassiveDNS::addressHead(Kind kind, uint32_t addr) {
+    switch (kind) {
+        case KIND_A: return ipv4_index.find(addr);
+        case KIND_AAAA: return &ipv6_pool[addr].head;
+        case KIND_CNAME: return cname_index.find(addr);
+    }
+    return nullptr;
+}
+
+void PassiveDNS::removeEntry(uint32_t index) {
+    Entry& e = entries[index];
+
+    // 从地址链表摘除
+    uint32_t* link = addressHead(static_cast<Kind>(e.kind), e.addr);
+    while (*link != index) {
+        link = &entries[*link].next_addr;
+    }
+    *link = e.next_addr;
+    if (*addressHead(static_cast<Kind>(e.kind), e.addr) == kInvalidId) {
+        if (e.kind == KIND_A) {
+            ipv4_index.erase(e.addr);
+        } else if (e.kind == KIND_CNAME) {
+            cname_index.erase(e.addr);
+        } else {
+            ipv6_index.erase(ipv6_pool[e.addr].addr);
+            ipv6_free.push_back(e.addr);
+        }
+    }
+
+    // 从域名链表摘除
+    link = name_index.find(e.name);
+    while (*link != index) {
+        link = &entries[*link].next_name;
+    }
+    *link = e.next_name;
+    if (*name_index.find(e.name) == kInvalidId) {
+        name_index.erase(e.name);
+    }
+
+    e.live = 0;
+    e.next_addr = free_entry;
+    free_entry = index;
+    --live_count;
+}
+
+void PassiveDNS::schedule(uint32_t index) {
+    timers.schedule(entries[index].expire, index);
+}
+
+} // namespace dns_parser
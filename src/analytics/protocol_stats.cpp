@@ -0,0 +1,181 @@
+#include "../../include/analytics/protocol_stats.h"
+#include <cstring>
+#include <thread>
+
+namespace dns_parser {
+
+const size_t ProtocolStats::kQtypeSlots;
+const size_t ProtocolStats::kRcodes;
+const size_t ProtocolStats::kOpcodes;
+const size_t ProtocolStats::kSections;
+const size_t ProtocolStats::kSectionBuckets;
+const size_t ProtocolStats::kSizeBuckets;
+const size_t ProtocolStats::kParseErrors;
+const size_t ProtocolStats::kRejectReasons;
+
+static_assert(NAME_UPPERCASE == 1 << ProtocolStats::NAMES_UPPERCASE && NAME_NON_LDH == 1 << ProtocolStats::NAMES_NON_LDH &&
+              NAME_IDN == 1 << ProtocolStats::NAMES_IDN && NAME_BAD_LENGTH == 1 << ProtocolStats::NAMES_BAD_LENGTH,
+              "域名检查计数项与 NameFlag 的位不一致");
+static_assert(sizeof(ProtocolStats::Fields<std::atomic<uint64_t> >) == sizeof(ProtocolStats::Counters),
+              "原子计数与快照的布局不一致");
+
+namespace {
+
+// 各标志位在头部标志字段中的掩码，顺序与 ProtocolStats::Flag 一致
+const uint16_t kFlagMasks[ProtocolStats::FLAG_COUNT] = {
+    0x0400,     // AA
+    0x0200,     // TC
+    0x0100,     // RD
+    0x0080,     // RA
+    0x0020,     // AD
+    0x0010      // CD
+};
+
+const size_t kSizeLimits[ProtocolStats::kSizeBuckets - 1] = { 64, 128, 256, 512, 1232, 1500, 4096 };
+
+inline uint16_t readU16(const uint8_t* p) {
+    return static_cast<uint16_t>((p[0] << 8) | p[1]);
+}
+
+// 跳过线格式的问题域名，返回类型字段的偏移；域名截断时返回 0
+size_t questionTypeOffset(const uint8_t* data, size_t length) {
+    size_t offset = 12;
+    while (offset < length) {
+        uint8_t len = data[offset];
+        if (len == 0) {
+            return offset + 3 <= length ? offset + 1 : 0;
+        }
+        if ((len & 0xC0) == 0xC0) {
+            return offset + 4 <= length ? offset + 2 : 0;
+        }
+        offset += 1 + len;
+    }
+    return 0;
+}
+
+} // namespace
+
+ProtocolStats::Counters::Counters() {
+    std::memset(this, 0, sizeof(*this));
+}
+
+void ProtocolStats::Counters::merge(const Counters& other) {
+    // 所有字段都是 uint64_t，按数组逐项累加
+    static_assert(sizeof(Counters) % sizeof(uint64_t) == 0, "Counters 只能包含 uint64_t 字段");
+    uint64_t* into = reinterpret_cast<uint64_t*>(this);
+    const uint64_t* from = reinterpret_cast<const uint64_t*>(&other);
+    for (size_t i = 0; i < sizeof(Counters) / sizeof(uint64_t); ++i) {
+        into[i] += from[i];
+    }
+}
+
+uint64_t ProtocolStats::Counters::parseFailures() const {
+    uint64_t total = 0;
+    for (size_t i = 0; i < kParseErrors; ++i) {
+        total += parse_failures[i];
+    }
+    return total;
+}
+
+ProtocolStats::ProtocolStats() : sequence(0) {
+    // 原子计数与快照布局相同，按数组逐项清零
+    std::atomic<uint64_t>* cells = reinterpret_cast<std::atomic<uint64_t>*>(&counters);
+    for (size_t i = 0; i < sizeof(Counters) / sizeof(uint64_t); ++i) {
+        cells[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+void ProtocolStats::recordMessage(const uint8_t* data, size_t length) {
+    beginWrite();
+    bump(counters.messages);
+    bump(counters.sizes[sizeBucket(length)]);
+    if (length < 12) {
+        bump(counters.short_messages);
+        endWrite();
+        return;
+    }
+
+    uint16_t flags = readU16(data + 2);
+    bool response = (flags & 0x8000) != 0;
+    bump(response ? counters.responses : counters.queries);
+    bump(counters.opcodes[(flags >> 11) & 0x0F]);
+    if (response) {
+        bump(counters.rcodes[flags & 0x0F]);
+    }
+    for (size_t i = 0; i < FLAG_COUNT; ++i) {
+        if (flags & kFlagMasks[i]) {
+            bump(counters.flags[i]);
+        }
+    }
+    for (size_t i = 0; i < kSections; ++i) {
+        bump(counters.sections[i][sectionBucket(readU16(data + 4 + 2 * i))]);
+    }
+    if (readU16(data + 4) != 0) {
+        size_t offset = questionTypeOffset(data, length);
+        if (offset) {
+            uint16_t qtype = readU16(data + offset);
+            bump(counters.qtypes[qtype < kQtypeSlots - 1 ? qtype : kQtypeSlots - 1]);
+        }
+    }
+    endWrite();
+}
+
+void ProtocolStats::recordEdns(const RData& opt) {
+    beginWrite();
+    bump(counters.edns[EDNS_PRESENT]);
+    if (opt.kind != RDataKind::OPT) {
+        bump(counters.edns[EDNS_MALFORMED]);
+    } else {
+        if (opt.opt.flags & OPTData::kDnssecOk) {
+            bump(counters.edns[EDNS_DO]);
+        }
+        if (opt.opt.cookie.length) {
+            bump(counters.edns[EDNS_COOKIE]);
+        }
+        if (opt.opt.ecs_family) {
+            bump(counters.edns[EDNS_SUBNET]);
+        }
+    }
+    endWrite();
+}
+
+void ProtocolStats::snapshot(Counters& out) const {
+    for (;;) {
+        uint32_t before = sequence.load(std::memory_order_acquire);
+        if (before & 1) {
+            std::this_thread::yield();
+            continue;
+        }
+        const std::atomic<uint64_t>* cells = reinterpret_cast<const std::atomic<uint64_t>*>(&counters);
+        uint64_t* into = reinterpret_cast<uint64_t*>(&out);
+        for (size_t i = 0; i < sizeof(Counters) / sizeof(uint64_t); ++i) {
+            into[i] = cells[i].load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (sequence.load(std::memory_order_relaxed) == before) {
+            return;
+        }
+    }
+}
+
+size_t ProtocolStats::sectionBucket(uint16_t count) noexcept {
+    if (count <= 2) {
+        return count;
+    }
+    if (count > 16) {
+        return kSectionBuckets - 1;
+    }
+    // 3-4、5-8、9-16
+    return 1 + (32 - static_cast<size_t>(__builtin_clz(static_cast<unsigned>(count - 1))));
+}
+
+size_t ProtocolStats::sizeBucket(size_t length) noexcept {
+    for (size_t i = 0; i < kSizeBuckets - 1; ++i) {
+        if (length <= kSizeLimits[i]) {
+            return i;
+        }
+    }
+    return kSizeBuckets - 1;
+}
+
+} // namespace dns_parser
@@ -0,0 +1,125 @@
+#include "../../include/analytics/subnet_counters.h"
+#include "../../include/tools/hash.h"
+#include <algorithm>
+#include <cstring>
+
+namespace dns_parser {
+
+namespace {
+
+inline void bump(std::atomic<uint64_t>& counter) {
+    counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+inline bool sameSubnet(const SubnetCounters::Subnet& a, const SubnetCounters::Subnet& b) {
+    return std::memcmp(&a, &b, sizeof(SubnetCounters::Subnet)) == 0;
+}
+
+// 合并排序用：按地址族、前缀和地址排序，使相同子网相邻
+inline bool subnetLess(const SubnetCounters::Entry& a, const SubnetCounters::Entry& b) {
+    return std::memcmp(&a.subnet, &b.subnet, sizeof(SubnetCounters::Subnet)) < 0;
+}
+
+} // namespace
+
+SubnetCounters::SubnetCounters(size_t max_subnets, uint8_t ipv4_prefix, uint8_t ipv6_prefix)
+    : max_subnets(max_subnets), mask(0), ipv4_prefix(std::min<uint8_t>(ipv4_prefix, 32)),
+      ipv6_prefix(std::min<uint8_t>(ipv6_prefix, 128)), slots(nullptr), live(0), overflow_count(0) {
+    // 负载不超过一半，探测链保持很短
+    size_t capacity = 16;
+    while (capacity < max_subnets * 2) {
+        capacity <<= 1;
+    }
+    mask = capacity - 1;
+}
+
+void SubnetCounters::setAggregation(uint8_t ipv4, uint8_t ipv6) {
+    ipv4_prefix = std::min<uint8_t>(ipv4, 32);
+    ipv6_prefix = std::min<uint8_t>(ipv6, 128);
+}
+
+bool SubnetCounters::record(const OPTData& opt, bool query) {
+    if (opt.ecs_family != 1 && opt.ecs_family != 2) {
+        return false;
+    }
+
+    Subnet key;
+    std::memset(&key, 0, sizeof(key));
+    key.family = opt.ecs_family == 1 ? 4 : 6;
+    key.prefix = std::min(opt.ecs_source, opt.ecs_family == 1 ? ipv4_prefix : ipv6_prefix);
+    size_t bytes = key.prefix / 8;
+    std::memcpy(key.address, opt.ecs_address, bytes);
+    if (key.prefix % 8) {
+        key.address[bytes] = static_cast<uint8_t>(opt.ecs_address[bytes] & (0xFF00u >> (key.prefix % 8)));
+    }
+
+    if (!storage) {
+        if (max_subnets == 0) {
+            bump(overflow_count);
+            return false;
+        }
+        storage.reset(new Slot[mask + 1]);
+        slots.store(storage.get(), std::memory_order_release);
+    }
+
+    Slot* table = storage.get();
+    size_t i = static_cast<size_t>(hashBytes(&key, sizeof(key))) & mask;
+    while (table[i].used.load(std::memory_order_relaxed)) {
+        if (sameSubnet(table[i].subnet, key)) {
+            bump(query ? table[i].queries : table[i].responses);
+            return true;
+        }
+        i = (i + 1) & mask;
+    }
+
+    if (live.load(std::memory_order_relaxed) >= max_subnets) {
+        bump(overflow_count);
+        return false;
+    }
+    table[i].subnet = key;
+    bump(query ? table[i].queries : table[i].responses);
+    // 键和计数写好之后再发布占用标记
+    table[i].used.store(true, std::memory_order_release);
+    live.store(live.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    return true;
+}
+
+void SubnetCounters::snapshot(std::vector<Entry>& out) const {
+    const Slot* table = slots.load(std::memory_order_acquire);
+    if (!table) {
+        return;
+    }
+    for (size_t i = 0; i <= mask; ++i) {
+        if (!table[i].used.load(std::memory_order_acquire)) {
+            continue;
+        }
+        Entry entry;
+        entry.subnet = table[i].subnet;
+        entry.queries = table[i].queries.load(std::memory_order_relaxed);
+        entry.responses = table[i].responses.load(std::memory_order_relaxed);
+        out.push_back(entry);
+    }
+}
+
+void SubnetCounters::top(std::vector<Entry>& entries, size_t n) {
+    std::sort(entries.begin(), entries.end(), subnetLess);
+    size_t merged = 0;
+    for (size_t i = 0; i < entries.size(); ++i) {
+        if (merged && sameSubnet(entries[merged - 1].subnet, entries[i].subnet)) {
+            entries[merged - 1].queries += entries[i].queries;
+            entries[merged - 1].responses += entries[i].responses;
+        } else {
+            entries[merged++] = entries[i];
+        }
+    }
+    entries.resize(merged);
+
+    size_t keep = std::min(n, entries.size());
+    std::partial_sort(entries.begin(), entries.begin() + keep, entries.end(),
+        [](const Entry& a, const Entry& b) {
+            return a.queries + a.responses > b.queries + b.responses;
+        });
+    entries.resize(keep);
+}
+
+} // namespace dns_parser
@@ -0,0 +1,213 @@
+#include "../../include/config/config_store.h"
+#include "../../include/tools/aligned.h"
+#include "../../include/tools/hash.h"
+#include <chrono>
+#include <sys/stat.h>
+
+namespace dns_parser {
+
+const unsigned short ConfigStore::kMaxReaders;
+const uint64_t ConfigStore::kOffline;
+
+// ------------------------------ ConfigStore ------------------------------
+
+ConfigStore::ConfigStore()
+    : current(new RuntimeConfig()), epoch(1), slots(alignedNewArray<Slot>(kMaxReaders)) {
+}
+
+ConfigStore::~ConfigStore() {
+    for (size_t i = 0; i < retired.size(); ++i) {
+        delete retired[i].config;
+    }
+    delete current.load();
+    alignedDeleteArray(slots, kMaxReaders);
+}
+
+const RuntimeConfig* ConfigStore::acquire(unsigned short reader) {
+    if (reader >= kMaxReaders) {
+        return nullptr;
+    }
+    std::atomic<uint64_t>& slot = slots[reader].epoch;
+    if (slot.load(std::memory_order_relaxed) == kOffline) {
+        // 上线必须先于读取指针对写者可见，否则写者可能释放本线程即将读到的快照
+        slot.store(epoch.load(std::memory_order_seq_cst), std::memory_order_seq_cst);
+        return current.load(std::memory_order_seq_cst);
+    }
+    return current.load(std::memory_order_acquire);
+}
+
+void ConfigStore::quiescent(unsigned short reader) {
+    if (reader >= kMaxReaders) {
+        return;
+    }
+    // acquire 读纪元保证之后的 acquire() 能看到该纪元对应的新指针
+    slots[reader].epoch.store(epoch.load(std::memory_order_acquire), std::memory_order_release);
+}
+
+void ConfigStore::offline(unsigned short reader) {
+    if (reader >= kMaxReaders) {
+        return;
+    }
+    slots[reader].epoch.store(kOffline, std::memory_order_release);
+}
+
+void ConfigStore::publish(RuntimeConfig* next) {
+    std::lock_guard<std::mutex> lock(write_mutex);
+    next->version = epoch.load(std::memory_order_relaxed);
+    const RuntimeConfig* old = current.exchange(next, std::memory_order_seq_cst);
+    uint64_t now = epoch.fetch_add(1, std::memory_order_seq_cst) + 1;
+    Retired entry;
+    entry.config = const_cast<RuntimeConfig*>(old);
+    entry.epoch = now;
+    retired.push_back(entry);
+    reclaimLocked();
+}
+
+size_t ConfigStore::reclaim() {
+    std::lock_guard<std::mutex> lock(write_mutex);
+    return reclaimLocked();
+}
+
+size_t ConfigStore::reclaimLocked() {
+    if (retired.empty()) {
+        return 0;
+    }
+
+    // 所有在线读者中最旧的静止纪元
+    uint64_t oldest = kOffline;
+    for (unsigned short i = 0; i < kMaxReaders; ++i) {
+        uint64_t seen = slots[i].epoch.load(std::memory_order_seq_cst);
+        if (seen < oldest) {
+            oldest = seen;
+        }
+    }
+
+    size_t kept = 0;
+    for (size_t i = 0; i < retired.size(); ++i) {
+        if (retired[i].epoch <= oldest) {
+            delete retired[i].config;
+        } else {
+            retired[kept++] = retired[i];
+        }
+    }
+    retired.resize(kept);
+    return kept;
+}
+
+RuntimeConfig ConfigStore::snapshot() const {
+    // 当前快照只会在 publish 中被替换，持有写者锁时不会被释放
+    std::lock_guard<std::mutex> lock(write_mutex);
+    return *current.load(std::memory_order_acquire);
+}
+
+uint64_t ConfigStore::version() const noexcept {
+    return epoch.load(std::memory_order_relaxed) - 1;
+}
+
+// ------------------------------ ConfigWatcher ------------------------------
+
+ConfigWatcher::ConfigWatcher(ConfigStore& store, const std::string& path)
+    : store(store), path(path), running(false), loaded(false),
+      last_stamp(0), reload_count(0) {
+}
+
+ConfigWatcher::~ConfigWatcher() {
+    stop();
+}
+
+bool ConfigWatcher::start() {
+    bool ok = poll();
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!running) {
+        running = true;
+        worker = std::thread(&ConfigWatcher::run, this);
+    }
+    return ok;
+}
+
+void ConfigWatcher::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!running) {
+            return;
+        }
+        running = false;
+    }
+    wake.notify_all();
+    worker.join();
+}
+
+namespace {
+
+// 文件的修改时间和大小指纹，文件不存在时返回 false
+bool fileStamp(const std::string& path, uint64_t& stamp) {
+    struct stat info;
+    if (stat(path.c_str(), &info) != 0) {
+        return false;
+    }
+    uint64_t mtime_ns = static_cast<uint64_t>(info.st_mtim.tv_sec) * 1000000000ULL + info.st_mtim.tv_nsec;
+    stamp = mix64(mtime_ns ^ mix64(static_cast<uint64_t>(info.st_size)));
+    return true;
+}
+
+// 快照引用的外部文件的指纹，文件缺失也算一种状态（出现时触发重新加载）
+uint64_t referencedStamp(const RuntimeConfig& config) {
+    const std::string* paths[] = {&config.policy_path, &config.allowlist_path, &config.blocklist_path,
+                                  &config.public_suffix_path};
+    uint64_t stamp = 0;
+    for (size_t i = 0; i < sizeof(paths) / sizeof(paths[0]); ++i) {
+        uint64_t file = 0;
+        if (!paths[i]->empty()) {
+            fileStamp(*paths[i], file);
+        }
+        stamp = mix64(stamp ^ file) + i;
+    }
+    return stamp;
+}
+
+} // namespace
+
+bool ConfigWatcher::poll() {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    uint64_t config_stamp;
+    if (!fileStamp(path, config_stamp)) {
+        return false;
+    }
+    if (loaded && mix64(config_stamp ^ referencedStamp(store.snapshot())) == last_stamp) {
+        // 没有新快照可发布，顺便回收已被所有读者越过的旧快照
+        store.reclaim();
+        return false;
+    }
+
+    RuntimeConfig* next = new RuntimeConfig();
+    if (!RuntimeConfig::loadFromFile(path, *next)) {
+        delete next;
+        return false;
+    }
+    loaded = true;
+    last_stamp = mix64(config_stamp ^ referencedStamp(*next));
+    store.publish(next);
+    reload_count.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+uint64_t ConfigWatcher::reloads() const noexcept {
+    return reload_count.load(std::memory_order_relaxed);
+}
+
+void ConfigWatcher::run() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (running) {
+        uint32_t interval = store.snapshot().reload_interval_ms;
+        wake.wait_for(lock, std::chrono::milliseconds(interval));
+        if (!running) {
+            break;
+        }
+        lock.unlock();
+        poll();
+        lock.lock();
+    }
+}
+
+} // namespace dns_parser
@@ -0,0 +1,119 @@
+#include "../../include/config/runtime_config.h"
+#include <arpa/inet.h>
+#include <algorithm>
+#include <cctype>
+
+namespace dns_parser {
+
+namespace {
+
+// 非负整数配置项，负数视为无效
+template <typename T>
+T readUnsigned(const ConfigParser& parser, const std::string& key, T fallback) {
+    int64_t value = parser.getInt64(key, static_cast<int64_t>(fallback));
+    return value < 0 ? fallback : static_cast<T>(value);
+}
+
+} // namespace
+
+RuntimeConfig::RuntimeConfig()
+    : c2s_buffer_size(10485760), s2c_buffer_size(10485760),
+      memory_budget(268435456), huge_pages(false),
+      flow_timeout_ms(120000), max_flows(1000), query_timeout_ms(5000), max_pending_queries(65536),
+      enable_threading(true), thread_count(4),
+      log_level(LogLevel::Info), log_file("log/dns.log"),
+      max_subnets(4096), subnet_ipv4_prefix(24), subnet_ipv6_prefix(56), skip_dnssec(true),
+      normalize_names(true), max_names(65536), stage_timing(false),
+      reload_interval_ms(1000), version(0) {
+    // 默认黑洞地址为 0.0.0.0 和 ::
+    sinkhole.has_ipv4 = true;
+    sinkhole.has_ipv6 = true;
+}
+
+RuntimeConfig RuntimeConfig::fromParser(const ConfigParser& parser) {
+    RuntimeConfig config;
+    config.c2s_buffer_size = readUnsigned<size_t>(parser, "Buffer.c2s_buffer_size", config.c2s_buffer_size);
+    config.s2c_buffer_size = readUnsigned<size_t>(parser, "Buffer.s2c_buffer_size", config.s2c_buffer_size);
+    config.memory_budget = readUnsigned<size_t>(parser, "Buffer.memory_budget", config.memory_budget);
+    config.huge_pages = parser.getBool("Buffer.huge_pages", config.huge_pages);
+    config.flow_timeout_ms = readUnsigned<uint32_t>(parser, "Flow.flow_timeout", config.flow_timeout_ms);
+    config.max_flows = readUnsigned<size_t>(parser, "Flow.max_flows", config.max_flows);
+    config.query_timeout_ms = readUnsigned<uint32_t>(parser, "Flow.query_timeout", config.query_timeout_ms);
+    config.max_pending_queries = readUnsigned<size_t>(parser, "Flow.max_pending_queries", config.max_pending_queries);
+    config.enable_threading = parser.getBool("Performance.enable_threading", config.enable_threading);
+    config.thread_count = readUnsigned<unsigned short>(parser, "Performance.thread_count", config.thread_count);
+    config.log_level = parseLogLevel(parser.getString("Logging.log_level"), config.log_level);
+    config.log_file = parser.getString("Logging.log_file", config.log_file);
+    config.blocklist_path = parser.getString("Lists.blocklist", config.blocklist_path);
+    config.allowlist_path = parser.getString("Lists.allowlist", config.allowlist_path);
+    config.public_suffix_path = parser.getString("Lists.public_suffix", config.public_suffix_path);
+    config.policy_path = parser.getString("Policy.rules", config.policy_path);
+    config.sinkhole.ttl = readUnsigned<uint32_t>(parser, "Policy.synthetic_ttl", config.sinkhole.ttl);
+    std::string ipv4 = parser.getString("Policy.sinkhole_ipv4", "0.0.0.0");
+    std::string ipv6 = parser.getString("Policy.sinkhole_ipv6", "::");
+    config.sinkhole.has_ipv4 = !ipv4.empty() && inet_pton(AF_INET, ipv4.c_str(), config.sinkhole.ipv4) == 1;
+    config.sinkhole.has_ipv6 = !ipv6.empty() && inet_pton(AF_INET6, ipv6.c_str(), config.sinkhole.ipv6) == 1;
+    config.shedding.enabled = parser.getBool("Shedding.enabled", config.shedding.enabled);
+    config.shedding.latency_high_ns =
+        readUnsigned<uint32_t>(parser, "Shedding.latency_high", config.shedding.latency_high_ns / 1000) * 1000;
+    config.shedding.latency_low_ns =
+        readUnsigned<uint32_t>(parser, "Shedding.latency_low", config.shedding.latency_low_ns / 1000) * 1000;
+    config.shedding.pressure_high = static_cast<uint8_t>(
+        std::min<uint32_t>(100, readUnsigned<uint32_t>(parser, "Shedding.pressure_high", config.shedding.pressure_high)));
+    config.shedding.pressure_low = static_cast<uint8_t>(
+        std::min<uint32_t>(100, readUnsigned<uint32_t>(parser, "Shedding.pressure_low", config.shedding.pressure_low)));
+    config.shedding.sample_rate = readUnsigned<uint32_t>(parser, "Shedding.sample_rate", config.shedding.sample_rate);
+    if (config.shedding.sample_rate == 0) {
+        config.shedding.sample_rate = 1;
+    }
+    config.shedding.hold_ms = readUnsigned<uint32_t>(parser, "Shedding.hold_time", config.shedding.hold_ms);
+    config.max_subnets = readUnsigned<size_t>(parser, "EDNS.max_subnets", config.max_subnets);
+    config.subnet_ipv4_prefix = static_cast<uint8_t>(
+        std::min<uint32_t>(32, readUnsigned<uint32_t>(parser, "EDNS.subnet_ipv4_prefix", config.subnet_ipv4_prefix)));
+    config.subnet_ipv6_prefix = static_cast<uint8_t>(
+        std::min<uint32_t>(128, readUnsigned<uint32_t>(parser, "EDNS.subnet_ipv6_prefix", config.subnet_ipv6_prefix)));
+    config.skip_dnssec = parser.getBool("DNSSEC.skip_records", config.skip_dnssec);
+    config.normalize_names = parser.getBool("Names.normalize", config.normalize_names);
+    config.max_names = readUnsigned<size_t>(parser, "Names.max_names", config.max_names);
+    if (config.max_names == 0) {
+        config.max_names = RuntimeConfig().max_names;
+    }
+    config.stage_timing = parser.getBool("Diagnostics.stage_timing", config.stage_timing);
+    config.reload_interval_ms = readUnsigned<uint32_t>(parser, "Reload.interval", config.reload_interval_ms);
+    if (config.reload_interval_ms == 0) {
+        config.reload_interval_ms = RuntimeConfig().reload_interval_ms;
+    }
+    return config;
+}
+
+bool RuntimeConfig::loadFromFile(const std::string& filename, RuntimeConfig& out) {
+    ConfigParser parser;
+    if (!parser.loadFromFile(filename)) {
+        return false;
+    }
+    out = fromParser(parser);
+    out.policy = PolicyEngine::load(out.policy_path, out.allowlist_path, out.blocklist_path);
+    out.public_suffixes = PublicSuffixList::load(out.public_suffix_path);
+    return true;
+}
+
+LogLevel RuntimeConfig::parseLogLevel(const std::string& name, LogLevel fallback) {
+    std::string lower(name);
+    std::transform(lower.begin(), lower.end(), lower.begin(),
+        [](unsigned char c) { return std::tolower(c); });
+    if (lower == "debug") {
+        return LogLevel::Debug;
+    }
+    if (lower == "info") {
+        return LogLevel::Info;
+    }
+    if (lower == "warning" || lower == "warn") {
+        return LogLevel::Warning;
+    }
+    if (lower == "error") {
+        return LogLevel::Error;
+    }
+    return fallback;
+}
+
+} // namespace dns_parser
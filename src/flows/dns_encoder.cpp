@@ -0,0 +1,147 @@
+#include "../../include/flows/dns_encoder.h"
+#include <cstring>
+
+namespace dns_parser {
+
+const size_t DNSEncoder::kMaxResponseSize;
+
+namespace {
+
+const uint16_t kTypeA = 1;
+const uint16_t kTypeAAAA = 28;
+const uint16_t kTypeANY = 255;
+const uint16_t kClassIN = 1;
+
+// 写入位置顺序推进的小工具，调用方预先保证容量足够
+struct Writer {
+    uint8_t* p;
+
+    void u16(uint16_t value) {
+        p[0] = static_cast<uint8_t>(value >> 8);
+        p[1] = static_cast<uint8_t>(value);
+        p += 2;
+    }
+
+    void u32(uint32_t value) {
+        u16(static_cast<uint16_t>(value >> 16));
+        u16(static_cast<uint16_t>(value));
+    }
+
+    // 所有者名为指向问题区域名的压缩指针
+    void record(uint16_t type, uint32_t ttl, const uint8_t* rdata, uint16_t rdlength) {
+        u16(0xC000 | 12);
+        u16(type);
+        u16(kClassIN);
+        u32(ttl);
+        u16(rdlength);
+        std::memcpy(p, rdata, rdlength);
+        p += rdlength;
+    }
+};
+
+bool wantsA(uint16_t qtype, const SyntheticResponse& response) {
+    return response.kind == SyntheticKind::Sinkhole && response.has_ipv4 && (qtype == kTypeA || qtype == kTypeANY);
+}
+
+bool wantsAAAA(uint16_t qtype, const SyntheticResponse& response) {
+    return response.kind == SyntheticKind::Sinkhole && response.has_ipv6 &&
+           (qtype == kTypeAAAA || qtype == kTypeANY);
+}
+
+} // namespace
+
+SyntheticResponse::SyntheticResponse()
+    : kind(SyntheticKind::None), ttl(60), has_ipv4(false), has_ipv6(false) {
+    std::memset(ipv4, 0, sizeof(ipv4));
+    std::memset(ipv6, 0, sizeof(ipv6));
+}
+
+size_t DNSEncoder::questionEnd(const uint8_t* query, size_t length, uint16_t& qtype) {
+    // QR=0、OPCODE=0、QDCOUNT=1
+    if (!query || length < 12 || (query[2] & 0xF8) != 0 || query[4] != 0 || query[5] != 1) {
+        return 0;
+    }
+    size_t offset = 12;
+    while (offset < length && query[offset] != 0) {
+        uint8_t len = query[offset];
+        if ((len & 0xC0) != 0) {
+            return 0;
+        }
+        offset += 1 + len;
+    }
+    // 根标签 + QTYPE + QCLASS，域名总长不超过 255
+    if (offset + 5 > length || offset + 1 - 12 > 255) {
+        return 0;
+    }
+    qtype = static_cast<uint16_t>((query[offset + 1] << 8) | query[offset + 2]);
+    return offset + 5;
+}
+
+size_t DNSEncoder::responseSize(const uint8_t* query, size_t length, const SyntheticResponse& response) {
+    uint16_t qtype = 0;
+    size_t end = questionEnd(query, length, qtype);
+    if (end == 0 || response.kind == SyntheticKind::None) {
+        return 0;
+    }
+    if (wantsA(qtype, response)) {
+        end += 12 + 4;
+    }
+    if (wantsAAAA(qtype, response)) {
+        end += 12 + 16;
+    }
+    return end;
+}
+
+size_t DNSEncoder::encode(const uint8_t* query, size_t length, const SyntheticResponse& response,
+                          uint8_t* out, size_t capacity) {
+    uint16_t qtype = 0;
+    size_t question_end = questionEnd(query, length, qtype);
+    if (question_end == 0 || response.kind == SyntheticKind::None) {
+        return 0;
+    }
+    bool answer_a = wantsA(qtype, response);
+    bool answer_aaaa = wantsAAAA(qtype, response);
+    size_t total = question_end + (answer_a ? 12 + 4 : 0) + (answer_aaaa ? 12 + 16 : 0);
+    if (total > capacity) {
+        return 0;
+    }
+
+    // 先取出需要保留的头部字段，out 与 query 可能是同一块缓冲区
+    uint8_t id_high = query[0];
+    uint8_t id_low = query[1];
+    uint8_t rd = query[2] & 0x01;
+    uint8_t cd = query[3] & 0x10;
+    if (out != query) {
+        std::memmove(out + 12, query + 12, question_end - 12);
+    }
+
+    uint8_t rcode = 0;
+    if (response.kind == SyntheticKind::NXDomain) {
+        rcode = 3;
+    } else if (response.kind == SyntheticKind::Refused) {
+        rcode = 5;
+    }
+    uint16_t answers = static_cast<uint16_t>((answer_a ? 1 : 0) + (answer_aaaa ? 1 : 0));
+
+    Writer writer = { out };
+    writer.p[0] = id_high;
+    writer.p[1] = id_low;
+    writer.p[2] = static_cast<uint8_t>(0x80 | rd);       // QR=1，OPCODE=0，AA=0，TC=0
+    writer.p[3] = static_cast<uint8_t>(0x80 | cd | rcode);   // RA=1
+    writer.p += 4;
+    writer.u16(1);
+    writer.u16(answers);
+    writer.u16(0);
+    writer.u16(0);
+
+    writer.p = out + question_end;
+    if (answer_a) {
+        writer.record(kTypeA, response.ttl, response.ipv4, 4);
+    }
+    if (answer_aaaa) {
+        writer.record(kTypeAAAA, response.ttl, response.ipv6, 16);
+    }
+    return total;
+}
+
+} // namespace dns_parser
@@ -1,91 +1,144 @@
 #include "../../include/flows/dns_parser.h"
+#include "../../include/flows/public_suffix.h"
+#include "../../include/tools/name_check.h"
+#include "../../include/tools/name_interner.h"
+#include "../../include/tools/stage_timer.h"
+#include <cstring>
 #include <iostream>
 #include <iomanip>
 #include <arpa/inet.h>
 
 namespace dns_parser {
 
+const size_t DNSParser::kMaxNameLength;
+
+namespace {
+
+// 压缩指针最大跳转次数，防止指针环路
+const int kMaxPointerJumps = 64;
+
+// EDNS 选项代码
+const uint16_t kOptionClientSubnet = 8;
+const uint16_t kOptionCookie = 10;
+
+// 获取用于显示的域名：按 ID 驻留时从驻留表取回
+template <typename Entry>
+std::string displayName(const Message& message, const Entry& entry) {
+    if (entry.name_length == 0 && entry.name_id != kInvalidNameId && message.names) {
+        return message.names->name(entry.name_id);
+    }
+    return message.name(entry);
+}
+
+// 记录解析失败原因
+inline void fail(const ParseOptions& options, ParseError error) {
+    if (options.error) {
+        *options.error = error;
+    }
+}
+
+} // namespace
+
 bool DNSParser::parseQuery(const std::string& data, Message& message) {
+    return parseQuery(data, message, ParseOptions());
+}
+
+bool DNSParser::parseQuery(const std::string& data, Message& message, const ParseOptions& options) {
     size_t offset = 0;
+    message.clear();
     
     // 解析 DNS 头部
-    if (!parseHeader(data, offset, message.header)) {
+    bool ok = parseHeader(data, offset, message.header);
+    lapStage(options.stages, Stage::Header);
+    if (!ok) {
+        fail(options, ParseError::ShortHeader);
         return false;
     }
 
     // 解析查询问题
-    for (uint16_t i = 0; i < message.header.questions; ++i) {
-        DNSQuestion question;
-        
-        // 解析域名
-        question.domain_name = parseDomainName(data, offset);
-        
-        // 解析查询类型和类
-        if (offset + 4 > data.size()) {
-            return false;
-        }
-        question.type = ntohs(*reinterpret_cast<const uint16_t*>(data.data() + offset));
-        offset += 2;
-        question.class_ = ntohs(*reinterpret_cast<const uint16_t*>(data.data() + offset));
-        offset += 2;
-
-        message.questions.push_back(question);
+    ok = parseQuestions(data, offset, message, options);
+    lapStage(options.stages, Stage::Question);
+    if (!ok || options.questions_only) {
+        return ok;
     }
 
+    // 查询中的记录尽力解析，失败不影响查询本身，也不记录失败原因
+    if (message.header.answer_rrs || message.header.authority_rrs || message.header.additional_rrs) {
+        ParseOptions records_options = options;
+        records_options.error = nullptr;
+        parseSections(data, offset, message, records_options);
+        lapStage(options.stages, Stage::Records);
+    }
     return true;
 }
 
 bool DNSParser::parseResponse(const std::string& data, Message& message) {
+    return parseResponse(data, message, ParseOptions());
+}
+
+bool DNSParser::parseResponse(const std::string& data, Message& message, const ParseOptions& options) {
     size_t offset = 0;
+    message.clear();
     
     // 解析 DNS 头部
-    if (!parseHeader(data, offset, message.header)) {
+    bool ok = parseHeader(data, offset, message.header);
+    lapStage(options.stages, Stage::Header);
+    if (!ok) {
+        fail(options, ParseError::ShortHeader);
         return false;
     }
 
     // 解析查询问题
-    for (uint16_t i = 0; i < message.header.questions; ++i) {
-        DNSQuestion question;
-        question.domain_name = parseDomainName(data, offset);
-        
-        if (offset + 4 > data.size()) {
-            return false;
-        }
-        question.type = ntohs(*reinterpret_cast<const uint16_t*>(data.data() + offset));
-        offset += 2;
-        question.class_ = ntohs(*reinterpret_cast<const uint16_t*>(data.data() + offset));
-        offset += 2;
-
-        message.questions.push_back(question);
+    ok = parseQuestions(data, offset, message, options);
+    lapStage(options.stages, Stage::Question);
+    if (!ok || options.questions_only) {
+        return ok;
     }
 
-    // 解析应答记录
-    for (uint16_t i = 0; i < message.header.answer_rrs; ++i) {
-        DNSResourceRecord rr;
-        if (!parseResourceRecord(data, offset, rr)) {
-            return false;
-        }
-        message.answers.push_back(rr);
+    // 解析应答、权威和附加记录
+    ok = parseSections(data, offset, message, options);
+    lapStage(options.stages, Stage::Records);
+    return ok;
+}
+
+bool DNSParser::parseSections(const std::string& data, size_t& offset, Message& message,
+                              const ParseOptions& options) {
+    // 三个区段的记录依次存放在同一个数组中
+    bool ok = parseRecords(data, offset, message.header.answer_rrs, message, options);
+    message.answer_count = static_cast<uint16_t>(message.records.size());
+    if (ok) {
+        ok = parseRecords(data, offset, message.header.authority_rrs, message, options);
+        message.authority_count = static_cast<uint16_t>(message.records.size() - message.answer_count);
     }
+    if (ok) {
+        ok = parseRecords(data, offset, message.header.additional_rrs, message, options);
+    }
+    return ok;
+}
 
-    // 解析权威记录
-    for (uint16_t i = 0; i < message.header.authority_rrs; ++i) {
-        DNSResourceRecord rr;
-        if (!parseResourceRecord(data, offset, rr)) {
+bool DNSParser::parseQuestions(const std::string& data, size_t& offset, Message& message,
+                               const ParseOptions& options) {
+    for (uint16_t i = 0; i < message.header.questions; ++i) {
+        DNSQuestion question;
+        if (!parseQuestion(data, offset, message, question, options)) {
             return false;
         }
-        message.authorities.push_back(rr);
+        message.questions.push_back(question);
     }
+    return true;
+}
 
-    // 解析附加记录
-    for (uint16_t i = 0; i < message.header.additional_rrs; ++i) {
+bool DNSParser::parseRecords(const std::string& data, size_t& offset, uint16_t count, Message& message,
+                             const ParseOptions& options) {
+    for (uint16_t i = 0; i < count; ++i) {
         DNSResourceRecord rr;
-        if (!parseResourceRecord(data, offset, rr)) {
+        RData value;
+        if (!parseResourceRecord(data, offset, message, rr, value, options)) {
             return false;
         }
-        message.additionals.push_back(rr);
+        message.records.push_back(rr);
+        message.values.push_back(value);
     }
-
     return true;
 }
 
@@ -111,50 +164,189 @@ bool DNSParser::parseHeader(const std::string& data, size_t& offset, DNSHeader&
     return true;
 }
 
-std::string DNSParser::parseDomainName(const std::string& data, size_t& offset) {
-    std::string domain;
-    
-    while (offset < data.size()) {
-        uint8_t len = static_cast<uint8_t>(data[offset++]);
-        
+bool DNSParser::readDomainName(const std::string& data, size_t& offset, char* out, size_t& length,
+                               NameHash* hash) {
+    const uint8_t* ptr = reinterpret_cast<const uint8_t*>(data.data());
+    size_t pos = offset;
+    bool jumped = false;
+    int jumps = 0;
+    length = 0;
+    if (hash) {
+        hash->reset();
+    }
+
+    // 截断的名字沿用原有的宽松处理：保留已解析部分，偏移停在最后读取的字节之后
+    while (pos < data.size()) {
+        uint8_t len = ptr[pos++];
+        if (!jumped) {
+            offset = pos;
+        }
+
         // 检查是否是压缩指针
         if ((len & 0xC0) == 0xC0) {  // 最高两位为 11
-            if (offset >= data.size()) {
-                return domain;
+            if (pos >= data.size()) {
+                break;
+            }
+            if (++jumps > kMaxPointerJumps) {
+                return false;
             }
-            uint16_t pointer = ((len & 0x3F) << 8) | static_cast<uint8_t>(data[offset++]);
-            size_t saved_offset = offset;
-            offset = pointer;
-            domain += parseDomainName(data, offset);
-            offset = saved_offset;
-            return domain;
+            if (!jumped) {
+                offset = pos + 1;
+                jumped = true;
+            }
+            pos = ((len & 0x3F) << 8) | ptr[pos];
+            continue;
         }
-        
-        if (len == 0) {
+
+        if (len == 0 || pos + len > data.size()) {
             break;
         }
-        
-        if (offset + len > data.size()) {
-            return domain;
+        // 01、10 开头的扩展标签类型已废弃，标签长度不超过 63
+        if (len > 63) {
+            return false;
         }
-        
-        if (!domain.empty()) {
-            domain += ".";
+        if (length + (length ? 1 : 0) + len > kMaxNameLength) {
+            return false;
+        }
+
+        if (length) {
+            out[length++] = '.';
+        }
+        if (hash) {
+            // 复制、折叠和哈希在同一遍内完成
+            hash->addLabel(ptr + pos, len, length, reinterpret_cast<uint8_t*>(out + length));
+        } else {
+            std::memcpy(out + length, ptr + pos, len);
+        }
+        length += len;
+        pos += len;
+        if (!jumped) {
+            offset = pos;
         }
-        
-        domain += data.substr(offset, len);
-        offset += len;
     }
-    
-    return domain;
+
+    if (hash) {
+        hash->finish();
+    }
+    return true;
 }
 
-bool DNSParser::parseResourceRecord(const std::string& data, size_t& offset, DNSResourceRecord& rr) {
+std::string DNSParser::decodeDomainName(const std::string& data, size_t offset) {
+    char buffer[kMaxNameLength];
+    size_t length = 0;
+    if (!readDomainName(data, offset, buffer, length)) {
+        return std::string();
+    }
+    return std::string(buffer, length);
+}
+
+std::string DNSParser::decodeDomainName(const std::string& data, size_t offset, NameHash& hash) {
+    char buffer[kMaxNameLength];
+    size_t length = 0;
+    if (!readDomainName(data, offset, buffer, length, &hash)) {
+        hash.reset();
+        return std::string();
+    }
+    return std::string(buffer, length);
+}
+
+bool DNSParser::parseName(const std::string& data, size_t& offset, Message& message, uint32_t& name_id,
+                          uint8_t& name_length, uint8_t& name_flags, const ParseOptions& options,
+                          uint8_t* registrable_offset) {
+    char buffer[kMaxNameLength];
+    size_t length = 0;
+    // 驻留和公共后缀查找用到的哈希在解压缩的同一遍内算出，不再重新哈希
+    bool suffixes = registrable_offset && options.public_suffixes;
+    NameHash hash;
+    if (!readDomainName(data, offset, buffer, length, options.intern_names || suffixes ? &hash : nullptr)) {
+        fail(options, ParseError::BadName);
+        return false;
+    }
+    if (suffixes) {
+        size_t boundary = options.public_suffixes->registrableOffset(hash);
+        *registrable_offset = boundary == PublicSuffixList::npos ? kNoRegistrableOffset
+                                                                 : static_cast<uint8_t>(boundary);
+    }
+
+    // 驻留表本身不区分大小写，转换只影响首次驻留和复制到字节区的文本
+    name_flags = options.normalize_names ? normalizeName(buffer, length) : 0;
+    name_length = 0;
+    if (options.intern_names) {
+        NameInterner& interner = options.interner ? *options.interner : NameInterner::global();
+        // 规范化后的文本已是小写，驻留表不再折叠一遍
+        name_id = interner.intern(buffer, length, hash.full, options.normalize_names);
+        // 驻留表未满时不复制文本
+        if (name_id != kInvalidNameId) {
+            message.names = &interner;
+            return true;
+        }
+    }
+    message.bytes.append(buffer, length);
+    name_length = static_cast<uint8_t>(length);
+    return true;
+}
+
+bool DNSParser::parseQuestion(const std::string& data, size_t& offset, Message& message, DNSQuestion& question,
+                              const ParseOptions& options) {
     // 解析域名
-    rr.name = parseDomainName(data, offset);
+    question.name_offset = static_cast<uint32_t>(message.bytes.size());
+    if (!parseName(data, offset, message, question.name_id, question.name_length, question.name_flags, options,
+                   &question.registrable_offset)) {
+        return false;
+    }
+
+    // 解析查询类型和类
+    if (offset + 4 > data.size()) {
+        fail(options, ParseError::TruncatedQuestion);
+        return false;
+    }
+    question.type = ntohs(*reinterpret_cast<const uint16_t*>(data.data() + offset));
+    offset += 2;
+    question.class_ = ntohs(*reinterpret_cast<const uint16_t*>(data.data() + offset));
+    offset += 2;
+
+    return true;
+}
+
+bool DNSParser::parseResourceRecord(const std::string& data, size_t& offset, Message& message,
+                                    DNSResourceRecord& rr, RData& value, const ParseOptions& options) {
+    // 类型在域名之后：先跳过域名看类型，DNSSEC 记录只记下位置，其他记录回到域名起点常规解析
+    if (options.skip_dnssec) {
+        const uint8_t* ptr = reinterpret_cast<const uint8_t*>(data.data());
+        size_t pos = offset;
+        if (skipName(data, pos) && pos + 10 <= data.size()) {
+            uint16_t type = ntohs(*reinterpret_cast<const uint16_t*>(ptr + pos));
+            if (isDnssecType(type)) {
+                uint16_t rdlength = ntohs(*reinterpret_cast<const uint16_t*>(ptr + pos + 8));
+                if (pos + 10 + rdlength > data.size()) {
+                    fail(options, ParseError::TruncatedRecord);
+                    return false;
+                }
+                rr.name_id = kInvalidNameId;
+                rr.data_offset = static_cast<uint32_t>(message.bytes.size());
+                rr.name_length = 0;
+                rr.type = type;
+                rr.class_ = ntohs(*reinterpret_cast<const uint16_t*>(ptr + pos + 2));
+                rr.ttl = ntohl(*reinterpret_cast<const uint32_t*>(ptr + pos + 4));
+                rr.rdlength = rdlength;
+                rr.rdata_offset = static_cast<uint16_t>(pos + 10);
+                value.kind = RDataKind::Skipped;
+                value.owner = static_cast<uint16_t>(offset);
+                offset = pos + 10 + rdlength;
+                return true;
+            }
+        }
+    }
+
+    // 解析域名
+    rr.data_offset = static_cast<uint32_t>(message.bytes.size());
+    if (!parseName(data, offset, message, rr.name_id, rr.name_length, rr.name_flags, options)) {
+        return false;
+    }
     
     // 检查剩余字节是否足够
     if (offset + 10 > data.size()) {
+        fail(options, ParseError::TruncatedRecord);
         return false;
     }
     
@@ -171,30 +363,300 @@ bool DNSParser::parseResourceRecord(const std::string& data, size_t& offset, DNS
     
     // 检查数据长度是否合法
     if (offset + rr.rdlength > data.size()) {
+        fail(options, ParseError::TruncatedRecord);
         return false;
     }
     
-    // 解析资源数据
-    rr.rdata = data.substr(offset, rr.rdlength);
+    // 资源数据紧跟在域名之后追加到字节区
+    rr.rdata_offset = static_cast<uint16_t>(offset);
+    message.bytes.append(data.data() + offset, rr.rdlength);
     offset += rr.rdlength;
-    
+
+    // 同一遍内解码为固定布局，输出和分析不再重新解析
+    decodeRData(data, message, rr, value);
+    return true;
+}
+
+bool DNSParser::skipName(const std::string& data, size_t& offset) {
+    const uint8_t* ptr = reinterpret_cast<const uint8_t*>(data.data());
+    while (offset < data.size()) {
+        uint8_t len = ptr[offset];
+        if ((len & 0xC0) == 0xC0) {
+            if (offset + 2 > data.size()) {
+                return false;
+            }
+            offset += 2;
+            return true;
+        }
+        if (len & 0xC0) {
+            return false;
+        }
+        offset += 1 + len;
+        if (len == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool DNSParser::decodeName(const std::string& data, size_t& offset, size_t end, Message& message, ByteRef& ref) {
+    char buffer[kMaxNameLength];
+    size_t length = 0;
+    if (!readDomainName(data, offset, buffer, length) || offset > end) {
+        return false;
+    }
+    ref.offset = static_cast<uint32_t>(message.bytes.size());
+    ref.length = static_cast<uint16_t>(length);
+    message.bytes.append(buffer, length);
+    return true;
+}
+
+void DNSParser::decodeRData(const std::string& data, Message& message, const DNSResourceRecord& rr, RData& value) {
+    const uint8_t* ptr = reinterpret_cast<const uint8_t*>(data.data());
+    size_t start = rr.rdata_offset;
+    size_t end = start + rr.rdlength;
+    // 原始资源数据在字节区中的偏移，字符串和参数直接引用这里
+    uint32_t raw = rr.data_offset + rr.name_length;
+    size_t offset = start;
+    bool ok = true;
+
+    switch (rr.type) {
+        case static_cast<uint16_t>(DNSType::A):
+        case static_cast<uint16_t>(DNSType::AAAA): {
+            size_t size = rr.type == static_cast<uint16_t>(DNSType::A) ? 4 : 16;
+            value.kind = RDataKind::Address;
+            ok = rr.rdlength == size;
+            if (ok) {
+                std::memcpy(value.address, ptr + start, size);
+            }
+            break;
+        }
+        case static_cast<uint16_t>(DNSType::CNAME):
+        case static_cast<uint16_t>(DNSType::NS):
+        case static_cast<uint16_t>(DNSType::PTR):
+            value.kind = RDataKind::Name;
+            ok = decodeName(data, offset, end, message, value.name) && offset == end;
+            break;
+        case static_cast<uint16_t>(DNSType::MX):
+            value.kind = RDataKind::MX;
+            ok = rr.rdlength > 2;
+            if (ok) {
+                value.mx.preference = ntohs(*reinterpret_cast<const uint16_t*>(ptr + start));
+                offset += 2;
+                ok = decodeName(data, offset, end, message, value.mx.exchange) && offset == end;
+            }
+            break;
+        case static_cast<uint16_t>(DNSType::SOA):
+            value.kind = RDataKind::SOA;
+            ok = decodeName(data, offset, end, message, value.soa.mname) &&
+                 decodeName(data, offset, end, message, value.soa.rname) && offset + 20 == end;
+            if (ok) {
+                const uint32_t* fields = reinterpret_cast<const uint32_t*>(ptr + offset);
+                value.soa.serial = ntohl(fields[0]);
+                value.soa.refresh = ntohl(fields[1]);
+                value.soa.retry = ntohl(fields[2]);
+                value.soa.expire = ntohl(fields[3]);
+                value.soa.minimum = ntohl(fields[4]);
+            }
+            break;
+        case static_cast<uint16_t>(DNSType::SRV):
+            value.kind = RDataKind::SRV;
+            ok = rr.rdlength > 6;
+            if (ok) {
+                value.srv.priority = ntohs(*reinterpret_cast<const uint16_t*>(ptr + start));
+                value.srv.weight = ntohs(*reinterpret_cast<const uint16_t*>(ptr + start + 2));
+                value.srv.port = ntohs(*reinterpret_cast<const uint16_t*>(ptr + start + 4));
+                offset += 6;
+                ok = decodeName(data, offset, end, message, value.srv.target) && offset == end;
+            }
+            break;
+        case static_cast<uint16_t>(DNSType::TXT):
+            // 一个或多个带长度前缀的字符串，恰好占满资源数据
+            value.kind = RDataKind::TXT;
+            value.txt.count = 0;
+            value.txt.strings.offset = raw;
+            value.txt.strings.length = rr.rdlength;
+            while (offset < end) {
+                offset += 1 + ptr[offset];
+                ++value.txt.count;
+            }
+            ok = rr.rdlength > 0 && offset == end;
+            break;
+        case static_cast<uint16_t>(DNSType::CAA):
+            value.kind = RDataKind::CAA;
+            ok = rr.rdlength >= 2 && ptr[start + 1] > 0 && 2u + ptr[start + 1] <= rr.rdlength;
+            if (ok) {
+                uint8_t tag_length = ptr[start + 1];
+                value.caa.flags = ptr[start];
+                value.caa.tag.offset = raw + 2;
+                value.caa.tag.length = tag_length;
+                value.caa.value.offset = raw + 2 + tag_length;
+                value.caa.value.length = static_cast<uint16_t>(rr.rdlength - 2 - tag_length);
+            }
+            break;
+        case static_cast<uint16_t>(DNSType::SVCB):
+        case static_cast<uint16_t>(DNSType::HTTPS):
+            value.kind = RDataKind::SVCB;
+            ok = rr.rdlength > 2;
+            if (ok) {
+                value.svcb.priority = ntohs(*reinterpret_cast<const uint16_t*>(ptr + start));
+                offset += 2;
+                ok = decodeName(data, offset, end, message, value.svcb.target);
+            }
+            if (ok) {
+                value.svcb.params.offset = raw + static_cast<uint32_t>(offset - start);
+                value.svcb.params.length = static_cast<uint16_t>(end - offset);
+            }
+            break;
+        case static_cast<uint16_t>(DNSType::OPT):
+            value.kind = RDataKind::OPT;
+            ok = decodeOpt(data, rr, raw, value.opt);
+            break;
+        default:
+            value.kind = RDataKind::None;
+            return;
+    }
+
+    if (!ok) {
+        value.kind = RDataKind::Malformed;
+    }
+}
+
+bool DNSParser::decodeOpt(const std::string& data, const DNSResourceRecord& rr, uint32_t raw, OPTData& opt) {
+    const uint8_t* ptr = reinterpret_cast<const uint8_t*>(data.data());
+    // 类字段为 UDP 负载长度，TTL 字段依次为扩展响应码、版本和标志
+    opt.udp_size = rr.class_;
+    opt.extended_rcode = static_cast<uint8_t>(rr.ttl >> 24);
+    opt.version = static_cast<uint8_t>(rr.ttl >> 16);
+    opt.flags = static_cast<uint16_t>(rr.ttl);
+    opt.ecs_family = 0;
+    opt.ecs_source = 0;
+    opt.ecs_scope = 0;
+    opt.cookie.offset = 0;
+    opt.cookie.length = 0;
+
+    size_t start = rr.rdata_offset;
+    size_t end = start + rr.rdlength;
+    size_t offset = start;
+    while (offset + 4 <= end) {
+        uint16_t code = ntohs(*reinterpret_cast<const uint16_t*>(ptr + offset));
+        uint16_t length = ntohs(*reinterpret_cast<const uint16_t*>(ptr + offset + 2));
+        offset += 4;
+        if (offset + length > end) {
+            return false;
+        }
+
+        if (code == kOptionClientSubnet && length >= 4) {
+            // 地址族、源前缀、作用域前缀，地址只携带源前缀覆盖的字节；不合法的子网选项被忽略
+            uint16_t family = ntohs(*reinterpret_cast<const uint16_t*>(ptr + offset));
+            uint8_t source = ptr[offset + 2];
+            size_t address_length = length - 4u;
+            size_t max_length = family == 1 ? 4 : (family == 2 ? 16 : 0);
+            if (max_length && source <= max_length * 8 && address_length == (source + 7u) / 8) {
+                opt.ecs_family = static_cast<uint8_t>(family);
+                opt.ecs_source = source;
+                opt.ecs_scope = ptr[offset + 3];
+                std::memset(opt.ecs_address, 0, sizeof(opt.ecs_address));
+                std::memcpy(opt.ecs_address, ptr + offset + 4, address_length);
+                if (source % 8) {
+                    opt.ecs_address[address_length - 1] &= static_cast<uint8_t>(0xFF00u >> (source % 8));
+                }
+            }
+        } else if (code == kOptionCookie && (length == 8 || (length >= 16 && length <= 40))) {
+            // 客户端 Cookie 8 字节，服务器 Cookie 8-32 字节
+            opt.cookie.offset = raw + static_cast<uint32_t>(offset - start);
+            opt.cookie.length = length;
+        }
+        offset += length;
+    }
+    return offset == end;
+}
+
+std::string DNSParser::ownerName(const std::string& data, const Message& message, const DNSResourceRecord& rr) {
+    const RData& value = message.decoded(rr);
+    if (value.kind == RDataKind::Skipped) {
+        return decodeDomainName(data, value.owner);
+    }
+    return displayName(message, rr);
+}
+
+bool DNSParser::decodeRRSIG(const std::string& data, const DNSResourceRecord& rr, RRSIGData& out) {
+    const uint8_t* ptr = reinterpret_cast<const uint8_t*>(data.data());
+    size_t offset = rr.rdata_offset;
+    size_t end = offset + rr.rdlength;
+    if (rr.type != static_cast<uint16_t>(DNSType::RRSIG) || rr.rdlength < 18 || end > data.size()) {
+        return false;
+    }
+
+    out.type_covered = ntohs(*reinterpret_cast<const uint16_t*>(ptr + offset));
+    out.algorithm = ptr[offset + 2];
+    out.labels = ptr[offset + 3];
+    out.original_ttl = ntohl(*reinterpret_cast<const uint32_t*>(ptr + offset + 4));
+    out.expiration = ntohl(*reinterpret_cast<const uint32_t*>(ptr + offset + 8));
+    out.inception = ntohl(*reinterpret_cast<const uint32_t*>(ptr + offset + 12));
+    out.key_tag = ntohs(*reinterpret_cast<const uint16_t*>(ptr + offset + 16));
+    offset += 18;
+
+    char buffer[kMaxNameLength];
+    size_t length = 0;
+    if (!readDomainName(data, offset, buffer, length) || offset > end) {
+        return false;
+    }
+    out.signer.assign(buffer, length);
+    out.signature_offset = static_cast<uint16_t>(offset);
+    out.signature_length = static_cast<uint16_t>(end - offset);
+    return true;
+}
+
+bool DNSParser::decodeDNSKEY(const std::string& data, const DNSResourceRecord& rr, DNSKEYData& out) {
+    const uint8_t* ptr = reinterpret_cast<const uint8_t*>(data.data());
+    size_t start = rr.rdata_offset;
+    size_t end = start + rr.rdlength;
+    if (rr.type != static_cast<uint16_t>(DNSType::DNSKEY) || rr.rdlength < 4 || end > data.size()) {
+        return false;
+    }
+
+    out.flags = ntohs(*reinterpret_cast<const uint16_t*>(ptr + start));
+    out.protocol = ptr[start + 2];
+    out.algorithm = ptr[start + 3];
+    out.key_offset = static_cast<uint16_t>(start + 4);
+    out.key_length = static_cast<uint16_t>(rr.rdlength - 4);
+
+    if (out.algorithm == 1) {
+        // RSA/MD5：取模数最低 24 位中的高 16 位
+        out.key_tag = out.key_length >= 3 ? static_cast<uint16_t>((ptr[end - 3] << 8) | ptr[end - 2]) : 0;
+    } else {
+        // RFC 4034 附录 B：整个资源数据按 16 位累加，进位折回
+        uint32_t sum = 0;
+        for (size_t i = 0; i < rr.rdlength; ++i) {
+            sum += (i & 1) ? ptr[start + i] : static_cast<uint32_t>(ptr[start + i]) << 8;
+        }
+        sum += (sum >> 16) & 0xFFFF;
+        out.key_tag = static_cast<uint16_t>(sum);
+    }
     return true;
 }
 
 void DNSParser::printMessageDetails(const Message& message, bool isQuery) {
+    printMessageDetails(message, isQuery, message.header.transaction_id);
+}
+
+void DNSParser::printMessageDetails(const Message& message, bool isQuery, uint16_t transactionId) {
     std::cout << "\n===== DNS " << (isQuery ? "查询" : "响应") << " =====" << std::endl;
     
     // 输出头部信息
-    printHeader(message.header);
+    DNSHeader header = message.header;
+    header.transaction_id = transactionId;
+    printHeader(header);
     
     // 输出查询问题
-    printQuestions(message.questions);
+    printQuestions(message);
     
     // 如果是响应包，输出资源记录
     if (!isQuery) {
-        printResourceRecords(message.answers, "应答");
-        printResourceRecords(message.authorities, "权威");
-        printResourceRecords(message.additionals, "附加");
+        printResourceRecords(message, message.answers(), "应答");
+        printResourceRecords(message, message.authorities(), "权威");
+        printResourceRecords(message, message.additionals(), "附加");
     }
 }
 
@@ -227,7 +689,8 @@ void DNSParser::printHeader(const DNSHeader& header) {
     std::cout << "附加记录数: " << header.additional_rrs << std::endl;
 }
 
-void DNSParser::printQuestions(const std::vector<DNSQuestion>& questions) {
+void DNSParser::printQuestions(const Message& message) {
+    const dns_parser::SmallVector<DNSQuestion, 1>& questions = message.questions;
     if (questions.empty()) {
         return;
     }
@@ -236,7 +699,11 @@ void DNSParser::printQuestions(const std::vector<DNSQuestion>& questions) {
     for (size_t i = 0; i < questions.size(); ++i) {
         const auto& question = questions[i];
         std::cout << "问题 #" << (i + 1) << std::endl;
-        std::cout << "域名: " << question.domain_name << std::endl;
+        std::string name = displayName(message, question);
+        std::cout << "域名: " << name << std::endl;
+        if (question.registrable_offset < name.size()) {
+            std::cout << "可注册域名: " << name.substr(question.registrable_offset) << std::endl;
+        }
         
         // 输出查询类型
         std::cout << "类型: ";
@@ -251,6 +718,15 @@ void DNSParser::printQuestions(const std::vector<DNSQuestion>& questions) {
             case 28: std::cout << "AAAA (28) - IPv6 地址"; break;
             case 33: std::cout << "SRV (33) - 服务定位"; break;
             case 35: std::cout << "NAPTR (35) - 名称权威指针"; break;
+            case 43: std::cout << "DS (43) - 委派签名者"; break;
+            case 46: std::cout << "RRSIG (46) - 资源记录集签名"; break;
+            case 47: std::cout << "NSEC (47) - 下一个安全记录"; break;
+            case 48: std::cout << "DNSKEY (48) - DNS 公钥"; break;
+            case 50: std::cout << "NSEC3 (50) - 散列的下一个安全记录"; break;
+            case 51: std::cout << "NSEC3PARAM (51) - NSEC3 参数"; break;
+            case 64: std::cout << "SVCB (64) - 服务绑定"; break;
+            case 65: std::cout << "HTTPS (65) - HTTPS 服务绑定"; break;
+            case 257: std::cout << "CAA (257) - 证书颁发机构授权"; break;
             case 255: std::cout << "ANY (255) - 任意类型"; break;
             default: std::cout << question.type << " - 未知类型";
         }
@@ -268,7 +744,7 @@ void DNSParser::printQuestions(const std::vector<DNSQuestion>& questions) {
     }
 }
 
-void DNSParser::printResourceRecords(const std::vector<DNSResourceRecord>& records, const std::string& recordType) {
+void DNSParser::printResourceRecords(const Message& message, const RecordSpan& records, const std::string& recordType) {
     if (records.empty()) {
         return;
     }
@@ -279,7 +755,13 @@ void DNSParser::printResourceRecords(const std::vector<DNSResourceRecord>& recor
     for (size_t i = 0; i < records.size(); ++i) {
         const auto& record = records[i];
         std::cout << "\n记录 #" << (i + 1) << std::endl;
-        std::cout << "名称: " << record.name << std::endl;
+        const RData& value = message.decoded(record);
+        if (value.kind == RDataKind::Skipped) {
+            std::cout << "名称: (未解析，位于报文偏移 " << value.owner << ")" << std::endl;
+        } else {
+            std::cout << "名称: " << displayName(message, record) << std::endl;
+        }
+        const char* rdata = reinterpret_cast<const char*>(message.rdata(record));
         
         // 输出记录类型
         std::cout << "类型: ";
@@ -294,6 +776,9 @@ void DNSParser::printResourceRecords(const std::vector<DNSResourceRecord>& recor
             case 28: std::cout << "AAAA (28) - IPv6 地址"; break;
             case 33: std::cout << "SRV (33) - 服务定位"; break;
             case 35: std::cout << "NAPTR (35) - 名称权威指针"; break;
+            case 64: std::cout << "SVCB (64) - 服务绑定"; break;
+            case 65: std::cout << "HTTPS (65) - HTTPS 服务绑定"; break;
+            case 257: std::cout << "CAA (257) - 证书颁发机构授权"; break;
             default: std::cout << record.type << " - 未知类型";
         }
         std::cout << std::endl;
@@ -311,44 +796,98 @@ void DNSParser::printResourceRecords(const std::vector<DNSResourceRecord>& recor
         std::cout << "TTL: " << record.ttl << " 秒" << std::endl;
         std::cout << "数据长度: " << record.rdlength << " 字节" << std::endl;
         
-        // 根据记录类型解析数据
-        if (record.type == 1 && record.rdlength == 4) {  // A 记录
-            const unsigned char* ip = reinterpret_cast<const unsigned char*>(record.rdata.data());
-            std::cout << "IP 地址: " << static_cast<int>(ip[0]) << "." 
-                      << static_cast<int>(ip[1]) << "."
-                      << static_cast<int>(ip[2]) << "."
-                      << static_cast<int>(ip[3]) << std::endl;
-        } else if (record.type == 28 && record.rdlength == 16) {  // AAAA 记录
-            const unsigned char* ip = reinterpret_cast<const unsigned char*>(record.rdata.data());
-            std::cout << "IPv6 地址: ";
-            for (int j = 0; j < 16; j += 2) {
-                if (j > 0) std::cout << ":";
-                std::cout << std::hex << std::setw(2) << std::setfill('0') 
-                          << static_cast<int>(ip[j]) << std::setw(2) 
-                          << static_cast<int>(ip[j+1]);
-            }
-            std::cout << std::dec << std::endl;
-        } else if (record.type == 5) {  // CNAME 记录
-            std::cout << "规范名称: " << record.rdata << std::endl;
-        } else if (record.type == 2) {  // NS 记录
-            std::cout << "名称服务器: " << record.rdata << std::endl;
-        } else if (record.type == 15) {  // MX 记录
-            if (record.rdlength >= 2) {
-                uint16_t preference = ntohs(*reinterpret_cast<const uint16_t*>(record.rdata.data()));
-                std::string exchange = record.rdata.substr(2);
-                std::cout << "优先级: " << preference << std::endl;
-                std::cout << "邮件服务器: " << exchange << std::endl;
-            }
-        } else if (record.type == 16) {  // TXT 记录
-            std::cout << "文本: " << record.rdata << std::endl;
-        } else {
-            // 其他类型记录，以十六进制显示
-            std::cout << "数据: ";
-            for (size_t j = 0; j < record.rdata.size(); ++j) {
-                std::cout << std::hex << std::setw(2) << std::setfill('0') 
-                          << static_cast<int>(static_cast<unsigned char>(record.rdata[j])) << " ";
+        // 按解码结果输出，内嵌域名已经解压缩
+        switch (value.kind) {
+            case RDataKind::Address:
+                if (record.rdlength == 4) {
+                    std::cout << "IP 地址: " << static_cast<int>(value.address[0]) << "."
+                              << static_cast<int>(value.address[1]) << "."
+                              << static_cast<int>(value.address[2]) << "."
+                              << static_cast<int>(value.address[3]) << std::endl;
+                } else {
+                    std::cout << "IPv6 地址: ";
+                    for (int j = 0; j < 16; j += 2) {
+                        if (j > 0) std::cout << ":";
+                        std::cout << std::hex << std::setw(2) << std::setfill('0')
+                                  << static_cast<int>(value.address[j]) << std::setw(2)
+                                  << static_cast<int>(value.address[j + 1]);
+                    }
+                    std::cout << std::dec << std::endl;
+                }
+                break;
+            case RDataKind::Name:
+                if (record.type == static_cast<uint16_t>(DNSType::CNAME)) {
+                    std::cout << "规范名称: ";
+                } else if (record.type == static_cast<uint16_t>(DNSType::NS)) {
+                    std::cout << "名称服务器: ";
+                } else {
+                    std::cout << "指向域名: ";
+                }
+                std::cout << message.text(value.name) << std::endl;
+                break;
+            case RDataKind::MX:
+                std::cout << "优先级: " << value.mx.preference << std::endl;
+                std::cout << "邮件服务器: " << message.text(value.mx.exchange) << std::endl;
+                break;
+            case RDataKind::SOA:
+                std::cout << "主名称服务器: " << message.text(value.soa.mname) << std::endl;
+                std::cout << "管理员邮箱: " << message.text(value.soa.rname) << std::endl;
+                std::cout << "序列号: " << value.soa.serial << ", 刷新: " << value.soa.refresh
+                          << ", 重试: " << value.soa.retry << ", 过期: " << value.soa.expire
+                          << ", 最小 TTL: " << value.soa.minimum << std::endl;
+                break;
+            case RDataKind::SRV:
+                std::cout << "优先级: " << value.srv.priority << ", 权重: " << value.srv.weight
+                          << ", 端口: " << value.srv.port << std::endl;
+                std::cout << "目标: " << message.text(value.srv.target) << std::endl;
+                break;
+            case RDataKind::TXT: {
+                const char* strings = message.data(value.txt.strings);
+                size_t pos = 0;
+                std::cout << "文本:";
+                while (pos < value.txt.strings.length) {
+                    uint8_t len = static_cast<uint8_t>(strings[pos]);
+                    std::cout << " \"" << std::string(strings + pos + 1, len) << "\"";
+                    pos += 1 + len;
+                }
+                std::cout << std::endl;
+                break;
             }
-            std::cout << std::dec << std::endl;
+            case RDataKind::CAA:
+                std::cout << "CAA: " << static_cast<int>(value.caa.flags) << " " << message.text(value.caa.tag)
+                          << " \"" << message.text(value.caa.value) << "\"" << std::endl;
+                break;
+            case RDataKind::SVCB:
+                std::cout << "优先级: " << value.svcb.priority << std::endl;
+                std::cout << "目标: " << (value.svcb.target.length ? message.text(value.svcb.target) : ".")
+                          << ", 参数长度: " << value.svcb.params.length << " 字节" << std::endl;
+                break;
+            case RDataKind::Skipped:
+                std::cout << "数据: (未复制，位于报文偏移 " << record.rdata_offset << ")" << std::endl;
+                break;
+            case RDataKind::OPT:
+                std::cout << "EDNS 版本: " << static_cast<int>(value.opt.version)
+                          << ", UDP 负载: " << value.opt.udp_size
+                          << ", 扩展响应码: " << static_cast<int>(value.opt.extended_rcode)
+                          << ", DO: " << ((value.opt.flags & OPTData::kDnssecOk) ? 1 : 0) << std::endl;
+                if (value.opt.cookie.length) {
+                    std::cout << "Cookie: " << value.opt.cookie.length << " 字节" << std::endl;
+                }
+                if (value.opt.ecs_family) {
+                    std::cout << "客户端子网: 地址族 " << static_cast<int>(value.opt.ecs_family)
+                              << ", 源前缀 /" << static_cast<int>(value.opt.ecs_source)
+                              << ", 作用域前缀 /" << static_cast<int>(value.opt.ecs_scope) << std::endl;
+                }
+                break;
+            default:
+                // 其他类型或格式不合法的记录，以十六进制显示
+                std::cout << "数据: ";
+                for (size_t j = 0; j < record.rdlength; ++j) {
+                    std::cout << std::hex << std::setw(2) << std::setfill('0')
+                              << static_cast<int>(static_cast<unsigned char>(rdata[j])) << " ";
+                }
+                std::cout << std::dec << std::endl;
+                break;
         }
     }
 }
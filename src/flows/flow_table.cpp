@@ -0,0 +1,288 @@
+#include "../../include/flows/flow_table.h"
+#include "../../include/tools/hash.h"
+#include <algorithm>
+
+namespace dns_parser {
+
+size_t FourTupleHash::operator()(const FourTuple& key) const {
+    // 与 FourTuple::operator== 保持一致：IPv4 只参与 4 字节地址
+    uint64_t ports = (static_cast<uint64_t>(static_cast<uint16_t>(key.sourcePort)) << 16) |
+                     static_cast<uint16_t>(key.destPort);
+    uint64_t h = hashBytes(&ports, sizeof(ports), key.srcIPvN);
+    if (key.srcIPvN == 6) {
+        h = hashBytes(key.srcIPv6, 16, h);
+        h = hashBytes(key.dstIPv6, 16, h);
+    } else {
+        uint64_t addrs = (static_cast<uint64_t>(key.srcIPv4) << 32) | key.dstIPv4;
+        h = hashBytes(&addrs, sizeof(addrs), h);
+    }
+    return static_cast<size_t>(h);
+}
+
+// ------------------------------ FlowBuffer ------------------------------
+
+FlowBuffer::FlowBuffer()
+    : block(nullptr), block_size(0) {
+}
+
+AppendResult FlowBuffer::append(BufferPool& pool, size_t max_size, const char* data, size_t len) {
+    if (len == 0) {
+        return AppendResult::Ok;
+    }
+    size_t need = size() + len;
+    if (need > block_size) {
+        // 上限取不超过 max_size 的最大分级，但至少是最小分级
+        size_t limit = pool.classSize(max_size);
+        if (limit > max_size && limit > pool.classSize(1)) {
+            limit >>= 1;
+        }
+        if (need > limit) {
+            return AppendResult::OverLimit;
+        }
+        size_t target = std::min(pool.classSize(std::max(need, block_size * 2)), limit);
+        char* next = pool.acquire(target);
+        if (!next) {
+            return AppendResult::NoBudget;
+        }
+        if (ring) {
+            pool.release(ring->rebind(next, target), block_size);
+        } else {
+            ring.reset(new CircularString(next, target));
+        }
+        block = next;
+        block_size = target;
+    }
+    ring->push_back(data, len);
+    return AppendResult::Ok;
+}
+
+CircularString* FlowBuffer::stream() noexcept {
+    return ring.get();
+}
+
+void FlowBuffer::consume(size_t n) {
+    if (n) {
+        ring->erase_up_to(n - 1);
+    }
+}
+
+size_t FlowBuffer::release(BufferPool& pool) noexcept {
+    if (!ring) {
+        return 0;
+    }
+    size_t freed = block_size;
+    ring.reset();
+    pool.release(block, block_size);
+    block = nullptr;
+    block_size = 0;
+    return freed;
+}
+
+size_t FlowBuffer::size() const noexcept {
+    return ring ? ring->size() : 0;
+}
+
+size_t FlowBuffer::capacity() const noexcept {
+    return block_size;
+}
+
+// ------------------------------ FlowTable ------------------------------
+
+const uint64_t FlowTable::kTimerTag;
+const uint32_t FlowTable::kNoFlow;
+const uint64_t FlowTable::kReclaimIdleMs;
+
+FlowTable::FlowTable(BufferPool& pool, TimerWheel& timers, size_t max_flows, size_t c2s_max, size_t s2c_max,
+                     uint32_t timeout_ms)
+    : pool(pool), timers(timers), max_flows(max_flows ? max_flows : 1), c2s_max(c2s_max), s2c_max(s2c_max),
+      timeout_ms(timeout_ms), oldest(kNoFlow), newest(kNoFlow), index(max_flows * 2), created_count(0), evicted_count(0), timeout_count(0),
+      reclaimed_bytes(0), overflow_count(0) {
+}
+
+FlowTable::~FlowTable() {
+    for (size_t i = 0; i < flows.size(); ++i) {
+        timers.cancel(flows[i].timer);
+        flows[i].c2s.release(pool);
+        flows[i].s2c.release(pool);
+    }
+}
+
+void FlowTable::setLimits(size_t max_flows, size_t c2s_max, size_t s2c_max, uint32_t timeout_ms) {
+    this->max_flows = max_flows ? max_flows : 1;
+    this->c2s_max = c2s_max;
+    this->s2c_max = s2c_max;
+    this->timeout_ms = timeout_ms;
+}
+
+FlowTable::Flow* FlowTable::find(const FourTuple& key) {
+    uint32_t* slot = index.find(key);
+    return slot ? &flows[*slot] : nullptr;
+}
+
+FlowTable::Flow& FlowTable::touch(const FourTuple& key, uint64_t now_ms) {
+    uint32_t* existing = index.find(key);
+    if (existing) {
+        Flow& flow = flows[*existing];
+        flow.last_seen = now_ms;
+        if (newest != *existing) {
+            unlink(*existing);
+            linkNewest(*existing);
+        }
+        return flow;
+    }
+
+    while (index.size() >= max_flows) {
+        evictOldest();
+    }
+
+    uint32_t slot;
+    if (!free_slots.empty()) {
+        slot = free_slots.back();
+        free_slots.pop_back();
+    } else {
+        slot = static_cast<uint32_t>(flows.size());
+        flows.push_back(Flow());
+    }
+    Flow& flow = flows[slot];
+    flow.key = key;
+    flow.last_seen = now_ms;
+    flow.live = true;
+    flow.stream = false;
+    flow.timer = timers.schedule(now_ms + timeout_ms, kTimerTag | slot);
+    index.insert(key, slot);
+    linkNewest(slot);
+    ++created_count;
+    return flow;
+}
+
+bool FlowTable::append(Flow& flow, bool c2s, const char* data, size_t len) {
+    FlowBuffer& buffer = c2s ? flow.c2s : flow.s2c;
+    size_t max_size = c2s ? c2s_max : s2c_max;
+    AppendResult result = buffer.append(pool, max_size, data, len);
+
+    // 只有预算不足才回收其他流的缓冲区并重试一次，超过本方向上限与其他流无关
+    if (result == AppendResult::NoBudget &&
+        reclaimIdle(pool.classSize(buffer.size() + len), flow.last_seen, &flow)) {
+        result = buffer.append(pool, max_size, data, len);
+    }
+    if (result != AppendResult::Ok) {
+        ++overflow_count;
+        return false;
+    }
+    return true;
+}
+
+bool FlowTable::remove(const FourTuple& key) {
+    uint32_t* slot = index.find(key);
+    if (!slot) {
+        return false;
+    }
+    uint32_t target = *slot;
+    index.erase(key);
+    releaseSlot(target);
+    return true;
+}
+
+size_t FlowTable::reclaimIdle(size_t bytes, uint64_t now_ms, const Flow* keep) {
+    size_t freed = 0;
+    for (uint32_t slot = oldest; slot != kNoFlow && freed < bytes; slot = flows[slot].newer) {
+        Flow& flow = flows[slot];
+        if (&flow == keep) {
+            continue;
+        }
+        // 空闲过久的流视为已中断，不完整的消息一并丢弃；其余流只归还空的缓冲区
+        bool idle = flow.last_seen + kReclaimIdleMs <= now_ms;
+        if (idle || flow.c2s.size() == 0) {
+            freed += flow.c2s.release(pool);
+        }
+        if (idle || flow.s2c.size() == 0) {
+            freed += flow.s2c.release(pool);
+        }
+    }
+    reclaimed_bytes += freed;
+    return freed;
+}
+
+void FlowTable::onTimer(uint64_t data, uint64_t now_ms) {
+    uint32_t slot = static_cast<uint32_t>(data & (kTimerTag - 1));
+    if (slot >= flows.size() || !flows[slot].live) {
+        return;
+    }
+    Flow& flow = flows[slot];
+    if (flow.last_seen + timeout_ms > now_ms) {
+        // 期间有过活动，按最近一次活动时间重新计时
+        flow.timer = timers.schedule(flow.last_seen + timeout_ms, kTimerTag | slot);
+        return;
+    }
+    flow.timer = TimerWheel::kInvalidHandle;
+    index.erase(flow.key);
+    releaseSlot(slot);
+    ++timeout_count;
+}
+
+size_t FlowTable::size() const noexcept {
+    return index.size();
+}
+
+FlowTable::Stats FlowTable::stats() const noexcept {
+    Stats snapshot;
+    snapshot.flows = index.size();
+    snapshot.created = created_count;
+    snapshot.evicted = evicted_count;
+    snapshot.timeouts = timeout_count;
+    snapshot.reclaimed_bytes = reclaimed_bytes;
+    snapshot.overflows = overflow_count;
+    return snapshot;
+}
+
+void FlowTable::releaseSlot(uint32_t slot) {
+    Flow& flow = flows[slot];
+    timers.cancel(flow.timer);
+    flow.timer = TimerWheel::kInvalidHandle;
+    flow.c2s.release(pool);
+    flow.s2c.release(pool);
+    flow.live = false;
+    flow.stream = false;
+    unlink(slot);
+    free_slots.push_back(slot);
+}
+
+void FlowTable::evictOldest() {
+    if (oldest == kNoFlow) {
+        return;
+    }
+    uint32_t slot = oldest;
+    index.erase(flows[slot].key);
+    releaseSlot(slot);
+    ++evicted_count;
+}
+
+void FlowTable::linkNewest(uint32_t slot) {
+    Flow& flow = flows[slot];
+    flow.older = newest;
+    flow.newer = kNoFlow;
+    if (newest != kNoFlow) {
+        flows[newest].newer = slot;
+    } else {
+        oldest = slot;
+    }
+    newest = slot;
+}
+
+void FlowTable::unlink(uint32_t slot) {
+    Flow& flow = flows[slot];
+    if (flow.older != kNoFlow) {
+        flows[flow.older].newer = flow.newer;
+    } else {
+        oldest = flow.newer;
+    }
+    if (flow.newer != kNoFlow) {
+        flows[flow.newer].older = flow.older;
+    } else {
+        newest = flow.older;
+    }
+    flow.older = kNoFlow;
+    flow.newer = kNoFlow;
+}
+
+} // namespace dns_parser
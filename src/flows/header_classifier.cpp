@@ -0,0 +1,23 @@
+#include "../../include/flows/header_classifier.h"
+
+namespace dns_parser {
+
+const char* headerCheckName(HeaderCheck check) {
+    switch (check) {
+        case HeaderCheck::Ok:
+            return "通过";
+        case HeaderCheck::TooShort:
+            return "头部过短";
+        case HeaderCheck::BadOpcode:
+            return "操作码无效";
+        case HeaderCheck::WrongDirection:
+            return "QR 与方向不符";
+        case HeaderCheck::CountsExceedLength:
+            return "记录数超出长度";
+        case HeaderCheck::Count:
+            break;
+    }
+    return "未知";
+}
+
+} // namespace dns_parser
@@ -0,0 +1,112 @@
+#include "../../include/flows/load_shedder.h"
+
+namespace dns_parser {
+
+const size_t LoadShedder::kLevels;
+
+ShedPolicy::ShedPolicy()
+    : enabled(false), latency_high_ns(50000), latency_low_ns(10000),
+      pressure_high(80), pressure_low(50), sample_rate(16), hold_ms(500) {
+}
+
+LoadShedder::LoadShedder(const ShedPolicy& policy, uint64_t now_ms)
+    : current(ShedLevel::Full), counter(0), last_change_ms(now_ms), transitions(0) {
+    for (size_t i = 0; i < kLevels; ++i) {
+        packets[i] = 0;
+        latency[i] = 0;
+        sampled[i] = false;
+    }
+    setPolicy(policy);
+}
+
+void LoadShedder::setPolicy(const ShedPolicy& value) {
+    policy = value;
+    if (policy.sample_rate == 0) {
+        policy.sample_rate = 1;
+    }
+    if (!policy.enabled) {
+        current = ShedLevel::Full;
+    }
+}
+
+ShedLevel LoadShedder::admit() noexcept {
+    ShedLevel depth = current;
+    if (depth != ShedLevel::Full && ++counter >= policy.sample_rate) {
+        counter = 0;
+        depth = static_cast<ShedLevel>(static_cast<uint8_t>(depth) - 1);
+    }
+    ++packets[static_cast<size_t>(depth)];
+    return depth;
+}
+
+bool LoadShedder::observe(ShedLevel depth, uint64_t latency_ns, uint8_t pressure, uint64_t now_ms,
+                          Transition* change) {
+    size_t index = static_cast<size_t>(depth);
+    uint32_t sample = latency_ns > 0xFFFFFFFFu ? 0xFFFFFFFFu : static_cast<uint32_t>(latency_ns);
+    if (!sampled[index]) {
+        latency[index] = sample;
+        sampled[index] = true;
+    } else {
+        latency[index] = static_cast<uint32_t>(
+            static_cast<int64_t>(latency[index]) + (static_cast<int64_t>(sample) - latency[index]) / 8);
+    }
+
+    if (!policy.enabled || now_ms - last_change_ms < policy.hold_ms) {
+        return false;
+    }
+
+    size_t level = static_cast<size_t>(current);
+    size_t next = level;
+    if (latency[level] > policy.latency_high_ns || pressure > policy.pressure_high) {
+        if (level + 1 < kLevels) {
+            next = level + 1;
+        }
+    } else if (level > 0 && pressure < policy.pressure_low && sampled[level - 1] &&
+               latency[level - 1] < policy.latency_low_ns) {
+        next = level - 1;
+    }
+    if (next == level) {
+        return false;
+    }
+
+    if (change) {
+        change->from = current;
+        change->to = static_cast<ShedLevel>(next);
+        change->latency_ns = latency[level];
+        change->pressure = pressure;
+    }
+    current = static_cast<ShedLevel>(next);
+    counter = 0;
+    last_change_ms = now_ms;
+    ++transitions;
+    return true;
+}
+
+ShedLevel LoadShedder::level() const noexcept {
+    return current;
+}
+
+LoadShedder::Stats LoadShedder::stats() const noexcept {
+    Stats stats;
+    stats.level = current;
+    stats.transitions = transitions;
+    for (size_t i = 0; i < kLevels; ++i) {
+        stats.packets[i] = packets[i];
+        stats.latency_ns[i] = latency[i];
+    }
+    return stats;
+}
+
+const char* LoadShedder::levelName(ShedLevel level) {
+    switch (level) {
+        case ShedLevel::Full:
+            return "完整解析";
+        case ShedLevel::Questions:
+            return "头部+问题";
+        case ShedLevel::Sampling:
+            return "抽样计数";
+    }
+    return "未知";
+}
+
+} // namespace dns_parser
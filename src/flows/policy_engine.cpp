@@ -0,0 +1,630 @@
+#include "../../include/flows/policy_engine.h"
+#include "../../include/tools/hash.h"
+#include "../../include/tools/name_hash.h"
+#include <arpa/inet.h>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace dns_parser {
+
+const size_t PolicyEngine::kMaxRules;
+const uint32_t PolicyEngine::kNoRow;
+const size_t PolicyEngine::kMaxWords;
+
+namespace {
+
+// 检查文本域名的标签后按 hashNameText 计算哈希（与解码器的后缀哈希一致）；
+// 完全限定形式末尾的一个 '.' 被去掉，"." 和空串表示根域，返回 kNameHashSeed
+bool hashName(const std::string& name, uint64_t& hash) {
+    size_t size = name.size();
+    if (size && name[size - 1] == '.') {
+        --size;
+    }
+    size_t start = 0;
+    while (start < size) {
+        size_t dot = std::min(name.find('.', start), size);
+        size_t len = dot - start;
+        if (len == 0 || len > 63) {
+            return false;
+        }
+        start = dot + 1;
+    }
+    // 去掉末尾的点后仍以点结尾（如 "a.."）时最后一个标签为空
+    if (size && name[size - 1] == '.') {
+        return false;
+    }
+    hash = hashNameText(name.data(), size);
+    return true;
+}
+
+// 截断到前缀长度（IPv4 按主机字节序整数处理）
+uint32_t maskIPv4(const uint8_t* addr, uint8_t length) {
+    uint32_t value = (static_cast<uint32_t>(addr[0]) << 24) | (static_cast<uint32_t>(addr[1]) << 16) |
+                     (static_cast<uint32_t>(addr[2]) << 8) | addr[3];
+    return length == 0 ? 0 : value & (0xFFFFFFFFu << (32 - length));
+}
+
+void maskIPv6(const uint8_t* addr, uint8_t length, uint8_t* out) {
+    for (unsigned i = 0; i < 16; ++i) {
+        unsigned bits = length > i * 8 ? std::min<unsigned>(length - i * 8, 8) : 0;
+        out[i] = static_cast<uint8_t>(addr[i] & (0xFF00u >> bits));
+    }
+}
+
+std::string toUpper(const std::string& text) {
+    std::string upper(text);
+    std::transform(upper.begin(), upper.end(), upper.begin(), ::toupper);
+    return upper;
+}
+
+// 类型名或 TYPEnnn / 数字
+bool parseQtype(const std::string& text, uint16_t& out) {
+    static const struct { const char* name; uint16_t value; } kTypes[] = {
+        {"A", 1}, {"NS", 2}, {"CNAME", 5}, {"SOA", 6}, {"PTR", 12}, {"MX", 15}, {"TXT", 16},
+        {"AAAA", 28}, {"SRV", 33}, {"NAPTR", 35}, {"DS", 43}, {"RRSIG", 46}, {"NSEC", 47},
+        {"DNSKEY", 48}, {"NSEC3", 50}, {"SVCB", 64}, {"HTTPS", 65}, {"ANY", 255}, {"CAA", 257}
+    };
+    std::string upper = toUpper(text);
+    for (size_t i = 0; i < sizeof(kTypes) / sizeof(kTypes[0]); ++i) {
+        if (upper == kTypes[i].name) {
+            out = kTypes[i].value;
+            return true;
+        }
+    }
+    const char* digits = upper.compare(0, 4, "TYPE") == 0 ? upper.c_str() + 4 : upper.c_str();
+    char* end = nullptr;
+    unsigned long value = std::strtoul(digits, &end, 10);
+    if (*digits == '\0' || *end != '\0' || value > 0xFFFF) {
+        return false;
+    }
+    out = static_cast<uint16_t>(value);
+    return true;
+}
+
+bool parseRcode(const std::string& text, uint8_t& out) {
+    static const char* kCodes[] = {"NOERROR", "FORMERR", "SERVFAIL", "NXDOMAIN", "NOTIMP", "REFUSED"};
+    std::string upper = toUpper(text);
+    for (uint8_t i = 0; i < sizeof(kCodes) / sizeof(kCodes[0]); ++i) {
+        if (upper == kCodes[i]) {
+            out = i;
+            return true;
+        }
+    }
+    char* end = nullptr;
+    unsigned long value = std::strtoul(upper.c_str(), &end, 10);
+    if (upper.empty() || *end != '\0' || value > 15) {
+        return false;
+    }
+    out = static_cast<uint8_t>(value);
+    return true;
+}
+
+bool parseAction(const std::string& text, PolicyAction& out) {
+    std::string upper = toUpper(text);
+    if (upper == "BLOCK" || upper == "DROP") {
+        out = PolicyAction::Acknowledge;
+    } else if (upper == "FORWARD" || upper == "ALLOW") {
+        out = PolicyAction::Forward;
+    } else if (upper == "NONE") {
+        out = PolicyAction::None;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+std::vector<std::string> split(const std::string& text, char delimiter) {
+    std::vector<std::string> parts;
+    std::stringstream stream(text);
+    std::string part;
+    while (std::getline(stream, part, delimiter)) {
+        if (!part.empty()) {
+            parts.push_back(part);
+        }
+    }
+    return parts;
+}
+
+// 解析一条规则行中的字段，错误时写入 error
+bool parseField(const std::string& token, PolicyRule& rule, std::string& error) {
+    size_t eq = token.find('=');
+    if (eq == std::string::npos || eq == 0 || eq + 1 == token.size()) {
+        error = "无效的字段: " + token;
+        return false;
+    }
+    std::string field = token.substr(0, eq);
+    std::vector<std::string> values = split(token.substr(eq + 1), ',');
+    for (size_t i = 0; i < values.size(); ++i) {
+        const std::string& value = values[i];
+        bool ok = true;
+        if (field == "qname") {
+            uint64_t hash;
+            ok = hashName(value, hash);
+            rule.qnames.push_back(value);
+        } else if (field == "qtype") {
+            uint16_t qtype = 0;
+            ok = parseQtype(value, qtype);
+            rule.qtypes.push_back(qtype);
+        } else if (field == "rcode") {
+            uint8_t rcode = 0;
+            ok = parseRcode(value, rcode);
+            rule.rcodes.push_back(rcode);
+        } else if (field == "respond") {
+            std::string upper = toUpper(value);
+            if (upper == "NXDOMAIN") {
+                rule.respond = SyntheticKind::NXDomain;
+            } else if (upper == "REFUSED") {
+                rule.respond = SyntheticKind::Refused;
+            } else if (upper == "SINKHOLE") {
+                rule.respond = SyntheticKind::Sinkhole;
+            } else {
+                ok = false;
+            }
+        } else if (field == "client" || field == "answer") {
+            IpPrefix prefix;
+            ok = IpPrefix::parse(value, prefix);
+            (field == "client" ? rule.clients : rule.answers).push_back(prefix);
+        } else {
+            error = "未知的字段: " + field;
+            return false;
+        }
+        if (!ok) {
+            error = "无效的取值: " + token;
+            return false;
+        }
+    }
+    return true;
+}
+
+// 把名单中的一个域名加入规则；根域会匹配所有查询，在名单中出现时忽略
+void addListName(const std::string& name, PolicyRule& rule) {
+    uint64_t hash;
+    if (hashName(name, hash) && hash != kNameHashSeed) {
+        rule.qnames.push_back(name);
+    }
+}
+
+// 读取域名名单：每行一个域名，# 开头为注释，合并为一条规则。也接受 hosts 文件格式
+// （"0.0.0.0 ads.example.com ..."）：首个字段是 IP 地址时取其后的各个域名
+bool readDomainList(const std::string& path, PolicyAction action, PolicyRule& rule) {
+    std::ifstream file(path.c_str());
+    if (!file.is_open()) {
+        return false;
+    }
+    rule.action = action;
+    std::string line;
+    while (std::getline(file, line)) {
+        std::stringstream stream(line);
+        std::string name;
+        if (!(stream >> name) || name[0] == '#') {
+            continue;
+        }
+        uint8_t addr[16];
+        if (inet_pton(AF_INET, name.c_str(), addr) != 1 && inet_pton(AF_INET6, name.c_str(), addr) != 1) {
+            addListName(name, rule);
+            continue;
+        }
+        while (stream >> name && name[0] != '#') {
+            addListName(name, rule);
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+bool IpPrefix::parse(const std::string& text, IpPrefix& out) {
+    std::string address = text;
+    int length = -1;
+    size_t slash = text.find('/');
+    if (slash != std::string::npos) {
+        address = text.substr(0, slash);
+        char* end = nullptr;
+        length = static_cast<int>(std::strtol(text.c_str() + slash + 1, &end, 10));
+        if (slash + 1 == text.size() || *end != '\0' || length < 0) {
+            return false;
+        }
+    }
+
+    uint8_t raw[16];
+    std::memset(raw, 0, sizeof(raw));
+    if (inet_pton(AF_INET, address.c_str(), raw) == 1) {
+        out.version = 4;
+        length = length < 0 ? 32 : length;
+        if (length > 32) {
+            return false;
+        }
+    } else if (inet_pton(AF_INET6, address.c_str(), raw) == 1) {
+        out.version = 6;
+        length = length < 0 ? 128 : length;
+        if (length > 128) {
+            return false;
+        }
+    } else {
+        return false;
+    }
+    out.length = static_cast<uint8_t>(length);
+    maskIPv6(raw, out.length, out.addr);
+    return true;
+}
+
+size_t PolicyEngine::IPv6KeyHash::operator()(const IPv6Key& key) const {
+    return static_cast<size_t>(hashBytes(key.data(), key.size()));
+}
+
+PolicyEngine::PolicyEngine(const std::vector<PolicyRule>& rules, PolicyAction default_action)
+    : default_action(default_action), used_fields(0) {
+    size_t count = std::min(rules.size(), kMaxRules);
+    words = std::max<size_t>((count + 63) / 64, 1);
+    for (size_t i = 0; i < 16; ++i) {
+        rcode_rows[i] = kNoRow;
+    }
+    for (int field = 0; field < FIELD_COUNT; ++field) {
+        newRow();
+    }
+
+    for (size_t r = 0; r < count; ++r) {
+        const PolicyRule& rule = rules[r];
+        actions.push_back(rule.action);
+        responds.push_back(rule.respond);
+
+        // 域名：根域等价于不限制
+        bool any_name = rule.qnames.empty();
+        for (size_t i = 0; i < rule.qnames.size(); ++i) {
+            uint64_t hash;
+            if (!hashName(rule.qnames[i], hash)) {
+                continue;
+            }
+            if (hash == kNameHashSeed) {
+                any_name = true;
+                continue;
+            }
+            uint32_t* row = qname_rows.find(hash);
+            setBit(row ? *row : *qname_rows.insert(hash, newRow()).first, r);
+        }
+        if (any_name) {
+            setBit(FIELD_QNAME, r);
+        } else {
+            used_fields |= 1u << FIELD_QNAME;
+        }
+
+        for (size_t i = 0; i < rule.qtypes.size(); ++i) {
+            uint32_t* row = qtype_rows.find(rule.qtypes[i]);
+            setBit(row ? *row : *qtype_rows.insert(rule.qtypes[i], newRow()).first, r);
+        }
+        for (size_t i = 0; i < rule.rcodes.size(); ++i) {
+            uint32_t& row = rcode_rows[rule.rcodes[i] & 0x0F];
+            if (row == kNoRow) {
+                row = newRow();
+            }
+            setBit(row, r);
+        }
+        for (size_t i = 0; i < rule.clients.size(); ++i) {
+            addPrefix(client_rows, rule.clients[i], r);
+        }
+        for (size_t i = 0; i < rule.answers.size(); ++i) {
+            addPrefix(answer_rows, rule.answers[i], r);
+        }
+
+        const size_t sizes[] = {0, rule.qtypes.size(), rule.rcodes.size(), rule.clients.size(), rule.answers.size()};
+        for (int field = FIELD_QTYPE; field < FIELD_COUNT; ++field) {
+            if (sizes[field] == 0) {
+                setBit(field, r);
+            } else {
+                used_fields |= 1u << field;
+            }
+        }
+    }
+}
+
+PolicyEngine::Decision PolicyEngine::evaluate(const PolicyRequest& request) const {
+    Decision decision = { default_action, SyntheticKind::None, -1 };
+    if (actions.empty()) {
+        return decision;
+    }
+
+    // 所有规则的候选位图，逐字段按位与
+    uint64_t acc[kMaxWords];
+    uint64_t hits[kMaxWords];
+    for (size_t w = 0; w < words; ++w) {
+        acc[w] = ~uint64_t(0);
+    }
+
+    const uint8_t* data = request.data;
+    size_t length = request.data ? request.length : 0;
+    bool has_question = length >= 12 && ((data[4] << 8) | data[5]) > 0;
+
+    // 问题域名：在线格式标签上从根向下计算各级后缀哈希（问题区不会出现压缩指针）
+    size_t offset = 12;
+    bool name_ok = false;
+    if (has_question) {
+        size_t labels[128];
+        size_t count = 0;
+        while (offset < length && count < 128) {
+            uint8_t len = data[offset];
+            if (len == 0) {
+                name_ok = true;
+                break;
+            }
+            if ((len & 0xC0) != 0 || offset + 1 + len > length) {
+                break;
+            }
+            labels[count++] = offset;
+            offset += 1 + len;
+        }
+        if (used_fields & (1u << FIELD_QNAME)) {
+            std::memcpy(hits, &rows[FIELD_QNAME * words], words * sizeof(uint64_t));
+            if (name_ok) {
+                uint64_t hash = kNameHashSeed;
+                for (size_t i = count; i > 0; --i) {
+                    hash = hashSuffix(hashLabel(data + labels[i - 1] + 1, data[labels[i - 1]]), hash);
+                    const uint32_t* row = qname_rows.find(hash);
+                    if (row) {
+                        orRow(*row, hits);
+                    }
+                }
+            }
+            andInto(acc, hits, words);
+        }
+    } else if (used_fields & (1u << FIELD_QNAME)) {
+        andInto(acc, &rows[FIELD_QNAME * words], words);
+    }
+
+    if (used_fields & (1u << FIELD_QTYPE)) {
+        std::memcpy(hits, &rows[FIELD_QTYPE * words], words * sizeof(uint64_t));
+        if (name_ok && offset + 3 <= length) {
+            uint32_t qtype = (static_cast<uint32_t>(data[offset + 1]) << 8) | data[offset + 2];
+            const uint32_t* row = qtype_rows.find(qtype);
+            if (row) {
+                orRow(*row, hits);
+            }
+        }
+        andInto(acc, hits, words);
+    }
+
+    // 响应码只对响应（QR=1）有意义
+    if (used_fields & (1u << FIELD_RCODE)) {
+        std::memcpy(hits, &rows[FIELD_RCODE * words], words * sizeof(uint64_t));
+        if (length >= 12 && (data[2] & 0x80)) {
+            orRow(rcode_rows[data[3] & 0x0F], hits);
+        }
+        andInto(acc, hits, words);
+    }
+
+    if (used_fields & (1u << FIELD_CLIENT)) {
+        std::memcpy(hits, &rows[FIELD_CLIENT * words], words * sizeof(uint64_t));
+        if (request.client) {
+            orPrefixes(client_rows, request.client_version, request.client, hits);
+        }
+        andInto(acc, hits, words);
+    }
+
+    if (used_fields & (1u << FIELD_ANSWER)) {
+        std::memcpy(hits, &rows[FIELD_ANSWER * words], words * sizeof(uint64_t));
+        if (request.message) {
+            RecordSpan answers = request.message->answers();
+            for (size_t i = 0; i < answers.size(); ++i) {
+                const DNSResourceRecord& rr = answers[i];
+                const uint8_t* addr = request.message->rdata(rr);
+                if (rr.type == static_cast<uint16_t>(DNSType::A) && rr.rdlength == 4) {
+                    orPrefixes(answer_rows, 4, addr, hits);
+                } else if (rr.type == static_cast<uint16_t>(DNSType::AAAA) && rr.rdlength == 16) {
+                    orPrefixes(answer_rows, 6, addr, hits);
+                }
+            }
+        }
+        andInto(acc, hits, words);
+    }
+
+    for (size_t w = 0; w < words; ++w) {
+        if (acc[w]) {
+            size_t rule = w * 64 + __builtin_ctzll(acc[w]);
+            if (rule < actions.size()) {
+                decision.action = actions[rule];
+                decision.respond = responds[rule];
+                decision.rule = static_cast<int>(rule);
+            }
+            break;
+        }
+    }
+    return decision;
+}
+
+size_t PolicyEngine::ruleCount() const noexcept {
+    return actions.size();
+}
+
+PolicyAction PolicyEngine::defaultAction() const noexcept {
+    return default_action;
+}
+
+bool PolicyEngine::parseRules(const std::string& text, std::vector<PolicyRule>& rules, PolicyAction& default_action,
+                              std::string* error) {
+    std::vector<PolicyRule> parsed;
+    PolicyAction fallback = default_action;
+    std::stringstream stream(text);
+    std::string line;
+    size_t number = 0;
+    while (std::getline(stream, line)) {
+        ++number;
+        size_t hash = line.find('#');
+        if (hash != std::string::npos) {
+            line.erase(hash);
+        }
+        std::stringstream tokens(line);
+        std::string keyword;
+        if (!(tokens >> keyword)) {
+            continue;
+        }
+
+        std::string message;
+        if (keyword == "default") {
+            std::string action;
+            if (!(tokens >> action) || !parseAction(action, fallback)) {
+                message = "无效的默认动作";
+            }
+        } else {
+            PolicyRule rule;
+            if (!parseAction(keyword, rule.action) || rule.action == PolicyAction::None) {
+                message = "未知的动作: " + keyword;
+            }
+            std::string token;
+            while (message.empty() && tokens >> token) {
+                parseField(token, rule, message);
+            }
+            if (message.empty() && rule.respond != SyntheticKind::None && rule.action != PolicyAction::Acknowledge) {
+                message = "只有 block 规则可以合成响应";
+            }
+            if (message.empty()) {
+                parsed.push_back(rule);
+            }
+        }
+        if (!message.empty()) {
+            if (error) {
+                *error = "第 " + std::to_string(number) + " 行: " + message;
+            }
+            return false;
+        }
+    }
+    rules.insert(rules.end(), parsed.begin(), parsed.end());
+    default_action = fallback;
+    return true;
+}
+
+std::shared_ptr<const PolicyEngine> PolicyEngine::load(const std::string& rules_path,
+                                                       const std::string& allowlist_path,
+                                                       const std::string& blocklist_path) {
+    std::vector<PolicyRule> rules;
+    PolicyAction default_action = PolicyAction::None;
+    bool any = false;
+
+    if (!allowlist_path.empty()) {
+        PolicyRule rule;
+        if (readDomainList(allowlist_path, PolicyAction::Forward, rule)) {
+            any = true;
+            if (!rule.qnames.empty()) {
+                rules.push_back(rule);
+            }
+        } else {
+            std::cerr << "警告: 无法读取白名单: " << allowlist_path << std::endl;
+        }
+    }
+
+    if (!rules_path.empty()) {
+        std::ifstream file(rules_path.c_str());
+        std::string error;
+        if (!file.is_open()) {
+            std::cerr << "警告: 无法读取策略文件: " << rules_path << std::endl;
+        } else {
+            std::stringstream content;
+            content << file.rdbuf();
+            if (PolicyEngine::parseRules(content.str(), rules, default_action, &error)) {
+                any = true;
+            } else {
+                std::cerr << "警告: 策略文件有误，已忽略: " << rules_path << " " << error << std::endl;
+            }
+        }
+    }
+
+    if (!blocklist_path.empty()) {
+        PolicyRule rule;
+        if (readDomainList(blocklist_path, PolicyAction::Acknowledge, rule)) {
+            any = true;
+            if (!rule.qnames.empty()) {
+                rules.push_back(rule);
+            }
+        } else {
+            std::cerr << "警告: 无法读取黑名单: " << blocklist_path << std::endl;
+        }
+    }
+
+    if (!any) {
+        return std::shared_ptr<const PolicyEngine>();
+    }
+    if (rules.size() > kMaxRules) {
+        std::cerr << "警告: 策略规则超过 " << kMaxRules << " 条，多余的规则被忽略" << std::endl;
+    }
+    return std::make_shared<const PolicyEngine>(rules, default_action);
+}
+
+uint32_t PolicyEngine::newRow() {
+    uint32_t row = static_cast<uint32_t>(rows.size() / words);
+    rows.resize(rows.size() + words, 0);
+    return row;
+}
+
+void PolicyEngine::setBit(uint32_t row, size_t rule) {
+    rows[row * words + rule / 64] |= uint64_t(1) << (rule % 64);
+}
+
+void PolicyEngine::addPrefix(PrefixTable& table, const IpPrefix& prefix, size_t rule) {
+    if (prefix.version == 4) {
+        uint32_t key = maskIPv4(prefix.addr, prefix.length);
+        size_t g = 0;
+        while (g < table.v4.size() && table.v4[g].length != prefix.length) {
+            ++g;
+        }
+        if (g == table.v4.size()) {
+            table.v4.push_back(IPv4Group());
+            table.v4[g].length = prefix.length;
+        }
+        uint32_t* row = table.v4[g].rows.find(key);
+        setBit(row ? *row : *table.v4[g].rows.insert(key, newRow()).first, rule);
+    } else {
+        IPv6Key key;
+        std::memcpy(key.data(), prefix.addr, key.size());
+        size_t g = 0;
+        while (g < table.v6.size() && table.v6[g].length != prefix.length) {
+            ++g;
+        }
+        if (g == table.v6.size()) {
+            table.v6.push_back(IPv6Group());
+            table.v6[g].length = prefix.length;
+        }
+        uint32_t* row = table.v6[g].rows.find(key);
+        setBit(row ? *row : *table.v6[g].rows.insert(key, newRow()).first, rule);
+    }
+}
+
+// 按每个出现过的前缀长度查一次表，命中的规则并入 acc
+void PolicyEngine::orPrefixes(const PrefixTable& table, uint8_t version, const uint8_t* addr, uint64_t* acc) const {
+    if (version == 4) {
+        for (size_t g = 0; g < table.v4.size(); ++g) {
+            const uint32_t* row = table.v4[g].rows.find(maskIPv4(addr, table.v4[g].length));
+            if (row) {
+                orRow(*row, acc);
+            }
+        }
+    } else if (version == 6) {
+        for (size_t g = 0; g < table.v6.size(); ++g) {
+            IPv6Key key;
+            maskIPv6(addr, table.v6[g].length, key.data());
+            const uint32_t* row = table.v6[g].rows.find(key);
+            if (row) {
+                orRow(*row, acc);
+            }
+        }
+    }
+}
+
+void PolicyEngine::orRow(uint32_t row, uint64_t* acc) const {
+    if (row == kNoRow) {
+        return;
+    }
+    const uint64_t* bits = &rows[row * words];
+    for (size_t w = 0; w < words; ++w) {
+        acc[w] |= bits[w];
+    }
+}
+
+void PolicyEngine::andInto(uint64_t* acc, const uint64_t* mask, size_t words) {
+    for (size_t w = 0; w < words; ++w) {
+        acc[w] &= mask[w];
+    }
+}
+
+} // namespace dns_parser
@@ -0,0 +1,276 @@
+#include "../../include/flows/public_suffix.h"
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <vector>
+
+namespace dns_parser {
+
+const size_t PublicSuffixList::npos;
+
+namespace {
+
+// 把 UTF-8 文本解码为码点，格式错误时返回 false
+bool decodeUtf8(const std::string& text, std::vector<uint32_t>& out) {
+    for (size_t i = 0; i < text.size();) {
+        uint8_t lead = static_cast<uint8_t>(text[i]);
+        size_t extra;
+        uint32_t cp;
+        if (lead < 0x80) {
+            extra = 0;
+            cp = lead;
+        } else if ((lead & 0xE0) == 0xC0) {
+            extra = 1;
+            cp = lead & 0x1F;
+        } else if ((lead & 0xF0) == 0xE0) {
+            extra = 2;
+            cp = lead & 0x0F;
+        } else if ((lead & 0xF8) == 0xF0) {
+            extra = 3;
+            cp = lead & 0x07;
+        } else {
+            return false;
+        }
+        if (i + extra >= text.size()) {
+            return false;
+        }
+        for (size_t k = 1; k <= extra; ++k) {
+            uint8_t next = static_cast<uint8_t>(text[i + k]);
+            if ((next & 0xC0) != 0x80) {
+                return false;
+            }
+            cp = (cp << 6) | (next & 0x3F);
+        }
+        out.push_back(cp);
+        i += extra + 1;
+    }
+    return true;
+}
+
+// RFC 3492 的参数
+const uint32_t kBase = 36;
+const uint32_t kTmin = 1;
+const uint32_t kTmax = 26;
+const uint32_t kSkew = 38;
+const uint32_t kDamp = 700;
+
+uint32_t adaptBias(uint32_t delta, uint32_t points, bool first) {
+    delta = first ? delta / kDamp : delta / 2;
+    delta += delta / points;
+    uint32_t k = 0;
+    while (delta > ((kBase - kTmin) * kTmax) / 2) {
+        delta /= kBase - kTmin;
+        k += kBase;
+    }
+    return k + (kBase - kTmin + 1) * delta / (delta + kSkew);
+}
+
+char punycodeDigit(uint32_t d) {
+    return static_cast<char>(d < 26 ? 'a' + d : '0' + (d - 26));
+}
+
+// 按 RFC 3492 把码点编码为 Punycode（不含 "xn--" 前缀），溢出时返回 false
+bool encodePunycode(const std::vector<uint32_t>& input, std::string& out) {
+    uint32_t basic = 0;
+    for (size_t i = 0; i < input.size(); ++i) {
+        if (input[i] < 0x80) {
+            out.push_back(static_cast<char>(input[i]));
+            ++basic;
+        }
+    }
+    if (basic) {
+        out.push_back('-');
+    }
+
+    uint32_t n = 0x80;
+    uint32_t delta = 0;
+    uint32_t bias = 72;
+    uint32_t handled = basic;
+    while (handled < input.size()) {
+        uint32_t next = std::numeric_limits<uint32_t>::max();
+        for (size_t i = 0; i < input.size(); ++i) {
+            if (input[i] >= n && input[i] < next) {
+                next = input[i];
+            }
+        }
+        if (next - n > (std::numeric_limits<uint32_t>::max() - delta) / (handled + 1)) {
+            return false;
+        }
+        delta += (next - n) * (handled + 1);
+        n = next;
+        for (size_t i = 0; i < input.size(); ++i) {
+            if (input[i] < n && ++delta == 0) {
+                return false;
+            }
+            if (input[i] != n) {
+                continue;
+            }
+            uint32_t q = delta;
+            for (uint32_t k = kBase;; k += kBase) {
+                uint32_t t = k <= bias ? kTmin : (k >= bias + kTmax ? kTmax : k - bias);
+                if (q < t) {
+                    break;
+                }
+                out.push_back(punycodeDigit(t + (q - t) % (kBase - t)));
+                q = (q - t) / (kBase - t);
+            }
+            out.push_back(punycodeDigit(q));
+            bias = adaptBias(delta, handled + 1, handled == basic);
+            delta = 0;
+            ++handled;
+        }
+        ++delta;
+        ++n;
+    }
+    return true;
+}
+
+// 把规则的一个标签转为线格式使用的小写 ASCII 形式
+bool toAsciiLabel(const std::string& label, std::string& out) {
+    bool ascii = true;
+    for (size_t i = 0; i < label.size(); ++i) {
+        if (static_cast<uint8_t>(label[i]) >= 0x80) {
+            ascii = false;
+            break;
+        }
+    }
+    if (ascii) {
+        for (size_t i = 0; i < label.size(); ++i) {
+            out.push_back(static_cast<char>(foldByte(static_cast<uint8_t>(label[i]))));
+        }
+        return true;
+    }
+    std::vector<uint32_t> points;
+    if (!decodeUtf8(label, points)) {
+        return false;
+    }
+    out += "xn--";
+    return encodePunycode(points, out);
+}
+
+} // namespace
+
+PublicSuffixList::PublicSuffixList() : rules(0) {
+}
+
+bool PublicSuffixList::addRule(const std::string& rule) {
+    std::string body = rule;
+    uint8_t flag = NODE_RULE;
+    if (!body.empty() && body[0] == '!') {
+        flag = NODE_EXCEPTION;
+        body.erase(0, 1);
+    } else if (body.size() > 2 && body[0] == '*' && body[1] == '.') {
+        flag = NODE_WILDCARD;
+        body.erase(0, 2);
+    }
+
+    std::string ascii;
+    size_t start = 0;
+    while (start <= body.size()) {
+        size_t dot = body.find('.', start);
+        if (dot == std::string::npos) {
+            dot = body.size();
+        }
+        std::string label = body.substr(start, dot - start);
+        size_t before = ascii.size();
+        if (label.empty() || label.find('*') != std::string::npos || !toAsciiLabel(label, ascii) ||
+            ascii.size() - before > 63) {
+            return false;
+        }
+        if (dot < body.size()) {
+            ascii.push_back('.');
+        }
+        start = dot + 1;
+    }
+
+    NameHash hash;
+    if (ascii.size() > 253 || !hash.assign(ascii.data(), ascii.size()) ||
+        (flag == NODE_EXCEPTION && hash.labels < 2)) {
+        return false;
+    }
+    // 每一级后缀都是节点，查找时据此判断是否还有更长的规则
+    for (size_t i = 1; i < hash.labels; ++i) {
+        nodes[hash.suffixes[i]];
+    }
+    nodes[hash.suffixes[0]] |= flag;
+    ++rules;
+    return true;
+}
+
+size_t PublicSuffixList::parse(const std::string& text) {
+    std::istringstream stream(text);
+    std::string line;
+    size_t added = 0;
+    while (std::getline(stream, line)) {
+        std::istringstream words(line);
+        std::string rule;
+        if (!(words >> rule) || rule.compare(0, 2, "//") == 0) {
+            continue;
+        }
+        if (addRule(rule)) {
+            ++added;
+        }
+    }
+    return added;
+}
+
+std::shared_ptr<const PublicSuffixList> PublicSuffixList::load(const std::string& path) {
+    if (path.empty()) {
+        return std::shared_ptr<const PublicSuffixList>();
+    }
+    std::ifstream file(path.c_str());
+    if (!file.is_open()) {
+        std::cerr << "警告: 无法读取公共后缀列表: " << path << std::endl;
+        return std::shared_ptr<const PublicSuffixList>();
+    }
+    std::stringstream content;
+    content << file.rdbuf();
+    std::shared_ptr<PublicSuffixList> list = std::make_shared<PublicSuffixList>();
+    list->parse(content.str());
+    return list;
+}
+
+size_t PublicSuffixList::suffixLabels(const NameHash& hash) const {
+    if (hash.labels == 0) {
+        return 0;
+    }
+    // 默认规则 "*"：顶级域本身是公共后缀
+    size_t suffix = 1;
+    uint8_t parent = 0;
+    for (size_t k = 1; k <= hash.labels; ++k) {
+        if (parent & NODE_WILDCARD) {
+            suffix = k;
+        }
+        const uint8_t* node = nodes.find(hash.suffixes[hash.labels - k]);
+        if (!node) {
+            break;
+        }
+        if (*node & NODE_EXCEPTION) {
+            return k - 1;
+        }
+        if (*node & NODE_RULE) {
+            suffix = k;
+        }
+        parent = *node;
+    }
+    return suffix;
+}
+
+size_t PublicSuffixList::registrableOffset(const NameHash& hash) const {
+    size_t suffix = suffixLabels(hash);
+    if (suffix >= hash.labels) {
+        return npos;
+    }
+    return hash.offsets[hash.labels - suffix - 1];
+}
+
+size_t PublicSuffixList::registrableOffset(const char* name, size_t length) const {
+    NameHash hash;
+    if (!hash.assign(name, length)) {
+        return npos;
+    }
+    return registrableOffset(hash);
+}
+
+} // namespace dns_parser
@@ -0,0 +1,120 @@
+#include "../../include/flows/query_tracker.h"
+#include "../../include/flows/flow_table.h"
+#include "../../include/tools/hash.h"
+
+namespace dns_parser {
+
+const uint64_t QueryTracker::kTimerTag;
+
+size_t QueryTracker::KeyHash::operator()(const Key& key) const {
+    return static_cast<size_t>(mix64(FourTupleHash()(key.tuple) ^ key.id));
+}
+
+QueryTracker::QueryTracker(TimerWheel& timers, size_t max_pending, uint32_t timeout_ms)
+    : timers(timers), max_pending(max_pending), timeout_ms(timeout_ms), index(max_pending * 2),
+      matched_count(0), timeout_count(0), unmatched_count(0), dropped_count(0), total_rtt(0) {
+}
+
+QueryTracker::~QueryTracker() {
+    for (size_t i = 0; i < entries.size(); ++i) {
+        if (entries[i].live) {
+            timers.cancel(entries[i].timer);
+        }
+    }
+}
+
+void QueryTracker::setLimits(size_t max_pending, uint32_t timeout_ms) {
+    this->max_pending = max_pending;
+    this->timeout_ms = timeout_ms;
+}
+
+void QueryTracker::onQuery(const FourTuple& tuple, uint16_t id, uint64_t now_ms) {
+    Key key;
+    key.tuple = tuple;
+    key.id = id;
+
+    uint32_t* existing = index.find(key);
+    if (existing) {
+        // 重传：以最后一次发送为准
+        Entry& entry = entries[*existing];
+        entry.sent_ms = now_ms;
+        timers.reschedule(entry.timer, now_ms + timeout_ms);
+        return;
+    }
+    if (index.size() >= max_pending) {
+        ++dropped_count;
+        return;
+    }
+
+    uint32_t slot;
+    if (!free_entries.empty()) {
+        slot = free_entries.back();
+        free_entries.pop_back();
+    } else {
+        slot = static_cast<uint32_t>(entries.size());
+        entries.push_back(Entry());
+    }
+    Entry& entry = entries[slot];
+    entry.key = key;
+    entry.sent_ms = now_ms;
+    entry.timer = timers.schedule(now_ms + timeout_ms, kTimerTag | slot);
+    entry.live = true;
+    index.insert(key, slot);
+}
+
+bool QueryTracker::onResponse(const FourTuple& tuple, uint16_t id, uint64_t now_ms, uint64_t* rtt_ms) {
+    Key key;
+    key.tuple = tuple;
+    key.id = id;
+
+    uint32_t* existing = index.find(key);
+    if (!existing) {
+        ++unmatched_count;
+        return false;
+    }
+    uint32_t slot = *existing;
+    uint64_t rtt = now_ms >= entries[slot].sent_ms ? now_ms - entries[slot].sent_ms : 0;
+    timers.cancel(entries[slot].timer);
+    removeEntry(slot);
+
+    ++matched_count;
+    total_rtt += rtt;
+    if (rtt_ms) {
+        *rtt_ms = rtt;
+    }
+    return true;
+}
+
+void QueryTracker::onTimer(uint64_t data) {
+    uint32_t slot = static_cast<uint32_t>(data & (kTimerTag - 1));
+    if (slot >= entries.size() || !entries[slot].live) {
+        return;
+    }
+    removeEntry(slot);
+    ++timeout_count;
+}
+
+size_t QueryTracker::size() const noexcept {
+    return index.size();
+}
+
+QueryTracker::Stats QueryTracker::stats() const noexcept {
+    Stats snapshot;
+    snapshot.pending = index.size();
+    snapshot.matched = matched_count;
+    snapshot.timeouts = timeout_count;
+    snapshot.unmatched = unmatched_count;
+    snapshot.dropped = dropped_count;
+    snapshot.total_rtt_ms = total_rtt;
+    return snapshot;
+}
+
+void QueryTracker::removeEntry(uint32_t slot) {
+    Entry& entry = entries[slot];
+    index.erase(entry.key);
+    entry.live = false;
+    entry.timer = TimerWheel::kInvalidHandle;
+    free_entries.push_back(slot);
+}
+
+} // namespace dns_parser
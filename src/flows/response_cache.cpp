@@ -0,0 +1,153 @@
+#include "../../include/flows/response_cache.h"
+#include "../../include/tools/hash.h"
+#include <algorithm>
+#include <cstring>
+
+namespace dns_parser {
+
+const size_t ResponseCache::kWays;
+
+namespace {
+
+// EDNS OPT 伪记录的 TTL 字段不是生存时间
+const uint16_t kTypeOPT = 41;
+
+// 事务 ID 占报文前两个字节
+const size_t kIdLength = 2;
+
+} // namespace
+
+ResponseCache::ResponseCache(size_t capacity, uint32_t negative_ttl, uint32_t max_ttl)
+    : negative_ttl(negative_ttl), max_ttl(max_ttl), live(0),
+      hit_count(0), miss_count(0), insert_count(0), eviction_count(0), expiration_count(0) {
+    size_t sets = 1;
+    while (sets * kWays < capacity) {
+        sets <<= 1;
+    }
+    set_mask = sets - 1;
+    entries.resize(sets * kWays);
+}
+
+uint64_t ResponseCache::hashPacket(const char* data, size_t len) {
+    if (len <= kIdLength) {
+        return hashBytes(data, 0, len);
+    }
+    return hashBytes(data + kIdLength, len - kIdLength, len);
+}
+
+const Message* ResponseCache::lookup(const std::string& packet, uint32_t now) {
+    if (packet.size() <= kIdLength) {
+        bump(miss_count);
+        return nullptr;
+    }
+
+    uint64_t hash = hashPacket(packet.data(), packet.size());
+    Entry* set = &entries[(hash & set_mask) * kWays];
+    for (size_t i = 0; i < kWays; ++i) {
+        Entry& entry = set[i];
+        if (!entry.message || entry.hash != hash) {
+            continue;
+        }
+        if (entry.expire <= now) {
+            release(entry);
+            bump(expiration_count);
+            continue;
+        }
+        if (entry.payload.size() + kIdLength == packet.size() &&
+            std::memcmp(entry.payload.data(), packet.data() + kIdLength, entry.payload.size()) == 0) {
+            bump(hit_count);
+            return entry.message.get();
+        }
+    }
+
+    bump(miss_count);
+    return nullptr;
+}
+
+void ResponseCache::insert(const std::string& packet, const Message& message, uint32_t now) {
+    if (packet.size() <= kIdLength) {
+        return;
+    }
+    uint32_t ttl = cacheTtl(message);
+    if (ttl == 0) {
+        return;
+    }
+
+    uint64_t hash = hashPacket(packet.data(), packet.size());
+    Entry* set = &entries[(hash & set_mask) * kWays];
+
+    // 优先使用空位或已过期的条目，否则淘汰最早过期的条目
+    Entry* victim = nullptr;
+    for (size_t i = 0; i < kWays; ++i) {
+        Entry& entry = set[i];
+        if (!entry.message) {
+            victim = &entry;
+            break;
+        }
+        if (entry.expire <= now) {
+            release(entry);
+            bump(expiration_count);
+            victim = &entry;
+            break;
+        }
+        if (!victim || entry.expire < victim->expire) {
+            victim = &entry;
+        }
+    }
+    if (victim->message) {
+        release(*victim);
+        bump(eviction_count);
+    }
+
+    victim->hash = hash;
+    victim->expire = now + ttl;
+    victim->payload.assign(packet.data() + kIdLength, packet.size() - kIdLength);
+    victim->message.reset(new Message(message));
+    ++live;
+    bump(insert_count);
+}
+
+ResponseCache::Stats ResponseCache::stats() const {
+    Stats snapshot;
+    snapshot.hits = hit_count.load(std::memory_order_relaxed);
+    snapshot.misses = miss_count.load(std::memory_order_relaxed);
+    snapshot.inserts = insert_count.load(std::memory_order_relaxed);
+    snapshot.evictions = eviction_count.load(std::memory_order_relaxed);
+    snapshot.expirations = expiration_count.load(std::memory_order_relaxed);
+    return snapshot;
+}
+
+void ResponseCache::clear() {
+    for (size_t i = 0; i < entries.size(); ++i) {
+        if (entries[i].message) {
+            release(entries[i]);
+        }
+    }
+}
+
+size_t ResponseCache::size() const noexcept {
+    return live;
+}
+
+uint32_t ResponseCache::cacheTtl(const Message& message) const {
+    // 三个区段的记录连续存放，一次遍历即可
+    bool found = false;
+    uint32_t ttl = max_ttl;
+    for (size_t i = 0; i < message.records.size(); ++i) {
+        const DNSResourceRecord& rr = message.records[i];
+        if (rr.type == kTypeOPT) {
+            continue;
+        }
+        ttl = std::min(ttl, rr.ttl);
+        found = true;
+    }
+    return found ? ttl : std::min(negative_ttl, max_ttl);
+}
+
+void ResponseCache::release(Entry& entry) {
+    entry.message.reset();
+    entry.payload.clear();
+    --live;
+}
+
+} // namespace dns_parser
@@ -11,6 +11,24 @@
 
 #include "../../include/plugin/plugin.h"
 #include "../../include/flows/dns_parser.h"
+#include "../../include/flows/header_classifier.h"
+#include "../../include/analytics/passive_dns.h"
+#include "../../include/analytics/protocol_stats.h"
+#include "../../include/analytics/subnet_counters.h"
+#include "../../include/flows/response_cache.h"
+#include "../../include/config/config_store.h"
+#include "../../include/flows/flow_table.h"
+#include "../../include/flows/query_tracker.h"
+#include "../../include/flows/dns_encoder.h"
+#include "../../include/flows/load_shedder.h"
+#include "../../include/tools/name_check.h"
+#include "../../include/tools/sharded.h"
+#include "../../include/tools/stage_timer.h"
+#include <arpa/inet.h>
+#include <algorithm>
+#include <atomic>
+#include <ctime>
+#include <memory>
 
 // 全局变量
 
@@ -18,6 +36,180 @@
 static std::string projectRoot;
 // 全局配置文件路径
 static std::string configFilePath;
+// 运行时配置快照（Filter 无锁读取）与配置文件监视线程
+static dns_parser::ConfigStore configStore;
+static std::unique_ptr<dns_parser::ConfigWatcher> configWatcher;
+// 流缓冲区共享的进程级内存预算（只在申请和归还缓冲块时访问）
+static dns_parser::MemoryBudget memoryBudget;
+
+// 每次 Filter 推进时间轮的最大工作量
+static const size_t kTimerStepBudget = 64;
+
+// 阶段计时的重置代数：StageStats 请求重置时递增，各线程在下一个数据包开始时清空自己的直方图
+static std::atomic<uint64_t> stageResetEpoch(0);
+
+// 单调递增的线程内计数，只有所属线程写入，其他线程可随时读取
+static inline void bump(std::atomic<uint64_t>& counter, uint64_t n = 1) {
+    counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+// 每个线程的插件处理计数（协议层面的计数见 ProtocolStats）
+struct PacketCounters {
+    std::atomic<uint64_t> cache_reuses;     // 复用缓存解析结果的响应
+    std::atomic<uint64_t> blocked;          // 策略判定为拦截的数据包
+    std::atomic<uint64_t> synthesized;      // 由插件合成响应代为应答的查询
+
+    PacketCounters() : cache_reuses(0), blocked(0), synthesized(0) {}
+};
+
+// 每个工作线程的全部可变状态，按 TASK::Thread 分片并按缓存行对齐，
+// 数据路径上不与其他线程共享任何可写数据；汇总视图由 Remove/CacheStats 等合并步骤构建
+struct alignas(dns_parser::kCacheLineSize) ThreadState {
+    dns_parser::TimerWheel timers;      // 驱动流超时和查询超时（刻度为毫秒）
+    dns_parser::BufferPool pool;
+    dns_parser::FlowTable flows;
+    dns_parser::QueryTracker queries;
+    dns_parser::ResponseCache cache;    // 响应去重缓存
+    dns_parser::NameInterner names;     // 本线程私有的域名驻留表，解析结果、缓存和被动 DNS 中的 ID 都指向它，
+                                        // 只在本线程内有意义，写满回收后重新编号
+    dns_parser::PassiveDNS passive;     // 被动 DNS 分片
+    dns_parser::LoadShedder shedder;    // 过载降级控制
+    dns_parser::StageRecorder stages;   // 各处理阶段的耗时直方图
+    dns_parser::ProtocolStats protocol; // 协议计数（顺序锁快照）
+    dns_parser::SubnetCounters subnets; // 按 EDNS 客户端子网的计数
+    PacketCounters counters;
+    Message message;                    // 复用的解析结果，保留扩容后的容量
+    std::string frame;                  // 从流缓冲区切出的消息，保留容量逐条复用
+    uint64_t config_version;            // 已应用的配置版本
+    uint64_t stage_epoch;               // 已应用的阶段计时重置代数
+
+    // 导入任务容量不足以原地写入合成响应时使用的导出任务，在本线程下一次 Filter 之前有效
+    TASK reply;
+    unsigned char reply_buffer[dns_parser::DNSEncoder::kMaxResponseSize];
+
+    ThreadState(const dns_parser::RuntimeConfig& config, uint64_t now_ms)
+        : timers(now_ms),
+          pool(memoryBudget, 4096, std::max(config.c2s_buffer_size, config.s2c_buffer_size), config.huge_pages),
+          flows(pool, timers, config.max_flows, config.c2s_buffer_size, config.s2c_buffer_size,
+                config.flow_timeout_ms),
+          queries(timers, config.max_pending_queries, config.query_timeout_ms),
+          names(config.max_names, false),
+          passive(1 << 20, 86400, names),
+          shedder(config.shedding, now_ms),
+          subnets(config.max_subnets, config.subnet_ipv4_prefix, config.subnet_ipv6_prefix),
+          config_version(config.version),
+          stage_epoch(stageResetEpoch.load(std::memory_order_relaxed)) {
+    }
+
+    // 驻留表写满时回收：被动 DNS 只保留仍有映射的名字，缓存的消息持有旧 ID，一并清空
+    void recycleNames() {
+        cache.clear();
+        passive.compactNames();
+    }
+
+    // 小步推进时间轮，按类别分发到期的定时器
+    void advance(uint64_t now_ms) {
+        timers.advance(now_ms, kTimerStepBudget, [this, now_ms](uint64_t data) {
+            if ((data & ~(dns_parser::FlowTable::kTimerTag - 1)) == dns_parser::FlowTable::kTimerTag) {
+                flows.onTimer(data, now_ms);
+            } else {
+                queries.onTimer(data);
+            }
+        });
+    }
+};
+static dns_parser::Sharded<ThreadState> threadStates;
+
+// 能取得配置快照的线程都必须有独立的状态分片
+static_assert(dns_parser::Sharded<ThreadState>::kMaxShards >= dns_parser::ConfigStore::kMaxReaders,
+              "线程状态分片数不能少于配置读者数");
+
+// 获取线程对应的状态，未经 Single 初始化的线程在首次使用时创建；配置版本变化时更新上限
+// （缓冲池的分级上限和大页选项在创建时确定），并清空按旧解析选项（DNSSEC 跳过、域名规范化、
+// 公共后缀列表）得到的缓存结果。线程编号超出分片上限时返回 nullptr
+static ThreadState* threadStateFor(unsigned short thread, const dns_parser::RuntimeConfig& config, uint64_t now_ms) {
+    ThreadState* state = threadStates.find(thread);
+    if (!state) {
+        memoryBudget.setLimit(config.memory_budget);
+        return threadStates.local(thread, config, now_ms);
+    }
+    if (state->config_version != config.version) {
+        memoryBudget.setLimit(config.memory_budget);
+        state->flows.setLimits(config.max_flows, config.c2s_buffer_size, config.s2c_buffer_size,
+                               config.flow_timeout_ms);
+        state->queries.setLimits(config.max_pending_queries, config.query_timeout_ms);
+        state->shedder.setPolicy(config.shedding);
+        state->subnets.setAggregation(config.subnet_ipv4_prefix, config.subnet_ipv6_prefix);
+        state->cache.clear();
+        state->config_version = config.version;
+    }
+    return state;
+}
+
+// 宿主按线程设置的信号：SetPacketTime 设置的数据包时间（毫秒，0 表示未设置）和
+// SetQueuePressure 报告的队列占用百分比。宿主可能逐包设置，每个线程单独占一个缓存行
+struct alignas(dns_parser::kCacheLineSize) HostSignals {
+    std::atomic<unsigned long long> millis;
+    std::atomic<unsigned char> pressure;
+};
+static HostSignals hostSignals[dns_parser::Sharded<ThreadState>::kMaxShards];
+
+// 线程编号超出分片上限时返回 nullptr，不与其他线程共用信号
+static HostSignals* hostSignalsFor(unsigned short thread) {
+    return thread < dns_parser::Sharded<ThreadState>::kMaxShards ? &hostSignals[thread] : nullptr;
+}
+
+// 获取线程当前的数据包时间（毫秒）
+// 宿主未提供时间戳时退回 CLOCK_MONOTONIC_COARSE，走 vDSO，不产生系统调用
+static uint64_t packetMillis(unsigned short thread) {
+    HostSignals* signals = hostSignalsFor(thread);
+    unsigned long long stamp = signals ? signals->millis.load(std::memory_order_relaxed) : 0;
+    if (stamp) {
+        return stamp;
+    }
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000 + ts.tv_nsec / 1000000;
+}
+
+// 单调时钟（纳秒），用于测量处理耗时
+static uint64_t monotonicNanos() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + ts.tv_nsec;
+}
+
+// 以客户端到服务端方向构造流的四元组
+static FourTuple flowKey(const TASK& task) {
+    const ENTITY& client = task.Source.Role == 'C' ? task.Source : task.Target;
+    const ENTITY& server = task.Source.Role == 'C' ? task.Target : task.Source;
+    FourTuple key;
+    memset(&key, 0, sizeof(key));
+    key.srcIPvN = client.IPvN;
+    key.dstIPvN = server.IPvN;
+    if (client.IPvN == 6) {
+        memcpy(key.srcIPv6, client.IPv6, 16);
+        memcpy(key.dstIPv6, server.IPv6, 16);
+    } else {
+        key.srcIPv4 = client.IPv4;
+        key.dstIPv4 = server.IPv4;
+    }
+    key.sourcePort = client.Port;
+    key.destPort = server.Port;
+    return key;
+}
+
+// 判断数据是否为一个完整的带 2 字节长度前缀的 DNS 消息（DNS over TCP 的典型首包）。
+// 宿主不提供传输层协议，只凭长度前缀判断时约 1/65536 的 UDP 报文（事务 ID 恰好等于
+// 长度减 2）会被误判，因此还要求去掉前缀后能通过头部检查、整体作为报文时不能通过；
+// 两种解释都成立的数据按报文处理，不会把连接标记为流式传输
+static bool isStreamFrame(const unsigned char* data, unsigned int length, bool fromClient) {
+    if (length < 14 || static_cast<unsigned int>((data[0] << 8) | data[1]) != length - 2) {
+        return false;
+    }
+    return dns_parser::classifyHeader(data + 2, length - 2, fromClient) == dns_parser::HeaderCheck::Ok &&
+           dns_parser::classifyHeader(data, length, fromClient) != dns_parser::HeaderCheck::Ok;
+}
 
 // 获取当前目录的工具函数
 std::string getCurrentDir() {
@@ -47,6 +239,8 @@ std::string getProjectRoot() {
     return "./";
 }
 
+
+
 // 判断文件是否存在
 bool fileExists(const std::string& filepath) {
     std::ifstream file(filepath);
@@ -73,12 +267,12 @@ int Create(unsigned short Version, unsigned short Amount, const char *Option) {
     }
     std::cout << "配置文件路径: " << configFilePath << std::endl;
 
-    // 注释掉配置文件检查，因为这只是测试
-    // if (!fileExists(configFilePath)) {
-    //     std::cerr << "错误: 配置文件不存在: " << configFilePath << std::endl;
-    //     return -1;
-    // }
-    
+    // 加载配置并启动监视线程，配置文件缺失时使用默认配置，文件出现后自动加载
+    configWatcher.reset(new dns_parser::ConfigWatcher(configStore, configFilePath));
+    if (!configWatcher->start()) {
+        std::cerr << "警告: 无法加载配置文件，使用默认配置: " << configFilePath << std::endl;
+    }
+
     std::cout << "DNS数据包解析插件初始化完成" << std::endl;
     return 0;
 }
@@ -92,51 +286,530 @@ int Single(unsigned short Thread, const char *Option) {
         std::cout << "Option: " << Option << std::endl;
     }
 
+    // 预先创建本线程的状态分片，避免首包承担分配开销
+    const dns_parser::RuntimeConfig* config = configStore.acquire(Thread);
+    if (!config) {
+        std::cerr << "错误: 线程编号 " << Thread << " 超出上限 " << dns_parser::ConfigStore::kMaxReaders
+                  << "，该线程的数据包不会被处理" << std::endl;
+        return -1;
+    }
+    threadStateFor(Thread, *config, packetMillis(Thread));  // 编号已由 acquire 检查
+    // 下线而不是宣告静止：收不到数据包的线程不会再报告静止，不能拖住旧快照的回收；
+    // 首个数据包的 acquire 会让它重新上线
+    configStore.offline(Thread);
+
     std::cout << "线程 " << Thread << " 初始化完成" << std::endl;
     return 0;
 }
 
 // ------------------------------ 3. Filter 处理函数 ------------------------------
-// 数据过滤函数，处理每个数据包
-int Filter(TASK *Import, TASK **Export) {
-    // 初始化导出参数
-    *Export = Import;
+// 单个数据包的处理上下文
+struct PacketContext {
+    ThreadState& state;
+    FourTuple key;          // 客户端到服务端方向的四元组
+    bool verbose;           // 是否输出消息详情
+    uint64_t now_ms;        // 数据包时间（毫秒）
+    const ENTITY& client;   // 客户端一侧的通信实体
+    const dns_parser::PolicyEngine* policy;     // 当前快照的策略，未配置时为 nullptr
+    dns_parser::PolicyAction verdict;           // 本数据包内各消息判定的合并结果
+    dns_parser::SyntheticKind respond;          // 拦截规则要求的合成响应
+    dns_parser::ShedLevel depth;                // 过载降级决定的处理深度
+    bool skip_dnssec;                           // DNSSEC 记录只记下位置
+    bool normalize_names;                       // 域名转为小写并检查
+    const dns_parser::PublicSuffixList* suffixes;   // 当前快照的公共后缀列表，未配置时为 nullptr
+    bool time_output;                           // 启用过载降级时单独计量输出耗时
+    uint64_t output_ns;                         // 本数据包输出消息详情的耗时（纳秒）
+};
 
-    // 检查输入参数
-    if (!Import || !Import->Buffer || Import->Length <= 0) {
-        return 0;
+// 输出消息详情。打印耗时取决于终端或日志的吞吐而不是解析负载，单独计时后
+// 从过载降级的时延信号中扣除；transactionId 为 nullptr 时使用消息自身的 ID
+static void printDetails(PacketContext& ctx, const Message& message, bool isQuery, const uint16_t* transactionId) {
+    uint64_t start = ctx.time_output ? monotonicNanos() : 0;
+    if (transactionId) {
+        dns_parser::DNSParser::printMessageDetails(message, isQuery, *transactionId);
+    } else {
+        dns_parser::DNSParser::printMessageDetails(message, isQuery);
+    }
+    if (ctx.time_output) {
+        ctx.output_ns += monotonicNanos() - start;
+    }
+}
+
+// 对一条消息做策略判定，同一数据包内多条消息（流式传输）以拦截优先
+static void applyPolicy(PacketContext& ctx, const std::string& packetData, const Message* message) {
+    if (!ctx.policy) {
+        return;
+    }
+    dns_parser::PolicyRequest request;
+    request.data = reinterpret_cast<const uint8_t*>(packetData.data());
+    request.length = packetData.size();
+    request.message = message;
+    request.client_version = ctx.client.IPvN;
+    request.client = ctx.client.IPvN == 6 ? ctx.client.IPv6 : reinterpret_cast<const uint8_t*>(&ctx.client.IPv4);
+    dns_parser::PolicyEngine::Decision decision = ctx.policy->evaluate(request);
+    if (decision.action == dns_parser::PolicyAction::Acknowledge || ctx.verdict == dns_parser::PolicyAction::None) {
+        ctx.verdict = decision.action;
+        ctx.respond = decision.respond;
     }
+}
 
-    // 判断是查询还是响应（根据源端角色）
-    bool isQuery = (Import->Source.Role == 'C');
-    
-    // 获取数据包内容（直接是应用层数据）
-    std::string packetData(reinterpret_cast<char*>(Import->Buffer), Import->Length);
+// 用合成响应代为应答被拦截的 UDP 查询：导入任务的容量足够时原地改写，
+// 否则写入线程的导出任务。响应方向与查询相反，动作为转发
+static bool synthesizeReply(ThreadState& state, TASK* Import, TASK** Export,
+                            const dns_parser::SyntheticResponse& params) {
+    size_t size = dns_parser::DNSEncoder::responseSize(Import->Buffer, Import->Length, params);
+    if (size == 0) {
+        return false;
+    }
+    TASK* reply = Import;
+    if (Import->Volume < size) {
+        state.reply = *Import;
+        state.reply.Buffer = state.reply_buffer;
+        state.reply.Volume = sizeof(state.reply_buffer);
+        reply = &state.reply;
+    }
+    reply->Length = static_cast<unsigned int>(
+        dns_parser::DNSEncoder::encode(Import->Buffer, Import->Length, params, reply->Buffer, reply->Volume));
+    std::swap(reply->Source, reply->Target);
+    reply->Action = static_cast<unsigned char>(dns_parser::PolicyAction::Forward);
+    *Export = reply;
+    bump(state.counters.synthesized);
+    return true;
+}
+
+// 完整解析的消息中的 OPT 伪记录计入 EDNS 计数，客户端子网计入按子网的计数
+static void observeEdns(PacketContext& ctx, const Message& message, bool isQuery) {
+    const RData* opt = message.opt();
+    if (!opt) {
+        return;
+    }
+    ctx.state.protocol.recordEdns(*opt);
+    if (opt->kind == RDataKind::OPT) {
+        ctx.state.subnets.record(opt->opt, isQuery);
+    }
+}
+
+// 解析出的第一个问题的域名检查结果计入域名计数
+static void observeNames(PacketContext& ctx, const Message& message) {
+    if (ctx.normalize_names && !message.questions.empty()) {
+        ctx.state.protocol.recordName(message.questions[0].name_flags);
+    }
+}
+
+// 处理一个完整的 DNS 消息
+static void processMessage(PacketContext& ctx, const std::string& packetData, bool isQuery) {
+    uint32_t now = static_cast<uint32_t>(ctx.now_ms / 1000);
+    ctx.state.protocol.recordMessage(reinterpret_cast<const uint8_t*>(packetData.data()), packetData.size());
+
+    // 查询/响应按事务 ID 关联，未应答的查询由时间轮超时
+    if (packetData.size() >= 2) {
+        uint16_t transactionId = static_cast<uint16_t>(
+            (static_cast<unsigned char>(packetData[0]) << 8) | static_cast<unsigned char>(packetData[1]));
+        if (isQuery) {
+            ctx.state.queries.onQuery(ctx.key, transactionId, ctx.now_ms);
+        } else {
+            ctx.state.queries.onResponse(ctx.key, transactionId, ctx.now_ms);
+        }
+    }
+
+    // 抽样计数深度：只计数、关联查询和按线格式判定策略，不解析
+    if (ctx.depth == dns_parser::ShedLevel::Sampling) {
+        applyPolicy(ctx, packetData, nullptr);
+        ctx.state.stages.lap(dns_parser::Stage::Analytics);
+        return;
+    }
+
+    if (ctx.state.names.full()) {
+        ctx.state.recycleNames();
+    }
+
+    // 与已缓存响应逐字节相同（事务 ID 除外）时直接复用解析结果
+    if (!isQuery) {
+        const Message* cached = ctx.state.cache.lookup(packetData, now);
+        if (cached) {
+            bump(ctx.state.counters.cache_reuses);
+            applyPolicy(ctx, packetData, cached);
+            ctx.state.passive.observe(*cached, now);
+            observeEdns(ctx, *cached, isQuery);
+            observeNames(ctx, *cached);
+            ctx.state.stages.lap(dns_parser::Stage::Analytics);
+
+            uint16_t transactionId = static_cast<uint16_t>(
+                (static_cast<unsigned char>(packetData[0]) << 8) | static_cast<unsigned char>(packetData[1]));
+            if (ctx.verbose) {
+                printDetails(ctx, *cached, isQuery, &transactionId);
+            }
+            ctx.state.stages.lap(dns_parser::Stage::Output);
+            return;
+        }
+    }
+    ctx.state.stages.lap(dns_parser::Stage::Analytics);
     
-    // 创建消息结构
-    Message message;
+    // 线程复用的消息结构，解析前清空
+    Message& message = ctx.state.message;
     
-    // 解析 DNS 数据包
+    // 解析 DNS 数据包（域名写入本线程的驻留表，避免逐包构造字符串）
+    dns_parser::ParseOptions options;
+    options.intern_names = true;
+    options.interner = &ctx.state.names;
+    options.questions_only = ctx.depth == dns_parser::ShedLevel::Questions;
+    options.skip_dnssec = ctx.skip_dnssec;
+    options.normalize_names = ctx.normalize_names;
+    options.public_suffixes = ctx.suffixes;
+    options.stages = &ctx.state.stages;
+    dns_parser::ParseError error = dns_parser::ParseError::None;
+    options.error = &error;
     bool parseSuccess = false;
     if (isQuery) {
-        parseSuccess = dns_parser::DNSParser::parseQuery(packetData, message);
+        parseSuccess = dns_parser::DNSParser::parseQuery(packetData, message, options);
     } else {
-        parseSuccess = dns_parser::DNSParser::parseResponse(packetData, message);
+        parseSuccess = dns_parser::DNSParser::parseResponse(packetData, message, options);
     }
     
+    // 解析失败时仍按线格式的问题区判定，应答地址条件不会命中
+    applyPolicy(ctx, packetData, parseSuccess ? &message : nullptr);
+
     // 如果解析成功，输出信息
     if (parseSuccess) {
+        // 完整解析的响应写入去重缓存，地址记录写入被动 DNS 存储
+        if (!options.questions_only) {
+            if (!isQuery) {
+                ctx.state.cache.insert(packetData, message, now);
+                ctx.state.passive.observe(message, now);
+            }
+            observeEdns(ctx, message, isQuery);
+        }
+        observeNames(ctx, message);
+        ctx.state.stages.lap(dns_parser::Stage::Analytics);
+
         // 使用封装的输出函数显示详细信息
-        dns_parser::DNSParser::printMessageDetails(message, isQuery);
+        if (ctx.verbose) {
+            printDetails(ctx, message, isQuery, nullptr);
+        }
+        ctx.state.stages.lap(dns_parser::Stage::Output);
+    } else {
+        ctx.state.protocol.recordFailure(error);
+        ctx.state.stages.lap(dns_parser::Stage::Analytics);
     }
-    
+}
+
+// 流式传输：数据写入流缓冲区，按 2 字节长度前缀切出完整消息逐个处理
+static void processStream(PacketContext& ctx, const TASK& task) {
+    bool isQuery = (task.Source.Role == 'C');
+    dns_parser::FlowTable::Flow& flow = ctx.state.flows.touch(ctx.key, ctx.now_ms);
+    flow.stream = true;
+
+    dns_parser::FlowBuffer& buffer = isQuery ? flow.c2s : flow.s2c;
+    bool appended = ctx.state.flows.append(flow, isQuery, reinterpret_cast<const char*>(task.Buffer), task.Length);
+    ctx.state.stages.lap(dns_parser::Stage::Intake);
+    if (!appended) {
+        // 消息超过缓冲区上限或预算不足，丢弃该方向未处理的数据重新同步
+        buffer.release(ctx.state.pool);
+        return;
+    }
+
+    // 长度前缀和头部直接在流缓冲区中读取，只有跨越回绕点时才拼到栈上；
+    // 通过检查的消息按片段最多两次 memcpy 写入复用的 frame，不再逐条分配字符串
+    CircularString* stream = buffer.stream();
+    CircularString::Segment parts[2];
+    while (stream && stream->size() >= 2) {
+        size_t prefixLength = std::min<size_t>(stream->size(), 14);
+        uint8_t prefix[14];
+        const uint8_t* head = reinterpret_cast<const uint8_t*>(stream->contiguous(0, prefixLength));
+        if (!head) {
+            size_t num = stream->segments(0, prefixLength, parts);
+            size_t copied = 0;
+            for (size_t i = 0; i < num; ++i) {
+                std::memcpy(prefix + copied, parts[i].data, parts[i].length);
+                copied += parts[i].length;
+            }
+            head = prefix;
+        }
+        size_t length = (static_cast<size_t>(head[0]) << 8) | head[1];
+        if (stream->size() < 2 + length) {
+            break;
+        }
+        if (length) {
+            // 被拒绝的消息不复制出来
+            dns_parser::HeaderCheck check = dns_parser::classifyHeader(head + 2, length, isQuery);
+            if (check == dns_parser::HeaderCheck::Ok) {
+                std::string& frame = ctx.state.frame;
+                size_t num = stream->segments(2, length, parts);
+                frame.assign(parts[0].data, parts[0].length);
+                if (num == 2) {
+                    frame.append(parts[1].data, parts[1].length);
+                }
+                processMessage(ctx, frame, isQuery);
+            } else {
+                ctx.state.protocol.recordRejected(check);
+            }
+        }
+        buffer.consume(2 + length);
+    }
+}
+
+// 输出一次降级级别变化
+static void reportShedChange(unsigned short thread, const dns_parser::LoadShedder::Transition& change) {
+    std::cerr << "线程 " << thread << " 负载级别: " << dns_parser::LoadShedder::levelName(change.from)
+              << " -> " << dns_parser::LoadShedder::levelName(change.to)
+              << " (处理时延 " << change.latency_ns << "ns, 队列占用 " << static_cast<unsigned>(change.pressure)
+              << "%)" << std::endl;
+}
+
+// 按上下文中的处理深度处理一个数据包
+static int handlePacket(PacketContext& ctx, TASK *Import, TASK **Export, const dns_parser::RuntimeConfig& config) {
+    ThreadState& state = ctx.state;
+    uint64_t nowMs = ctx.now_ms;
+
+    // 按数据包时间小步推进时间轮，处理流超时和查询超时
+    state.advance(nowMs);
+    state.stages.lap(dns_parser::Stage::Intake);
+
+    // 连接关闭：归还流缓冲区
+    if (Import->Inform == 0x13) {
+        state.flows.remove(ctx.key);
+        return 0;
+    }
+
+    // 已识别为流式传输的连接，或首包带有匹配的长度前缀
+    dns_parser::FlowTable::Flow* flow = state.flows.find(ctx.key);
+    if ((flow && flow->stream) || isStreamFrame(Import->Buffer, Import->Length, Import->Source.Role == 'C')) {
+        processStream(ctx, *Import);
+    } else {
+        // 判断是查询还是响应（根据源端角色）
+        bool isQuery = (Import->Source.Role == 'C');
+
+        // 复制和解析之前先检查头部，非 DNS 数据和垃圾数据只计入拒绝原因
+        dns_parser::HeaderCheck check = dns_parser::classifyHeader(Import->Buffer, Import->Length, isQuery);
+        if (check != dns_parser::HeaderCheck::Ok) {
+            state.protocol.recordRejected(check);
+            state.stages.lap(dns_parser::Stage::Header);
+            return 0;
+        }
+
+        // 获取数据包内容（直接是应用层数据）
+        std::string packetData(reinterpret_cast<char*>(Import->Buffer), Import->Length);
+        state.stages.lap(dns_parser::Stage::Intake);
+        processMessage(ctx, packetData, isQuery);
+
+        // 被拦截的查询按规则要求由插件直接应答
+        if (isQuery && ctx.verdict == dns_parser::PolicyAction::Acknowledge &&
+            ctx.respond != dns_parser::SyntheticKind::None) {
+            dns_parser::SyntheticResponse params = config.sinkhole;
+            params.kind = ctx.respond;
+            if (synthesizeReply(state, Import, Export, params)) {
+                bump(state.counters.blocked);
+                state.stages.lap(dns_parser::Stage::Output);
+                return 0;
+            }
+        }
+    }
+
+    // 策略判定通过导出任务的动作指令交给宿主：0x21 知晓（拦截）/ 0x22 转发
+    if (ctx.verdict != dns_parser::PolicyAction::None) {
+        Import->Action = static_cast<unsigned char>(ctx.verdict);
+        if (ctx.verdict == dns_parser::PolicyAction::Acknowledge) {
+            bump(state.counters.blocked);
+        }
+    }
+    state.stages.lap(dns_parser::Stage::Output);
     return 0;
 }
 
+// 按当前配置快照处理一个数据包，启用过载降级时测量处理耗时并调整级别
+static int processPacket(TASK *Import, TASK **Export, const dns_parser::RuntimeConfig& config) {
+    // 取得任务阶段从这里开始计时；编译期关闭时整个条件为常量 false
+    bool timing = DNS_PARSER_STAGE_TIMING && config.stage_timing;
+    uint64_t intake = timing ? dns_parser::CycleClock::now() : 0;
+    uint64_t nowMs = packetMillis(Import->Thread);
+    ThreadState* found = threadStateFor(Import->Thread, config, nowMs);
+    if (!found) {
+        return 0;
+    }
+    ThreadState& state = *found;
+    state.protocol.recordPacket();
+    uint64_t epoch = stageResetEpoch.load(std::memory_order_relaxed);
+    if (state.stage_epoch != epoch) {
+        state.stages.reset();
+        state.stage_epoch = epoch;
+    }
+    state.stages.begin(timing, intake);
+    PacketContext ctx = { state, flowKey(*Import),
+                          config.log_level <= dns_parser::LogLevel::Info, nowMs,
+                          Import->Source.Role == 'C' ? Import->Source : Import->Target,
+                          config.policy.get(), dns_parser::PolicyAction::None, dns_parser::SyntheticKind::None,
+                          state.shedder.admit(), config.skip_dnssec, config.normalize_names,
+                          config.public_suffixes.get(), config.shedding.enabled, 0 };
+    if (!config.shedding.enabled) {
+        int result = handlePacket(ctx, Import, Export, config);
+        state.stages.finish();
+        return result;
+    }
+
+    // 时延信号不含输出消息详情的耗时，终端或日志变慢不会触发降级
+    uint64_t start = monotonicNanos();
+    int result = handlePacket(ctx, Import, Export, config);
+    state.stages.finish();
+    uint64_t elapsed = monotonicNanos() - start - ctx.output_ns;
+    dns_parser::LoadShedder::Transition change;
+    if (state.shedder.observe(ctx.depth, elapsed,
+                              hostSignalsFor(Import->Thread)->pressure.load(std::memory_order_relaxed),
+                              nowMs, &change)) {
+        reportShedChange(Import->Thread, change);
+    }
+    return result;
+}
+
+// 数据过滤函数，处理每个数据包
+int Filter(TASK *Import, TASK **Export) {
+    // 初始化导出参数
+    *Export = Import;
+
+    // 检查输入参数
+    if (!Import || !Import->Buffer || Import->Length <= 0) {
+        return 0;
+    }
+
+    // 一次原子读取取得配置快照，处理完后宣告静止，允许回收被替换的旧快照；
+    // 线程编号超出上限时原样放行
+    const dns_parser::RuntimeConfig* config = configStore.acquire(Import->Thread);
+    if (!config) {
+        return 0;
+    }
+    int result = processPacket(Import, Export, *config);
+    configStore.quiescent(Import->Thread);
+    return result;
+}
+
 // ------------------------------ 4. 插件拆除（资源清理） ------------------------------
-// 负责资源释放和清理
+// 负责资源释放和清理，调用时所有工作线程必须已停止
 void Remove() {
     std::cout << "清理插件资源..." << std::endl;
+    if (configWatcher) {
+        std::cout << "配置版本: " << configStore.version()
+                  << ", 重新加载次数: " << configWatcher->reloads() << std::endl;
+        configWatcher.reset();
+    }
+
+    // 合并步骤：把各线程分片汇总成全局视图
+    uint32_t now = 0;
+    threadStates.forEach([&now](unsigned short thread, ThreadState&) {
+        now = std::max(now, static_cast<uint32_t>(packetMillis(thread) / 1000));
+    });
+    dns_parser::PassiveDNS passive;
+    uint64_t cacheReuses = 0;
+    uint64_t blocked = 0;
+    uint64_t synthesized = 0;
+    size_t internedNames = 0;
+    size_t flowCount = 0;
+    uint64_t overflows = 0;
+    uint64_t flowTimeouts = 0;
+    uint64_t matched = 0;
+    uint64_t queryTimeouts = 0;
+    uint64_t totalRtt = 0;
+    uint64_t shedTransitions = 0;
+    uint64_t depthPackets[dns_parser::LoadShedder::kLevels] = {};
+    threadStates.forEach([&](unsigned short, ThreadState& state) {
+        passive.merge(state.passive, now);
+        internedNames += state.names.size();
+        cacheReuses += state.counters.cache_reuses.load(std::memory_order_relaxed);
+        blocked += state.counters.blocked.load(std::memory_order_relaxed);
+        synthesized += state.counters.synthesized.load(std::memory_order_relaxed);
+        dns_parser::FlowTable::Stats flowStats = state.flows.stats();
+        flowCount += flowStats.flows;
+        overflows += flowStats.overflows;
+        flowTimeouts += flowStats.timeouts;
+        dns_parser::QueryTracker::Stats queryStats = state.queries.stats();
+        matched += queryStats.matched;
+        queryTimeouts += queryStats.timeouts;
+        totalRtt += queryStats.total_rtt_ms;
+        dns_parser::LoadShedder::Stats shedStats = state.shedder.stats();
+        shedTransitions += shedStats.transitions;
+        for (size_t i = 0; i < dns_parser::LoadShedder::kLevels; ++i) {
+            depthPackets[i] += shedStats.packets[i];
+        }
+    });
+
+    DNS_STATS dnsStats;
+    DnsStats(&dnsStats);
+    unsigned long long parseFailures = 0;
+    for (size_t i = 0; i < DNS_STATS_PARSE_ERRORS; ++i) {
+        parseFailures += dnsStats.ParseFailures[i];
+    }
+    unsigned long long rejected = 0;
+    for (size_t i = 0; i < DNS_STATS_REJECT_REASONS; ++i) {
+        rejected += dnsStats.Rejected[i];
+    }
+    std::cout << "数据包: " << dnsStats.Packets << ", 消息: " << dnsStats.Messages
+              << " (查询 " << dnsStats.Queries << ", 响应 " << dnsStats.Responses << ")"
+              << ", 头部检查拒绝: " << rejected
+              << ", 解析失败: " << parseFailures
+              << ", 复用缓存结果: " << cacheReuses << ", 策略拦截: " << blocked
+              << ", 合成应答: " << synthesized << std::endl;
+    std::cout << "被动 DNS 映射数: " << passive.size()
+              << ", 域名数: " << passive.nameCount()
+              << ", 丢弃数: " << passive.dropped() << std::endl;
+    std::cout << "驻留域名数: " << internedNames << std::endl;
+    std::cout << "EDNS: 带 OPT " << dnsStats.Edns[dns_parser::ProtocolStats::EDNS_PRESENT]
+              << ", DO " << dnsStats.Edns[dns_parser::ProtocolStats::EDNS_DO]
+              << ", Cookie " << dnsStats.Edns[dns_parser::ProtocolStats::EDNS_COOKIE]
+              << ", 客户端子网 " << dnsStats.Edns[dns_parser::ProtocolStats::EDNS_SUBNET]
+              << ", 格式错误 " << dnsStats.Edns[dns_parser::ProtocolStats::EDNS_MALFORMED] << std::endl;
+    std::cout << "域名检查 (" << dns_parser::nameCheckImplementation() << "): 含大写字母 "
+              << dnsStats.Names[dns_parser::ProtocolStats::NAMES_UPPERCASE]
+              << ", 非 LDH " << dnsStats.Names[dns_parser::ProtocolStats::NAMES_NON_LDH]
+              << ", 国际化域名 " << dnsStats.Names[dns_parser::ProtocolStats::NAMES_IDN]
+              << ", 标签长度不合法 " << dnsStats.Names[dns_parser::ProtocolStats::NAMES_BAD_LENGTH] << std::endl;
+    SUBNET_STATS subnets[5];
+    int subnetCount = SubnetStats(subnets, 5);
+    for (int i = 0; i < subnetCount; ++i) {
+        char address[INET6_ADDRSTRLEN];
+        inet_ntop(subnets[i].Family == 4 ? AF_INET : AF_INET6, subnets[i].Address, address, sizeof(address));
+        std::cout << "子网 " << address << "/" << static_cast<int>(subnets[i].Prefix)
+                  << ": 查询 " << subnets[i].Queries << ", 响应 " << subnets[i].Responses << std::endl;
+    }
+
+    STAGE_STATS stageStats[STAGE_COUNT];
+    StageStats(stageStats, 0);
+    for (size_t i = 0; i < STAGE_COUNT; ++i) {
+        if (stageStats[i].Count) {
+            std::cout << "阶段 " << dns_parser::StageRecorder::stageName(static_cast<dns_parser::Stage>(i))
+                      << ": 次数 " << stageStats[i].Count
+                      << ", 平均 " << stageStats[i].Total / stageStats[i].Count << "ns"
+                      << ", P50 " << stageStats[i].P50 << "ns, P99 " << stageStats[i].P99
+                      << "ns, 最大 " << stageStats[i].Max << "ns" << std::endl;
+        }
+    }
+
+    ALLOC_STATS allocStats;
+    if (AllocStats(&allocStats, -1) == 0 && allocStats.Packets) {
+        std::cout << "堆分配: 每包平均 " << static_cast<double>(allocStats.Allocations) / allocStats.Packets
+                  << " 次 / " << allocStats.Bytes / allocStats.Packets << " 字节"
+                  << ", P99 " << allocStats.P99PerPacket << " 次, 最多 " << allocStats.MaxPerPacket << " 次"
+                  << ", 释放 " << allocStats.Frees << " 次, 缓冲池新块 " << allocStats.ArenaBlocks
+                  << " (" << allocStats.ArenaBytes << " 字节)" << std::endl;
+        for (size_t i = 0; i < STAGE_COUNT; ++i) {
+            if (allocStats.StageAllocations[i]) {
+                std::cout << "阶段 " << dns_parser::StageRecorder::stageName(static_cast<dns_parser::Stage>(i))
+                          << ": 分配 " << allocStats.StageAllocations[i] << " 次 / "
+                          << allocStats.StageBytes[i] << " 字节" << std::endl;
+            }
+        }
+    }
+
+    CACHE_STATS stats;
+    CacheStats(&stats);
+    uint64_t lookups = stats.Hits + stats.Misses;
+    std::cout << "响应缓存命中: " << stats.Hits << ", 未命中: " << stats.Misses
+              << ", 命中率: " << (lookups ? 100.0 * stats.Hits / lookups : 0.0) << "%" << std::endl;
+    std::cout << "流数量: " << flowCount << ", 超时流: " << flowTimeouts << ", 缓冲区溢出: " << overflows
+              << ", 缓冲区预算占用: " << memoryBudget.used() << std::endl;
+    std::cout << "已应答查询: " << matched << ", 超时查询: " << queryTimeouts
+              << ", 平均时延: " << (matched ? totalRtt / matched : 0) << "ms" << std::endl;
+    std::cout << "负载级别变化: " << shedTransitions << ", 完整解析: " << depthPackets[0]
+              << ", 头部+问题: " << depthPackets[1] << ", 仅计数: " << depthPackets[2] << std::endl;
+
+    threadStates.clear();
     std::cout << "插件资源清理完成" << std::endl;
 }
 
@@ -145,4 +818,156 @@ void SetConfigFilePath(const char* path) {
     if (path != nullptr) {
         configFilePath = path;
     }
-}
\ No newline at end of file
+}
+
+// 汇总所有线程的响应缓存统计
+void CacheStats(CACHE_STATS *Stats) {
+    if (!Stats) {
+        return;
+    }
+    memset(Stats, 0, sizeof(CACHE_STATS));
+    // 缓存计数是原子量，可以与工作线程并发读取
+    threadStates.forEach([Stats](unsigned short, ThreadState& state) {
+        dns_parser::ResponseCache::Stats stats = state.cache.stats();
+        Stats->Hits += stats.hits;
+        Stats->Misses += stats.misses;
+        Stats->Inserts += stats.inserts;
+        Stats->Evictions += stats.evictions;
+        Stats->Expirations += stats.expirations;
+    });
+}
+
+// 汇总所有线程的协议计数：逐线程读取顺序锁快照后合并，不阻塞工作线程
+void DnsStats(DNS_STATS *Stats) {
+    if (!Stats) {
+        return;
+    }
+    typedef dns_parser::ProtocolStats Protocol;
+    static_assert(DNS_STATS_PARSE_ERRORS == Protocol::kParseErrors, "解析失败原因数量不一致");
+    static_assert(DNS_STATS_QTYPES == Protocol::kQtypeSlots, "查询类型项数不一致");
+    static_assert(DNS_STATS_SECTION_BUCKETS == Protocol::kSectionBuckets, "区段分桶数不一致");
+    static_assert(DNS_STATS_SIZE_BUCKETS == Protocol::kSizeBuckets, "长度分桶数不一致");
+    static_assert(DNS_STATS_REJECT_REASONS == Protocol::kRejectReasons, "头部检查拒绝原因数量不一致");
+    static_assert(DNS_STATS_EDNS == Protocol::EDNS_COUNT, "EDNS 计数项数不一致");
+    static_assert(DNS_STATS_NAMES == Protocol::NAMES_COUNT, "域名检查计数项数不一致");
+
+    Protocol::Counters merged;
+    threadStates.forEach([&merged](unsigned short, ThreadState& state) {
+        Protocol::Counters counters;
+        state.protocol.snapshot(counters);
+        merged.merge(counters);
+    });
+
+    Stats->Packets = merged.packets;
+    Stats->Messages = merged.messages;
+    Stats->Queries = merged.queries;
+    Stats->Responses = merged.responses;
+    Stats->ShortMessages = merged.short_messages;
+    std::copy(merged.parse_failures, merged.parse_failures + Protocol::kParseErrors, Stats->ParseFailures);
+    std::copy(merged.rejected, merged.rejected + Protocol::kRejectReasons, Stats->Rejected);
+    std::copy(merged.qtypes, merged.qtypes + Protocol::kQtypeSlots, Stats->Qtypes);
+    std::copy(merged.rcodes, merged.rcodes + Protocol::kRcodes, Stats->Rcodes);
+    std::copy(merged.opcodes, merged.opcodes + Protocol::kOpcodes, Stats->Opcodes);
+    std::copy(merged.flags, merged.flags + Protocol::FLAG_COUNT, Stats->Flags);
+    for (size_t i = 0; i < Protocol::kSections; ++i) {
+        std::copy(merged.sections[i], merged.sections[i] + Protocol::kSectionBuckets, Stats->Sections[i]);
+    }
+    std::copy(merged.sizes, merged.sizes + Protocol::kSizeBuckets, Stats->Sizes);
+    std::copy(merged.edns, merged.edns + Protocol::EDNS_COUNT, Stats->Edns);
+    std::copy(merged.names, merged.names + Protocol::NAMES_COUNT, Stats->Names);
+}
+
+// 合并所有线程的客户端子网计数，按总数降序输出
+int SubnetStats(SUBNET_STATS *Stats, int Max) {
+    if (!Stats || Max <= 0) {
+        return 0;
+    }
+    std::vector<dns_parser::SubnetCounters::Entry> entries;
+    threadStates.forEach([&entries](unsigned short, ThreadState& state) {
+        state.subnets.snapshot(entries);
+    });
+    dns_parser::SubnetCounters::top(entries, static_cast<size_t>(Max));
+    for (size_t i = 0; i < entries.size(); ++i) {
+        SUBNET_STATS& out = Stats[i];
+        out.Family = entries[i].subnet.family;
+        out.Prefix = entries[i].subnet.prefix;
+        memcpy(out.Address, entries[i].subnet.address, sizeof(out.Address));
+        out.Queries = entries[i].queries;
+        out.Responses = entries[i].responses;
+    }
+    return static_cast<int>(entries.size());
+}
+
+// 汇总指定线程或所有线程的堆分配统计
+int AllocStats(ALLOC_STATS *Stats, int Thread) {
+    if (!Stats || !DNS_PARSER_ALLOC_TRACKING) {
+        return -1;
+    }
+    memset(Stats, 0, sizeof(ALLOC_STATS));
+    std::unique_ptr<dns_parser::LatencyHistogram::Snapshot> perPacket(new dns_parser::LatencyHistogram::Snapshot());
+    bool found = false;
+    threadStates.forEach([&](unsigned short thread, ThreadState& state) {
+        if (Thread >= 0 && Thread != thread) {
+            return;
+        }
+        found = true;
+        dns_parser::StageRecorder::AllocStats stats = state.stages.allocStats();
+        Stats->Packets += stats.packets;
+        Stats->Frees += stats.frees;
+        Stats->ArenaBlocks += stats.arena_blocks;
+        Stats->ArenaBytes += stats.arena_bytes;
+        for (size_t i = 0; i < STAGE_COUNT; ++i) {
+            Stats->StageAllocations[i] += stats.allocations[i];
+            Stats->StageBytes[i] += stats.bytes[i];
+            Stats->Allocations += stats.allocations[i];
+            Stats->Bytes += stats.bytes[i];
+        }
+        state.stages.allocationsPerPacket().snapshot(*perPacket);
+    });
+    Stats->MaxPerPacket = perPacket->max;
+    Stats->P99PerPacket = perPacket->valueAt(99);
+    return found ? 0 : -1;
+}
+
+// 汇总所有线程的阶段耗时直方图，换算为纳秒
+void StageStats(STAGE_STATS *Stats, int Reset) {
+    if (!Stats) {
+        return;
+    }
+    static_assert(STAGE_COUNT == dns_parser::StageRecorder::kStages, "阶段数量不一致");
+    double scale = dns_parser::CycleClock::nanosPerTick();
+    for (size_t i = 0; i < STAGE_COUNT; ++i) {
+        std::unique_ptr<dns_parser::LatencyHistogram::Snapshot> merged(new dns_parser::LatencyHistogram::Snapshot());
+        threadStates.forEach([&merged, i](unsigned short, ThreadState& state) {
+            state.stages.histogram(static_cast<dns_parser::Stage>(i)).snapshot(*merged);
+        });
+        STAGE_STATS& out = Stats[i];
+        out.Count = merged->count;
+        out.Total = static_cast<unsigned long long>(merged->total * scale);
+        out.Min = merged->count ? static_cast<unsigned long long>(merged->min * scale) : 0;
+        out.Max = static_cast<unsigned long long>(merged->max * scale);
+        out.P50 = static_cast<unsigned long long>(merged->valueAt(50) * scale);
+        out.P90 = static_cast<unsigned long long>(merged->valueAt(90) * scale);
+        out.P99 = static_cast<unsigned long long>(merged->valueAt(99) * scale);
+        out.P999 = static_cast<unsigned long long>(merged->valueAt(99.9) * scale);
+    }
+    if (Reset) {
+        stageResetEpoch.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+// 设置线程当前处理的数据包时间
+void SetPacketTime(unsigned short Thread, unsigned long long Milliseconds) {
+    HostSignals* signals = hostSignalsFor(Thread);
+    if (signals) {
+        signals->millis.store(Milliseconds, std::memory_order_relaxed);
+    }
+}
+
+// 报告线程输入队列的占用
+void SetQueuePressure(unsigned short Thread, unsigned int Percent) {
+    HostSignals* signals = hostSignalsFor(Thread);
+    if (signals) {
+        signals->pressure.store(static_cast<unsigned char>(std::min(Percent, 100u)), std::memory_order_relaxed);
+    }
+}
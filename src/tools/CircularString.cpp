@@ -1,77 +1,306 @@
-#include "../include/tools/CircularString.h"
+#include "../../include/tools/CircularString.h"
 #include <algorithm>
-#include <unordered_map>
+#include <cstring>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace {
+
+// 向上取整到 2 的幂
+size_t round_up_pow2(size_t n) {
+    size_t result = 1;
+    while (result < n) {
+        result <<= 1;
+    }
+    return result;
+}
+
+} // namespace
 
 // 将逻辑索引转换为物理索引
 size_t CircularString::physical_index(size_t logical_index) const {
-    return (head + logical_index) % capacity;
+    return mask ? (head + logical_index) & mask : (head + logical_index) % capacity;
 }
 
 // 将物理索引转换为逻辑索引
 // 物理索引是从头指针开始的，逻辑索引是从0开始的
 size_t CircularString::logical_index(size_t physical_index) const {
-    return (physical_index + capacity - head) % capacity;
+    return mask ? (physical_index + capacity - head) & mask : (physical_index + capacity - head) % capacity;
 }
 
 // 构造函数，创建指定容量的环形字符串
 CircularString::CircularString(size_t size)
-    : capacity(size), head(0), count(0) {
+    : CircularString(size, Backing::Heap) {
+}
+
+// 构造函数，创建指定容量和存储方式的环形字符串
+CircularString::CircularString(size_t size, Backing backing)
+    : buffer(nullptr), capacity(size), mask(0), head(0), count(0), backing(backing) {
     if (capacity == 0) {
         throw std::invalid_argument("Capacity must be positive");
     }
-    buffer.resize(capacity);
+    if (backing == Backing::Mirrored) {
+        size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        capacity = round_up_pow2(std::max(capacity, page));
+    }
+    if ((capacity & (capacity - 1)) == 0) {
+        mask = capacity - 1;
+    }
+    allocate();
+}
+
+// 构造函数，使用调用方提供的内存
+CircularString::CircularString(char* storage, size_t size)
+    : buffer(storage), capacity(size), mask(0), head(0), count(0), backing(Backing::External) {
+    if (!storage || capacity == 0) {
+        throw std::invalid_argument("External storage must be non-empty");
+    }
+    if ((capacity & (capacity - 1)) == 0) {
+        mask = capacity - 1;
+    }
+}
+
+CircularString::CircularString(const CircularString& other)
+    : buffer(nullptr), capacity(other.capacity), mask(other.mask), head(0), count(0),
+      backing(other.backing == Backing::External ? Backing::Heap : other.backing) {
+    allocate();
+    // 复制时顺便线性化，头指针归零
+    Segment parts[2];
+    size_t num = other.readable_segments(parts);
+    for (size_t i = 0; i < num; ++i) {
+        std::memcpy(buffer + count, parts[i].data, parts[i].length);
+        count += parts[i].length;
+    }
+}
+
+CircularString::CircularString(CircularString&& other) noexcept
+    : buffer(other.buffer), capacity(other.capacity), mask(other.mask), head(other.head),
+      count(other.count), backing(other.backing) {
+    other.buffer = nullptr;
+    other.count = 0;
+    other.head = 0;
+}
+
+CircularString& CircularString::operator=(CircularString other) noexcept {
+    swap(other);
+    return *this;
+}
+
+CircularString::~CircularString() {
+    release();
+}
+
+void CircularString::swap(CircularString& other) noexcept {
+    std::swap(buffer, other.buffer);
+    std::swap(capacity, other.capacity);
+    std::swap(mask, other.mask);
+    std::swap(head, other.head);
+    std::swap(count, other.count);
+    std::swap(backing, other.backing);
+}
+
+// 分配底层存储
+void CircularString::allocate() {
+    if (backing == Backing::Heap) {
+        buffer = new char[capacity];
+        return;
+    }
+
+    // 先保留 2 倍容量的地址空间，再把同一个 memfd 固定映射到前后两半
+    int fd = memfd_create("circular_string", MFD_CLOEXEC);
+    if (fd < 0) {
+        throw std::runtime_error("memfd_create failed");
+    }
+    if (ftruncate(fd, static_cast<off_t>(capacity)) != 0) {
+        close(fd);
+        throw std::runtime_error("ftruncate failed");
+    }
+    void* base = mmap(nullptr, capacity * 2, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED) {
+        close(fd);
+        throw std::runtime_error("mmap reserve failed");
+    }
+    char* region = static_cast<char*>(base);
+    void* lower = mmap(region, capacity, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0);
+    void* upper = mmap(region + capacity, capacity, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0);
+    close(fd);
+    if (lower == MAP_FAILED || upper == MAP_FAILED) {
+        munmap(base, capacity * 2);
+        throw std::runtime_error("mmap mirror failed");
+    }
+    buffer = region;
+}
+
+// 释放底层存储，外部存储由调用方归还
+void CircularString::release() noexcept {
+    if (!buffer) {
+        return;
+    }
+    if (backing == Backing::Heap) {
+        delete[] buffer;
+    } else if (backing == Backing::Mirrored) {
+        munmap(buffer, capacity * 2);
+    }
+    buffer = nullptr;
+}
+
+// 把数据线性化搬到新的外部存储
+char* CircularString::rebind(char* storage, size_t size) {
+    if (backing != Backing::External) {
+        throw std::logic_error("rebind requires external storage");
+    }
+    if (!storage || size < count || size == 0) {
+        throw std::invalid_argument("External storage too small");
+    }
+    Segment parts[2];
+    size_t num = readable_segments(parts);
+    size_t offset = 0;
+    for (size_t i = 0; i < num; ++i) {
+        std::memcpy(storage + offset, parts[i].data, parts[i].length);
+        offset += parts[i].length;
+    }
+
+    char* old = buffer;
+    buffer = storage;
+    capacity = size;
+    mask = (capacity & (capacity - 1)) == 0 ? capacity - 1 : 0;
+    head = 0;
+    return old;
 }
 
 // 在末尾插入字符串
 void CircularString::push_back(const std::string& str) {
-    for (char c : str) {
-        // 计算实际要插入的物理位置
-        size_t insert_pos = physical_index(count);
-
-        if (count < capacity) {
-            // 缓冲区未满，直接追加
-            buffer[insert_pos] = c;
-            ++count;
-        }
-        else {
-            // 缓冲区已满，覆盖最旧元素并移动头指针
-            buffer[insert_pos] = c;
-            head = (head + 1) % capacity; // 最旧元素被覆盖，头指针向前移动
-        }
+    push_back(str.data(), str.size());
+}
+
+// 在末尾插入一段字节，按回绕点拆成最多两次 memcpy
+void CircularString::push_back(const char* data, size_t len) {
+    if (len == 0) {
+        return;
+    }
+
+    // 数据比容量还大时只有最后 capacity 个字节会留下
+    if (len >= capacity) {
+        std::memcpy(buffer, data + (len - capacity), capacity);
+        head = 0;
+        count = capacity;
+        return;
+    }
+
+    size_t tail = physical_index(count);
+    // 双重映射时越过末尾的写入会落到缓冲区开头，一次 memcpy 即可
+    size_t first = backing == Backing::Mirrored ? len : std::min(len, capacity - tail);
+    std::memcpy(buffer + tail, data, first);
+    if (first < len) {
+        std::memcpy(buffer, data + first, len - first);
+    }
+
+    // 缓冲区溢出时最旧的元素被覆盖，头指针随之前移
+    if (count + len > capacity) {
+        head = (head + (count + len - capacity)) % capacity;
+        count = capacity;
+    } else {
+        count += len;
+    }
+}
+
+// 获取逻辑区间对应的连续内存片段
+size_t CircularString::segments(size_t start, size_t length, Segment out[2]) const {
+    if (start > count || length > count - start) {
+        throw std::out_of_range("Invalid segment range");
+    }
+    if (length == 0) {
+        return 0;
+    }
+
+    size_t begin = physical_index(start);
+    size_t first = backing == Backing::Mirrored ? length : std::min(length, capacity - begin);
+    out[0].data = buffer + begin;
+    out[0].length = first;
+    if (first == length) {
+        return 1;
+    }
+    out[1].data = buffer;
+    out[1].length = length - first;
+    return 2;
+}
+
+// 获取全部可读数据对应的连续内存片段
+size_t CircularString::readable_segments(Segment out[2]) const noexcept {
+    return segments(0, count, out);
+}
+
+// 获取逻辑区间的连续指针
+const char* CircularString::contiguous(size_t start, size_t length) const {
+    Segment parts[2];
+    size_t num = segments(start, length, parts);
+    if (num == 0) {
+        return buffer + physical_index(start);
     }
+    return num == 1 ? parts[0].data : nullptr;
+}
+
+// 获取存储方式
+CircularString::Backing CircularString::backing_mode() const noexcept {
+    return backing;
 }
 
 // 查找第n次出现的字符串（Sunday算法优化）
 size_t CircularString::find_nth(const std::string& target, size_t n) const {
+    Segment parts[2];
+    size_t num = readable_segments(parts);
+    return find_nth_in_segments(parts, num, target, n);
+}
+
+// 在一至两个连续片段组成的数据中查找第n次出现的字符串
+size_t CircularString::find_nth_in_segments(const Segment* parts, size_t num,
+                                            const std::string& target, size_t n) {
     if (target.empty()) {
         throw std::invalid_argument("查找目标不能为空字符串");
     }
 
     const size_t target_len = target.length();
-    const size_t buffer_len = count;
+    size_t buffer_len = 0;
+    for (size_t i = 0; i < num; ++i) {
+        buffer_len += parts[i].length;
+    }
 
     if (target_len > buffer_len) {
         throw std::out_of_range("字符串未找到足够次数");
     }
 
-    // Sunday算法预处理坏字符表
-    std::unordered_map<char, size_t> bad_char_shift;
+    // Sunday算法预处理坏字符表（256 项栈上数组，未出现的字符跳过 target_len + 1）
+    size_t bad_char_shift[256];
+    for (size_t i = 0; i < 256; ++i) {
+        bad_char_shift[i] = target_len + 1;
+    }
     for (size_t i = 0; i < target_len; ++i) {
-        bad_char_shift[target[i]] = target_len - i;
+        bad_char_shift[static_cast<unsigned char>(target[i])] = target_len - i;
     }
 
+    // 按回绕点把数据视为前后两段，窗口落在单段内时直接 memcmp
+    const char* first = parts[0].data;
+    const size_t first_len = parts[0].length;
+    const char* second = num > 1 ? parts[1].data : nullptr;
+    const char* pattern = target.data();
+
     size_t occurrences = 0;
     size_t current = 0;
 
     while (current <= buffer_len - target_len) {
-        size_t j;
-        // 检查匹配
-        for (j = 0; j < target_len; ++j) {
-            const size_t phys_idx = physical_index(current + j);
-            if (buffer[phys_idx] != target[j]) break;
+        bool matched;
+        if (current + target_len <= first_len) {
+            matched = std::memcmp(first + current, pattern, target_len) == 0;
+        } else if (current >= first_len) {
+            matched = std::memcmp(second + (current - first_len), pattern, target_len) == 0;
+        } else {
+            // 窗口跨越回绕点，分两段比较
+            size_t head_len = first_len - current;
+            matched = std::memcmp(first + current, pattern, head_len) == 0 &&
+                      std::memcmp(second, pattern + head_len, target_len - head_len) == 0;
         }
 
-        if (j == target_len) {
+        if (matched) {
             if (++occurrences == n) {
                 return current;
             }
@@ -82,10 +311,10 @@ size_t CircularString::find_nth(const std::string& target, size_t n) const {
             const size_t next_char_pos = current + target_len;
             if (next_char_pos >= buffer_len) break;
 
-            const char next_char = buffer[physical_index(next_char_pos)];
-            current += bad_char_shift.count(next_char) ?
-                bad_char_shift[next_char] :
-                target_len + 1;
+            const char next_char = next_char_pos < first_len ?
+                first[next_char_pos] :
+                second[next_char_pos - first_len];
+            current += bad_char_shift[static_cast<unsigned char>(next_char)];
         }
     }
 
@@ -98,10 +327,12 @@ std::string CircularString::substring(size_t m, size_t n) const {
         throw std::out_of_range("Invalid index range");
     }
 
+    Segment parts[2];
+    size_t num = segments(m, n - m + 1, parts);
     std::string result;
     result.reserve(n - m + 1);
-    for (size_t i = m; i <= n; ++i) {
-        result.push_back(buffer[physical_index(i)]);
+    for (size_t i = 0; i < num; ++i) {
+        result.append(parts[i].data, parts[i].length);
     }
     return result;
 }
@@ -135,7 +366,6 @@ char CircularString::at(size_t index) {
 }
 
 size_t CircularString::find(size_t start_index, size_t end_index, const char target) {
-    std::vector<char>::iterator target_it;
     if (start_index >= end_index) {
         return size_t(-1);
     }
@@ -145,34 +375,23 @@ size_t CircularString::find(size_t start_index, size_t end_index, const char tar
     if (end_index > count) {
         throw std::out_of_range("end index out of range");
     }
-    size_t physical_start_index = physical_index(start_index);
-    size_t physical_end_index = physical_index(end_index);
-    //缓冲区没循环的情况下，std::find()一次
-    if (physical_start_index <= physical_end_index) {
-        target_it = std::find(buffer.begin() + physical_start_index, buffer.begin() + physical_end_index, target);
-        if (target_it == buffer.begin() + physical_end_index) {
-            return -1;
-        }
-        else {
-            return logical_index(target_it - buffer.begin());
-        }
-    }
-    //缓冲区循环的情况下，std::find()两次
-    else {
-        target_it = std::find(buffer.begin() + physical_start_index, buffer.end(), target); //先找后半段
-        if (target_it == buffer.end()) {
-            target_it = std::find(buffer.begin(), buffer.begin() + physical_end_index, target);   //后半段找不到再找前半段
-            if (target_it == buffer.begin() + physical_end_index) {
-                return -1;
-            }
-            else {
-                return logical_index(target_it - buffer.begin());
-            }
-        }
-        else {
-            return logical_index(target_it - buffer.begin());
-        }
-    }
 
+    Segment parts[2];
+    size_t num = segments(start_index, end_index - start_index, parts);
+    size_t hit = find_in_segments(parts, num, target);
+    return hit == size_t(-1) ? hit : start_index + hit;
+}
 
+// 在一至两个连续片段组成的数据中查找字符
+size_t CircularString::find_in_segments(const Segment* parts, size_t num, char target) {
+    // 按连续片段调用 memchr（glibc 内部按 CPU 选择 SSE2/AVX2 实现）
+    size_t base = 0;
+    for (size_t i = 0; i < num; ++i) {
+        const void* hit = std::memchr(parts[i].data, target, parts[i].length);
+        if (hit) {
+            return base + (static_cast<const char*>(hit) - parts[i].data);
+        }
+        base += parts[i].length;
+    }
+    return size_t(-1);
 }
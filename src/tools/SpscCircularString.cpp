@@ -0,0 +1,174 @@
+#include "../../include/tools/SpscCircularString.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+// 构造函数
+SpscCircularString::SpscCircularString(size_t size)
+    : buffer(nullptr), capacity(1), mask(0), write_pos(0), cached_read_pos(0),
+      read_pos(0), cached_write_pos(0) {
+    if (size == 0) {
+        throw std::invalid_argument("Capacity must be positive");
+    }
+    while (capacity < size) {
+        capacity <<= 1;
+    }
+    mask = capacity - 1;
+    buffer = new char[capacity];
+}
+
+SpscCircularString::~SpscCircularString() {
+    delete[] buffer;
+}
+
+// ------------------------------ 生产者 ------------------------------
+
+size_t SpscCircularString::writable() const noexcept {
+    uint64_t write = write_pos.load(std::memory_order_relaxed);
+    return capacity - static_cast<size_t>(write - read_pos.load(std::memory_order_acquire));
+}
+
+size_t SpscCircularString::reserve(size_t n, MutableSegment out[2]) noexcept {
+    if (n == 0 || n > capacity) {
+        return 0;
+    }
+    uint64_t write = write_pos.load(std::memory_order_relaxed);
+
+    // 先用缓存的读位置判断，不够时才读取消费者的原子变量
+    if (capacity - static_cast<size_t>(write - cached_read_pos) < n) {
+        cached_read_pos = read_pos.load(std::memory_order_acquire);
+        if (capacity - static_cast<size_t>(write - cached_read_pos) < n) {
+            return 0;
+        }
+    }
+
+    size_t begin = static_cast<size_t>(write) & mask;
+    size_t first = std::min(n, capacity - begin);
+    out[0].data = buffer + begin;
+    out[0].length = first;
+    if (first == n) {
+        return 1;
+    }
+    out[1].data = buffer;
+    out[1].length = n - first;
+    return 2;
+}
+
+void SpscCircularString::commit(size_t n) noexcept {
+    // release 语义保证消费者看到新位置时也能看到写入的数据
+    write_pos.store(write_pos.load(std::memory_order_relaxed) + n, std::memory_order_release);
+}
+
+bool SpscCircularString::push_back(const char* data, size_t len) noexcept {
+    if (len == 0) {
+        return true;
+    }
+    MutableSegment parts[2];
+    size_t num = reserve(len, parts);
+    if (num == 0) {
+        return false;
+    }
+    std::memcpy(parts[0].data, data, parts[0].length);
+    if (num == 2) {
+        std::memcpy(parts[1].data, data + parts[0].length, parts[1].length);
+    }
+    commit(len);
+    return true;
+}
+
+bool SpscCircularString::push_back(const std::string& str) noexcept {
+    return push_back(str.data(), str.size());
+}
+
+// ------------------------------ 消费者 ------------------------------
+
+size_t SpscCircularString::size() const noexcept {
+    cached_write_pos = write_pos.load(std::memory_order_acquire);
+    return static_cast<size_t>(cached_write_pos - read_pos.load(std::memory_order_relaxed));
+}
+
+size_t SpscCircularString::cap() const noexcept {
+    return capacity;
+}
+
+size_t SpscCircularString::segments(size_t start, size_t length, Segment out[2]) const {
+    uint64_t read = read_pos.load(std::memory_order_relaxed);
+    if (start + length > static_cast<size_t>(cached_write_pos - read)) {
+        // 缓存的写位置不够时刷新一次
+        size();
+        if (start + length > static_cast<size_t>(cached_write_pos - read)) {
+            throw std::out_of_range("Invalid segment range");
+        }
+    }
+    if (length == 0) {
+        return 0;
+    }
+
+    size_t begin = static_cast<size_t>(read + start) & mask;
+    size_t first = std::min(length, capacity - begin);
+    out[0].data = buffer + begin;
+    out[0].length = first;
+    if (first == length) {
+        return 1;
+    }
+    out[1].data = buffer;
+    out[1].length = length - first;
+    return 2;
+}
+
+size_t SpscCircularString::readable_segments(Segment out[2]) const noexcept {
+    return segments(0, size(), out);
+}
+
+size_t SpscCircularString::find_nth(const std::string& target, size_t n) const {
+    Segment parts[2];
+    size_t num = readable_segments(parts);
+    return CircularString::find_nth_in_segments(parts, num, target, n);
+}
+
+std::string SpscCircularString::substring(size_t m, size_t n) const {
+    if (m > n) {
+        throw std::out_of_range("Invalid index range");
+    }
+    Segment parts[2];
+    size_t num = segments(m, n - m + 1, parts);
+    std::string result;
+    result.reserve(n - m + 1);
+    for (size_t i = 0; i < num; ++i) {
+        result.append(parts[i].data, parts[i].length);
+    }
+    return result;
+}
+
+size_t SpscCircularString::find(size_t start_index, size_t end_index, const char target) const {
+    if (start_index >= end_index) {
+        return size_t(-1);
+    }
+    Segment parts[2];
+    size_t num = segments(start_index, end_index - start_index, parts);
+    size_t hit = CircularString::find_in_segments(parts, num, target);
+    return hit == size_t(-1) ? hit : start_index + hit;
+}
+
+char SpscCircularString::at(size_t index) const {
+    Segment parts[2];
+    try {
+        segments(index, 1, parts);
+    } catch (const std::out_of_range&) {
+        throw std::out_of_range("Input index of At() is out of range");
+    }
+    return parts[0].data[0];
+}
+
+void SpscCircularString::release(size_t n) {
+    uint64_t read = read_pos.load(std::memory_order_relaxed);
+    if (n > static_cast<size_t>(cached_write_pos - read) && n > size()) {
+        throw std::out_of_range("Release size out of range");
+    }
+    // release 语义保证生产者复用这段空间前，消费者对它的读取已经完成
+    read_pos.store(read + n, std::memory_order_release);
+}
+
+void SpscCircularString::erase_up_to(size_t k) {
+    release(k + 1);
+}
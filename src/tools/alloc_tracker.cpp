@@ -0,0 +1,72 @@
+#include "../../include/tools/alloc_tracker.h"
+
+#if DNS_PARSER_ALLOC_TRACKING
+
+#include <cstdlib>
+#include <new>
+
+namespace dns_parser {
+
+thread_local AllocTally threadAllocTally = { 0, 0, 0, 0, 0 };
+
+} // namespace dns_parser
+
+// 替换全局分配函数：进程内所有 new/delete（包括宿主程序的）都会经过这里，
+// 只用于诊断构建。计数是线程局部的普通整数，不引入任何同步
+namespace {
+
+inline void* trackedAllocate(std::size_t size) noexcept {
+    void* block = std::malloc(size ? size : 1);
+    if (block) {
+        ++dns_parser::threadAllocTally.allocations;
+        dns_parser::threadAllocTally.bytes += size;
+    }
+    return block;
+}
+
+inline void trackedFree(void* block) noexcept {
+    if (block) {
+        ++dns_parser::threadAllocTally.frees;
+        std::free(block);
+    }
+}
+
+} // namespace
+
+void* operator new(std::size_t size) {
+    void* block = trackedAllocate(size);
+    if (!block) {
+        throw std::bad_alloc();
+    }
+    return block;
+}
+
+void* operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    return trackedAllocate(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return trackedAllocate(size);
+}
+
+void operator delete(void* block) noexcept {
+    trackedFree(block);
+}
+
+void operator delete[](void* block) noexcept {
+    trackedFree(block);
+}
+
+void operator delete(void* block, const std::nothrow_t&) noexcept {
+    trackedFree(block);
+}
+
+void operator delete[](void* block, const std::nothrow_t&) noexcept {
+    trackedFree(block);
+}
+
+#endif // DNS_PARSER_ALLOC_TRACKING
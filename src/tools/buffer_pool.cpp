@@ -0,0 +1,194 @@
+#include "../../include/tools/buffer_pool.h"
+#include "../../include/tools/alloc_tracker.h"
+#include <algorithm>
+#include <new>
+#include <sys/mman.h>
+
+namespace dns_parser {
+
+const size_t BufferPool::kMapThreshold;
+const size_t BufferPool::kMaxCachedPerClass;
+const size_t BufferPool::kMaxCachedBytes;
+
+namespace {
+
+// 不小于 n 的最小 2 的幂的指数
+size_t ceilShift(size_t n) {
+    size_t shift = 0;
+    while ((size_t(1) << shift) < n) {
+        ++shift;
+    }
+    return shift;
+}
+
+} // namespace
+
+// ------------------------------ MemoryBudget ------------------------------
+
+MemoryBudget::MemoryBudget(size_t limit)
+    : used_bytes(0), limit_bytes(limit) {
+}
+
+bool MemoryBudget::tryCharge(size_t n) noexcept {
+    size_t limit = limit_bytes.load(std::memory_order_relaxed);
+    size_t current = used_bytes.load(std::memory_order_relaxed);
+    do {
+        if (limit && current + n > limit) {
+            return false;
+        }
+    } while (!used_bytes.compare_exchange_weak(current, current + n, std::memory_order_relaxed));
+    return true;
+}
+
+void MemoryBudget::credit(size_t n) noexcept {
+    used_bytes.fetch_sub(n, std::memory_order_relaxed);
+}
+
+void MemoryBudget::setLimit(size_t limit) noexcept {
+    limit_bytes.store(limit, std::memory_order_relaxed);
+}
+
+size_t MemoryBudget::used() const noexcept {
+    return used_bytes.load(std::memory_order_relaxed);
+}
+
+size_t MemoryBudget::limit() const noexcept {
+    return limit_bytes.load(std::memory_order_relaxed);
+}
+
+// ------------------------------ BufferPool ------------------------------
+
+BufferPool::BufferPool(MemoryBudget& budget, size_t min_block, size_t max_block, bool huge_pages)
+    : budget(budget), min_shift(ceilShift(min_block ? min_block : 1)), max_shift(0),
+      huge_pages(huge_pages), allocation_count(0), reuse_count(0), denial_count(0),
+      huge_count(0), cached(0) {
+    max_shift = std::max(min_shift, ceilShift(max_block ? max_block : 1));
+    free_lists.resize(max_shift - min_shift + 1);
+}
+
+BufferPool::~BufferPool() {
+    trim();
+}
+
+size_t BufferPool::classSize(size_t n) const noexcept {
+    size_t shift = ceilShift(n);
+    if (shift < min_shift) {
+        shift = min_shift;
+    }
+    if (shift > max_shift) {
+        shift = max_shift;
+    }
+    return size_t(1) << shift;
+}
+
+size_t BufferPool::classIndex(size_t size) const noexcept {
+    return ceilShift(size) - min_shift;
+}
+
+char* BufferPool::acquire(size_t size) {
+    // 空闲块不占预算，复用时同样需要记账
+    if (!budget.tryCharge(size)) {
+        ++denial_count;
+        return nullptr;
+    }
+    std::vector<char*>& list = free_lists[classIndex(size)];
+    if (!list.empty()) {
+        char* block = list.back();
+        list.pop_back();
+        cached -= size;
+        ++reuse_count;
+        return block;
+    }
+
+    char* block = allocateBlock(size);
+    if (!block) {
+        budget.credit(size);
+        ++denial_count;
+        return nullptr;
+    }
+    ++allocation_count;
+    return block;
+}
+
+void BufferPool::release(char* block, size_t size) noexcept {
+    if (!block) {
+        return;
+    }
+    budget.credit(size);
+    std::vector<char*>& list = free_lists[classIndex(size)];
+    if (size < kMapThreshold && list.size() < kMaxCachedPerClass && cached + size <= kMaxCachedBytes) {
+        list.push_back(block);
+        cached += size;
+        return;
+    }
+    freeBlock(block, size);
+}
+
+size_t BufferPool::trim() noexcept {
+    size_t freed = 0;
+    for (size_t i = 0; i < free_lists.size(); ++i) {
+        size_t size = size_t(1) << (min_shift + i);
+        for (size_t j = 0; j < free_lists[i].size(); ++j) {
+            freeBlock(free_lists[i][j], size);
+            freed += size;
+        }
+        free_lists[i].clear();
+    }
+    cached = 0;
+    return freed;
+}
+
+BufferPool::Stats BufferPool::stats() const noexcept {
+    Stats snapshot;
+    snapshot.allocations = allocation_count;
+    snapshot.reuses = reuse_count;
+    snapshot.denials = denial_count;
+    snapshot.huge_blocks = huge_count;
+    snapshot.cached_bytes = cached;
+    return snapshot;
+}
+
+size_t BufferPool::maxBlock() const noexcept {
+    return size_t(1) << max_shift;
+}
+
+char* BufferPool::allocateBlock(size_t size) {
+    noteArenaBlock(size);
+    if (size < kMapThreshold) {
+        return new (std::nothrow) char[size];
+    }
+
+    void* block = MAP_FAILED;
+#ifdef MAP_HUGETLB
+    if (huge_pages) {
+        block = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (block != MAP_FAILED) {
+            ++huge_count;
+        }
+    }
+#endif
+    if (block == MAP_FAILED) {
+        // 没有预留大页时退回普通映射，交给透明大页
+        block = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (block == MAP_FAILED) {
+            return nullptr;
+        }
+#ifdef MADV_HUGEPAGE
+        if (huge_pages) {
+            madvise(block, size, MADV_HUGEPAGE);
+        }
+#endif
+    }
+    return static_cast<char*>(block);
+}
+
+void BufferPool::freeBlock(char* block, size_t size) noexcept {
+    if (size < kMapThreshold) {
+        delete[] block;
+    } else {
+        munmap(block, size);
+    }
+}
+
+} // namespace dns_parser
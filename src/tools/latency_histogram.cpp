@@ -0,0 +1,82 @@
+#include "../../include/tools/latency_histogram.h"
+#include <algorithm>
+#include <cstring>
+
+namespace dns_parser {
+
+const unsigned LatencyHistogram::kSubBucketBits;
+const size_t LatencyHistogram::kSubBuckets;
+const size_t LatencyHistogram::kBuckets;
+
+LatencyHistogram::Snapshot::Snapshot() : count(0), total(0), min(UINT64_MAX), max(0) {
+    std::memset(buckets, 0, sizeof(buckets));
+}
+
+void LatencyHistogram::Snapshot::merge(const Snapshot& other) {
+    count += other.count;
+    total += other.total;
+    min = std::min(min, other.min);
+    max = std::max(max, other.max);
+    for (size_t i = 0; i < kBuckets; ++i) {
+        buckets[i] += other.buckets[i];
+    }
+}
+
+uint64_t LatencyHistogram::Snapshot::valueAt(double percentile) const {
+    if (count == 0) {
+        return 0;
+    }
+    // 排名从 1 开始，向上取整
+    double rank = percentile / 100.0 * static_cast<double>(count);
+    uint64_t target = std::max<uint64_t>(1, static_cast<uint64_t>(rank + 0.999999));
+    target = std::min(target, count);
+    uint64_t seen = 0;
+    for (size_t i = 0; i < kBuckets; ++i) {
+        seen += buckets[i];
+        if (seen >= target) {
+            return std::min(bucketUpperBound(i), max);
+        }
+    }
+    return max;
+}
+
+LatencyHistogram::LatencyHistogram() : count(0), total(0), min(UINT64_MAX), max(0) {
+    for (size_t i = 0; i < kBuckets; ++i) {
+        buckets[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+void LatencyHistogram::reset() noexcept {
+    for (size_t i = 0; i < kBuckets; ++i) {
+        buckets[i].store(0, std::memory_order_relaxed);
+    }
+    count.store(0, std::memory_order_relaxed);
+    total.store(0, std::memory_order_relaxed);
+    min.store(UINT64_MAX, std::memory_order_relaxed);
+    max.store(0, std::memory_order_relaxed);
+}
+
+void LatencyHistogram::snapshot(Snapshot& out) const {
+    // 各字段分别读取，与写入线程并发时快照内部可能有一个样本的出入
+    uint64_t counted = 0;
+    for (size_t i = 0; i < kBuckets; ++i) {
+        uint64_t n = buckets[i].load(std::memory_order_relaxed);
+        out.buckets[i] += n;
+        counted += n;
+    }
+    out.count += counted;
+    out.total += total.load(std::memory_order_relaxed);
+    out.min = std::min(out.min, min.load(std::memory_order_relaxed));
+    out.max = std::max(out.max, max.load(std::memory_order_relaxed));
+}
+
+uint64_t LatencyHistogram::bucketUpperBound(size_t bucket) noexcept {
+    if (bucket < kSubBuckets) {
+        return bucket;
+    }
+    unsigned shift = static_cast<unsigned>(bucket / kSubBuckets) - 1;
+    uint64_t base = static_cast<uint64_t>(kSubBuckets + bucket % kSubBuckets) << shift;
+    return base + ((uint64_t(1) << shift) - 1);
+}
+
+} // namespace dns_parser
@@ -0,0 +1,410 @@
+#include "../../include/tools/name_check.h"
+#include <cstring>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define DNS_PARSER_NAME_CHECK_X86 1
+#include <immintrin.h>
+#define DNS_PARSER_TARGET(isa) __attribute__((target(isa)))
+#else
+#define DNS_PARSER_NAME_CHECK_X86 0
+#endif
+
+// 记录位置位的辅助函数被各指令集的实现内联，避免调用时在 AVX 和 SSE 状态之间切换
+#if defined(__GNUC__) || defined(__clang__)
+#define DNS_PARSER_ALWAYS_INLINE inline __attribute__((always_inline))
+#else
+#define DNS_PARSER_ALWAYS_INLINE inline
+#endif
+
+namespace dns_parser {
+
+namespace {
+
+const size_t kMaxText = 256;            // 掩码覆盖的字节数，域名文本不超过 255 字节
+const size_t kWords = kMaxText / 64;
+
+/**
+ * @brief 一个域名中各类字节的位置
+ *
+ * '.'、'-'、'x'、'n'（均为转换后的小写）按位置记录，供按位检查标签边界和
+ * "xn--" 前缀；其余三项只关心是否出现，按块按位或
+ */
+struct NameMasks {
+    uint64_t dots[kWords];
+    uint64_t hyphens[kWords];
+    uint64_t xs[kWords];
+    uint64_t ns[kWords];
+    uint32_t upper;
+    uint32_t invalid;       // 小写字母、数字、'-'、'.' 以外的字节
+    uint32_t high;          // 非 ASCII 字节
+
+    NameMasks() : dots(), hyphens(), xs(), ns(), upper(0), invalid(0), high(0) {}
+};
+
+/**
+ * @brief 一块字节的分类结果，第 i 位对应块内第 i 个字节
+ */
+struct BlockBits {
+    uint32_t upper;
+    uint32_t invalid;
+    uint32_t high;
+    uint32_t dots;
+    uint32_t hyphens;
+    uint32_t xs;
+    uint32_t ns;
+};
+
+// 把块内 width 个字节的位置位写到 pos 处，可跨越两个掩码字
+DNS_PARSER_ALWAYS_INLINE void setBits(uint64_t* words, size_t pos, uint32_t bits, size_t width) {
+    size_t shift = pos % 64;
+    words[pos / 64] |= static_cast<uint64_t>(bits) << shift;
+    if (shift + width > 64) {
+        words[pos / 64 + 1] |= static_cast<uint64_t>(bits) >> (64 - shift);
+    }
+}
+
+DNS_PARSER_ALWAYS_INLINE void recordBlock(NameMasks& masks, const BlockBits& bits, size_t pos, size_t width) {
+    masks.upper |= bits.upper;
+    masks.invalid |= bits.invalid;
+    masks.high |= bits.high;
+    setBits(masks.dots, pos, bits.dots, width);
+    setBits(masks.hyphens, pos, bits.hyphens, width);
+    setBits(masks.xs, pos, bits.xs, width);
+    setBits(masks.ns, pos, bits.ns, width);
+}
+
+// 第 i 位取 words 第 i + k 位的值，k 小于 64
+DNS_PARSER_ALWAYS_INLINE uint64_t shiftDown(const uint64_t* words, size_t w, size_t k) {
+    uint64_t next = w + 1 < kWords ? words[w + 1] : 0;
+    return (words[w] >> k) | (next << (64 - k));
+}
+
+/**
+ * @brief 掩码取得之后按位检查所有标签
+ *
+ * 标签开头是第 0 个字节和每个 '.' 之后的字节，结尾是最后一个字节和每个 '.' 之前的字节：
+ * 开头或结尾是 '-' 的标签不是 LDH，开头或结尾是 '.' 的标签为空，开头之后依次是
+ * "xn--" 的是 A-label。只有超过 63 字节的标签需要逐个 '.' 查找，短名字不会出现。
+ */
+uint8_t checkLabels(size_t length, const NameMasks& masks) {
+    uint8_t flags = 0;
+    if (masks.upper) {
+        flags |= NAME_UPPERCASE;
+    }
+    if (masks.invalid) {
+        flags |= NAME_NON_LDH;
+    }
+    if (masks.high) {
+        flags |= NAME_IDN;
+    }
+    if (length == 0) {
+        return flags;
+    }
+
+    size_t words = (length + 63) / 64;
+    size_t last = length - 1;
+    uint64_t edge = 0;
+    uint64_t empty = 0;
+    uint64_t ace = 0;
+    uint64_t carry = 1;     // 第 0 个字节是标签开头
+    for (size_t w = 0; w < words; ++w) {
+        uint64_t dots = masks.dots[w];
+        uint64_t starts = (dots << 1) | carry;
+        carry = dots >> 63;
+        uint64_t ends = shiftDown(masks.dots, w, 1);
+        if (w == last / 64) {
+            ends |= 1ULL << (last % 64);
+        }
+        edge |= masks.hyphens[w] & (starts | ends);
+        empty |= dots & (starts | ends);
+        ace |= starts & masks.xs[w] & shiftDown(masks.ns, w, 1) &
+               shiftDown(masks.hyphens, w, 2) & shiftDown(masks.hyphens, w, 3);
+    }
+    if (edge) {
+        flags |= NAME_NON_LDH;
+    }
+    if (ace) {
+        flags |= NAME_IDN;
+    }
+    if (empty) {
+        flags |= NAME_BAD_LENGTH;
+    }
+
+    if (length > 63 && !empty) {
+        size_t start = 0;
+        for (size_t w = 0; w < words; ++w) {
+            for (uint64_t bits = masks.dots[w]; bits; bits &= bits - 1) {
+                size_t dot = w * 64 + static_cast<size_t>(__builtin_ctzll(bits));
+                if (dot - start > 63) {
+                    flags |= NAME_BAD_LENGTH;
+                }
+                start = dot + 1;
+            }
+        }
+        if (length - start > 63) {
+            flags |= NAME_BAD_LENGTH;
+        }
+    }
+    return flags;
+}
+
+// 超长的文本不在掩码范围内，只转小写
+uint8_t foldLongName(char* name, size_t length) {
+    uint8_t flags = NAME_BAD_LENGTH;
+    for (size_t i = 0; i < length; ++i) {
+        uint8_t c = static_cast<uint8_t>(name[i]);
+        if (static_cast<uint8_t>(c - 'A') < 26) {
+            name[i] = static_cast<char>(c | 0x20);
+            flags |= NAME_UPPERCASE;
+        }
+    }
+    return flags;
+}
+
+// 逐字节处理 [begin, end)，用于标量实现和向量实现处理不足 8 字节的名字
+void scanBytes(char* name, size_t begin, size_t end, NameMasks& masks) {
+    for (size_t i = begin; i < end; ++i) {
+        uint8_t c = static_cast<uint8_t>(name[i]);
+        uint64_t bit = 1ULL << (i % 64);
+        if (static_cast<uint8_t>(c - 'A') < 26) {
+            c |= 0x20;
+            name[i] = static_cast<char>(c);
+            masks.upper = 1;
+        }
+        if (c == '.') {
+            masks.dots[i / 64] |= bit;
+        } else if (c == '-') {
+            masks.hyphens[i / 64] |= bit;
+        } else if (static_cast<uint8_t>(c - 'a') >= 26 && static_cast<uint8_t>(c - '0') >= 10) {
+            masks.invalid = 1;
+            masks.high |= c >> 7;
+        }
+        if (c == 'x') {
+            masks.xs[i / 64] |= bit;
+        } else if (c == 'n') {
+            masks.ns[i / 64] |= bit;
+        }
+    }
+}
+
+#if DNS_PARSER_NAME_CHECK_X86
+
+// 有符号比较实现无符号区间判断：c 在 [lo, lo + n) 内时 c + (0x80 - lo) 落在 [-128, -128 + n)
+DNS_PARSER_TARGET("sse2")
+inline __m128i inRange16(__m128i v, uint8_t lo, int n) {
+    __m128i shifted = _mm_add_epi8(v, _mm_set1_epi8(static_cast<char>(0x80 - lo)));
+    return _mm_cmplt_epi8(shifted, _mm_set1_epi8(static_cast<char>(-128 + n)));
+}
+
+// 转换一块 16 字节并分类，返回转换后的数据
+DNS_PARSER_TARGET("sse2")
+inline __m128i scan16(__m128i v, BlockBits& bits) {
+    __m128i upper = inRange16(v, 'A', 26);
+    v = _mm_or_si128(v, _mm_and_si128(upper, _mm_set1_epi8(0x20)));
+    __m128i dot = _mm_cmpeq_epi8(v, _mm_set1_epi8('.'));
+    __m128i hyphen = _mm_cmpeq_epi8(v, _mm_set1_epi8('-'));
+    __m128i valid = _mm_or_si128(_mm_or_si128(inRange16(v, 'a', 26), inRange16(v, '0', 10)),
+                                 _mm_or_si128(dot, hyphen));
+    bits.upper = static_cast<uint32_t>(_mm_movemask_epi8(upper));
+    bits.invalid = ~static_cast<uint32_t>(_mm_movemask_epi8(valid)) & 0xFFFF;
+    bits.high = static_cast<uint32_t>(_mm_movemask_epi8(v));
+    bits.dots = static_cast<uint32_t>(_mm_movemask_epi8(dot));
+    bits.hyphens = static_cast<uint32_t>(_mm_movemask_epi8(hyphen));
+    bits.xs = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8('x'))));
+    bits.ns = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8('n'))));
+    return v;
+}
+
+DNS_PARSER_TARGET("sse2")
+inline void scanBlock16(char* name, size_t pos, NameMasks& masks) {
+    BlockBits bits;
+    __m128i v = scan16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(name + pos)), bits);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(name + pos), v);
+    recordBlock(masks, bits, pos, 16);
+}
+
+/**
+ * @brief SSE2 处理整个名字
+ *
+ * 尾部不足一块时最后一块与前一块重叠，转换可以重复进行，位置位按或合并；
+ * 8 到 15 字节的名字拼成首尾各 8 字节的一块，更短的逐字节处理，都不读写名字之外的内存
+ */
+DNS_PARSER_TARGET("sse2")
+void scanSse2(char* name, size_t length, NameMasks& masks) {
+    if (length >= 16) {
+        size_t i = 0;
+        for (; i + 16 <= length; i += 16) {
+            scanBlock16(name, i, masks);
+        }
+        if (i < length) {
+            scanBlock16(name, length - 16, masks);
+        }
+    } else if (length >= 8) {
+        size_t tail = length - 8;
+        __m128i v = _mm_unpacklo_epi64(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(name)),
+                                       _mm_loadl_epi64(reinterpret_cast<const __m128i*>(name + tail)));
+        BlockBits bits;
+        v = scan16(v, bits);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(name), v);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(name + tail), _mm_unpackhi_epi64(v, v));
+        BlockBits high = bits;
+        bits.dots &= 0xFF;
+        bits.hyphens &= 0xFF;
+        bits.xs &= 0xFF;
+        bits.ns &= 0xFF;
+        recordBlock(masks, bits, 0, 8);
+        high.dots >>= 8;
+        high.hyphens >>= 8;
+        high.xs >>= 8;
+        high.ns >>= 8;
+        recordBlock(masks, high, tail, 8);
+    } else {
+        scanBytes(name, 0, length, masks);
+    }
+}
+
+DNS_PARSER_TARGET("avx2")
+inline __m256i inRange32(__m256i v, uint8_t lo, int n) {
+    __m256i shifted = _mm256_add_epi8(v, _mm256_set1_epi8(static_cast<char>(0x80 - lo)));
+    return _mm256_cmpgt_epi8(_mm256_set1_epi8(static_cast<char>(-128 + n)), shifted);
+}
+
+DNS_PARSER_TARGET("avx2")
+inline void scanBlock32(char* name, size_t pos, NameMasks& masks) {
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(name + pos));
+    __m256i upper = inRange32(v, 'A', 26);
+    v = _mm256_or_si256(v, _mm256_and_si256(upper, _mm256_set1_epi8(0x20)));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(name + pos), v);
+
+    __m256i dot = _mm256_cmpeq_epi8(v, _mm256_set1_epi8('.'));
+    __m256i hyphen = _mm256_cmpeq_epi8(v, _mm256_set1_epi8('-'));
+    __m256i valid = _mm256_or_si256(_mm256_or_si256(inRange32(v, 'a', 26), inRange32(v, '0', 10)),
+                                    _mm256_or_si256(dot, hyphen));
+    BlockBits bits;
+    bits.upper = static_cast<uint32_t>(_mm256_movemask_epi8(upper));
+    bits.invalid = ~static_cast<uint32_t>(_mm256_movemask_epi8(valid));
+    bits.high = static_cast<uint32_t>(_mm256_movemask_epi8(v));
+    bits.dots = static_cast<uint32_t>(_mm256_movemask_epi8(dot));
+    bits.hyphens = static_cast<uint32_t>(_mm256_movemask_epi8(hyphen));
+    bits.xs = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('x'))));
+    bits.ns = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('n'))));
+    recordBlock(masks, bits, pos, 32);
+}
+
+#endif // DNS_PARSER_NAME_CHECK_X86
+
+typedef uint8_t (*NormalizeFn)(char*, size_t);
+
+struct Implementation {
+    NormalizeFn normalize;
+    const char* name;
+};
+
+Implementation selectImplementation() {
+    Implementation chosen = { detail::normalizeNameScalar, "scalar" };
+    if (detail::cpuHasAvx2()) {
+        chosen.normalize = detail::normalizeNameAvx2;
+        chosen.name = "avx2";
+    } else if (detail::cpuHasSse2()) {
+        chosen.normalize = detail::normalizeNameSse2;
+        chosen.name = "sse2";
+    }
+    return chosen;
+}
+
+const Implementation& implementation() {
+    static const Implementation selected = selectImplementation();
+    return selected;
+}
+
+} // namespace
+
+namespace detail {
+
+uint8_t normalizeNameScalar(char* name, size_t length) {
+    if (length >= kMaxText) {
+        return foldLongName(name, length);
+    }
+    NameMasks masks;
+    scanBytes(name, 0, length, masks);
+    return checkLabels(length, masks);
+}
+
+#if DNS_PARSER_NAME_CHECK_X86
+
+DNS_PARSER_TARGET("sse2")
+uint8_t normalizeNameSse2(char* name, size_t length) {
+    if (length >= kMaxText) {
+        return foldLongName(name, length);
+    }
+    NameMasks masks;
+    scanSse2(name, length, masks);
+    return checkLabels(length, masks);
+}
+
+DNS_PARSER_TARGET("avx2")
+uint8_t normalizeNameAvx2(char* name, size_t length) {
+    if (length >= kMaxText) {
+        return foldLongName(name, length);
+    }
+    NameMasks masks;
+    // 不足一块的名字（大多数查询名）交给 SSE2 的路径
+    if (length < 32) {
+        scanSse2(name, length, masks);
+    } else {
+        size_t i = 0;
+        for (; i + 32 <= length; i += 32) {
+            scanBlock32(name, i, masks);
+        }
+        if (i < length) {
+            scanBlock32(name, length - 32, masks);
+        }
+    }
+    return checkLabels(length, masks);
+}
+
+bool cpuHasSse2() {
+#if defined(__x86_64__)
+    return true;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("sse2");
+#endif
+}
+
+bool cpuHasAvx2() {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+}
+
+#else
+
+uint8_t normalizeNameSse2(char* name, size_t length) {
+    return normalizeNameScalar(name, length);
+}
+
+uint8_t normalizeNameAvx2(char* name, size_t length) {
+    return normalizeNameScalar(name, length);
+}
+
+bool cpuHasSse2() {
+    return false;
+}
+
+bool cpuHasAvx2() {
+    return false;
+}
+
+#endif // DNS_PARSER_NAME_CHECK_X86
+
+} // namespace detail
+
+uint8_t normalizeName(char* name, size_t length) {
+    return implementation().normalize(name, length);
+}
+
+const char* nameCheckImplementation() {
+    return implementation().name;
+}
+
+} // namespace dns_parser
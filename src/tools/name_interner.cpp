@@ -0,0 +1,294 @@
+#include "../../include/tools/name_interner.h"
+#include "../../include/tools/aligned.h"
+#include "../../include/tools/name_hash.h"
+#include <cstring>
+
+namespace dns_parser {
+
+const uint32_t NameInterner::kInvalidId;
+const size_t NameInterner::kMaxNameLength;
+const size_t NameInterner::kLocalSlabSize;
+
+namespace {
+
+// 全局驻留表容量
+const size_t kGlobalCapacity = 1 << 20;
+
+// 复制并转为小写，返回规范化后的长度
+inline void foldCase(const char* src, size_t len, char* dst) {
+    for (size_t i = 0; i < len; ++i) {
+        char c = src[i];
+        dst[i] = (c >= 'A' && c <= 'Z') ? static_cast<char>(c + ('a' - 'A')) : c;
+    }
+}
+
+inline uint32_t tagOf(uint64_t hash) {
+    return static_cast<uint32_t>(hash >> 32);
+}
+
+} // namespace
+
+NameInterner::NameInterner(size_t max_names, bool shared)
+    : capacity(max_names), next_id(0), slab_bytes(0), shared(shared),
+      stripe_count(shared ? kStripes : 1), slab_size(shared ? kSlabSize : kLocalSlabSize) {
+    // 哈希表保持不超过 50% 负载，探测链始终很短
+    size_t table_size = 16;
+    while (table_size < max_names * 2) {
+        table_size <<= 1;
+    }
+    mask = table_size - 1;
+    slots = new std::atomic<uint64_t>[table_size];
+    for (size_t i = 0; i < table_size; ++i) {
+        slots[i].store(0, std::memory_order_relaxed);
+    }
+
+    chunk_count = (max_names >> kChunkBits) + 1;
+    chunks = new std::atomic<std::atomic<const char*>*>[chunk_count];
+    for (size_t i = 0; i < chunk_count; ++i) {
+        chunks[i].store(nullptr, std::memory_order_relaxed);
+    }
+
+    stripes = alignedNewArray<Stripe>(stripe_count);
+}
+
+NameInterner::~NameInterner() {
+    for (size_t i = 0; i < stripe_count; ++i) {
+        for (size_t j = 0; j < stripes[i].slabs.size(); ++j) {
+            delete[] stripes[i].slabs[j];
+        }
+    }
+    alignedDeleteArray(stripes, stripe_count);
+    for (size_t i = 0; i < chunk_count; ++i) {
+        delete[] chunks[i].load(std::memory_order_relaxed);
+    }
+    delete[] chunks;
+    delete[] slots;
+}
+
+NameInterner& NameInterner::global() {
+    static NameInterner instance(kGlobalCapacity);
+    return instance;
+}
+
+uint32_t NameInterner::intern(const char* name, size_t len) {
+    if (len > kMaxNameLength) {
+        return kInvalidId;
+    }
+    return intern(name, len, hashNameText(name, len));
+}
+
+uint32_t NameInterner::intern(const char* name, size_t len, uint64_t hash, bool lowercase) {
+    if (len > kMaxNameLength) {
+        return kInvalidId;
+    }
+
+    char buffer[kMaxNameLength];
+    const char* folded = name;
+    if (!lowercase) {
+        foldCase(name, len, buffer);
+        folded = buffer;
+    }
+
+    // 快速路径：无锁命中
+    uint32_t id = lookup(folded, len, hash);
+    if (id != kInvalidId) {
+        return id;
+    }
+
+    // 同名插入必然落在同一分段，加锁后复查即可避免重复分配；私有实例没有并发写入者
+    Stripe& stripe = stripes[hash & (stripe_count - 1)];
+    std::unique_lock<std::mutex> guard(stripe.lock, std::defer_lock);
+    if (shared) {
+        guard.lock();
+        id = lookup(folded, len, hash);
+        if (id != kInvalidId) {
+            return id;
+        }
+    }
+
+    if (shared) {
+        id = next_id.fetch_add(1, std::memory_order_relaxed);
+        if (id >= capacity) {
+            next_id.store(static_cast<uint32_t>(capacity), std::memory_order_relaxed);
+            return kInvalidId;
+        }
+    } else {
+        id = next_id.load(std::memory_order_relaxed);
+        if (id >= capacity) {
+            return kInvalidId;
+        }
+        next_id.store(id + 1, std::memory_order_relaxed);
+    }
+
+    // 记录格式：[长度 1 字节][名字][\0]
+    char* rec = allocate(stripe, len + 2);
+    rec[0] = static_cast<char>(len);
+    std::memcpy(rec + 1, folded, len);
+    rec[len + 1] = '\0';
+    publish(id, rec);
+
+    // 目录先于槽位发布，读者看到槽位时一定能看到记录
+    uint64_t value = (static_cast<uint64_t>(tagOf(hash)) << 32) | (static_cast<uint64_t>(id) + 1);
+    size_t i = static_cast<size_t>(hash) & mask;
+    while (true) {
+        uint64_t expected = 0;
+        if (!shared) {
+            if (slots[i].load(std::memory_order_relaxed) == 0) {
+                slots[i].store(value, std::memory_order_release);
+                break;
+            }
+        } else if (slots[i].compare_exchange_strong(expected, value, std::memory_order_release,
+                                                    std::memory_order_relaxed)) {
+            break;
+        }
+        i = (i + 1) & mask;
+    }
+    return id;
+}
+
+uint32_t NameInterner::intern(const std::string& name) {
+    return intern(name.data(), name.size());
+}
+
+uint32_t NameInterner::find(const char* name, size_t len) const {
+    if (len > kMaxNameLength) {
+        return kInvalidId;
+    }
+    char folded[kMaxNameLength];
+    foldCase(name, len, folded);
+    return lookup(folded, len, hashNameText(folded, len));
+}
+
+uint32_t NameInterner::find(const std::string& name) const {
+    return find(name.data(), name.size());
+}
+
+const char* NameInterner::data(uint32_t id, size_t* len) const {
+    const char* rec = record(id);
+    if (!rec) {
+        return nullptr;
+    }
+    if (len) {
+        *len = static_cast<uint8_t>(rec[0]);
+    }
+    return rec + 1;
+}
+
+std::string NameInterner::name(uint32_t id) const {
+    size_t len = 0;
+    const char* str = data(id, &len);
+    return str ? std::string(str, len) : std::string();
+}
+
+size_t NameInterner::size() const noexcept {
+    size_t n = next_id.load(std::memory_order_relaxed);
+    return n < capacity ? n : capacity;
+}
+
+size_t NameInterner::maxNames() const noexcept {
+    return capacity;
+}
+
+bool NameInterner::full() const noexcept {
+    return next_id.load(std::memory_order_relaxed) >= capacity;
+}
+
+void NameInterner::clear() {
+    for (size_t i = 0; i <= mask; ++i) {
+        slots[i].store(0, std::memory_order_relaxed);
+    }
+    for (size_t i = 0; i < chunk_count; ++i) {
+        delete[] chunks[i].exchange(nullptr, std::memory_order_relaxed);
+    }
+    for (size_t i = 0; i < stripe_count; ++i) {
+        Stripe& stripe = stripes[i];
+        for (size_t j = 0; j < stripe.slabs.size(); ++j) {
+            delete[] stripe.slabs[j];
+        }
+        stripe.slabs.clear();
+        stripe.cursor = nullptr;
+        stripe.remaining = 0;
+    }
+    slab_bytes.store(0, std::memory_order_relaxed);
+    next_id.store(0, std::memory_order_release);
+}
+
+size_t NameInterner::memoryUsage() const noexcept {
+    size_t used_chunks = 0;
+    for (size_t i = 0; i < chunk_count; ++i) {
+        if (chunks[i].load(std::memory_order_relaxed)) {
+            ++used_chunks;
+        }
+    }
+    return (mask + 1) * sizeof(uint64_t)
+        + used_chunks * kChunkSize * sizeof(const char*)
+        + slab_bytes.load(std::memory_order_relaxed);
+}
+
+uint32_t NameInterner::lookup(const char* name, size_t len, uint64_t hash) const {
+    uint32_t tag = tagOf(hash);
+    size_t i = static_cast<size_t>(hash) & mask;
+    while (true) {
+        uint64_t value = slots[i].load(std::memory_order_acquire);
+        if (value == 0) {
+            return kInvalidId;
+        }
+        if (static_cast<uint32_t>(value >> 32) == tag) {
+            uint32_t id = static_cast<uint32_t>(value) - 1;
+            const char* rec = record(id);
+            if (rec && static_cast<uint8_t>(rec[0]) == len && std::memcmp(rec + 1, name, len) == 0) {
+                return id;
+            }
+        }
+        i = (i + 1) & mask;
+    }
+}
+
+const char* NameInterner::record(uint32_t id) const {
+    if (id >= capacity) {
+        return nullptr;
+    }
+    std::atomic<const char*>* chunk = chunks[id >> kChunkBits].load(std::memory_order_acquire);
+    if (!chunk) {
+        return nullptr;
+    }
+    return chunk[id & (kChunkSize - 1)].load(std::memory_order_acquire);
+}
+
+void NameInterner::publish(uint32_t id, const char* rec) {
+    std::atomic<std::atomic<const char*>*>& slot = chunks[id >> kChunkBits];
+    std::atomic<const char*>* chunk = slot.load(std::memory_order_acquire);
+    if (!chunk) {
+        // 目录块按需创建，共享实例中多个分段同时创建时只保留一个
+        std::atomic<const char*>* fresh = new std::atomic<const char*>[kChunkSize];
+        for (size_t i = 0; i < kChunkSize; ++i) {
+            fresh[i].store(nullptr, std::memory_order_relaxed);
+        }
+        if (!shared) {
+            slot.store(fresh, std::memory_order_release);
+            chunk = fresh;
+        } else if (slot.compare_exchange_strong(chunk, fresh, std::memory_order_acq_rel,
+                                                std::memory_order_acquire)) {
+            chunk = fresh;
+        } else {
+            delete[] fresh;
+        }
+    }
+    chunk[id & (kChunkSize - 1)].store(rec, std::memory_order_release);
+}
+
+char* NameInterner::allocate(Stripe& stripe, size_t bytes) {
+    if (stripe.remaining < bytes) {
+        char* slab = new char[slab_size];
+        stripe.slabs.push_back(slab);
+        stripe.cursor = slab;
+        stripe.remaining = slab_size;
+        slab_bytes.fetch_add(slab_size, std::memory_order_relaxed);
+    }
+    char* rec = stripe.cursor;
+    stripe.cursor += bytes;
+    stripe.remaining -= bytes;
+    return rec;
+}
+
+} // namespace dns_parser
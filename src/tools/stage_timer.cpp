@@ -0,0 +1,111 @@
+#include "../../include/tools/stage_timer.h"
+
+namespace dns_parser {
+
+const size_t StageRecorder::kStages;
+
+namespace {
+
+uint64_t monotonicNanos() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + ts.tv_nsec;
+}
+
+double calibrate() {
+#if defined(__x86_64__) || defined(__i386__)
+    uint64_t start_ns = monotonicNanos();
+    uint64_t start_ticks = CycleClock::now();
+    struct timespec pause = { 0, 10000000 };
+    nanosleep(&pause, nullptr);
+    uint64_t elapsed_ns = monotonicNanos() - start_ns;
+    uint64_t elapsed_ticks = CycleClock::now() - start_ticks;
+    return elapsed_ticks ? static_cast<double>(elapsed_ns) / static_cast<double>(elapsed_ticks) : 1.0;
+#else
+    return 1.0;
+#endif
+}
+
+} // namespace
+
+double CycleClock::nanosPerTick() {
+    // 局部静态变量的初始化是线程安全的
+    static const double value = calibrate();
+    return value;
+}
+
+namespace {
+
+inline void bump(std::atomic<uint64_t>& counter, uint64_t n) noexcept {
+    counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+} // namespace
+
+void StageRecorder::reset() noexcept {
+    for (size_t i = 0; i < kStages; ++i) {
+        histograms[i].reset();
+        stage_allocations[i].store(0, std::memory_order_relaxed);
+        stage_bytes[i].store(0, std::memory_order_relaxed);
+    }
+    per_packet.reset();
+    alloc_packets.store(0, std::memory_order_relaxed);
+    alloc_frees.store(0, std::memory_order_relaxed);
+    arena_blocks.store(0, std::memory_order_relaxed);
+    arena_bytes.store(0, std::memory_order_relaxed);
+}
+
+void StageRecorder::finishAllocations() noexcept {
+    // 最后一个计时点之后的分配（如 Filter 返回前的清理）计入输出阶段
+    lap(Stage::Output);
+    uint64_t packet_allocations = 0;
+    for (size_t i = 0; i < kStages; ++i) {
+        if (alloc_pending[i]) {
+            bump(stage_allocations[i], alloc_pending[i]);
+            bump(stage_bytes[i], bytes_pending[i]);
+            packet_allocations += alloc_pending[i];
+            alloc_pending[i] = 0;
+            bytes_pending[i] = 0;
+        }
+    }
+    per_packet.record(packet_allocations);
+    bump(alloc_packets, 1);
+    bump(alloc_frees, alloc_last.frees - alloc_begin.frees);
+    bump(arena_blocks, alloc_last.arena_blocks - alloc_begin.arena_blocks);
+    bump(arena_bytes, alloc_last.arena_bytes - alloc_begin.arena_bytes);
+}
+
+StageRecorder::AllocStats StageRecorder::allocStats() const noexcept {
+    AllocStats stats;
+    stats.packets = alloc_packets.load(std::memory_order_relaxed);
+    stats.frees = alloc_frees.load(std::memory_order_relaxed);
+    stats.arena_blocks = arena_blocks.load(std::memory_order_relaxed);
+    stats.arena_bytes = arena_bytes.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < kStages; ++i) {
+        stats.allocations[i] = stage_allocations[i].load(std::memory_order_relaxed);
+        stats.bytes[i] = stage_bytes[i].load(std::memory_order_relaxed);
+    }
+    return stats;
+}
+
+const char* StageRecorder::stageName(Stage stage) {
+    switch (stage) {
+        case Stage::Intake:
+            return "取得任务";
+        case Stage::Header:
+            return "头部解析";
+        case Stage::Question:
+            return "问题解析";
+        case Stage::Records:
+            return "资源记录解析";
+        case Stage::Analytics:
+            return "分析";
+        case Stage::Output:
+            return "输出";
+        case Stage::Count:
+            break;
+    }
+    return "未知";
+}
+
+} // namespace dns_parser
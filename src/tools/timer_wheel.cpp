@@ -0,0 +1,233 @@
+#include "../../include/tools/timer_wheel.h"
+#include <cstring>
+
+namespace dns_parser {
+
+const TimerWheel::Handle TimerWheel::kInvalidHandle;
+const unsigned TimerWheel::kLevels;
+const unsigned TimerWheel::kSlotBits;
+const unsigned TimerWheel::kSlots;
+const uint64_t TimerWheel::kSlotMask;
+const uint32_t TimerWheel::kNil;
+
+TimerWheel::TimerWheel(uint64_t now)
+    : free_node(kNil), current(now), count(0), cascaded(false), firing(false) {
+    for (size_t i = 0; i < kLevels * kSlots; ++i) {
+        heads[i] = kNil;
+    }
+    std::memset(occupied, 0, sizeof(occupied));
+}
+
+void TimerWheel::reset(uint64_t now) {
+    if (count == 0) {
+        current = now;
+        cascaded = false;
+    }
+}
+
+TimerWheel::Handle TimerWheel::schedule(uint64_t expire, uint64_t data) {
+    uint32_t index;
+    if (free_node != kNil) {
+        index = free_node;
+        free_node = nodes[index].next;
+    } else {
+        index = static_cast<uint32_t>(nodes.size());
+        Node node;
+        node.generation = 1;
+        nodes.push_back(node);
+    }
+
+    Node& node = nodes[index];
+    node.expire = expire;
+    node.data = data;
+    node.live = true;
+    link(index);
+    ++count;
+    return (static_cast<uint64_t>(node.generation) << 32) | index;
+}
+
+bool TimerWheel::cancel(Handle handle) {
+    Node* node = lookup(handle);
+    if (!node) {
+        return false;
+    }
+    uint32_t index = static_cast<uint32_t>(handle);
+    unlink(index);
+    release(index);
+    return true;
+}
+
+bool TimerWheel::reschedule(Handle handle, uint64_t expire) {
+    Node* node = lookup(handle);
+    if (!node) {
+        return false;
+    }
+    uint32_t index = static_cast<uint32_t>(handle);
+    unlink(index);
+    node->expire = expire;
+    link(index);
+    return true;
+}
+
+uint64_t TimerWheel::now() const noexcept {
+    return current;
+}
+
+size_t TimerWheel::size() const noexcept {
+    return count;
+}
+
+TimerWheel::Node* TimerWheel::lookup(Handle handle) {
+    uint32_t index = static_cast<uint32_t>(handle);
+    if (handle == kInvalidHandle || index >= nodes.size()) {
+        return nullptr;
+    }
+    Node& node = nodes[index];
+    if (!node.live || node.generation != static_cast<uint32_t>(handle >> 32)) {
+        return nullptr;
+    }
+    return &node;
+}
+
+// 按到期刻度与当前刻度的最高不同位选择层级
+void TimerWheel::link(uint32_t index) {
+    Node& node = nodes[index];
+    // 正在触发 current 刻度时，已到期的新定时器推迟到下一个刻度
+    uint64_t floor = firing ? current + 1 : current;
+    if (node.expire < floor) {
+        node.expire = floor;
+    }
+
+    uint64_t diff = node.expire ^ current;
+    unsigned level = 0;
+    while (level < kLevels && (diff >> (kSlotBits * (level + 1))) != 0) {
+        ++level;
+    }
+    unsigned slot;
+    if (level < kLevels) {
+        slot = static_cast<unsigned>((node.expire >> (kSlotBits * level)) & kSlotMask);
+    } else {
+        // 跨轮的定时器挂在最高层已处理过的槽位，下一轮才会扫到：
+        // 一轮之内的按到期槽位放置，更远的挂在本轮最后处理的槽位，届时重新计算
+        level = kLevels - 1;
+        unsigned shift = kSlotBits * level;
+        if (node.expire - current < (uint64_t(1) << (kSlotBits * kLevels))) {
+            slot = static_cast<unsigned>((node.expire >> shift) & kSlotMask);
+        } else {
+            slot = static_cast<unsigned>(((current >> shift) + kSlotMask) & kSlotMask);
+        }
+    }
+
+    uint32_t bucket = level * kSlots + slot;
+    node.slot = static_cast<uint16_t>(bucket);
+    node.prev = kNil;
+    node.next = heads[bucket];
+    if (node.next != kNil) {
+        nodes[node.next].prev = index;
+    }
+    heads[bucket] = index;
+    occupied[level][slot / 64] |= uint64_t(1) << (slot % 64);
+}
+
+void TimerWheel::unlink(uint32_t index) {
+    Node& node = nodes[index];
+    if (node.prev != kNil) {
+        nodes[node.prev].next = node.next;
+    } else {
+        heads[node.slot] = node.next;
+    }
+    if (node.next != kNil) {
+        nodes[node.next].prev = node.prev;
+    }
+    if (heads[node.slot] == kNil) {
+        unsigned level = node.slot / kSlots;
+        unsigned slot = node.slot % kSlots;
+        occupied[level][slot / 64] &= ~(uint64_t(1) << (slot % 64));
+    }
+}
+
+// 从槽位摘下并回收节点（advance 中从链表头摘下时调用）
+void TimerWheel::release(uint32_t index) {
+    Node& node = nodes[index];
+    if (node.live && heads[node.slot] == index) {
+        unlink(index);
+    }
+    node.live = false;
+    ++node.generation;
+    if (node.generation == 0) {
+        node.generation = 1;
+    }
+    node.next = free_node;
+    free_node = index;
+    --count;
+}
+
+// 在 tick 处把各层对应槽位的定时器下放到低层，高层先处理
+size_t TimerWheel::cascade(uint64_t tick) {
+    size_t moved = 0;
+    for (unsigned level = kLevels - 1; level > 0; --level) {
+        uint64_t low_mask = (uint64_t(1) << (kSlotBits * level)) - 1;
+        if ((tick & low_mask) != 0) {
+            continue;
+        }
+        unsigned slot = static_cast<unsigned>((tick >> (kSlotBits * level)) & kSlotMask);
+        uint32_t bucket = level * kSlots + slot;
+        uint32_t index = heads[bucket];
+        heads[bucket] = kNil;
+        occupied[level][slot / 64] &= ~(uint64_t(1) << (slot % 64));
+        while (index != kNil) {
+            uint32_t next = nodes[index].next;
+            link(index);
+            index = next;
+            ++moved;
+        }
+    }
+    return moved;
+}
+
+// 在某层位图中查找不小于 from 的第一个占用槽位
+int TimerWheel::findSlot(unsigned level, unsigned from) const {
+    for (unsigned word = from / 64; word < kSlots / 64; ++word) {
+        uint64_t bits = occupied[level][word];
+        if (word == from / 64) {
+            bits &= ~uint64_t(0) << (from % 64);
+        }
+        if (bits) {
+            return static_cast<int>(word * 64 + __builtin_ctzll(bits));
+        }
+    }
+    return -1;
+}
+
+// 计算下一个需要处理的刻度：各层下一个占用槽位的起点取最小值。
+// current 恰好对齐到高层槽位边界时，该高层槽位尚未下放，其起点就是 current，
+// 可能早于低层的占用槽位，所以不能在找到第一个非空层时就返回。
+uint64_t TimerWheel::nextEventTick() const {
+    unsigned top = kSlotBits * kLevels;
+    // 本轮都为空（只剩挂在最高层已处理槽位的远期定时器）时跳到下一轮起点
+    uint64_t best = ((current >> top) + 1) << top;
+    for (unsigned level = 0; level < kLevels; ++level) {
+        unsigned shift = kSlotBits * level;
+        unsigned index = static_cast<unsigned>((current >> shift) & kSlotMask);
+        uint64_t low_mask = (uint64_t(1) << shift) - 1;
+        // 高层当前槽位若已开始处理则已下放，只看后面的槽位
+        unsigned from = (level == 0 || (current & low_mask) == 0) ? index : index + 1;
+        if (from >= kSlots) {
+            continue;
+        }
+        int slot = findSlot(level, from);
+        if (slot >= 0) {
+            uint64_t block = current >> (shift + kSlotBits) << (shift + kSlotBits);
+            uint64_t tick = block | (static_cast<uint64_t>(slot) << shift);
+            if (tick < current) {
+                tick = current;
+            }
+            if (tick < best) {
+                best = tick;
+            }
+        }
+    }
+    return best;
+}
+
+} // namespace dns_parser
@@ -0,0 +1,120 @@
+#include <gtest/gtest.h>
+#include "../include/tools/alloc_tracker.h"
+#include "../include/tools/buffer_pool.h"
+#include "../include/tools/stage_timer.h"
+#include <memory>
+#include <vector>
+
+using namespace dns_parser;
+
+namespace {
+
+// 防止编译器把成对的 new/delete 优化掉
+void* volatile sink;
+
+} // namespace
+
+TEST(AllocTrackerTest, CountsThreadAllocations) {
+    AllocTally before = currentAllocTally();
+    int* value = new int(7);
+    sink = value;
+    delete value;
+    std::unique_ptr<char[]> buffer(new char[100]);
+    sink = buffer.get();
+    buffer.reset();
+    AllocTally after = currentAllocTally();
+
+#if DNS_PARSER_ALLOC_TRACKING
+    EXPECT_EQ(after.allocations - before.allocations, 2u);
+    EXPECT_EQ(after.bytes - before.bytes, sizeof(int) + 100);
+    EXPECT_EQ(after.frees - before.frees, 2u);
+#else
+    EXPECT_EQ(before.allocations, 0u);
+    EXPECT_EQ(after.allocations, 0u);
+    EXPECT_EQ(after.bytes, 0u);
+    EXPECT_EQ(after.frees, 0u);
+#endif
+}
+
+TEST(AllocTrackerTest, CountsArenaBlocks) {
+    AllocTally before = currentAllocTally();
+    noteArenaBlock(4096);
+    AllocTally after = currentAllocTally();
+#if DNS_PARSER_ALLOC_TRACKING
+    EXPECT_EQ(after.arena_blocks - before.arena_blocks, 1u);
+    EXPECT_EQ(after.arena_bytes - before.arena_bytes, 4096u);
+#else
+    EXPECT_EQ(before.arena_blocks, 0u);
+    EXPECT_EQ(after.arena_blocks, 0u);
+    EXPECT_EQ(after.arena_bytes, 0u);
+#endif
+}
+
+TEST(AllocTrackerTest, AttributesAllocationsToStages) {
+    std::unique_ptr<StageRecorder> recorder(new StageRecorder());
+    std::vector<std::unique_ptr<int> > held;
+
+    for (int packet = 0; packet < 3; ++packet) {
+        // 计时在运行期关闭时分配统计仍然生效
+        recorder->begin(false, CycleClock::now());
+        held.emplace_back(new int(packet));
+        recorder->lap(Stage::Intake);
+        recorder->lap(Stage::Header);
+        held.emplace_back(new int(packet));
+        held.emplace_back(new int(packet));
+        recorder->lap(Stage::Question);
+        held.emplace_back(new int(packet));
+        recorder->finish();
+        held.clear();
+    }
+
+    StageRecorder::AllocStats stats = recorder->allocStats();
+    LatencyHistogram::Snapshot* perPacket = new LatencyHistogram::Snapshot();
+    recorder->allocationsPerPacket().snapshot(*perPacket);
+#if DNS_PARSER_ALLOC_TRACKING
+    // held 的扩容也会分配，只检查下界和阶段划分
+    EXPECT_EQ(stats.packets, 3u);
+    EXPECT_GE(stats.allocations[static_cast<size_t>(Stage::Intake)], 3u);
+    EXPECT_EQ(stats.allocations[static_cast<size_t>(Stage::Header)], 0u);
+    EXPECT_GE(stats.allocations[static_cast<size_t>(Stage::Question)], 6u);
+    // finish() 之前的最后一段计入输出阶段
+    EXPECT_GE(stats.allocations[static_cast<size_t>(Stage::Output)], 3u);
+    EXPECT_GE(stats.bytes[static_cast<size_t>(Stage::Question)], 6 * sizeof(int));
+    EXPECT_EQ(perPacket->count, 3u);
+    EXPECT_GE(perPacket->min, 4u);
+
+    recorder->reset();
+    stats = recorder->allocStats();
+    EXPECT_EQ(stats.packets, 0u);
+    EXPECT_EQ(stats.allocations[static_cast<size_t>(Stage::Question)], 0u);
+#else
+    EXPECT_EQ(stats.packets, 0u);
+    for (size_t i = 0; i < StageRecorder::kStages; ++i) {
+        EXPECT_EQ(stats.allocations[i], 0u);
+        EXPECT_EQ(stats.bytes[i], 0u);
+    }
+    EXPECT_EQ(perPacket->count, 0u);
+#endif
+    delete perPacket;
+}
+
+TEST(AllocTrackerTest, BufferPoolReportsNewBlocksOnly) {
+    MemoryBudget budget;
+    BufferPool pool(budget);
+    size_t size = pool.classSize(1000);
+    AllocTally before = currentAllocTally();
+    char* block = pool.acquire(size);
+    ASSERT_NE(block, nullptr);
+    pool.release(block, size);
+    block = pool.acquire(size);
+    ASSERT_NE(block, nullptr);
+    pool.release(block, size);
+    AllocTally after = currentAllocTally();
+#if DNS_PARSER_ALLOC_TRACKING
+    // 第二次申请复用空闲链表中的块，不计入
+    EXPECT_EQ(after.arena_blocks - before.arena_blocks, 1u);
+    EXPECT_EQ(after.arena_bytes - before.arena_bytes, size);
+#else
+    EXPECT_EQ(after.arena_blocks, before.arena_blocks);
+#endif
+}
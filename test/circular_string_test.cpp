@@ -0,0 +1,298 @@
+#include <gtest/gtest.h>
+#include "../include/tools/CircularString.h"
+#include "../include/tools/SpscCircularString.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+
+// 将片段拼接为字符串
+static std::string joinSegments(const CircularString::Segment* parts, size_t num) {
+    std::string result;
+    for (size_t i = 0; i < num; ++i) {
+        result.append(parts[i].data, parts[i].length);
+    }
+    return result;
+}
+
+TEST(CircularStringTest, PushBackWrapsAndOverwrites) {
+    CircularString ring(8);
+    ring.push_back("abcdef");
+    ring.erase_up_to(3);              // 剩余 "ef"
+    ring.push_back("ghijk");          // 跨越回绕点
+    EXPECT_EQ(ring.size(), 7u);
+    EXPECT_EQ(ring.substring(0, 6), "efghijk");
+
+    ring.push_back("lmn");            // 溢出，覆盖最旧的两个字节
+    EXPECT_EQ(ring.size(), 8u);
+    EXPECT_EQ(ring.substring(0, 7), "ghijklmn");
+
+    ring.push_back("0123456789");     // 超过容量，只保留最后 8 个字节
+    EXPECT_EQ(ring.substring(0, 7), "23456789");
+}
+
+TEST(CircularStringTest, SegmentsSplitAtWrapPoint) {
+    CircularString ring(8);
+    ring.push_back("abcdef");
+    ring.erase_up_to(4);              // 剩余 "f"，物理位置 5
+    ring.push_back("ghij");
+
+    CircularString::Segment parts[2];
+    size_t num = ring.readable_segments(parts);
+    ASSERT_EQ(num, 2u);
+    EXPECT_EQ(parts[0].length, 3u);
+    EXPECT_EQ(parts[1].length, 2u);
+    EXPECT_EQ(joinSegments(parts, num), "fghij");
+
+    num = ring.segments(1, 2, parts);
+    ASSERT_EQ(num, 1u);
+    EXPECT_EQ(joinSegments(parts, num), "gh");
+
+    EXPECT_EQ(ring.segments(5, 0, parts), 0u);
+    EXPECT_THROW(ring.segments(3, 3, parts), std::out_of_range);
+}
+
+TEST(CircularStringTest, MatchesReferenceModel) {
+    const size_t kCapacity = 97;
+    CircularString ring(kCapacity);
+    std::string model;
+    srand(7);
+
+    for (int round = 0; round < 2000; ++round) {
+        if (rand() % 4 == 0 && !model.empty()) {
+            size_t k = rand() % model.size();
+            ring.erase_up_to(k);
+            model.erase(0, k + 1);
+        } else {
+            std::string chunk(rand() % 150, '\0');
+            for (size_t i = 0; i < chunk.size(); ++i) {
+                chunk[i] = static_cast<char>('a' + rand() % 26);
+            }
+            ring.push_back(chunk);
+            model += chunk;
+            if (model.size() > kCapacity) {
+                model.erase(0, model.size() - kCapacity);
+            }
+        }
+
+        ASSERT_EQ(ring.size(), model.size());
+        CircularString::Segment parts[2];
+        ASSERT_EQ(joinSegments(parts, ring.readable_segments(parts)), model);
+    }
+}
+
+TEST(CircularStringTest, FindAcrossSegments) {
+    CircularString ring(8);
+    ring.push_back("abcdef");
+    ring.erase_up_to(3);              // 剩余 "ef"
+    ring.push_back("ghiej");          // "efghiej"，物理上在 "gh" 之后回绕
+
+    EXPECT_EQ(ring.find(0, ring.size(), 'e'), 0u);
+    EXPECT_EQ(ring.find(1, ring.size(), 'e'), 5u);
+    EXPECT_EQ(ring.find(1, ring.size(), 'j'), 6u);
+    EXPECT_EQ(ring.find(1, 5, 'j'), size_t(-1));
+    EXPECT_EQ(ring.find(3, 3, 'x'), size_t(-1));
+}
+
+TEST(CircularStringTest, FindNthMatchesAcrossWrapPoint) {
+    CircularString ring(16);
+    ring.push_back("xxxxxxxxxxxx");
+    ring.erase_up_to(9);              // 物理起点 10
+    ring.push_back("abc\r\nd\r\nef\r\n");
+
+    // 第一个 "\r\n" 横跨物理回绕点
+    EXPECT_EQ(ring.find_nth("\r\n", 1), 5u);
+    EXPECT_EQ(ring.find_nth("\r\n", 2), 8u);
+    EXPECT_EQ(ring.find_nth("\r\n", 3), 12u);
+    EXPECT_EQ(ring.find_nth("xab", 1), 1u);
+    EXPECT_THROW(ring.find_nth("\r\n", 4), std::out_of_range);
+    EXPECT_THROW(ring.find_nth("", 1), std::invalid_argument);
+}
+
+TEST(CircularStringTest, FindNthMatchesReferenceSearch) {
+    CircularString ring(61);
+    std::string model;
+    srand(11);
+
+    for (int round = 0; round < 500; ++round) {
+        std::string chunk(rand() % 40, '\0');
+        for (size_t i = 0; i < chunk.size(); ++i) {
+            chunk[i] = static_cast<char>('a' + rand() % 3);
+        }
+        ring.push_back(chunk);
+        model += chunk;
+        if (model.size() > 61) {
+            model.erase(0, model.size() - 61);
+        }
+
+        std::string target = model.substr(rand() % model.size(), 1 + rand() % 3);
+        size_t pos = model.find(target);
+        for (size_t n = 1; pos != std::string::npos; ++n) {
+            ASSERT_EQ(ring.find_nth(target, n), pos);
+            pos = model.find(target, pos + 1);
+        }
+    }
+}
+
+TEST(CircularStringTest, MirroredBackingIsAlwaysContiguous) {
+    CircularString ring(1000, CircularString::Backing::Mirrored);
+    EXPECT_EQ(ring.backing_mode(), CircularString::Backing::Mirrored);
+    size_t capacity = ring.cap();
+    ASSERT_GE(capacity, 1000u);
+    EXPECT_EQ(capacity & (capacity - 1), 0u);
+
+    // 让数据跨越物理回绕点
+    ring.push_back(std::string(capacity - 3, 'x'));
+    ring.erase_up_to(capacity - 4);
+    ring.push_back("abcdefgh");
+
+    CircularString::Segment parts[2];
+    ASSERT_EQ(ring.readable_segments(parts), 1u);
+    EXPECT_EQ(std::string(parts[0].data, parts[0].length), "abcdefgh");
+
+    const char* ptr = ring.contiguous(1, 6);
+    ASSERT_NE(ptr, nullptr);
+    EXPECT_EQ(std::string(ptr, 6), "bcdefg");
+    EXPECT_EQ(ring.find_nth("cde", 1), 2u);
+    EXPECT_EQ(ring.find(0, ring.size(), 'h'), 7u);
+}
+
+TEST(CircularStringTest, HeapContiguousReturnsNullAcrossWrap) {
+    CircularString ring(8);
+    ring.push_back("abcdef");
+    ring.erase_up_to(4);
+    ring.push_back("ghij");           // "fghij"，物理上在 "fgh" 之后回绕
+
+    EXPECT_NE(ring.contiguous(0, 3), nullptr);
+    EXPECT_EQ(ring.contiguous(0, 5), nullptr);
+
+    // 复制后数据被线性化
+    CircularString copy(ring);
+    EXPECT_EQ(copy.substring(0, 4), "fghij");
+    ASSERT_NE(copy.contiguous(0, 5), nullptr);
+    EXPECT_EQ(std::string(copy.contiguous(0, 5), 5), "fghij");
+}
+
+TEST(CircularStringTest, MirroredMatchesReferenceModel) {
+    CircularString ring(4096, CircularString::Backing::Mirrored);
+    const size_t capacity = ring.cap();
+    std::string model;
+    srand(5);
+
+    for (int round = 0; round < 500; ++round) {
+        if (rand() % 3 == 0 && !model.empty()) {
+            size_t k = rand() % model.size();
+            ring.erase_up_to(k);
+            model.erase(0, k + 1);
+        } else {
+            std::string chunk(rand() % 3000, '\0');
+            for (size_t i = 0; i < chunk.size(); ++i) {
+                chunk[i] = static_cast<char>('a' + rand() % 26);
+            }
+            ring.push_back(chunk);
+            model += chunk;
+            if (model.size() > capacity) {
+                model.erase(0, model.size() - capacity);
+            }
+        }
+
+        ASSERT_EQ(ring.size(), model.size());
+        if (!model.empty()) {
+            ASSERT_EQ(std::string(ring.contiguous(0, model.size()), model.size()), model);
+        }
+    }
+}
+
+TEST(SpscCircularStringTest, ReserveCommitAndRelease) {
+    SpscCircularString ring(10);
+    EXPECT_EQ(ring.cap(), 16u);
+    EXPECT_TRUE(ring.push_back("hello\r\nworld\r\n"));
+    EXPECT_FALSE(ring.push_back("abc"));          // 不覆盖未读数据
+    EXPECT_EQ(ring.size(), 14u);
+    EXPECT_EQ(ring.find_nth("\r\n", 2), 12u);
+    EXPECT_EQ(ring.find(0, ring.size(), 'w'), 7u);
+    EXPECT_EQ(ring.substring(0, 4), "hello");
+
+    ring.erase_up_to(6);
+    EXPECT_EQ(ring.writable(), 9u);
+
+    // 预留空间跨越回绕点
+    SpscCircularString::MutableSegment parts[2];
+    ASSERT_EQ(ring.reserve(5, parts), 2u);
+    std::memcpy(parts[0].data, "12345", parts[0].length);
+    std::memcpy(parts[1].data, "12345" + parts[0].length, parts[1].length);
+    EXPECT_EQ(ring.size(), 7u);                    // 提交前不可见
+    ring.commit(5);
+    EXPECT_EQ(ring.substring(0, ring.size() - 1), "world\r\n12345");
+    EXPECT_EQ(ring.find_nth("\n1", 1), 6u);
+    EXPECT_EQ(ring.at(7), '1');
+    EXPECT_THROW(ring.release(13), std::out_of_range);
+}
+
+TEST(SpscCircularStringTest, ProducerConsumerThreadsPreserveOrder) {
+    SpscCircularString ring(256);
+    const size_t kTotal = 200000;
+
+    std::thread producer([&ring, kTotal]() {
+        char chunk[37];
+        size_t next = 0;
+        while (next < kTotal) {
+            size_t len = std::min(sizeof(chunk), kTotal - next);
+            for (size_t i = 0; i < len; ++i) {
+                chunk[i] = static_cast<char>((next + i) % 251);
+            }
+            if (ring.push_back(chunk, len)) {
+                next += len;
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    size_t consumed = 0;
+    bool ordered = true;
+    while (consumed < kTotal) {
+        CircularString::Segment parts[2];
+        size_t num = ring.readable_segments(parts);
+        size_t got = 0;
+        for (size_t s = 0; s < num; ++s) {
+            for (size_t i = 0; i < parts[s].length; ++i) {
+                ordered = ordered && parts[s].data[i] == static_cast<char>((consumed + got + i) % 251);
+            }
+            got += parts[s].length;
+        }
+        if (got) {
+            ring.release(got);
+            consumed += got;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+    EXPECT_TRUE(ordered);
+    EXPECT_EQ(ring.size(), 0u);
+}
+
+TEST(CircularStringTest, ExternalStorageRebindKeepsData) {
+    char small[8];
+    char large[32];
+    CircularString ring(small, sizeof(small));
+    EXPECT_EQ(ring.backing_mode(), CircularString::Backing::External);
+
+    ring.push_back("abcdef");
+    ring.erase_up_to(3);
+    ring.push_back("ghij");     // 跨越回绕点：ef + ghij
+    EXPECT_EQ(ring.rebind(large, sizeof(large)), small);
+    EXPECT_EQ(ring.cap(), sizeof(large));
+    EXPECT_EQ(ring.substring(0, 5), "efghij");
+    EXPECT_NE(ring.contiguous(0, 6), nullptr);
+
+    // 副本使用自有的堆内存
+    CircularString copy(ring);
+    EXPECT_EQ(copy.backing_mode(), CircularString::Backing::Heap);
+    EXPECT_EQ(copy.substring(0, 5), "efghij");
+
+    CircularString heap(4);
+    EXPECT_THROW(heap.rebind(large, sizeof(large)), std::logic_error);
+}
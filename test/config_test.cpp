@@ -0,0 +1,166 @@
+#include <gtest/gtest.h>
+#include "../include/config/config_store.h"
+#include "../include/config/runtime_config.h"
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <unistd.h>
+
+using namespace dns_parser;
+
+// 写入临时配置文件
+static void writeFile(const std::string& path, const std::string& content) {
+    std::ofstream file(path.c_str(), std::ios::trunc);
+    file << content;
+}
+
+static std::string tempPath(const char* name) {
+    return std::string("/tmp/") + name + "_" + std::to_string(getpid()) + ".ini";
+}
+
+TEST(RuntimeConfigTest, LoadsTypedValuesAndKeepsDefaults) {
+    std::string path = tempPath("runtime_config");
+    writeFile(path,
+        "[Buffer]\n"
+        "c2s_buffer_size = 65536  ; 64KB\n"
+        "[Flow]\n"
+        "max_flows = -5\n"
+        "[Performance]\n"
+        "thread_count = 8\n"
+        "[Logging]\n"
+        "log_level = WARNING\n"
+        "[Lists]\n"
+        "blocklist = /etc/dns/block.txt\n"
+        "[Shedding]\n"
+        "latency_high = 20\n"
+        "sample_rate = 0\n"
+        "[EDNS]\n"
+        "subnet_ipv4_prefix = 40\n"
+        "subnet_ipv6_prefix = 48\n"
+        "[DNSSEC]\n"
+        "skip_records = false\n"
+        "[Names]\n"
+        "normalize = false\n");
+
+    RuntimeConfig config;
+    ASSERT_TRUE(RuntimeConfig::loadFromFile(path, config));
+    std::remove(path.c_str());
+
+    RuntimeConfig defaults;
+    EXPECT_EQ(config.c2s_buffer_size, 65536u);
+    EXPECT_EQ(config.s2c_buffer_size, defaults.s2c_buffer_size);
+    EXPECT_EQ(config.max_flows, defaults.max_flows);
+    EXPECT_EQ(config.thread_count, 8);
+    EXPECT_EQ(config.log_level, LogLevel::Warning);
+    EXPECT_EQ(config.blocklist_path, "/etc/dns/block.txt");
+    EXPECT_TRUE(config.allowlist_path.empty());
+    EXPECT_TRUE(config.public_suffix_path.empty());
+    EXPECT_FALSE(config.public_suffixes);
+    EXPECT_FALSE(defaults.shedding.enabled);
+    EXPECT_EQ(config.shedding.latency_high_ns, 20000u);
+    EXPECT_EQ(config.shedding.latency_low_ns, defaults.shedding.latency_low_ns);
+    EXPECT_EQ(config.shedding.sample_rate, 1u);
+    EXPECT_EQ(config.max_subnets, defaults.max_subnets);
+    EXPECT_EQ(config.subnet_ipv4_prefix, 32);
+    EXPECT_EQ(config.subnet_ipv6_prefix, 48);
+    EXPECT_TRUE(defaults.skip_dnssec);
+    EXPECT_FALSE(config.skip_dnssec);
+    EXPECT_TRUE(defaults.normalize_names);
+    EXPECT_FALSE(config.normalize_names);
+    EXPECT_FALSE(RuntimeConfig::loadFromFile(path, config));
+}
+
+TEST(ConfigStoreTest, RetiredSnapshotOutlivesActiveReader) {
+    ConfigStore store;
+    const RuntimeConfig* first = store.acquire(1);
+    EXPECT_EQ(store.version(), 0u);
+
+    RuntimeConfig* next = new RuntimeConfig();
+    next->max_flows = 42;
+    store.publish(next);
+    EXPECT_EQ(store.version(), 1u);
+
+    // 读者 1 仍处于本次 Filter 内，旧快照必须保留
+    EXPECT_EQ(first->max_flows, RuntimeConfig().max_flows);
+    EXPECT_EQ(store.reclaim(), 1u);
+
+    store.quiescent(1);
+    EXPECT_EQ(store.reclaim(), 0u);
+    EXPECT_EQ(store.acquire(1)->max_flows, 42u);
+    EXPECT_EQ(store.acquire(2)->max_flows, 42u);
+    store.offline(1);
+    store.offline(2);
+}
+
+TEST(ConfigStoreTest, RejectsReadersBeyondSlotCount) {
+    ConfigStore store;
+    const unsigned short alias = ConfigStore::kMaxReaders + 1;
+    EXPECT_EQ(store.acquire(alias), nullptr);
+
+    // 读者 1 持有快照时，超出上限的编号宣告静止不能让旧快照被回收
+    const RuntimeConfig* first = store.acquire(1);
+    store.publish(new RuntimeConfig());
+    store.quiescent(alias);
+    store.offline(alias);
+    EXPECT_EQ(store.reclaim(), 1u);
+    EXPECT_EQ(first->max_flows, RuntimeConfig().max_flows);
+    store.offline(1);
+    EXPECT_EQ(store.reclaim(), 0u);
+}
+
+TEST(ConfigStoreTest, ReadersSeeEveryPublishedSnapshotWithoutPause) {
+    ConfigStore store;
+    std::atomic<bool> done(false);
+    std::atomic<size_t> reads(0);
+
+    std::thread reader([&store, &done, &reads]() {
+        size_t last = 0;
+        while (!done.load(std::memory_order_relaxed)) {
+            const RuntimeConfig* config = store.acquire(3);
+            // 快照单调更新，不会读到已释放或更旧的值
+            ASSERT_GE(config->max_flows, last);
+            last = config->max_flows;
+            store.quiescent(3);
+            reads.fetch_add(1, std::memory_order_relaxed);
+        }
+        store.offline(3);
+    });
+
+    for (size_t i = 1; i <= 2000; ++i) {
+        RuntimeConfig* next = new RuntimeConfig();
+        next->max_flows = RuntimeConfig().max_flows + i;
+        store.publish(next);
+    }
+    // 读线程可能在全部发布完之后才开始运行，至少等它读到一次
+    while (reads.load(std::memory_order_relaxed) == 0) {
+        std::this_thread::yield();
+    }
+    done.store(true);
+    reader.join();
+
+    EXPECT_EQ(store.reclaim(), 0u);
+    EXPECT_EQ(store.version(), 2000u);
+    EXPECT_GT(reads.load(), 0u);
+}
+
+TEST(ConfigWatcherTest, PublishesOnlyWhenFileChanges) {
+    std::string path = tempPath("config_watcher");
+    writeFile(path, "[Flow]\nmax_flows = 10\n");
+
+    ConfigStore store;
+    ConfigWatcher watcher(store, path);
+    EXPECT_TRUE(watcher.poll());
+    EXPECT_FALSE(watcher.poll());
+    EXPECT_EQ(store.snapshot().max_flows, 10u);
+
+    writeFile(path, "[Flow]\nmax_flows = 2000\n");
+    EXPECT_TRUE(watcher.poll());
+    EXPECT_EQ(store.snapshot().max_flows, 2000u);
+    EXPECT_EQ(watcher.reloads(), 2u);
+
+    std::remove(path.c_str());
+    EXPECT_FALSE(watcher.poll());
+    EXPECT_EQ(store.snapshot().max_flows, 2000u);
+}
@@ -0,0 +1,130 @@
+#include <gtest/gtest.h>
+#include "../include/flows/dns_encoder.h"
+#include "../include/flows/dns_parser.h"
+#include <arpa/inet.h>
+#include <chrono>
+#include <cstring>
+#include <string>
+
+using namespace dns_parser;
+
+// 辅助函数：将十六进制字符串转换为二进制数据
+static std::string hexToBytes(const std::string& hex) {
+    std::string bytes;
+    for (size_t i = 0; i < hex.length(); i += 2) {
+        std::string byteString = hex.substr(i, 2);
+        char byte = (char) strtol(byteString.c_str(), nullptr, 16);
+        bytes.push_back(byte);
+    }
+    return bytes;
+}
+
+// www.example.com 查询（RD=1，带一个 EDNS OPT 附加记录），qtype 为给定类型
+static std::string buildQuery(uint16_t qtype) {
+    std::string query = hexToBytes("BEEF01000001000000000001"
+                                   "03777777076578616D706C6503636F6D00");
+    query.push_back(static_cast<char>(qtype >> 8));
+    query.push_back(static_cast<char>(qtype & 0xFF));
+    query += hexToBytes("0001" "0000291000000000000000");
+    return query;
+}
+
+static SyntheticResponse sinkhole() {
+    SyntheticResponse response;
+    response.kind = SyntheticKind::Sinkhole;
+    response.ttl = 300;
+    response.has_ipv4 = true;
+    response.has_ipv6 = true;
+    inet_pton(AF_INET, "10.9.8.7", response.ipv4);
+    inet_pton(AF_INET6, "2001:db8::53", response.ipv6);
+    return response;
+}
+
+static std::string encode(const std::string& query, const SyntheticResponse& response) {
+    uint8_t out[DNSEncoder::kMaxResponseSize];
+    size_t n = DNSEncoder::encode(reinterpret_cast<const uint8_t*>(query.data()), query.size(), response,
+                                  out, sizeof(out));
+    return std::string(reinterpret_cast<char*>(out), n);
+}
+
+TEST(DNSEncoderTest, EncodesNxdomainAndRefused) {
+    std::string query = buildQuery(1);
+    SyntheticResponse response;
+    response.kind = SyntheticKind::NXDomain;
+    std::string nx = encode(query, response);
+
+    Message message;
+    ASSERT_TRUE(DNSParser::parseResponse(nx, message));
+    EXPECT_EQ(message.header.transaction_id, 0xBEEF);
+    EXPECT_EQ(message.header.flags, 0x8183);   // QR、RD、RA，NXDOMAIN
+    ASSERT_EQ(message.questions.size(), 1u);
+    EXPECT_EQ(message.name(message.questions[0]), "www.example.com");
+    EXPECT_TRUE(message.answers().empty());
+    EXPECT_TRUE(message.additionals().empty());
+
+    response.kind = SyntheticKind::Refused;
+    std::string refused = encode(query, response);
+    ASSERT_EQ(refused.size(), nx.size());
+    EXPECT_EQ(static_cast<uint8_t>(refused[3]) & 0x0F, 5);
+}
+
+TEST(DNSEncoderTest, SinkholeAnswersMatchQueryTypeWithCompressedNames) {
+    Message message;
+    std::string a = encode(buildQuery(1), sinkhole());
+    ASSERT_TRUE(DNSParser::parseResponse(a, message));
+    ASSERT_EQ(message.answers().size(), 1u);
+    EXPECT_EQ(message.name(message.answers()[0]), "www.example.com");
+    EXPECT_EQ(message.answers()[0].ttl, 300u);
+    ASSERT_EQ(message.answers()[0].rdlength, 4);
+    EXPECT_EQ(std::memcmp(message.rdata(message.answers()[0]), "\x0A\x09\x08\x07", 4), 0);
+    // 所有者名是 2 字节的压缩指针
+    EXPECT_EQ(a.size(), 12u + 17u + 4u + 12u + 4u);
+
+    std::string any = encode(buildQuery(255), sinkhole());
+    Message anyMessage;
+    ASSERT_TRUE(DNSParser::parseResponse(any, anyMessage));
+    ASSERT_EQ(anyMessage.answers().size(), 2u);
+    EXPECT_EQ(anyMessage.answers()[1].type, 28);
+
+    // 其他类型返回 NOERROR 空应答
+    std::string mx = encode(buildQuery(15), sinkhole());
+    Message mxMessage;
+    ASSERT_TRUE(DNSParser::parseResponse(mx, mxMessage));
+    EXPECT_EQ(mxMessage.header.flags & 0x0F, 0);
+    EXPECT_TRUE(mxMessage.answers().empty());
+}
+
+TEST(DNSEncoderTest, EncodesInPlaceAndChecksCapacity) {
+    std::string query = buildQuery(28);
+    SyntheticResponse response = sinkhole();
+    size_t size = DNSEncoder::responseSize(reinterpret_cast<const uint8_t*>(query.data()), query.size(), response);
+    ASSERT_GT(size, query.size());
+
+    std::string buffer = query;
+    buffer.resize(size);
+    uint8_t* data = reinterpret_cast<uint8_t*>(&buffer[0]);
+    EXPECT_EQ(DNSEncoder::encode(data, query.size(), response, data, size - 1), 0u);
+    EXPECT_EQ(buffer.substr(0, query.size()), query);
+    EXPECT_EQ(DNSEncoder::encode(data, query.size(), response, data, size), size);
+    EXPECT_EQ(buffer, encode(query, response));
+}
+
+TEST(DNSEncoderTest, RejectsNonQueries) {
+    SyntheticResponse response;
+    response.kind = SyntheticKind::NXDomain;
+    uint8_t out[DNSEncoder::kMaxResponseSize];
+
+    std::string reply = buildQuery(1);
+    reply[2] = static_cast<char>(0x81);
+    EXPECT_EQ(DNSEncoder::encode(reinterpret_cast<const uint8_t*>(reply.data()), reply.size(), response, out,
+                                 sizeof(out)), 0u);
+
+    std::string truncated = buildQuery(1).substr(0, 20);
+    EXPECT_EQ(DNSEncoder::encode(reinterpret_cast<const uint8_t*>(truncated.data()), truncated.size(), response,
+                                 out, sizeof(out)), 0u);
+
+    response.kind = SyntheticKind::None;
+    std::string query = buildQuery(1);
+    EXPECT_EQ(DNSEncoder::encode(reinterpret_cast<const uint8_t*>(query.data()), query.size(), response, out,
+                                 sizeof(out)), 0u);
+}
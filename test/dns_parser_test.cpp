@@ -1,5 +1,10 @@
 #include <gtest/gtest.h>
 #include "../include/flows/dns_parser.h"
+#include "../include/flows/public_suffix.h"
+#include "../include/flows/response_cache.h"
+#include "../include/tools/name_check.h"
+#include "../include/tools/name_interner.h"
+#include <cstring>
 #include <string>
 #include <vector>
 #include <iostream>
@@ -73,11 +78,11 @@ TEST(DNSParserTest, ParseFullQueryPacket) {
     
     // 验证查询部分
     ASSERT_EQ(message.questions.size(), 1);
-    std::cout << "\n查询域名: " << message.questions[0].domain_name << std::endl;
+    std::cout << "\n查询域名: " << message.name(message.questions[0]) << std::endl;
     std::cout << "查询类型: " << message.questions[0].type << std::endl;
     std::cout << "查询类别: " << message.questions[0].class_ << std::endl;
     
-    EXPECT_EQ(message.questions[0].domain_name, "www.example.com");
+    EXPECT_EQ(message.name(message.questions[0]), "www.example.com");
     EXPECT_EQ(message.questions[0].type, 1);  // A 记录
     EXPECT_EQ(message.questions[0].class_, 1); // IN 类
 }
@@ -128,30 +133,30 @@ TEST(DNSParserTest, ParseFullResponsePacket) {
     
     // 验证查询部分
     ASSERT_EQ(message.questions.size(), 1);
-    std::cout << "\n查询域名: " << message.questions[0].domain_name << std::endl;
+    std::cout << "\n查询域名: " << message.name(message.questions[0]) << std::endl;
     std::cout << "查询类型: " << message.questions[0].type << std::endl;
     std::cout << "查询类别: " << message.questions[0].class_ << std::endl;
     
-    EXPECT_EQ(message.questions[0].domain_name, "www.example.com");
+    EXPECT_EQ(message.name(message.questions[0]), "www.example.com");
     EXPECT_EQ(message.questions[0].type, 1);  // A 记录
     EXPECT_EQ(message.questions[0].class_, 1); // IN 类
     
     // 验证应答部分
-    ASSERT_EQ(message.answers.size(), 1);
-    std::cout << "\n应答域名: " << message.answers[0].name << std::endl;
-    std::cout << "记录类型: " << message.answers[0].type << std::endl;
-    std::cout << "记录类别: " << message.answers[0].class_ << std::endl;
-    std::cout << "TTL: " << message.answers[0].ttl << " 秒" << std::endl;
-    std::cout << "数据长度: " << message.answers[0].rdlength << " 字节" << std::endl;
-    
-    EXPECT_EQ(message.answers[0].name, "www.example.com");
-    EXPECT_EQ(message.answers[0].type, 1);    // A 记录
-    EXPECT_EQ(message.answers[0].class_, 1);  // IN 类
-    EXPECT_EQ(message.answers[0].ttl, 60);    // 60秒
-    EXPECT_EQ(message.answers[0].rdlength, 4);
+    ASSERT_EQ(message.answers().size(), 1);
+    std::cout << "\n应答域名: " << message.name(message.answers()[0]) << std::endl;
+    std::cout << "记录类型: " << message.answers()[0].type << std::endl;
+    std::cout << "记录类别: " << message.answers()[0].class_ << std::endl;
+    std::cout << "TTL: " << message.answers()[0].ttl << " 秒" << std::endl;
+    std::cout << "数据长度: " << message.answers()[0].rdlength << " 字节" << std::endl;
+    
+    EXPECT_EQ(message.name(message.answers()[0]), "www.example.com");
+    EXPECT_EQ(message.answers()[0].type, 1);    // A 记录
+    EXPECT_EQ(message.answers()[0].class_, 1);  // IN 类
+    EXPECT_EQ(message.answers()[0].ttl, 60);    // 60秒
+    EXPECT_EQ(message.answers()[0].rdlength, 4);
     
     // 验证并打印 IP 地址
-    const unsigned char* ip = reinterpret_cast<const unsigned char*>(message.answers[0].rdata.data());
+    const unsigned char* ip = reinterpret_cast<const unsigned char*>(message.rdata(message.answers()[0]));
     std::cout << "IP 地址: " << static_cast<int>(ip[0]) << "." 
               << static_cast<int>(ip[1]) << "."
               << static_cast<int>(ip[2]) << "."
@@ -198,7 +203,7 @@ TEST(DNSParserTest, ParseAndPrintFullPacket) {
     std::cout << "\n[DNS 查询]" << std::endl;
     std::cout << "Transaction ID: 0x" << std::hex << queryMessage.header.transaction_id << std::dec << std::endl;
     std::cout << "Flags: 0x" << std::hex << queryMessage.header.flags << std::dec << std::endl;
-    std::cout << "查询域名: " << queryMessage.questions[0].domain_name << std::endl;
+    std::cout << "查询域名: " << queryMessage.name(queryMessage.questions[0]) << std::endl;
     std::cout << "查询类型: " << queryMessage.questions[0].type << std::endl;
     std::cout << "查询类别: " << queryMessage.questions[0].class_ << std::endl;
     
@@ -206,16 +211,557 @@ TEST(DNSParserTest, ParseAndPrintFullPacket) {
     std::cout << "\n[DNS 响应]" << std::endl;
     std::cout << "Transaction ID: 0x" << std::hex << responseMessage.header.transaction_id << std::dec << std::endl;
     std::cout << "Flags: 0x" << std::hex << responseMessage.header.flags << std::dec << std::endl;
-    std::cout << "查询域名: " << responseMessage.questions[0].domain_name << std::endl;
+    std::cout << "查询域名: " << responseMessage.name(responseMessage.questions[0]) << std::endl;
     
-    if (!responseMessage.answers.empty()) {
-        const unsigned char* ip = reinterpret_cast<const unsigned char*>(responseMessage.answers[0].rdata.data());
+    if (!responseMessage.answers().empty()) {
+        const unsigned char* ip = reinterpret_cast<const unsigned char*>(responseMessage.rdata(responseMessage.answers()[0]));
         std::cout << "\n解析结果:" << std::endl;
-        std::cout << responseMessage.questions[0].domain_name << " IN A " 
+        std::cout << responseMessage.name(responseMessage.questions[0]) << " IN A " 
                   << static_cast<int>(ip[0]) << "." 
                   << static_cast<int>(ip[1]) << "."
                   << static_cast<int>(ip[2]) << "."
                   << static_cast<int>(ip[3]) << std::endl;
-        std::cout << "TTL: " << responseMessage.answers[0].ttl << " 秒" << std::endl;
+        std::cout << "TTL: " << responseMessage.answers()[0].ttl << " 秒" << std::endl;
     }
 }
+
+// 测试按驻留 ID 解析域名
+TEST(DNSParserTest, ParseWithInternedNames) {
+    std::string responseHex = 
+        "AAAA81800001000100000000"
+        "03777777076578616D706C6503636F6D0000010001"
+        "C00C000100010000003C00045DB8D822";
+
+    ParseOptions options;
+    options.intern_names = true;
+    Message message;
+    ASSERT_TRUE(DNSParser::parseResponse(hexToBytes(responseHex), message, options));
+
+    ASSERT_EQ(message.questions.size(), 1);
+    ASSERT_EQ(message.answers().size(), 1);
+    EXPECT_TRUE(message.name(message.questions[0]).empty());
+    EXPECT_NE(message.questions[0].name_id, kInvalidNameId);
+    EXPECT_EQ(message.questions[0].name_id, message.answers()[0].name_id);
+    EXPECT_EQ(NameInterner::global().name(message.questions[0].name_id), "www.example.com");
+}
+
+// 测试只解析头部和问题区：资源记录被跳过，截断的应答区不影响结果
+TEST(DNSParserTest, ParseQuestionsOnly) {
+    std::string responseHex = 
+        "AAAA81800001000100000000"
+        "03777777076578616D706C6503636F6D0000010001"
+        "C00C0001";
+
+    Message full;
+    EXPECT_FALSE(DNSParser::parseResponse(hexToBytes(responseHex), full));
+
+    ParseOptions options;
+    options.questions_only = true;
+    Message message;
+    ASSERT_TRUE(DNSParser::parseResponse(hexToBytes(responseHex), message, options));
+    EXPECT_EQ(message.header.answer_rrs, 1);
+    ASSERT_EQ(message.questions.size(), 1);
+    EXPECT_EQ(message.name(message.questions[0]), "www.example.com");
+    EXPECT_TRUE(message.answers().empty());
+}
+
+// 测试紧凑布局：三个区段的记录连续存放，超过内联容量后转到堆上，消息可以复制和重复使用
+TEST(DNSParserTest, CompactLayoutSectionsAndReuse) {
+    std::string responseHex = 
+        "AAAA81800001000200010003"
+        "03777777076578616D706C6503636F6D0000010001"
+        "C00C000500010000012C00060363646EC010"
+        "C02D000100010000003C00045DB8D822"
+        "C0100002000100000E100006036E7331C010"
+        "C04F0001000100000E10000401020304"
+        "C04F001C000100000E10001020010DB8000000000000000000000001"
+        "00002904D0000000000000";
+    Message message;
+    ASSERT_TRUE(DNSParser::parseResponse(hexToBytes(responseHex), message));
+    ASSERT_EQ(message.records.size(), 6u);
+    EXPECT_FALSE(message.records.isInline());
+    ASSERT_EQ(message.answers().size(), 2u);
+    ASSERT_EQ(message.authorities().size(), 1u);
+    ASSERT_EQ(message.additionals().size(), 3u);
+
+    EXPECT_EQ(message.name(message.answers()[0]), "www.example.com");
+    EXPECT_EQ(message.answers()[0].type, 5);
+    EXPECT_EQ(message.name(message.answers()[1]), "cdn.example.com");
+    ASSERT_EQ(message.answers()[1].rdlength, 4);
+    EXPECT_EQ(std::memcmp(message.rdata(message.answers()[1]), "\x5D\xB8\xD8\x22", 4), 0);
+    EXPECT_EQ(message.name(message.authorities()[0]), "example.com");
+    EXPECT_EQ(message.authorities()[0].ttl, 3600u);
+    EXPECT_EQ(message.name(message.additionals()[1]), "ns1.example.com");
+    EXPECT_EQ(message.rdata(message.additionals()[1])[15], 1);
+    EXPECT_EQ(message.additionals()[2].type, 41);
+    EXPECT_TRUE(message.name(message.additionals()[2]).empty());
+
+    // 复制后的消息不依赖原消息的存储
+    Message copy = message;
+    EXPECT_EQ(copy.name(copy.answers()[1]), "cdn.example.com");
+
+    // 重复使用时先清空上一次的内容
+    std::string queryHex = 
+        "BBBB01000001000000000000"
+        "03777777076578616D706C6503636F6D0000010001";
+    ASSERT_TRUE(DNSParser::parseQuery(hexToBytes(queryHex), message));
+    ASSERT_EQ(message.questions.size(), 1u);
+    EXPECT_EQ(message.name(message.questions[0]), "www.example.com");
+    EXPECT_TRUE(message.records.empty());
+    EXPECT_TRUE(message.additionals().empty());
+    EXPECT_EQ(copy.name(copy.authorities()[0]), "example.com");
+}
+
+// 测试常见的小响应完全使用内联存储
+TEST(DNSParserTest, SmallResponseStaysInline) {
+    std::string responseHex = 
+        "AAAA81800001000100000000"
+        "03777777076578616D706C6503636F6D0000010001"
+        "C00C000100010000003C00045DB8D822";
+
+    Message message;
+    ASSERT_TRUE(DNSParser::parseResponse(hexToBytes(responseHex), message));
+    EXPECT_TRUE(message.questions.isInline());
+    EXPECT_TRUE(message.records.isInline());
+    EXPECT_TRUE(message.bytes.isInline());
+    EXPECT_LE(sizeof(DNSResourceRecord), 24u);
+}
+
+// 测试资源数据按类型解码，内嵌的压缩域名按整个报文解压缩
+TEST(DNSParserTest, DecodeTypedRData) {
+    std::string responseHex = 
+        "AAAA81800001000B00000000"
+        "076578616D706C6503636F6D0000010001"
+        "C00C000500010000012C000603777777C00C"                          // CNAME www.example.com
+        "C00C000200010000012C0006036E7331C00C"                          // NS ns1.example.com
+        "C00C000C00010000012C000704686F7374C00C"                        // PTR host.example.com
+        "C00C000F00010000012C0009000A046D61696CC00C"                    // MX 10 mail.example.com
+        "C00C000600010000012C0027036E7331C00C0A686F73746D6173746572C00C"
+        "78A3F17500001C2000000E10001275000000012C"                      // SOA
+        "C00C002100010000012C000C0001000501BB03737663C00C"              // SRV 1 5 443 svc.example.com
+        "C00C001000010000012C000C06763D73706631042D616C6C"              // TXT "v=spf1" "-all"
+        "C00C010100010000012C0016000569737375656C657473656E63727970742E6F7267"  // CAA 0 issue
+        "C00C004100010000012C000A00010000010003026832"                  // HTTPS 1 . alpn=h2
+        "C00C000100010000012C0003010203"                                // A，长度不合法
+        "C00C001C00010000012C001020010DB8000000000000000000000001";     // AAAA
+
+    Message message;
+    ASSERT_TRUE(DNSParser::parseResponse(hexToBytes(responseHex), message));
+    RecordSpan answers = message.answers();
+    ASSERT_EQ(answers.size(), 11u);
+    ASSERT_EQ(message.values.size(), 11u);
+
+    const RData& cname = message.decoded(answers[0]);
+    ASSERT_EQ(cname.kind, RDataKind::Name);
+    EXPECT_EQ(message.text(cname.name), "www.example.com");
+    EXPECT_EQ(message.text(message.decoded(answers[1]).name), "ns1.example.com");
+    EXPECT_EQ(message.text(message.decoded(answers[2]).name), "host.example.com");
+
+    const RData& mx = message.decoded(answers[3]);
+    ASSERT_EQ(mx.kind, RDataKind::MX);
+    EXPECT_EQ(mx.mx.preference, 10);
+    EXPECT_EQ(message.text(mx.mx.exchange), "mail.example.com");
+
+    const RData& soa = message.decoded(answers[4]);
+    ASSERT_EQ(soa.kind, RDataKind::SOA);
+    EXPECT_EQ(message.text(soa.soa.mname), "ns1.example.com");
+    EXPECT_EQ(message.text(soa.soa.rname), "hostmaster.example.com");
+    EXPECT_EQ(soa.soa.serial, 2024010101u);
+    EXPECT_EQ(soa.soa.refresh, 7200u);
+    EXPECT_EQ(soa.soa.retry, 3600u);
+    EXPECT_EQ(soa.soa.expire, 1209600u);
+    EXPECT_EQ(soa.soa.minimum, 300u);
+
+    const RData& srv = message.decoded(answers[5]);
+    ASSERT_EQ(srv.kind, RDataKind::SRV);
+    EXPECT_EQ(srv.srv.priority, 1);
+    EXPECT_EQ(srv.srv.weight, 5);
+    EXPECT_EQ(srv.srv.port, 443);
+    EXPECT_EQ(message.text(srv.srv.target), "svc.example.com");
+
+    const RData& txt = message.decoded(answers[6]);
+    ASSERT_EQ(txt.kind, RDataKind::TXT);
+    EXPECT_EQ(txt.txt.count, 2);
+    EXPECT_EQ(message.text(txt.txt.strings), std::string("\x06v=spf1\x04-all"));
+
+    const RData& caa = message.decoded(answers[7]);
+    ASSERT_EQ(caa.kind, RDataKind::CAA);
+    EXPECT_EQ(caa.caa.flags, 0);
+    EXPECT_EQ(message.text(caa.caa.tag), "issue");
+    EXPECT_EQ(message.text(caa.caa.value), "letsencrypt.org");
+
+    const RData& https = message.decoded(answers[8]);
+    ASSERT_EQ(https.kind, RDataKind::SVCB);
+    EXPECT_EQ(https.svcb.priority, 1);
+    EXPECT_EQ(https.svcb.target.length, 0);
+    EXPECT_EQ(message.text(https.svcb.params), std::string("\x00\x01\x00\x03\x02h2", 7));
+
+    EXPECT_EQ(message.decoded(answers[9]).kind, RDataKind::Malformed);
+    const RData& aaaa = message.decoded(answers[10]);
+    ASSERT_EQ(aaaa.kind, RDataKind::Address);
+    EXPECT_EQ(aaaa.address[0], 0x20);
+    EXPECT_EQ(aaaa.address[15], 0x01);
+
+    // 输出使用解压缩后的目标，而不是原始字节
+    testing::internal::CaptureStdout();
+    DNSParser::printMessageDetails(message, false);
+    std::string output = testing::internal::GetCapturedStdout();
+    EXPECT_NE(output.find("规范名称: www.example.com"), std::string::npos);
+    EXPECT_NE(output.find("邮件服务器: mail.example.com"), std::string::npos);
+    EXPECT_NE(output.find("目标: svc.example.com"), std::string::npos);
+}
+
+// 测试内嵌域名越过资源数据边界时标记为不合法，不影响整条消息的解析
+TEST(DNSParserTest, DecodeRejectsNameOutsideRData) {
+    std::string responseHex = 
+        "AAAA81800001000200000000"
+        "076578616D706C6503636F6D0000010001"
+        "C00C000500010000012C00020377"              // 长度 2，域名延伸到下一条记录
+        "C00C000100010000012C00045DB8D822";
+
+    Message message;
+    ASSERT_TRUE(DNSParser::parseResponse(hexToBytes(responseHex), message));
+    ASSERT_EQ(message.answers().size(), 2u);
+    EXPECT_EQ(message.decoded(message.answers()[0]).kind, RDataKind::Malformed);
+    EXPECT_EQ(message.decoded(message.answers()[1]).kind, RDataKind::Address);
+}
+
+// 测试查询中的 OPT 伪记录：DO 位、客户端子网（地址按源前缀清零）和 Cookie
+TEST(DNSParserTest, DecodeOptWithClientSubnetAndCookie) {
+    std::string queryHex =
+        "AAAA01000001000000000001"
+        "076578616D706C6503636F6D0000010001"
+        "0000291000000080000017"                    // OPT，UDP 4096，DO，数据长度 23
+        "0008000700011600C0A8FF"                    // ECS 192.168.255.0/22
+        "000A00080102030405060708";                 // 客户端 Cookie
+
+    Message message;
+    ASSERT_TRUE(DNSParser::parseQuery(hexToBytes(queryHex), message));
+    ASSERT_EQ(message.questions.size(), 1u);
+    ASSERT_EQ(message.additionals().size(), 1u);
+
+    const RData* opt = message.opt();
+    ASSERT_NE(opt, nullptr);
+    ASSERT_EQ(opt->kind, RDataKind::OPT);
+    EXPECT_EQ(opt->opt.udp_size, 4096);
+    EXPECT_EQ(opt->opt.version, 0);
+    EXPECT_TRUE(opt->opt.flags & OPTData::kDnssecOk);
+    EXPECT_EQ(opt->opt.ecs_family, 1);
+    EXPECT_EQ(opt->opt.ecs_source, 22);
+    EXPECT_EQ(opt->opt.ecs_scope, 0);
+    EXPECT_EQ(opt->opt.ecs_address[0], 0xC0);
+    EXPECT_EQ(opt->opt.ecs_address[1], 0xA8);
+    EXPECT_EQ(opt->opt.ecs_address[2], 0xFC);
+    EXPECT_EQ(opt->opt.ecs_address[3], 0x00);
+    ASSERT_EQ(opt->opt.cookie.length, 8u);
+    EXPECT_EQ(std::string(message.data(opt->opt.cookie), 8), hexToBytes("0102030405060708"));
+}
+
+// 测试选项长度越过 OPT 数据的记录被标记为格式错误
+TEST(DNSParserTest, DecodeOptRejectsOverrunningOption) {
+    std::string queryHex =
+        "AAAA01000001000000000001"
+        "076578616D706C6503636F6D0000010001"
+        "000029100000000000000C"
+        "000A00100102030405060708";                 // 声明 16 字节，只有 8 字节
+
+    Message message;
+    ASSERT_TRUE(DNSParser::parseQuery(hexToBytes(queryHex), message));
+    const RData* opt = message.opt();
+    ASSERT_NE(opt, nullptr);
+    EXPECT_EQ(opt->kind, RDataKind::Malformed);
+}
+
+// 测试查询的附加区截断时仍保留问题区
+TEST(DNSParserTest, QueryWithTruncatedAdditionalKeepsQuestion) {
+    std::string queryHex =
+        "AAAA01000001000000000001"
+        "076578616D706C6503636F6D0000010001"
+        "00002910";                                 // OPT 记录被截断
+
+    Message message;
+    ASSERT_TRUE(DNSParser::parseQuery(hexToBytes(queryHex), message));
+    ASSERT_EQ(message.questions.size(), 1u);
+    EXPECT_EQ(message.name(message.questions[0]), "example.com");
+    EXPECT_EQ(message.opt(), nullptr);
+}
+
+// 签名响应：A 应答、覆盖它的 RRSIG，以及权威区中的 DNSKEY
+static const char* kSignedResponseHex =
+    "AAAA81800001000200010000"
+    "076578616D706C6503636F6D0000010001"
+    "C00C000100010000012C00045DB8D822"
+    "C00C002E000100000E100027"                  // RRSIG，数据长度 39
+    "00010D0200000E1065000000640000003039"      // 覆盖 A，算法 13，2 个标签，密钥标签 12345
+    "076578616D706C6503636F6D00"                // 签名者 example.com
+    "0102030405060708"                          // 签名
+    "C00C0030000100000E100008"                  // DNSKEY，数据长度 8
+    "0101030DAABBCCDD";
+
+// 测试跳过模式下 DNSSEC 记录只记下位置，按需解码的结果与常规解析一致
+TEST(DNSParserTest, SkipDnssecRecordsKeepsWireSpans) {
+    std::string data = hexToBytes(kSignedResponseHex);
+
+    Message full;
+    ASSERT_TRUE(DNSParser::parseResponse(data, full));
+    ParseOptions options;
+    options.skip_dnssec = true;
+    Message skipped;
+    ASSERT_TRUE(DNSParser::parseResponse(data, skipped, options));
+
+    ASSERT_EQ(skipped.answers().size(), 2u);
+    ASSERT_EQ(skipped.authorities().size(), 1u);
+    EXPECT_EQ(skipped.decoded(skipped.answers()[0]).kind, RDataKind::Address);
+    EXPECT_EQ(skipped.name(skipped.answers()[0]), "example.com");
+    // 只有 A 记录的域名和地址进入字节区
+    EXPECT_EQ(skipped.bytes.size(), 11u + 11u + 4u);
+    EXPECT_LT(skipped.bytes.size(), full.bytes.size());
+
+    const DNSResourceRecord& rrsig = skipped.answers()[1];
+    EXPECT_EQ(skipped.decoded(rrsig).kind, RDataKind::Skipped);
+    EXPECT_EQ(rrsig.type, static_cast<uint16_t>(DNSType::RRSIG));
+    EXPECT_EQ(rrsig.ttl, 3600u);
+    EXPECT_EQ(rrsig.rdlength, 39);
+    EXPECT_EQ(rrsig.rdata_offset, full.answers()[1].rdata_offset);
+    EXPECT_EQ(skipped.name(rrsig), "");
+    EXPECT_EQ(DNSParser::ownerName(data, skipped, rrsig), "example.com");
+    EXPECT_EQ(DNSParser::ownerName(data, full, full.answers()[1]), "example.com");
+
+    RRSIGData sig;
+    ASSERT_TRUE(DNSParser::decodeRRSIG(data, rrsig, sig));
+    EXPECT_EQ(sig.type_covered, 1);
+    EXPECT_EQ(sig.algorithm, 13);
+    EXPECT_EQ(sig.labels, 2);
+    EXPECT_EQ(sig.original_ttl, 3600u);
+    EXPECT_EQ(sig.expiration, 0x65000000u);
+    EXPECT_EQ(sig.inception, 0x64000000u);
+    EXPECT_EQ(sig.key_tag, 12345);
+    EXPECT_EQ(sig.signer, "example.com");
+    EXPECT_EQ(sig.signature_length, 8);
+    EXPECT_EQ(data.substr(sig.signature_offset, sig.signature_length), hexToBytes("0102030405060708"));
+
+    DNSKEYData key;
+    ASSERT_TRUE(DNSParser::decodeDNSKEY(data, skipped.authorities()[0], key));
+    EXPECT_EQ(key.flags, 257);
+    EXPECT_EQ(key.protocol, 3);
+    EXPECT_EQ(key.algorithm, 13);
+    EXPECT_EQ(key.key_tag, 31655);
+    EXPECT_EQ(key.key_length, 4);
+    EXPECT_FALSE(DNSParser::decodeRRSIG(data, skipped.authorities()[0], sig));
+}
+
+// 测试跳过模式下截断的 DNSSEC 记录仍然报告截断
+TEST(DNSParserTest, SkipDnssecRejectsTruncatedRecord) {
+    std::string data = hexToBytes(
+        "AAAA81800001000100000000"
+        "076578616D706C6503636F6D0000010001"
+        "C00C002E000100000E100027"
+        "00010D02");
+    ParseError error = ParseError::None;
+    ParseOptions options;
+    options.skip_dnssec = true;
+    options.error = &error;
+    Message message;
+    EXPECT_FALSE(DNSParser::parseResponse(data, message, options));
+    EXPECT_EQ(error, ParseError::TruncatedRecord);
+}
+
+// 测试解码域名时顺带计算的哈希：大小写不敏感，与文本形式一致，压缩指针后的标签同样计入
+TEST(DNSParserTest, DecodeNameComputesSuffixHashes) {
+    std::string data = hexToBytes(
+        "AAAA81800001000100000000"
+        "03575757076578616D706C6503636F6D0000010001"    // WWW.example.com
+        "046D61696CC010000100010000012C00045DB8D822");  // mail + 指向 example.com 的指针
+
+    NameHash hash;
+    EXPECT_EQ(DNSParser::decodeDomainName(data, 12, hash), "WWW.example.com");
+    ASSERT_EQ(hash.labels, 3u);
+    EXPECT_EQ(hash.full, hashNameText("www.example.com", 15));
+    EXPECT_EQ(hash.suffixes[0], hash.full);
+    EXPECT_EQ(hash.suffixes[1], hashNameText("example.com", 11));
+    EXPECT_EQ(hash.suffixes[2], hashNameText("COM", 3));
+    EXPECT_EQ(hash.offsets[1], 4);
+    EXPECT_EQ(hash.offsets[2], 12);
+
+    NameHash compressed;
+    EXPECT_EQ(DNSParser::decodeDomainName(data, 33, compressed), "mail.example.com");
+    ASSERT_EQ(compressed.labels, 3u);
+    EXPECT_EQ(compressed.full, hashNameText("mail.example.com", 16));
+    EXPECT_EQ(compressed.suffixes[1], hash.suffixes[1]);
+
+    NameHash root;
+    EXPECT_EQ(DNSParser::decodeDomainName(hexToBytes("00"), 0, root), "");
+    EXPECT_EQ(root.labels, 0u);
+    EXPECT_EQ(root.full, kNameHashSeed);
+
+    // 边折叠边哈希的结果与先转小写再整体哈希相同，跨越 8 字节分组的标签也一致
+    const char* label = "Label-Longer-Than-Eight";
+    std::string lower = "label-longer-than-eight";
+    uint8_t copy[32];
+    EXPECT_EQ(hashLabel(reinterpret_cast<const uint8_t*>(label), lower.size(), copy),
+              hashBytes(lower.data(), lower.size()));
+    EXPECT_EQ(std::string(reinterpret_cast<char*>(copy), lower.size()), label);
+
+    // 01、10 开头的扩展标签类型不是合法的标签长度
+    NameHash extended;
+    EXPECT_EQ(DNSParser::decodeDomainName(hexToBytes("4161626300"), 0, extended), "");
+}
+
+// 测试解析时规范化域名：复制到字节区的文本为小写，检查结果写入 name_flags
+TEST(DNSParserTest, NormalizeNamesLowercasesAndFlags) {
+    std::string data = hexToBytes(
+        "AAAA81800001000100000000"
+        "03575757076578616D706C6503636F6D0000010001"              // WWW.example.com
+        "065F7365727669C0100001000100000E1000045DB8D822");     // _servi + 指向 example.com 的指针
+
+    ParseOptions options;
+    options.normalize_names = true;
+    Message message;
+    ASSERT_TRUE(DNSParser::parseResponse(data, message, options));
+    ASSERT_EQ(message.questions.size(), 1u);
+    EXPECT_EQ(message.name(message.questions[0]), "www.example.com");
+    EXPECT_EQ(message.questions[0].name_flags, NAME_UPPERCASE);
+    ASSERT_EQ(message.answers().size(), 1u);
+    EXPECT_EQ(message.name(message.answers()[0]), "_servi.example.com");
+    EXPECT_EQ(message.answers()[0].name_flags, NAME_NON_LDH);
+
+    // 未开启时保留原样且不检查
+    ASSERT_TRUE(DNSParser::parseResponse(data, message));
+    EXPECT_EQ(message.name(message.questions[0]), "WWW.example.com");
+    EXPECT_EQ(message.questions[0].name_flags, 0);
+}
+
+// 测试带公共后缀列表解析时为问题记下可注册域名的起始位置
+TEST(DNSParserTest, QuestionsCarryRegistrableOffset) {
+    PublicSuffixList suffixes;
+    suffixes.parse("uk\nco.uk\n");
+    std::string query = hexToBytes(
+        "AAAA01000001000000000000"
+        "037777770653616D706C6502636F02756B0000010001");   // www.Sample.co.uk
+
+    ParseOptions options;
+    options.public_suffixes = &suffixes;
+    Message message;
+    ASSERT_TRUE(DNSParser::parseQuery(query, message, options));
+    ASSERT_EQ(message.questions.size(), 1u);
+    EXPECT_EQ(message.questions[0].registrable_offset, 4);
+    EXPECT_EQ(message.name(message.questions[0]).substr(4), "Sample.co.uk");
+
+    // 驻留时同样可用
+    options.intern_names = true;
+    ASSERT_TRUE(DNSParser::parseQuery(query, message, options));
+    EXPECT_EQ(message.questions[0].registrable_offset, 4);
+
+    // 域名本身是公共后缀，或未提供列表
+    ASSERT_TRUE(DNSParser::parseQuery(hexToBytes("AAAA0100000100000000000002636F02756B0000010001"),
+                                      message, options));
+    EXPECT_EQ(message.questions[0].registrable_offset, kNoRegistrableOffset);
+    ASSERT_TRUE(DNSParser::parseQuery(query, message));
+    EXPECT_EQ(message.questions[0].registrable_offset, kNoRegistrableOffset);
+}
+
+// 测试驻留解析的域名与按文本驻留的是同一个 ID
+TEST(DNSParserTest, InternedNamesUseDecoderHash) {
+    std::string data = hexToBytes(
+        "AAAA01000001000000000000"
+        "0448617368076578616D706C6503636F6D0000010001");  // Hash.example.com
+    ParseOptions options;
+    options.intern_names = true;
+    Message message;
+    ASSERT_TRUE(DNSParser::parseQuery(data, message, options));
+    ASSERT_EQ(message.questions.size(), 1u);
+    EXPECT_EQ(message.questions[0].name_id, NameInterner::global().find("hash.EXAMPLE.com"));
+    EXPECT_NE(message.questions[0].name_id, kInvalidNameId);
+}
+
+// 测试标签之后跟压缩指针时以 '.' 连接，整个名字是指针时不加前导 '.'
+TEST(DNSParserTest, PointerSuffixJoinsWithDot) {
+    std::string data = hexToBytes(
+        "AAAA81800001000000000000"
+        "076578616D706C6503636F6D00"    // example.com
+        "03777777C00C"                  // www + 指向 example.com 的指针
+        "C019");                        // 指向 www.example.com 的指针
+
+    EXPECT_EQ(DNSParser::decodeDomainName(data, 25), "www.example.com");
+    EXPECT_EQ(DNSParser::decodeDomainName(data, 31), "www.example.com");
+}
+
+// 测试压缩指针环路被拒绝
+TEST(DNSParserTest, RejectCompressionLoop) {
+    std::string queryHex = 
+        "AAAA01000001000000000000"
+        "C00C00010001";   // 指针指向自身
+
+    Message message;
+    EXPECT_FALSE(DNSParser::parseQuery(hexToBytes(queryHex), message));
+}
+
+// 测试响应去重缓存：事务 ID 不同的相同响应命中缓存
+TEST(ResponseCacheTest, HitIgnoresTransactionId) {
+    std::string first = hexToBytes(
+        "AAAA81800001000100000000"
+        "03777777076578616D706C6503636F6D0000010001"
+        "C00C000100010000003C00045DB8D822");
+    std::string second = first;
+    second[0] = 0x12;
+    second[1] = 0x34;
+
+    Message message;
+    ASSERT_TRUE(DNSParser::parseResponse(first, message));
+
+    ResponseCache cache(16);
+    EXPECT_EQ(cache.lookup(first, 1000), nullptr);
+    cache.insert(first, message, 1000);
+
+    const Message* cached = cache.lookup(second, 1010);
+    ASSERT_NE(cached, nullptr);
+    ASSERT_EQ(cached->answers().size(), 1);
+    EXPECT_EQ(cached->answers()[0].ttl, 60);
+
+    // 内容不同的响应不会命中
+    std::string other = first;
+    other[other.size() - 1] = 0x23;
+    EXPECT_EQ(cache.lookup(other, 1010), nullptr);
+
+    ResponseCache::Stats stats = cache.stats();
+    EXPECT_EQ(stats.hits, 1);
+    EXPECT_EQ(stats.misses, 2);
+    EXPECT_EQ(stats.inserts, 1);
+}
+
+// 测试响应去重缓存按最短 TTL 过期
+TEST(ResponseCacheTest, ExpiresByShortestTtl) {
+    std::string packet = hexToBytes(
+        "AAAA81800001000200000000"
+        "03777777076578616D706C6503636F6D0000010001"
+        "C00C00010001000000780004" "5DB8D822"      // TTL 120
+        "C00C000100010000001E0004" "5DB8D823");    // TTL 30
+
+    Message message;
+    ASSERT_TRUE(DNSParser::parseResponse(packet, message));
+
+    ResponseCache cache(16);
+    cache.insert(packet, message, 1000);
+    EXPECT_NE(cache.lookup(packet, 1029), nullptr);
+    EXPECT_EQ(cache.lookup(packet, 1030), nullptr);
+    EXPECT_EQ(cache.stats().expirations, 1);
+    EXPECT_EQ(cache.size(), 0);
+}
+
+// 测试清空响应去重缓存（配置重新加载后旧的解析结果不再复用）
+TEST(ResponseCacheTest, ClearDropsEntries) {
+    std::string packet = hexToBytes(
+        "AAAA81800001000100000000"
+        "03777777076578616D706C6503636F6D0000010001"
+        "C00C000100010000003C00045DB8D822");
+
+    Message message;
+    ASSERT_TRUE(DNSParser::parseResponse(packet, message));
+
+    ResponseCache cache(16);
+    cache.insert(packet, message, 1000);
+    EXPECT_EQ(cache.size(), 1);
+    cache.clear();
+    EXPECT_EQ(cache.size(), 0);
+    EXPECT_EQ(cache.lookup(packet, 1000), nullptr);
+}
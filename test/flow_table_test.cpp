@@ -0,0 +1,250 @@
+#include <gtest/gtest.h>
+#include "../include/flows/flow_table.h"
+#include "../include/flows/query_tracker.h"
+#include "../include/tools/buffer_pool.h"
+#include "../include/tools/timer_wheel.h"
+#include <cstring>
+#include <string>
+
+using namespace dns_parser;
+
+static FourTuple makeKey(int clientPort) {
+    FourTuple key;
+    memset(&key, 0, sizeof(key));
+    key.srcIPvN = 4;
+    key.dstIPvN = 4;
+    key.srcIPv4 = 0x0A000001;
+    key.dstIPv4 = 0x08080808;
+    key.sourcePort = clientPort;
+    key.destPort = 53;
+    return key;
+}
+
+TEST(BufferPoolTest, ReusesBlocksAndEnforcesBudget) {
+    MemoryBudget budget(16384);
+    BufferPool pool(budget, 4096, 65536);
+    EXPECT_EQ(pool.classSize(1), 4096u);
+    EXPECT_EQ(pool.classSize(5000), 8192u);
+    EXPECT_EQ(pool.classSize(1 << 20), 65536u);
+
+    char* a = pool.acquire(8192);
+    char* b = pool.acquire(8192);
+    ASSERT_NE(a, nullptr);
+    ASSERT_NE(b, nullptr);
+    EXPECT_EQ(budget.used(), 16384u);
+    EXPECT_EQ(pool.acquire(4096), nullptr);
+
+    // 归还的块留在空闲链表中，但立即归还预算；同级复用时重新记账
+    pool.release(a, 8192);
+    EXPECT_EQ(budget.used(), 8192u);
+    EXPECT_EQ(pool.acquire(8192), a);
+    EXPECT_EQ(budget.used(), 16384u);
+    pool.release(a, 8192);
+
+    // 空闲块不占预算，不同级别的申请直接成功
+    char* c = pool.acquire(4096);
+    ASSERT_NE(c, nullptr);
+    EXPECT_EQ(budget.used(), 8192u + 4096u);
+
+    BufferPool::Stats stats = pool.stats();
+    EXPECT_EQ(stats.reuses, 1u);
+    EXPECT_EQ(stats.denials, 1u);
+    pool.release(b, 8192);
+    pool.release(c, 4096);
+    EXPECT_EQ(budget.used(), 0u);
+    EXPECT_EQ(pool.trim(), 8192u + 8192u + 4096u);
+    EXPECT_EQ(pool.stats().cached_bytes, 0u);
+}
+
+TEST(BufferPoolTest, CachedBlocksDoNotStarveOtherPools) {
+    MemoryBudget budget(64 << 10);
+    BufferPool idle(budget, 4096, 65536);
+    BufferPool busy(budget, 4096, 65536);
+
+    // 空闲线程的池用满预算后全部归还，块留在它的空闲链表中
+    char* blocks[4];
+    for (int i = 0; i < 4; ++i) {
+        blocks[i] = idle.acquire(16384);
+        ASSERT_NE(blocks[i], nullptr);
+    }
+    EXPECT_EQ(busy.acquire(4096), nullptr);
+    for (int i = 0; i < 4; ++i) {
+        idle.release(blocks[i], 16384);
+    }
+    EXPECT_EQ(idle.stats().cached_bytes, 65536u);
+
+    // 其他线程的池不需要等它 trim() 就能拿到预算
+    char* block = busy.acquire(65536);
+    ASSERT_NE(block, nullptr);
+    EXPECT_EQ(busy.stats().denials, 1u);
+    busy.release(block, 65536);
+}
+
+TEST(BufferPoolTest, DoesNotCacheMappedBlocks) {
+    MemoryBudget budget;
+    BufferPool pool(budget, 4096, BufferPool::kMapThreshold);
+    char* block = pool.acquire(BufferPool::kMapThreshold);
+    ASSERT_NE(block, nullptr);
+    pool.release(block, BufferPool::kMapThreshold);
+    EXPECT_EQ(pool.stats().cached_bytes, 0u);
+    EXPECT_EQ(budget.used(), 0u);
+}
+
+TEST(FlowTableTest, BufferGrowsByClassUpToDirectionLimit) {
+    MemoryBudget budget;
+    BufferPool pool(budget, 4096, 1 << 20);
+    TimerWheel timers;
+    FlowTable table(pool, timers, 16, 20000, 4096, 1000);
+    FlowTable::Flow& flow = table.touch(makeKey(1000), 0);
+
+    std::string chunk(3000, 'a');
+    ASSERT_TRUE(table.append(flow, true, chunk.data(), chunk.size()));
+    EXPECT_EQ(flow.c2s.capacity(), 4096u);
+    ASSERT_TRUE(table.append(flow, true, chunk.data(), chunk.size()));
+    EXPECT_EQ(flow.c2s.capacity(), 8192u);
+    EXPECT_EQ(flow.c2s.size(), 6000u);
+
+    // 上限 20000 取不超过它的最大分级 16384
+    std::string big(10000, 'b');
+    ASSERT_TRUE(table.append(flow, true, big.data(), big.size()));
+    EXPECT_EQ(flow.c2s.capacity(), 16384u);
+    EXPECT_EQ(flow.c2s.stream()->at(5999), 'a');
+    EXPECT_EQ(flow.c2s.stream()->at(6000), 'b');
+    EXPECT_FALSE(table.append(flow, true, big.data(), big.size()));
+    EXPECT_EQ(flow.c2s.size(), 16000u);
+
+    // S2C 方向使用各自的上限
+    EXPECT_FALSE(table.append(flow, false, chunk.data(), chunk.size() + 2000));
+    EXPECT_EQ(table.stats().overflows, 2u);
+
+    flow.c2s.consume(16000);
+    EXPECT_EQ(flow.c2s.size(), 0u);
+    EXPECT_TRUE(table.remove(makeKey(1000)));
+    EXPECT_EQ(table.size(), 0u);
+}
+
+TEST(FlowTableTest, ReclaimsIdleFlowsUnderBudgetPressure) {
+    MemoryBudget budget(8192);
+    BufferPool pool(budget, 4096, 65536);
+    TimerWheel timers;
+    FlowTable table(pool, timers, 16, 65536, 65536, 1000);
+    std::string chunk(4000, 'x');
+
+    ASSERT_TRUE(table.append(table.touch(makeKey(1), 10), true, chunk.data(), chunk.size()));
+    ASSERT_TRUE(table.append(table.touch(makeKey(2), 20), true, chunk.data(), chunk.size()));
+
+    // 两个流都有不完整的消息且刚刚活动过，预算已满时不回收，新流写入失败
+    FlowTable::Flow& third = table.touch(makeKey(3), 30);
+    EXPECT_FALSE(table.append(third, true, chunk.data(), chunk.size()));
+    EXPECT_EQ(table.stats().reclaimed_bytes, 0u);
+
+    // 流 1 空闲超过 kReclaimIdleMs 后被视为中断，回收它的缓冲区；流 2 仍在阈值内
+    FlowTable::Flow& later = table.touch(makeKey(3), 10 + FlowTable::kReclaimIdleMs);
+    ASSERT_TRUE(table.append(later, true, chunk.data(), chunk.size()));
+    EXPECT_EQ(table.find(makeKey(1))->c2s.capacity(), 0u);
+    EXPECT_EQ(table.find(makeKey(2))->c2s.size(), 4000u);
+    EXPECT_EQ(table.stats().reclaimed_bytes, 4096u);
+    EXPECT_LE(budget.used(), 8192u);
+}
+
+TEST(FlowTableTest, ReclaimsEmptyBuffersBeforeIdleTimeout) {
+    MemoryBudget budget(8192);
+    BufferPool pool(budget, 4096, 65536);
+    TimerWheel timers;
+    FlowTable table(pool, timers, 16, 65536, 65536, 1000);
+    std::string chunk(4000, 'x');
+
+    // 流 1 的消息已处理完，缓冲区为空，流 2 仍有不完整的消息
+    FlowTable::Flow& first = table.touch(makeKey(1), 10);
+    ASSERT_TRUE(table.append(first, true, chunk.data(), chunk.size()));
+    first.c2s.consume(chunk.size());
+    ASSERT_TRUE(table.append(table.touch(makeKey(2), 20), true, chunk.data(), chunk.size()));
+
+    FlowTable::Flow& third = table.touch(makeKey(3), 30);
+    ASSERT_TRUE(table.append(third, true, chunk.data(), chunk.size()));
+    EXPECT_EQ(table.find(makeKey(1))->c2s.capacity(), 0u);
+    EXPECT_EQ(table.find(makeKey(2))->c2s.size(), 4000u);
+    EXPECT_EQ(table.stats().reclaimed_bytes, 4096u);
+}
+
+TEST(FlowTableTest, DirectionLimitDoesNotReclaimOtherFlows) {
+    MemoryBudget budget;
+    BufferPool pool(budget, 4096, 65536);
+    TimerWheel timers;
+    FlowTable table(pool, timers, 16, 8192, 8192, 1000);
+
+    // 流 B 缓冲着一个 TCP 消息的前 17 个字节
+    std::string partial(17, 'p');
+    ASSERT_TRUE(table.append(table.touch(makeKey(2), 0), true, partial.data(), partial.size()));
+
+    // 流 A 超过自己方向的上限只算溢出，流 B 的数据不受影响
+    std::string big(9000, 'a');
+    EXPECT_FALSE(table.append(table.touch(makeKey(1), 5000), true, big.data(), big.size()));
+    EXPECT_EQ(table.find(makeKey(2))->c2s.size(), 17u);
+    EXPECT_EQ(table.stats().reclaimed_bytes, 0u);
+    EXPECT_EQ(table.stats().overflows, 1u);
+}
+
+TEST(FlowTableTest, EvictsOldestFlowWhenFull) {
+    MemoryBudget budget;
+    BufferPool pool(budget);
+    TimerWheel timers;
+    FlowTable table(pool, timers, 2, 4096, 4096, 1000);
+    table.touch(makeKey(1), 100);
+    table.touch(makeKey(2), 150);
+    table.touch(makeKey(1), 180);    // 再次活动后移到链表尾部
+    table.touch(makeKey(3), 200);
+
+    EXPECT_EQ(table.size(), 2u);
+    EXPECT_NE(table.find(makeKey(1)), nullptr);
+    EXPECT_EQ(table.find(makeKey(2)), nullptr);
+    EXPECT_EQ(table.stats().evicted, 1u);
+
+    // 淘汰和删除后链表保持一致：流 1 现在最久未活动
+    EXPECT_TRUE(table.remove(makeKey(3)));
+    table.touch(makeKey(4), 300);
+    table.touch(makeKey(5), 400);
+    EXPECT_EQ(table.find(makeKey(1)), nullptr);
+    EXPECT_NE(table.find(makeKey(4)), nullptr);
+    EXPECT_EQ(table.stats().evicted, 2u);
+}
+
+TEST(FlowTableTest, IdleFlowsTimeOutByPacketTime) {
+    MemoryBudget budget;
+    BufferPool pool(budget);
+    TimerWheel timers(1000);
+    FlowTable table(pool, timers, 16, 4096, 4096, 500);
+    table.touch(makeKey(1), 1000);
+    table.touch(makeKey(2), 1000);
+
+    // 流 1 在超时前有活动，只有流 2 到期
+    table.touch(makeKey(1), 1400);
+    timers.advance(1500, 64, [&table](uint64_t data) { table.onTimer(data, 1500); });
+    EXPECT_NE(table.find(makeKey(1)), nullptr);
+    EXPECT_EQ(table.find(makeKey(2)), nullptr);
+
+    timers.advance(1900, 64, [&table](uint64_t data) { table.onTimer(data, 1900); });
+    EXPECT_EQ(table.size(), 0u);
+    EXPECT_EQ(table.stats().timeouts, 2u);
+    EXPECT_EQ(timers.size(), 0u);
+}
+
+TEST(QueryTrackerTest, MatchesResponsesAndTimesOutQueries) {
+    TimerWheel timers(0);
+    QueryTracker tracker(timers, 16, 2000);
+    tracker.onQuery(makeKey(1), 0x1234, 100);
+    tracker.onQuery(makeKey(2), 0x1234, 100);
+
+    uint64_t rtt = 0;
+    EXPECT_TRUE(tracker.onResponse(makeKey(1), 0x1234, 130, &rtt));
+    EXPECT_EQ(rtt, 30u);
+    EXPECT_FALSE(tracker.onResponse(makeKey(1), 0x1234, 140));
+
+    timers.advance(2100, 64, [&tracker](uint64_t data) { tracker.onTimer(data); });
+    QueryTracker::Stats stats = tracker.stats();
+    EXPECT_EQ(stats.pending, 0u);
+    EXPECT_EQ(stats.matched, 1u);
+    EXPECT_EQ(stats.unmatched, 1u);
+    EXPECT_EQ(stats.timeouts, 1u);
+    EXPECT_FALSE(tracker.onResponse(makeKey(2), 0x1234, 2200));
+}
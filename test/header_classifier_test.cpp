@@ -0,0 +1,71 @@
+#include <gtest/gtest.h>
+#include "../include/flows/header_classifier.h"
+#include <string>
+
+using namespace dns_parser;
+
+// 辅助函数：将十六进制字符串转换为二进制数据
+static std::string hexToBytes(const std::string& hex) {
+    std::string bytes;
+    for (size_t i = 0; i < hex.length(); i += 2) {
+        std::string byteString = hex.substr(i, 2);
+        char byte = (char) strtol(byteString.c_str(), nullptr, 16);
+        bytes.push_back(byte);
+    }
+    return bytes;
+}
+
+static HeaderCheck classify(const std::string& data, bool from_client) {
+    return classifyHeader(reinterpret_cast<const uint8_t*>(data.data()), data.size(), from_client);
+}
+
+static const char* kQuery = "AAAA01000001000000000000076578616D706C6503636F6D0000010001";
+static const char* kResponse = "AAAA81800001000100000000076578616D706C6503636F6D0000010001"
+                               "C00C000100010000012C00045DB8D822";
+
+TEST(HeaderClassifierTest, AcceptsQueriesAndResponses) {
+    EXPECT_EQ(classify(hexToBytes(kQuery), true), HeaderCheck::Ok);
+    EXPECT_EQ(classify(hexToBytes(kResponse), false), HeaderCheck::Ok);
+    // NOTIFY 和 UPDATE 是合法的操作码
+    EXPECT_EQ(classify(hexToBytes("AAAA20000001000000000000076578616D706C6503636F6D0000060001"), true),
+              HeaderCheck::Ok);
+    EXPECT_EQ(classify(hexToBytes("AAAA28000001000000000000076578616D706C6503636F6D0000060001"), true),
+              HeaderCheck::Ok);
+}
+
+TEST(HeaderClassifierTest, RejectsShortPayload) {
+    EXPECT_EQ(classify(hexToBytes("AAAA0100000100"), true), HeaderCheck::TooShort);
+    EXPECT_EQ(classify(std::string(), true), HeaderCheck::TooShort);
+}
+
+TEST(HeaderClassifierTest, RejectsUnassignedOpcode) {
+    // 操作码 3 未分配
+    EXPECT_EQ(classify(hexToBytes("AAAA18000001000000000000076578616D706C6503636F6D0000010001"), true),
+              HeaderCheck::BadOpcode);
+    // 端口 53 上的 HTTP 请求：操作码为 10
+    EXPECT_EQ(classify("GET / HTTP/1.1\r\nHost: example.com\r\n\r\n", true), HeaderCheck::BadOpcode);
+}
+
+TEST(HeaderClassifierTest, RejectsDirectionMismatch) {
+    EXPECT_EQ(classify(hexToBytes(kResponse), true), HeaderCheck::WrongDirection);
+    EXPECT_EQ(classify(hexToBytes(kQuery), false), HeaderCheck::WrongDirection);
+}
+
+TEST(HeaderClassifierTest, RejectsCountsThatCannotFit) {
+    // 声明 3 条应答但问题区之后只剩 0 字节（下限 33 字节）
+    std::string truncated = hexToBytes(kQuery);
+    truncated[7] = 3;
+    EXPECT_EQ(classify(truncated, true), HeaderCheck::CountsExceedLength);
+    // 所有计数取最大值
+    EXPECT_EQ(classify(hexToBytes("AAAA8180FFFFFFFFFFFFFFFF") + std::string(500, '\0'), false),
+              HeaderCheck::CountsExceedLength);
+    // 恰好放得下：1 个根域名问题和 1 条根域名记录
+    EXPECT_EQ(classify(hexToBytes("AAAA81800001000100000000" "0000010001" "0000010001000000000000"), false),
+              HeaderCheck::Ok);
+}
+
+TEST(HeaderClassifierTest, ReportsFirstFailingCheck) {
+    // 操作码无效、方向不符、计数超出长度同时命中
+    EXPECT_EQ(classify(hexToBytes("AAAA98000005000000000000"), true), HeaderCheck::BadOpcode);
+    EXPECT_STREQ(headerCheckName(HeaderCheck::WrongDirection), "QR 与方向不符");
+}
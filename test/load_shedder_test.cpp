@@ -0,0 +1,115 @@
+#include <gtest/gtest.h>
+#include "../include/flows/load_shedder.h"
+
+using namespace dns_parser;
+
+static ShedPolicy testPolicy() {
+    ShedPolicy policy;
+    policy.enabled = true;
+    policy.latency_high_ns = 10000;
+    policy.latency_low_ns = 2000;
+    policy.pressure_high = 80;
+    policy.pressure_low = 40;
+    policy.sample_rate = 4;
+    policy.hold_ms = 100;
+    return policy;
+}
+
+// 按给定耗时处理 count 个数据包，耗时按处理深度取值
+static int run(LoadShedder& shedder, const uint32_t cost[3], uint8_t pressure, uint64_t& now_ms, int count,
+               LoadShedder::Transition* last = nullptr) {
+    int changes = 0;
+    for (int i = 0; i < count; ++i) {
+        ShedLevel depth = shedder.admit();
+        LoadShedder::Transition change;
+        if (shedder.observe(depth, cost[static_cast<size_t>(depth)], pressure, now_ms, &change)) {
+            ++changes;
+            if (last) {
+                *last = change;
+            }
+        }
+        now_ms += 1;
+    }
+    return changes;
+}
+
+TEST(LoadShedderTest, DegradesStepByStepUnderSlowProcessing) {
+    uint64_t now = 1000;
+    LoadShedder shedder(testPolicy(), now);
+    const uint32_t cost[3] = { 50000, 20000, 200 };
+
+    // 变化之间至少间隔 hold_ms
+    LoadShedder::Transition change;
+    EXPECT_EQ(run(shedder, cost, 0, now, 99, &change), 0);
+    EXPECT_EQ(shedder.level(), ShedLevel::Full);
+    EXPECT_EQ(run(shedder, cost, 0, now, 2, &change), 1);
+    EXPECT_EQ(shedder.level(), ShedLevel::Questions);
+    EXPECT_EQ(change.from, ShedLevel::Full);
+    EXPECT_EQ(change.to, ShedLevel::Questions);
+    EXPECT_GT(change.latency_ns, 10000u);
+
+    // 头部+问题仍然太慢，进入抽样
+    EXPECT_EQ(run(shedder, cost, 0, now, 100), 1);
+    EXPECT_EQ(shedder.level(), ShedLevel::Sampling);
+
+    // 抽样级别已经够快，但上一级的时延仍然超标，不会恢复
+    EXPECT_EQ(run(shedder, cost, 0, now, 1000), 0);
+    EXPECT_EQ(shedder.level(), ShedLevel::Sampling);
+
+    // 抽样级别下每 4 个数据包中有一个解析头部和问题
+    LoadShedder::Stats before = shedder.stats();
+    run(shedder, cost, 0, now, 400);
+    LoadShedder::Stats after = shedder.stats();
+    EXPECT_EQ(after.packets[1] - before.packets[1], 100u);
+    EXPECT_EQ(after.packets[2] - before.packets[2], 300u);
+    EXPECT_EQ(after.packets[0], before.packets[0]);
+    EXPECT_EQ(after.transitions, 2u);
+}
+
+TEST(LoadShedderTest, RecoversWhenPreviousLevelIsFastAgain) {
+    uint64_t now = 0;
+    LoadShedder shedder(testPolicy(), now);
+    const uint32_t slow[3] = { 50000, 50000, 200 };
+    run(shedder, slow, 0, now, 300);
+    ASSERT_EQ(shedder.level(), ShedLevel::Sampling);
+
+    // 负载消失后逐级恢复，每级至少停留 hold_ms
+    const uint32_t fast[3] = { 1000, 500, 200 };
+    EXPECT_EQ(run(shedder, fast, 0, now, 150), 1);
+    EXPECT_EQ(shedder.level(), ShedLevel::Questions);
+    EXPECT_EQ(run(shedder, fast, 0, now, 200), 1);
+    EXPECT_EQ(shedder.level(), ShedLevel::Full);
+    EXPECT_EQ(run(shedder, fast, 0, now, 500), 0);
+}
+
+TEST(LoadShedderTest, QueuePressureDrivesLevelsWithHysteresis) {
+    uint64_t now = 0;
+    LoadShedder shedder(testPolicy(), now);
+    const uint32_t cost[3] = { 1000, 500, 200 };
+
+    EXPECT_EQ(run(shedder, cost, 90, now, 101), 1);
+    EXPECT_EQ(shedder.level(), ShedLevel::Questions);
+
+    // 介于两个阈值之间：保持当前级别
+    EXPECT_EQ(run(shedder, cost, 60, now, 500), 0);
+    EXPECT_EQ(shedder.level(), ShedLevel::Questions);
+
+    EXPECT_EQ(run(shedder, cost, 10, now, 200), 1);
+    EXPECT_EQ(shedder.level(), ShedLevel::Full);
+}
+
+TEST(LoadShedderTest, DisabledAlwaysParsesFully) {
+    ShedPolicy policy = testPolicy();
+    uint64_t now = 0;
+    LoadShedder shedder(policy, now);
+    const uint32_t slow[3] = { 50000, 50000, 50000 };
+    run(shedder, slow, 100, now, 150);
+    ASSERT_EQ(shedder.level(), ShedLevel::Questions);
+
+    policy.enabled = false;
+    shedder.setPolicy(policy);
+    EXPECT_EQ(shedder.level(), ShedLevel::Full);
+    uint64_t full = shedder.stats().packets[0];
+    EXPECT_EQ(run(shedder, slow, 100, now, 1000), 0);
+    EXPECT_EQ(shedder.stats().packets[0], full + 1000u);
+}
@@ -0,0 +1,115 @@
+#include <gtest/gtest.h>
+#include "../include/tools/name_check.h"
+#include <cstdlib>
+#include <string>
+
+using namespace dns_parser;
+
+// 对域名副本调用检查，返回标志位，name 改为转换后的结果
+static uint8_t check(std::string& name) {
+    return normalizeName(&name[0], name.size());
+}
+
+static uint8_t check(const char* text) {
+    std::string name(text);
+    return check(name);
+}
+
+TEST(NameCheckTest, LowercasesAndFlagsUppercase) {
+    std::string name = "WwW.ExAmPlE.CoM";
+    EXPECT_EQ(check(name), NAME_UPPERCASE);
+    EXPECT_EQ(name, "www.example.com");
+
+    // 超过一个向量块的名字
+    std::string longName = "ABCDEFGHIJKLMNOPQRSTUVWXYZ-0123456789.SUB.EXAMPLE.ORG";
+    EXPECT_EQ(check(longName), NAME_UPPERCASE);
+    EXPECT_EQ(longName, "abcdefghijklmnopqrstuvwxyz-0123456789.sub.example.org");
+
+    EXPECT_EQ(check("www.example.com"), 0);
+    EXPECT_EQ(check(""), 0);
+}
+
+TEST(NameCheckTest, FlagsNonLdhLabels) {
+    EXPECT_EQ(check("_dmarc.example.com"), NAME_NON_LDH);
+    EXPECT_EQ(check("a b.example.com"), NAME_NON_LDH);
+    EXPECT_EQ(check("-lead.example.com"), NAME_NON_LDH);
+    EXPECT_EQ(check("trail-.example.com"), NAME_NON_LDH);
+    EXPECT_EQ(check("mid-dle.example.com"), 0);
+    EXPECT_EQ(check("EXAMPLE.c*m"), NAME_UPPERCASE | NAME_NON_LDH);
+}
+
+TEST(NameCheckTest, FlagsIdnLabels) {
+    EXPECT_EQ(check("xn--bcher-kva.example"), NAME_IDN);
+    EXPECT_EQ(check("www.XN--bcher-kva.example"), NAME_IDN | NAME_UPPERCASE);
+    EXPECT_EQ(check("axn--b.example"), 0);
+    // 原始 UTF-8 同时不是 LDH
+    EXPECT_EQ(check("b\xC3\xBC" "cher.example"), NAME_IDN | NAME_NON_LDH);
+}
+
+TEST(NameCheckTest, FlagsBadLabelLengths) {
+    EXPECT_EQ(check("a..b"), NAME_BAD_LENGTH);
+    EXPECT_EQ(check(".a"), NAME_BAD_LENGTH);
+    EXPECT_EQ(check("a."), NAME_BAD_LENGTH);
+    EXPECT_EQ(check((std::string(63, 'a') + ".com").c_str()), 0);
+    EXPECT_EQ(check((std::string(64, 'a') + ".com").c_str()), NAME_BAD_LENGTH);
+
+    // 64 字节的标签跨越两个 AVX2 块和掩码字的边界
+    std::string spanning = std::string(40, 'b') + "." + std::string(64, 'C') + ".net";
+    EXPECT_EQ(check(spanning), NAME_BAD_LENGTH | NAME_UPPERCASE);
+    EXPECT_EQ(spanning, std::string(40, 'b') + "." + std::string(64, 'c') + ".net");
+}
+
+TEST(NameCheckTest, LabelEdgesAcrossMaskWords) {
+    // 连字符正好落在第 64 个字节（第二个掩码字的第一位）
+    std::string name = std::string(63, 'a') + ".-bc.example";
+    EXPECT_EQ(check(name), NAME_NON_LDH);
+    // 255 字节的合法名字
+    std::string full;
+    while (full.size() + 64 <= 255) {
+        full += std::string(63, 'x') + ".";
+    }
+    full += std::string(255 - full.size(), 'y');
+    ASSERT_EQ(full.size(), 255u);
+    EXPECT_EQ(check(full), 0);
+}
+
+TEST(NameCheckTest, ImplementationsAgree) {
+    EXPECT_NE(std::string(nameCheckImplementation()), "");
+    const char alphabet[] = "aZm09-._\x80\xFFQxn.-";
+    srand(12345);
+    for (int round = 0; round < 20000; ++round) {
+        size_t length = static_cast<size_t>(rand() % 256);
+        std::string name(length, 'a');
+        for (size_t i = 0; i < length; ++i) {
+            name[i] = alphabet[rand() % (sizeof(alphabet) - 1)];
+        }
+        // 部分名字由合法标签组成，覆盖标签长度和首尾的检查
+        if (round % 2) {
+            for (size_t i = 0; i < length; ++i) {
+                name[i] = (i % 9 == 8) ? '.' : (rand() % 4 ? 'k' : 'K');
+            }
+        }
+
+        std::string scalar = name;
+        uint8_t expected = detail::normalizeNameScalar(&scalar[0], scalar.size());
+        if (detail::cpuHasSse2()) {
+            std::string sse2 = name;
+            ASSERT_EQ(detail::normalizeNameSse2(&sse2[0], sse2.size()), expected) << name;
+            ASSERT_EQ(sse2, scalar);
+        }
+        if (detail::cpuHasAvx2()) {
+            std::string avx2 = name;
+            ASSERT_EQ(detail::normalizeNameAvx2(&avx2[0], avx2.size()), expected) << name;
+            ASSERT_EQ(avx2, scalar);
+        }
+        std::string dispatched = name;
+        ASSERT_EQ(normalizeName(&dispatched[0], dispatched.size()), expected);
+        ASSERT_EQ(dispatched, scalar);
+    }
+}
+
+TEST(NameCheckTest, OverlongTextOnlyFolds) {
+    std::string name(300, 'A');
+    EXPECT_EQ(check(name), NAME_BAD_LENGTH | NAME_UPPERCASE);
+    EXPECT_EQ(name, std::string(300, 'a'));
+}
@@ -0,0 +1,129 @@
+#include <gtest/gtest.h>
+#include "../include/tools/name_interner.h"
+#include "../include/tools/name_hash.h"
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace dns_parser;
+
+TEST(NameInternerTest, InternIsStableAndCaseInsensitive) {
+    NameInterner interner(1024);
+
+    uint32_t a = interner.intern("www.Example.com");
+    uint32_t b = interner.intern("WWW.EXAMPLE.COM");
+    uint32_t c = interner.intern("mail.example.com");
+
+    EXPECT_NE(a, NameInterner::kInvalidId);
+    EXPECT_EQ(a, b);
+    EXPECT_NE(a, c);
+    EXPECT_EQ(interner.size(), 2u);
+    EXPECT_EQ(interner.name(a), "www.example.com");
+    EXPECT_EQ(interner.find("www.example.COM"), a);
+    EXPECT_EQ(interner.find("missing.example.com"), NameInterner::kInvalidId);
+
+    size_t len = 0;
+    const char* str = interner.data(c, &len);
+    ASSERT_NE(str, nullptr);
+    EXPECT_EQ(std::string(str, len), "mail.example.com");
+}
+
+TEST(NameInternerTest, PrecomputedHashMatchesTextHash) {
+    NameInterner interner(1024);
+
+    const char* name = "WWW.Example.com";
+    uint32_t a = interner.intern(name, std::strlen(name), hashNameText(name, std::strlen(name)));
+    EXPECT_NE(a, NameInterner::kInvalidId);
+    EXPECT_EQ(interner.intern("www.example.com"), a);
+    EXPECT_EQ(interner.find("www.EXAMPLE.com"), a);
+    EXPECT_EQ(interner.size(), 1u);
+
+    // 调用方已转为小写时跳过折叠，得到同一个 ID
+    EXPECT_EQ(interner.intern("www.example.com", 15, hashNameText("www.example.com", 15), true), a);
+    EXPECT_EQ(interner.size(), 1u);
+}
+
+TEST(NameInternerTest, RejectsWhenFull) {
+    NameInterner interner(2);
+    EXPECT_NE(interner.intern("a.com"), NameInterner::kInvalidId);
+    EXPECT_NE(interner.intern("b.com"), NameInterner::kInvalidId);
+    EXPECT_EQ(interner.intern("c.com"), NameInterner::kInvalidId);
+    EXPECT_EQ(interner.intern("a.com"), interner.find("a.com"));
+    EXPECT_EQ(interner.size(), 2u);
+}
+
+TEST(NameInternerTest, ConcurrentInternAssignsOneIdPerName) {
+    const int kThreads = 4;
+    const int kNames = 5000;
+    NameInterner interner(kNames * 2);
+    std::vector<std::vector<uint32_t> > ids(kThreads, std::vector<uint32_t>(kNames));
+
+    std::vector<std::thread> workers;
+    for (int t = 0; t < kThreads; ++t) {
+        workers.push_back(std::thread([&interner, &ids, t]() {
+            for (int i = 0; i < kNames; ++i) {
+                // 各线程以不同顺序插入同一批名字
+                int n = (t % 2 == 0) ? i : kNames - 1 - i;
+                ids[t][n] = interner.intern("host" + std::to_string(n) + ".example.com");
+            }
+        }));
+    }
+    for (size_t t = 0; t < workers.size(); ++t) {
+        workers[t].join();
+    }
+
+    EXPECT_EQ(interner.size(), static_cast<size_t>(kNames));
+    for (int i = 0; i < kNames; ++i) {
+        for (int t = 1; t < kThreads; ++t) {
+            ASSERT_EQ(ids[0][i], ids[t][i]);
+        }
+        ASSERT_EQ(interner.name(ids[0][i]), "host" + std::to_string(i) + ".example.com");
+    }
+}
+
+TEST(NameInternerTest, ClearReclaimsCapacity) {
+    NameInterner interner(2);
+    interner.intern("a.com");
+    interner.intern("b.com");
+    EXPECT_TRUE(interner.full());
+    EXPECT_EQ(interner.maxNames(), 2u);
+    EXPECT_GT(interner.memoryUsage(), 0u);
+
+    interner.clear();
+    EXPECT_FALSE(interner.full());
+    EXPECT_EQ(interner.size(), 0u);
+    EXPECT_EQ(interner.find("a.com"), NameInterner::kInvalidId);
+
+    uint32_t c = interner.intern("C.com");
+    EXPECT_NE(c, NameInterner::kInvalidId);
+    EXPECT_EQ(interner.name(c), "c.com");
+    EXPECT_NE(interner.intern("d.com"), NameInterner::kInvalidId);
+    EXPECT_EQ(interner.intern("e.com"), NameInterner::kInvalidId);
+}
+
+TEST(NameInternerTest, PrivateInstanceInternsAndClears) {
+    NameInterner shared(2);
+    NameInterner local(2, false);
+    uint32_t a = local.intern("WWW.Example.com");
+    EXPECT_NE(a, NameInterner::kInvalidId);
+    EXPECT_EQ(local.intern("www.example.com"), a);
+    EXPECT_EQ(local.find("www.EXAMPLE.com"), a);
+    EXPECT_EQ(local.name(a), "www.example.com");
+
+    // 私有实例只有一个小 slab 分段
+    shared.intern("www.example.com");
+    EXPECT_LT(local.memoryUsage(), shared.memoryUsage());
+
+    EXPECT_NE(local.intern("b.com"), NameInterner::kInvalidId);
+    EXPECT_TRUE(local.full());
+    EXPECT_EQ(local.intern("c.com"), NameInterner::kInvalidId);
+    EXPECT_EQ(local.size(), 2u);
+
+    local.clear();
+    EXPECT_EQ(local.size(), 0u);
+    EXPECT_EQ(local.find("b.com"), NameInterner::kInvalidId);
+    uint32_t c = local.intern("c.com");
+    EXPECT_NE(c, NameInterner::kInvalidId);
+    EXPECT_EQ(local.name(c), "c.com");
+}
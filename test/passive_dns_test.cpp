@@ -0,0 +1,294 @@
+#include <gtest/gtest.h>
+#include "../include/analytics/passive_dns.h"
+#include "../include/flows/dns_parser.h"
+#include <arpa/inet.h>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace dns_parser;
+
+// 辅助函数：将十六进制字符串转换为二进制数据
+static std::string hexToBytes(const std::string& hex) {
+    std::string bytes;
+    for (size_t i = 0; i < hex.length(); i += 2) {
+        std::string byteString = hex.substr(i, 2);
+        char byte = (char) strtol(byteString.c_str(), nullptr, 16);
+        bytes.push_back(byte);
+    }
+    return bytes;
+}
+
+// www.example.com CNAME web.example.com, web.example.com A 93.184.216.34 / AAAA 2001:db8::1
+static std::string buildResponse() {
+    return hexToBytes(
+        "AAAA81800001000300000000"
+        "03777777076578616D706C6503636F6D0000010001"   // 问题: www.example.com A IN
+        "C00C000500010000003C0006"                     // www.example.com CNAME, TTL 60
+        "03776562C010"                                 // web + 指向 example.com
+        "C02D00010001000000780004"                     // web.example.com A, TTL 120
+        "5DB8D822"                                     // 93.184.216.34
+        "C02D001C0001000000780010"                     // web.example.com AAAA, TTL 120
+        "20010DB8000000000000000000000001");           // 2001:db8::1
+}
+
+TEST(PassiveDNSTest, ReverseAndForwardLookup) {
+    std::string data = buildResponse();
+    Message message;
+    ASSERT_TRUE(DNSParser::parseResponse(data, message));
+    ASSERT_EQ(message.answers().size(), 3u);
+
+    PassiveDNS store;
+    store.observe(message, 1000);
+    EXPECT_EQ(store.size(), 3u);
+
+    std::vector<std::string> names = store.namesForIPv4(inet_addr("93.184.216.34"));
+    ASSERT_EQ(names.size(), 1u);
+    EXPECT_EQ(names[0], "web.example.com");
+
+    uint8_t addr6[16] = {0x20, 0x01, 0x0d, 0xb8, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1};
+    names = store.namesForIPv6(addr6);
+    ASSERT_EQ(names.size(), 1u);
+    EXPECT_EQ(names[0], "web.example.com");
+
+    PassiveDNS::Resolution alias = store.resolve("WWW.Example.COM");
+    ASSERT_EQ(alias.cnames.size(), 1u);
+    EXPECT_EQ(alias.cnames[0], "web.example.com");
+
+    PassiveDNS::Resolution target = store.resolve("web.example.com");
+    ASSERT_EQ(target.ipv4.size(), 1u);
+    EXPECT_EQ(target.ipv4[0], inet_addr("93.184.216.34"));
+    ASSERT_EQ(target.ipv6.size(), 1u);
+}
+
+TEST(PassiveDNSTest, EntriesExpireByTTL) {
+    std::string data = buildResponse();
+    Message message;
+    ASSERT_TRUE(DNSParser::parseResponse(data, message));
+
+    PassiveDNS store;
+    store.observe(message, 1000);
+    EXPECT_EQ(store.nameCount(), 2u);
+
+    // CNAME 的 TTL 为 60 秒，地址记录为 120 秒
+    store.expire(1059);
+    EXPECT_EQ(store.size(), 3u);
+    store.expire(1060);
+    EXPECT_EQ(store.size(), 2u);
+    EXPECT_TRUE(store.resolve("www.example.com").cnames.empty());
+
+    // 重新观测会刷新过期时间
+    store.observe(message, 1100);
+    store.expire(1121);
+    EXPECT_EQ(store.size(), 3u);
+    store.expire(1220);
+    EXPECT_EQ(store.size(), 0u);
+    EXPECT_TRUE(store.namesForIPv4(inet_addr("93.184.216.34")).empty());
+    EXPECT_EQ(store.nameCount(), 0u);
+}
+
+TEST(PassiveDNSTest, ExpiryIsSpreadOverCalls) {
+    // 200 条同时过期的 A 记录
+    char header[32];
+    std::snprintf(header, sizeof(header), "AAAA8180000100%02X00000000", 200);
+    std::string hex = std::string(header) + "03777777076578616D706C6503636F6D0000010001";
+    for (int i = 0; i < 200; ++i) {
+        char answer[64];
+        std::snprintf(answer, sizeof(answer), "C00C000100010000003C00040A0000%02X", i);
+        hex += answer;
+    }
+    std::string data = hexToBytes(hex);
+    Message message;
+    ASSERT_TRUE(DNSParser::parseResponse(data, message));
+
+    PassiveDNS store;
+    store.observe(message, 1000);
+    ASSERT_EQ(store.size(), 200u);
+
+    // 每次最多处理 kExpireStepBudget 个定时器（槽位下放也计入），剩下的留给之后的调用
+    size_t calls = 0;
+    size_t previous = store.size();
+    while (!store.expire(1060)) {
+        EXPECT_LE(previous - store.size(), PassiveDNS::kExpireStepBudget);
+        previous = store.size();
+        ++calls;
+    }
+    EXPECT_EQ(store.size(), 0u);
+    EXPECT_GE(calls, 200u / PassiveDNS::kExpireStepBudget);
+}
+
+TEST(PassiveDNSTest, ReusesInternedNameIds) {
+    std::string data = buildResponse();
+    Message message;
+    ParseOptions options;
+    options.intern_names = true;
+    ASSERT_TRUE(DNSParser::parseResponse(data, message, options));
+    EXPECT_TRUE(message.name(message.answers()[1]).empty());
+
+    PassiveDNS store;
+    store.observe(message, 1000);
+    std::vector<std::string> names = store.namesForIPv4(inet_addr("93.184.216.34"));
+    ASSERT_EQ(names.size(), 1u);
+    EXPECT_EQ(names[0], "web.example.com");
+}
+
+TEST(PassiveDNSTest, CapacityLimitDropsNewMappings) {
+    std::string data = buildResponse();
+    Message message;
+    ASSERT_TRUE(DNSParser::parseResponse(data, message));
+
+    PassiveDNS store(2);
+    store.observe(message, 1000);
+    EXPECT_EQ(store.size(), 2u);
+    EXPECT_EQ(store.dropped(), 1u);
+}
+
+TEST(PassiveDNSTest, MergeBuildsAggregatedViewFromShards) {
+    std::string data = buildResponse();
+    Message message;
+    ASSERT_TRUE(DNSParser::parseResponse(data, message));
+
+    // 两个线程分片各自观测到同一响应，第二个分片更晚
+    PassiveDNS first;
+    PassiveDNS second(2);
+    first.observe(message, 1000);
+    second.observe(message, 1050);
+    EXPECT_EQ(second.dropped(), 1u);
+
+    PassiveDNS merged;
+    merged.merge(first, 1055);
+    merged.merge(second, 1055);
+    EXPECT_EQ(merged.size(), 3u);
+    EXPECT_EQ(merged.nameCount(), 2u);
+    EXPECT_EQ(merged.dropped(), 1u);
+    ASSERT_EQ(merged.namesForIPv4(inet_addr("93.184.216.34")).size(), 1u);
+
+    // 合并后保留较晚的过期时间：CNAME 在两个分片中分别于 1060 和 1110 到期
+    merged.expire(1109);
+    EXPECT_EQ(merged.resolve("www.example.com").cnames.size(), 1u);
+    merged.expire(1110);
+    EXPECT_TRUE(merged.resolve("www.example.com").cnames.empty());
+
+    // AAAA 只在第一个分片中（1120 到期），A 以第二个分片的 1170 为准
+    merged.expire(1169);
+    EXPECT_TRUE(merged.resolve("web.example.com").ipv6.empty());
+    EXPECT_EQ(merged.resolve("web.example.com").ipv4.size(), 1u);
+    merged.expire(1170);
+    EXPECT_EQ(merged.size(), 0u);
+}
+
+TEST(PassiveDNSTest, InternsOnlyRecordedNames) {
+    // txt.example.com TXT "abc"，www.example.com A 93.184.216.34
+    std::string data = hexToBytes(
+        "AAAA81800001000200000000"
+        "03777777076578616D706C6503636F6D0000010001"
+        "03747874C010001000010000003C0004"
+        "03616263"
+        "C00C000100010000003C0004"
+        "5DB8D822");
+    Message message;
+    ASSERT_TRUE(DNSParser::parseResponse(data, message));
+    ASSERT_EQ(message.answers().size(), 2u);
+
+    NameInterner interner(16);
+    PassiveDNS store(1 << 10, 86400, interner);
+    store.observe(message, 1000);
+    EXPECT_EQ(store.size(), 1u);
+    EXPECT_EQ(interner.size(), 1u);
+    EXPECT_EQ(interner.find("txt.example.com"), NameInterner::kInvalidId);
+}
+
+TEST(PassiveDNSTest, CompactNamesKeepsLiveMappings) {
+    std::string data = buildResponse();
+    Message message;
+    ASSERT_TRUE(DNSParser::parseResponse(data, message));
+
+    // 解析时驻留的其他名字不再被引用，回收后只剩被动 DNS 用到的两个名字
+    NameInterner interner(8);
+    for (int i = 0; i < 6; ++i) {
+        interner.intern("random" + std::to_string(i) + ".example.com");
+    }
+    PassiveDNS store(1 << 10, 86400, interner);
+    store.observe(message, 1000);
+    EXPECT_TRUE(interner.full());
+
+    store.compactNames();
+    EXPECT_EQ(interner.size(), 2u);
+    EXPECT_EQ(store.size(), 3u);
+    EXPECT_EQ(store.namesForIPv4(inet_addr("93.184.216.34"))[0], "web.example.com");
+    ASSERT_EQ(store.resolve("www.example.com").cnames.size(), 1u);
+    EXPECT_EQ(store.resolve("www.example.com").cnames[0], "web.example.com");
+
+    // 新 ID 下过期和刷新照常工作
+    store.observe(message, 1050);
+    EXPECT_EQ(store.size(), 3u);
+    store.expire(1170);
+    EXPECT_EQ(store.size(), 0u);
+    EXPECT_EQ(store.nameCount(), 0u);
+}
+
+TEST(PassiveDNSTest, CompactNamesClearsWhenMostNamesAreLive) {
+    std::string data = buildResponse();
+    Message message;
+    ASSERT_TRUE(DNSParser::parseResponse(data, message));
+
+    NameInterner interner(2);
+    PassiveDNS store(1 << 10, 86400, interner);
+    store.observe(message, 1000);
+    EXPECT_TRUE(interner.full());
+
+    store.compactNames();
+    EXPECT_EQ(store.size(), 0u);
+    EXPECT_EQ(interner.size(), 0u);
+    store.expire(2000);
+
+    store.observe(message, 2000);
+    EXPECT_EQ(store.size(), 3u);
+}
+
+TEST(PassiveDNSTest, MergeTranslatesNamesBetweenInterners) {
+    std::string data = buildResponse();
+    Message message;
+    ParseOptions options;
+    options.intern_names = true;
+    NameInterner shard_names(16);
+    options.interner = &shard_names;
+    ASSERT_TRUE(DNSParser::parseResponse(data, message, options));
+    EXPECT_EQ(message.names, &shard_names);
+
+    PassiveDNS shard(1 << 10, 86400, shard_names);
+    shard.observe(message, 1000);
+
+    NameInterner merged_names(16);
+    PassiveDNS merged(1 << 10, 86400, merged_names);
+    merged.merge(shard, 1000);
+    EXPECT_EQ(merged.size(), 3u);
+    EXPECT_EQ(merged.namesForIPv4(inet_addr("93.184.216.34"))[0], "web.example.com");
+    ASSERT_EQ(merged.resolve("www.example.com").cnames.size(), 1u);
+    EXPECT_EQ(merged.resolve("www.example.com").cnames[0], "web.example.com");
+}
+
+TEST(PassiveDNSTest, ObserveReinternsNamesFromOtherInterners) {
+    std::string data = buildResponse();
+    Message message;
+    ParseOptions options;
+    options.intern_names = true;
+    NameInterner parse_names(16);
+    options.interner = &parse_names;
+    ASSERT_TRUE(DNSParser::parseResponse(data, message, options));
+
+    // 存储的驻留表里同样的 ID 已经分给了其他名字
+    NameInterner store_names(16);
+    store_names.intern("first.other", 11);
+    store_names.intern("second.other", 12);
+    store_names.intern("third.other", 11);
+    PassiveDNS store(1 << 10, 86400, store_names);
+    store.observe(message, 1000);
+
+    std::vector<std::string> names = store.namesForIPv4(inet_addr("93.184.216.34"));
+    ASSERT_EQ(names.size(), 1u);
+    EXPECT_EQ(names[0], "web.example.com");
+    ASSERT_EQ(store.resolve("www.example.com").cnames.size(), 1u);
+    EXPECT_EQ(store.resolve("www.example.com").cnames[0], "web.example.com");
+    EXPECT_EQ(store.resolve("web.example.com").ipv4.size(), 1u);
+}
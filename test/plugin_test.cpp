@@ -7,8 +7,11 @@
 
 #include <iostream>
 #include <string>
+#include <cstdio>
 #include <cstring>
 #include <vector>
+#include <algorithm>
+#include <fstream>
 #include "../include/plugin/plugin.h"
 #include "../include/flows/dns_parser.h"
 #include "../include/tools/types.h"
@@ -135,6 +138,16 @@ void freeTask(TASK* task) {
 int main() {
     std::cout << "===== DNS解析插件测试程序 =====" << std::endl;
     
+    // 0. 准备配置：策略拦截 example.com 的成功响应，查询不受影响
+    std::string suffix = "_" + std::to_string(getpid());
+    std::string policyPath = "/tmp/plugin_test_policy" + suffix;
+    std::string configPath = "/tmp/plugin_test_config" + suffix + ".ini";
+    std::ofstream(policyPath.c_str()) << "block qname=example.com rcode=NOERROR\n"
+                                      << "block qname=example.com qtype=AAAA respond=nxdomain\n";
+    std::ofstream(configPath.c_str()) << "[Policy]\nrules = " << policyPath << "\n"
+                                      << "[Diagnostics]\nstage_timing = true\n";
+    SetConfigFilePath(configPath.c_str());
+
     // 1. 插件初始化
     std::cout << "\n----- 步骤1: 插件初始化 -----" << std::endl;
     int createResult = Create(1, 0, nullptr);
@@ -162,6 +175,35 @@ int main() {
         std::cerr << "处理DNS查询包失败，错误码: " << queryResult << std::endl;
     }
     
+    // 3.1 DNS over TCP：带长度前缀的查询被拆成两个分段，应在流缓冲区中重组
+    std::cout << "\n----- 步骤3.1: 处理分段的TCP DNS查询 -----" << std::endl;
+    TASK* tcpFirst = createDNSQueryTask();
+    TASK* tcpSecond = createDNSQueryTask();
+    std::string framed(reinterpret_cast<char*>(tcpFirst->Buffer), tcpFirst->Length);
+    framed.insert(0, 1, static_cast<char>(framed.size() & 0xFF));
+    framed.insert(0, 1, static_cast<char>(framed.size() >> 8 & 0xFF));
+    tcpFirst->Source.Port = tcpSecond->Source.Port = 40000;
+    delete[] tcpFirst->Buffer;
+    delete[] tcpSecond->Buffer;
+    tcpFirst->Length = framed.size();
+    tcpFirst->Buffer = new unsigned char[tcpFirst->Length];
+    memcpy(tcpFirst->Buffer, framed.data(), tcpFirst->Length);
+    tcpSecond->Length = 0;
+    tcpSecond->Buffer = nullptr;
+    // 首包完整，随后同一连接上的数据按 10 字节拆分送入
+    TASK* tcpExport = nullptr;
+    Filter(tcpFirst, &tcpExport);
+    std::string split = framed;
+    for (size_t offset = 0; offset < split.size(); offset += 10) {
+        size_t len = std::min<size_t>(10, split.size() - offset);
+        tcpSecond->Buffer = reinterpret_cast<unsigned char*>(&split[offset]);
+        tcpSecond->Length = len;
+        Filter(tcpSecond, &tcpExport);
+    }
+    tcpSecond->Buffer = nullptr;
+    tcpFirst->Inform = 0x13;  // 连接关闭
+    Filter(tcpFirst, &tcpExport);
+
     // 4. 处理DNS响应包
     std::cout << "\n----- 步骤4: 处理DNS响应包 -----" << std::endl;
     TASK* responseTask = createDNSResponseTask();
@@ -172,13 +214,105 @@ int main() {
         std::cerr << "处理DNS响应包失败，错误码: " << responseResult << std::endl;
     }
     
+    // 4.1 重复的DNS响应包（仅事务ID不同）应命中响应缓存
+    std::cout << "\n----- 步骤4.1: 处理重复的DNS响应包 -----" << std::endl;
+    TASK* repeatTask = createDNSResponseTask();
+    repeatTask->Buffer[0] = 0x12;
+    repeatTask->Buffer[1] = 0x34;
+    TASK* repeatExport = nullptr;
+    Filter(repeatTask, &repeatExport);
+
+    CACHE_STATS cacheStats;
+    CacheStats(&cacheStats);
+    std::cout << "响应缓存命中: " << cacheStats.Hits << ", 未命中: " << cacheStats.Misses << std::endl;
+    if (cacheStats.Hits != 1) {
+        std::cerr << "重复响应未命中缓存" << std::endl;
+        return 1;
+    }
+
+    // 4.2 策略判定通过 Action 导出：响应被拦截（0x21），查询保持原样
+    std::cout << "\n----- 步骤4.2: 检查策略判定 -----" << std::endl;
+    if (queryExport->Action != 0x12 || responseExport->Action != 0x21 || repeatExport->Action != 0x21) {
+        std::cerr << "策略判定不符合预期" << std::endl;
+        return 1;
+    }
+    
+    // 4.3 被拦截且要求合成响应的查询：插件直接应答 NXDOMAIN，方向与查询相反
+    std::cout << "\n----- 步骤4.3: 合成NXDOMAIN应答 -----" << std::endl;
+    TASK* blockedTask = createDNSQueryTask();
+    blockedTask->Buffer[blockedTask->Length - 3] = 28;   // 查询类型改为 AAAA
+    TASK* blockedExport = nullptr;
+    Filter(blockedTask, &blockedExport);
+    if (!blockedExport || blockedExport->Action != 0x22 || blockedExport->Source.Role != 'S' ||
+        blockedExport->Length != blockedTask->Length || (blockedExport->Buffer[2] & 0x80) == 0 ||
+        (blockedExport->Buffer[3] & 0x0F) != 3) {
+        std::cerr << "合成应答不符合预期" << std::endl;
+        return 1;
+    }
+    freeTask(blockedTask);
+
+    // 4.4 阶段计时：每个数据包都经过取得任务阶段，只有完整解析的响应经过资源记录阶段
+#if DNS_PARSER_STAGE_TIMING
+    std::cout << "\n----- 步骤4.4: 检查阶段计时 -----" << std::endl;
+    STAGE_STATS stageStats[STAGE_COUNT];
+    StageStats(stageStats, 1);
+    if (stageStats[0].Count < 4 || stageStats[3].Count == 0 || stageStats[3].Count >= stageStats[0].Count ||
+        stageStats[0].P50 > stageStats[0].Max) {
+        std::cerr << "阶段计时不符合预期" << std::endl;
+        return 1;
+    }
+    TASK* timedTask = createDNSQueryTask();
+    TASK* timedExport = nullptr;
+    Filter(timedTask, &timedExport);
+    freeTask(timedTask);
+    StageStats(stageStats, 0);
+    if (stageStats[0].Count != 1 || stageStats[3].Count != 0) {
+        std::cerr << "阶段计时重置不符合预期" << std::endl;
+        return 1;
+    }
+#endif
+
+    // 4.5 协议计数：查询和响应都按线格式头部计数
+    std::cout << "\n----- 步骤4.5: 检查协议计数 -----" << std::endl;
+    DNS_STATS dnsStats;
+    DnsStats(&dnsStats);
+    if (dnsStats.Packets == 0 || dnsStats.Messages != dnsStats.Queries + dnsStats.Responses + dnsStats.ShortMessages ||
+        dnsStats.Qtypes[1] == 0 || dnsStats.Qtypes[28] == 0 || dnsStats.Responses == 0 || dnsStats.Rcodes[0] == 0) {
+        std::cerr << "协议计数不符合预期" << std::endl;
+        return 1;
+    }
+
+    // 4.6 端口 53 上的非 DNS 数据在解析前被头部检查拒绝，不计入消息数
+    std::cout << "\n----- 步骤4.6: 拒绝非DNS数据 -----" << std::endl;
+    TASK* junkTask = createDNSQueryTask();
+    const char junk[] = "GET / HTTP/1.1\r\nHost: example.com\r\n\r\n";
+    delete[] junkTask->Buffer;
+    junkTask->Length = sizeof(junk) - 1;
+    junkTask->Buffer = new unsigned char[junkTask->Length];
+    memcpy(junkTask->Buffer, junk, junkTask->Length);
+    TASK* junkExport = nullptr;
+    Filter(junkTask, &junkExport);
+    freeTask(junkTask);
+    DNS_STATS afterJunk;
+    DnsStats(&afterJunk);
+    if (afterJunk.Messages != dnsStats.Messages || afterJunk.Rejected[2] != dnsStats.Rejected[2] + 1) {
+        std::cerr << "头部检查不符合预期" << std::endl;
+        return 1;
+    }
+
     // 5. 清理资源
     std::cout << "\n----- 步骤5: 清理资源 -----" << std::endl;
     Remove();
     
+    std::remove(policyPath.c_str());
+    std::remove(configPath.c_str());
+
     // 释放TASK资源
     freeTask(queryTask);
     freeTask(responseTask);
+    freeTask(repeatTask);
+    freeTask(tcpFirst);
+    freeTask(tcpSecond);
     
     std::cout << "\n===== DNS解析插件测试完成 =====" << std::endl;
     return 0;
@@ -0,0 +1,201 @@
+#include <gtest/gtest.h>
+#include "../include/flows/policy_engine.h"
+#include "../include/flows/dns_parser.h"
+#include <arpa/inet.h>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+using namespace dns_parser;
+
+// 辅助函数：将十六进制字符串转换为二进制数据
+static std::string hexToBytes(const std::string& hex) {
+    std::string bytes;
+    for (size_t i = 0; i < hex.length(); i += 2) {
+        std::string byteString = hex.substr(i, 2);
+        char byte = (char) strtol(byteString.c_str(), nullptr, 16);
+        bytes.push_back(byte);
+    }
+    return bytes;
+}
+
+// WWW.Example.com A 查询
+static std::string buildQuery() {
+    return hexToBytes("AAAA01000001000000000000"
+                      "03575757074578616D706C6503636F6D0000010001");
+}
+
+// www.example.com A 响应：NXDOMAIN 时没有应答，否则应答 93.184.216.34
+static std::string buildResponse(bool nxdomain) {
+    if (nxdomain) {
+        return hexToBytes("AAAA81830001000000000000"
+                          "03777777076578616D706C6503636F6D0000010001");
+    }
+    return hexToBytes("AAAA81800001000100000000"
+                      "03777777076578616D706C6503636F6D0000010001"
+                      "C00C000100010000012C00045DB8D822");
+}
+
+static PolicyEngine::Decision decide(const PolicyEngine& engine, const std::string& data, const char* client,
+                                     const Message* message = nullptr) {
+    uint8_t addr[16];
+    PolicyRequest request;
+    request.data = reinterpret_cast<const uint8_t*>(data.data());
+    request.length = data.size();
+    request.message = message;
+    request.client_version = inet_pton(AF_INET, client, addr) == 1 ? 4 : 6;
+    if (request.client_version == 6) {
+        inet_pton(AF_INET6, client, addr);
+    }
+    request.client = addr;
+    return engine.evaluate(request);
+}
+
+static PolicyEngine compile(const std::string& text) {
+    std::vector<PolicyRule> rules;
+    PolicyAction fallback = PolicyAction::None;
+    std::string error;
+    EXPECT_TRUE(PolicyEngine::parseRules(text, rules, fallback, &error)) << error;
+    return PolicyEngine(rules, fallback);
+}
+
+TEST(PolicyEngineTest, MatchesSuffixCaseInsensitivelyInRuleOrder) {
+    PolicyEngine engine = compile(
+        "# 白名单优先\n"
+        "forward qname=www.example.com client=10.0.0.0/8\n"
+        "block qname=EXAMPLE.com qtype=A,AAAA\n"
+        "block qname=example.net\n");
+    ASSERT_EQ(engine.ruleCount(), 3u);
+
+    std::string query = buildQuery();
+    PolicyEngine::Decision decision = decide(engine, query, "10.1.2.3");
+    EXPECT_EQ(decision.action, PolicyAction::Forward);
+    EXPECT_EQ(decision.rule, 0);
+
+    decision = decide(engine, query, "192.168.1.1");
+    EXPECT_EQ(decision.action, PolicyAction::Acknowledge);
+    EXPECT_EQ(decision.rule, 1);
+
+    // 后缀按标签边界匹配，ample.com 不是 example.com 的父域
+    PolicyEngine partial = compile("block qname=ample.com\n");
+    EXPECT_EQ(decide(partial, query, "192.168.1.1").action, PolicyAction::None);
+}
+
+TEST(PolicyEngineTest, MatchesRcodeAndAnswerPrefixOnResponses) {
+    PolicyEngine engine = compile(
+        "block rcode=NXDOMAIN\n"
+        "block answer=93.184.0.0/16 qtype=A\n"
+        "default forward\n");
+    EXPECT_EQ(engine.defaultAction(), PolicyAction::Forward);
+
+    // 查询中的 rcode 字段没有意义，不会命中
+    std::string query = buildQuery();
+    PolicyEngine::Decision decision = decide(engine, query, "10.0.0.1");
+    EXPECT_EQ(decision.action, PolicyAction::Forward);
+    EXPECT_EQ(decision.rule, -1);
+
+    std::string nx = buildResponse(true);
+    EXPECT_EQ(decide(engine, nx, "10.0.0.1").rule, 0);
+
+    std::string data = buildResponse(false);
+    Message message;
+    ASSERT_TRUE(DNSParser::parseResponse(data, message));
+    EXPECT_EQ(decide(engine, data, "10.0.0.1").rule, -1);
+    EXPECT_EQ(decide(engine, data, "10.0.0.1", &message).rule, 1);
+}
+
+TEST(PolicyEngineTest, MatchesIPv6ClientPrefixes) {
+    PolicyEngine engine = compile(
+        "block client=2001:db8::/32\n"
+        "forward client=2001:db8:1::1\n"
+        "forward client=::/0\n");
+    std::string query = buildQuery();
+    EXPECT_EQ(decide(engine, query, "2001:db8:1::1").rule, 0);
+    EXPECT_EQ(decide(engine, query, "2001:db9::1").rule, 2);
+    EXPECT_EQ(decide(engine, query, "10.0.0.1").action, PolicyAction::None);
+}
+
+TEST(PolicyEngineTest, HandlesMoreRulesThanOneWord) {
+    std::string text;
+    for (int i = 0; i < 200; ++i) {
+        text += "forward qname=host" + std::to_string(i) + ".example.org\n";
+    }
+    text += "block qname=example.com\n";
+    PolicyEngine engine = compile(text);
+    ASSERT_EQ(engine.ruleCount(), 201u);
+    PolicyEngine::Decision decision = decide(engine, buildQuery(), "10.0.0.1");
+    EXPECT_EQ(decision.action, PolicyAction::Acknowledge);
+    EXPECT_EQ(decision.rule, 200);
+}
+
+TEST(PolicyEngineTest, RejectsMalformedRules) {
+    std::vector<PolicyRule> rules;
+    PolicyAction fallback = PolicyAction::None;
+    std::string error;
+    EXPECT_FALSE(PolicyEngine::parseRules("block qname=example.com\nblock qtype=BOGUS\n", rules, fallback, &error));
+    EXPECT_NE(error.find("第 2 行"), std::string::npos);
+    EXPECT_TRUE(rules.empty());
+    EXPECT_FALSE(PolicyEngine::parseRules("mirror qname=example.com\n", rules, fallback, &error));
+    EXPECT_FALSE(PolicyEngine::parseRules("block client=10.0.0.0/33\n", rules, fallback, &error));
+    EXPECT_FALSE(PolicyEngine::parseRules("block color=red\n", rules, fallback, &error));
+}
+
+TEST(PolicyEngineTest, LoadsListsAroundRuleFile) {
+    std::string suffix = "_" + std::to_string(getpid());
+    std::string rules = "/tmp/policy_rules" + suffix;
+    std::string allow = "/tmp/policy_allow" + suffix;
+    std::string block = "/tmp/policy_block" + suffix;
+    std::ofstream(rules.c_str()) << "block client=10.0.0.0/8\n";
+    std::ofstream(allow.c_str()) << "# 注释\nwww.example.com\n";
+    std::ofstream(block.c_str()) << "example.com\nexample.net\n";
+
+    std::shared_ptr<const PolicyEngine> engine = PolicyEngine::load(rules, allow, block);
+    ASSERT_TRUE(engine);
+    EXPECT_EQ(engine->ruleCount(), 3u);
+    std::string query = buildQuery();
+    EXPECT_EQ(decide(*engine, query, "10.0.0.1").action, PolicyAction::Forward);
+
+    std::shared_ptr<const PolicyEngine> blockOnly = PolicyEngine::load("", "", block);
+    ASSERT_TRUE(blockOnly);
+    EXPECT_EQ(decide(*blockOnly, query, "10.0.0.1").action, PolicyAction::Acknowledge);
+    EXPECT_FALSE(PolicyEngine::load("", "", ""));
+
+    std::remove(rules.c_str());
+    std::remove(allow.c_str());
+    std::remove(block.c_str());
+}
+
+TEST(PolicyEngineTest, AcceptsFullyQualifiedNames) {
+    PolicyEngine engine = compile("block qname=example.com.\n");
+    EXPECT_EQ(decide(engine, buildQuery(), "10.0.0.1").action, PolicyAction::Acknowledge);
+
+    // 只去掉一个末尾的点，"." 仍表示根域
+    std::vector<PolicyRule> rules;
+    PolicyAction fallback = PolicyAction::None;
+    EXPECT_FALSE(PolicyEngine::parseRules("block qname=example.com..\n", rules, fallback, nullptr));
+    PolicyEngine root = compile("block qname=.\n");
+    EXPECT_EQ(decide(root, buildQuery(), "10.0.0.1").action, PolicyAction::Acknowledge);
+}
+
+TEST(PolicyEngineTest, ReadsHostsFormatLists) {
+    std::string block = "/tmp/policy_hosts_" + std::to_string(getpid());
+    std::ofstream(block.c_str()) << "# hosts 格式\n"
+                                    "0.0.0.0 ads.example.net tracker.example.org # 注释\n"
+                                    ":: example.com.\n"
+                                    ".\n";
+
+    std::shared_ptr<const PolicyEngine> engine = PolicyEngine::load("", "", block);
+    ASSERT_TRUE(engine);
+    std::string query = buildQuery();
+    EXPECT_EQ(decide(*engine, query, "10.0.0.1").action, PolicyAction::Acknowledge);
+
+    // 地址本身不作为域名，名单中的根域被忽略，不会拦截所有查询
+    std::ofstream(block.c_str()) << "0.0.0.0 ads.example.net\n.\n";
+    engine = PolicyEngine::load("", "", block);
+    ASSERT_TRUE(engine);
+    EXPECT_EQ(decide(*engine, query, "10.0.0.1").action, PolicyAction::None);
+
+    std::remove(block.c_str());
+}
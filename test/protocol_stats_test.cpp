@@ -0,0 +1,180 @@
+#include <gtest/gtest.h>
+#include "../include/analytics/protocol_stats.h"
+#include "../include/flows/dns_parser.h"
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+
+using namespace dns_parser;
+
+// 辅助函数：将十六进制字符串转换为二进制数据
+static std::string hexToBytes(const std::string& hex) {
+    std::string bytes;
+    for (size_t i = 0; i < hex.length(); i += 2) {
+        std::string byteString = hex.substr(i, 2);
+        char byte = (char) strtol(byteString.c_str(), nullptr, 16);
+        bytes.push_back(byte);
+    }
+    return bytes;
+}
+
+static void record(ProtocolStats& stats, const std::string& message) {
+    stats.recordMessage(reinterpret_cast<const uint8_t*>(message.data()), message.size());
+}
+
+static ParseError parseError(const std::string& data) {
+    ParseError error = ParseError::None;
+    ParseOptions options;
+    options.error = &error;
+    Message message;
+    EXPECT_FALSE(DNSParser::parseResponse(data, message, options));
+    return error;
+}
+
+TEST(ProtocolStatsTest, CountsHeaderFieldsFromWireFormat) {
+    std::unique_ptr<ProtocolStats> stats(new ProtocolStats());
+    // www.example.com AAAA 查询，RD=1，带一个附加记录
+    record(*stats, hexToBytes("AAAA01000001000000000001"
+                              "03777777076578616D706C6503636F6D00001C0001"
+                              "0000291000000000000000"));
+    // NXDOMAIN 响应，RD/RA
+    record(*stats, hexToBytes("AAAA81830001000000000000"
+                              "03777777076578616D706C6503636F6D0000010001"));
+    // HTTPS (65) 之外的大类型计入最后一项，截断的头部单独计数
+    record(*stats, hexToBytes("AAAA01000001000000000000"
+                              "03777777076578616D706C6503636F6D0001010001"));
+    record(*stats, hexToBytes("AAAA0100"));
+    stats->recordPacket();
+    stats->recordFailure(ParseError::BadName);
+
+    ProtocolStats::Counters counters;
+    stats->snapshot(counters);
+    EXPECT_EQ(counters.packets, 1u);
+    EXPECT_EQ(counters.messages, 4u);
+    EXPECT_EQ(counters.queries, 2u);
+    EXPECT_EQ(counters.responses, 1u);
+    EXPECT_EQ(counters.short_messages, 1u);
+    EXPECT_EQ(counters.qtypes[28], 1u);
+    EXPECT_EQ(counters.qtypes[1], 1u);
+    EXPECT_EQ(counters.qtypes[ProtocolStats::kQtypeSlots - 1], 1u);
+    EXPECT_EQ(counters.rcodes[3], 1u);
+    EXPECT_EQ(counters.opcodes[0], 3u);
+    EXPECT_EQ(counters.flags[ProtocolStats::FLAG_RD], 3u);
+    EXPECT_EQ(counters.flags[ProtocolStats::FLAG_RA], 1u);
+    EXPECT_EQ(counters.flags[ProtocolStats::FLAG_TC], 0u);
+    EXPECT_EQ(counters.sections[0][1], 3u);
+    EXPECT_EQ(counters.sections[3][1], 1u);
+    EXPECT_EQ(counters.sections[3][0], 2u);
+    EXPECT_EQ(counters.sizes[0], 4u);
+    EXPECT_EQ(counters.parse_failures[static_cast<size_t>(ParseError::BadName)], 1u);
+    EXPECT_EQ(counters.parseFailures(), 1u);
+
+    ProtocolStats::Counters merged;
+    merged.merge(counters);
+    merged.merge(counters);
+    EXPECT_EQ(merged.messages, 8u);
+    EXPECT_EQ(merged.qtypes[28], 2u);
+}
+
+TEST(ProtocolStatsTest, BucketsSectionCountsAndSizes) {
+    EXPECT_EQ(ProtocolStats::sectionBucket(0), 0u);
+    EXPECT_EQ(ProtocolStats::sectionBucket(2), 2u);
+    EXPECT_EQ(ProtocolStats::sectionBucket(3), 3u);
+    EXPECT_EQ(ProtocolStats::sectionBucket(4), 3u);
+    EXPECT_EQ(ProtocolStats::sectionBucket(5), 4u);
+    EXPECT_EQ(ProtocolStats::sectionBucket(16), 5u);
+    EXPECT_EQ(ProtocolStats::sectionBucket(17), 6u);
+    EXPECT_EQ(ProtocolStats::sectionBucket(65535), 6u);
+    EXPECT_EQ(ProtocolStats::sizeBucket(64), 0u);
+    EXPECT_EQ(ProtocolStats::sizeBucket(512), 3u);
+    EXPECT_EQ(ProtocolStats::sizeBucket(513), 4u);
+    EXPECT_EQ(ProtocolStats::sizeBucket(65535), ProtocolStats::kSizeBuckets - 1);
+}
+
+TEST(ProtocolStatsTest, ParserReportsFailureReasons) {
+    std::string question = "03777777076578616D706C6503636F6D0000010001";
+    EXPECT_EQ(parseError(hexToBytes("AAAA8180")), ParseError::ShortHeader);
+    EXPECT_EQ(parseError(hexToBytes("AAAA81800001000000000000C00C0001")), ParseError::BadName);
+    EXPECT_EQ(parseError(hexToBytes("AAAA81800001000000000000" + question.substr(0, 36))),
+              ParseError::TruncatedQuestion);
+    EXPECT_EQ(parseError(hexToBytes("AAAA81800001000100000000" + question + "C00C000100010000003C0004")),
+              ParseError::TruncatedRecord);
+}
+
+TEST(ProtocolStatsTest, CountsEdnsOptions) {
+    std::unique_ptr<ProtocolStats> stats(new ProtocolStats());
+    Message message;
+    // DO 置位，带客户端子网 192.0.2.0/24
+    ASSERT_TRUE(DNSParser::parseQuery(hexToBytes("AAAA01000001000000000001"
+                                                 "076578616D706C6503636F6D0000010001"
+                                                 "000029100000008000000B"
+                                                 "0008000700011800C00002"), message));
+    ASSERT_NE(message.opt(), nullptr);
+    stats->recordEdns(*message.opt());
+    // 选项长度越界
+    ASSERT_TRUE(DNSParser::parseQuery(hexToBytes("AAAA01000001000000000001"
+                                                 "076578616D706C6503636F6D0000010001"
+                                                 "0000291000000000000004"
+                                                 "000A0008"), message));
+    ASSERT_NE(message.opt(), nullptr);
+    stats->recordEdns(*message.opt());
+
+    ProtocolStats::Counters counters;
+    stats->snapshot(counters);
+    EXPECT_EQ(counters.edns[ProtocolStats::EDNS_PRESENT], 2u);
+    EXPECT_EQ(counters.edns[ProtocolStats::EDNS_DO], 1u);
+    EXPECT_EQ(counters.edns[ProtocolStats::EDNS_SUBNET], 1u);
+    EXPECT_EQ(counters.edns[ProtocolStats::EDNS_COOKIE], 0u);
+    EXPECT_EQ(counters.edns[ProtocolStats::EDNS_MALFORMED], 1u);
+}
+
+TEST(ProtocolStatsTest, CountsNameChecks) {
+    std::unique_ptr<ProtocolStats> stats(new ProtocolStats());
+    stats->recordName(0);
+    stats->recordName(NAME_UPPERCASE);
+    stats->recordName(NAME_UPPERCASE | NAME_IDN);
+    stats->recordName(NAME_NON_LDH | NAME_BAD_LENGTH);
+
+    ProtocolStats::Counters counters;
+    stats->snapshot(counters);
+    EXPECT_EQ(counters.names[ProtocolStats::NAMES_UPPERCASE], 2u);
+    EXPECT_EQ(counters.names[ProtocolStats::NAMES_NON_LDH], 1u);
+    EXPECT_EQ(counters.names[ProtocolStats::NAMES_IDN], 1u);
+    EXPECT_EQ(counters.names[ProtocolStats::NAMES_BAD_LENGTH], 1u);
+}
+
+TEST(ProtocolStatsTest, SnapshotsAreConsistentUnderConcurrentWrites) {
+    std::unique_ptr<ProtocolStats> stats(new ProtocolStats());
+    std::string query = hexToBytes("AAAA01000001000000000000"
+                                   "03777777076578616D706C6503636F6D0000010001");
+    std::string response = hexToBytes("AAAA81800001000000000000"
+                                      "03777777076578616D706C6503636F6D0000010001");
+    std::atomic<bool> done(false);
+    std::thread writer([&]() {
+        for (int i = 0; i < 200000; ++i) {
+            stats->recordPacket();
+            record(*stats, i % 2 ? response : query);
+        }
+        done.store(true);
+    });
+
+    // 每个快照内部的计数必须相互一致
+    uint64_t last = 0;
+    while (!done.load()) {
+        ProtocolStats::Counters counters;
+        stats->snapshot(counters);
+        ASSERT_EQ(counters.messages, counters.queries + counters.responses);
+        ASSERT_EQ(counters.qtypes[1], counters.messages);
+        ASSERT_GE(counters.packets, counters.messages);
+        ASSERT_LE(counters.packets, counters.messages + 1);
+        ASSERT_GE(counters.messages, last);
+        last = counters.messages;
+    }
+    writer.join();
+
+    ProtocolStats::Counters counters;
+    stats->snapshot(counters);
+    EXPECT_EQ(counters.messages, 200000u);
+    EXPECT_EQ(counters.responses, 100000u);
+}
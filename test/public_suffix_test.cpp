@@ -0,0 +1,114 @@
+#include <gtest/gtest.h>
+#include "../include/flows/public_suffix.h"
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <unistd.h>
+
+using namespace dns_parser;
+
+static const char* kList =
+    "// ===BEGIN ICANN DOMAINS===\n"
+    "com\n"
+    "uk\n"
+    "co.uk\n"
+    "jp\n"
+    "*.kawasaki.jp\n"
+    "!city.kawasaki.jp\n"
+    "\n"
+    "*.ck\n"
+    "!www.ck\n"
+    "cn\n"
+    "公司.cn\n"
+    "bücher.de   注释之后的内容被忽略\n"
+    "// ===BEGIN PRIVATE DOMAINS===\n"
+    "github.io\n";
+
+// 可注册域名的文本，没有时返回 "-"
+static std::string registrable(const PublicSuffixList& list, const std::string& name) {
+    size_t offset = list.registrableOffset(name.data(), name.size());
+    return offset == PublicSuffixList::npos ? "-" : name.substr(offset);
+}
+
+TEST(PublicSuffixTest, ParsesRulesAndSkipsComments) {
+    PublicSuffixList list;
+    EXPECT_EQ(list.parse(kList), 12u);
+    EXPECT_EQ(list.size(), 12u);
+
+    EXPECT_FALSE(list.addRule("!com"));         // 例外规则至少两级
+    EXPECT_FALSE(list.addRule("a..b"));
+    EXPECT_FALSE(list.addRule("*"));
+    EXPECT_FALSE(list.addRule("foo.*.bar"));
+    EXPECT_FALSE(list.addRule(std::string(64, 'a') + ".com"));
+    EXPECT_EQ(list.size(), 12u);
+}
+
+TEST(PublicSuffixTest, FindsRegistrableDomain) {
+    PublicSuffixList list;
+    list.parse(kList);
+
+    EXPECT_EQ(registrable(list, "www.example.com"), "example.com");
+    EXPECT_EQ(registrable(list, "example.com"), "example.com");
+    EXPECT_EQ(registrable(list, "com"), "-");
+    EXPECT_EQ(registrable(list, ""), "-");
+    EXPECT_EQ(registrable(list, "a.b.example.co.uk"), "example.co.uk");
+    EXPECT_EQ(registrable(list, "co.uk"), "-");
+    EXPECT_EQ(registrable(list, "WWW.Example.CO.UK"), "Example.CO.UK");
+    EXPECT_EQ(registrable(list, "user.github.io"), "user.github.io");
+
+    // 没有规则的顶级域按默认规则处理
+    EXPECT_EQ(registrable(list, "foo.bar.unknowntld"), "bar.unknowntld");
+    EXPECT_EQ(registrable(list, "unknowntld"), "-");
+}
+
+TEST(PublicSuffixTest, AppliesWildcardsAndExceptions) {
+    PublicSuffixList list;
+    list.parse(kList);
+
+    EXPECT_EQ(registrable(list, "foo.bar.kawasaki.jp"), "foo.bar.kawasaki.jp");
+    EXPECT_EQ(registrable(list, "bar.kawasaki.jp"), "-");
+    EXPECT_EQ(registrable(list, "city.kawasaki.jp"), "city.kawasaki.jp");
+    EXPECT_EQ(registrable(list, "www.city.kawasaki.jp"), "city.kawasaki.jp");
+    EXPECT_EQ(registrable(list, "www.ck"), "www.ck");
+    EXPECT_EQ(registrable(list, "a.www.ck"), "www.ck");
+    EXPECT_EQ(registrable(list, "x.y.ck"), "x.y.ck");
+    EXPECT_EQ(registrable(list, "y.ck"), "-");
+}
+
+TEST(PublicSuffixTest, ConvertsUnicodeRulesToALabels) {
+    PublicSuffixList list;
+    list.parse(kList);
+
+    EXPECT_EQ(registrable(list, "shop.xn--55qx5d.cn"), "shop.xn--55qx5d.cn");
+    EXPECT_EQ(registrable(list, "xn--55qx5d.cn"), "-");
+    EXPECT_EQ(registrable(list, "x.xn--bcher-kva.de"), "x.xn--bcher-kva.de");
+    EXPECT_EQ(registrable(list, "x.other.de"), "other.de");
+}
+
+TEST(PublicSuffixTest, UsesPrecomputedSuffixHashes) {
+    PublicSuffixList list;
+    list.parse(kList);
+
+    NameHash hash;
+    ASSERT_TRUE(hash.assign("a.b.example.co.uk", 17));
+    EXPECT_EQ(list.suffixLabels(hash), 2u);
+    EXPECT_EQ(list.registrableOffset(hash), 4u);
+
+    // 没有规则时只有默认规则
+    PublicSuffixList empty;
+    EXPECT_EQ(empty.suffixLabels(hash), 1u);
+    EXPECT_EQ(empty.registrableOffset(hash), 12u);
+}
+
+TEST(PublicSuffixTest, LoadsFromFile) {
+    std::string path = "/tmp/public_suffix_" + std::to_string(getpid());
+    std::ofstream(path.c_str()) << kList;
+
+    std::shared_ptr<const PublicSuffixList> list = PublicSuffixList::load(path);
+    ASSERT_TRUE(list);
+    EXPECT_EQ(list->size(), 12u);
+    EXPECT_EQ(registrable(*list, "www.example.co.uk"), "example.co.uk");
+    EXPECT_FALSE(PublicSuffixList::load(""));
+
+    std::remove(path.c_str());
+}
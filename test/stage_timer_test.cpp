@@ -0,0 +1,103 @@
+#include <gtest/gtest.h>
+#include "../include/tools/stage_timer.h"
+#include "../include/flows/dns_parser.h"
+#include <memory>
+#include <random>
+#include <string>
+
+using namespace dns_parser;
+
+TEST(LatencyHistogramTest, BucketsAreContiguousWithBoundedError) {
+    EXPECT_EQ(LatencyHistogram::bucketOf(0), 0u);
+    EXPECT_EQ(LatencyHistogram::bucketOf(15), 15u);
+    EXPECT_EQ(LatencyHistogram::bucketOf(16), 16u);
+    EXPECT_EQ(LatencyHistogram::bucketOf(32), 32u);
+    EXPECT_EQ(LatencyHistogram::bucketOf(UINT64_MAX), LatencyHistogram::kBuckets - 1);
+    EXPECT_EQ(LatencyHistogram::bucketUpperBound(LatencyHistogram::kBuckets - 1), UINT64_MAX);
+
+    // 相邻桶首尾相接，桶宽不超过下界的 1/16
+    for (size_t bucket = 1; bucket < LatencyHistogram::kBuckets; ++bucket) {
+        uint64_t low = LatencyHistogram::bucketUpperBound(bucket - 1) + 1;
+        uint64_t high = LatencyHistogram::bucketUpperBound(bucket);
+        ASSERT_EQ(LatencyHistogram::bucketOf(low), bucket);
+        ASSERT_EQ(LatencyHistogram::bucketOf(high), bucket);
+        ASSERT_LE(high - low, low / LatencyHistogram::kSubBuckets);
+    }
+}
+
+TEST(LatencyHistogramTest, PercentilesMergeAndReset) {
+    std::unique_ptr<LatencyHistogram> first(new LatencyHistogram());
+    std::unique_ptr<LatencyHistogram> second(new LatencyHistogram());
+    for (uint64_t value = 1; value <= 1000; ++value) {
+        (value % 2 ? *first : *second).record(value * 100);
+    }
+
+    std::unique_ptr<LatencyHistogram::Snapshot> snapshot(new LatencyHistogram::Snapshot());
+    first->snapshot(*snapshot);
+    second->snapshot(*snapshot);
+    EXPECT_EQ(snapshot->count, 1000u);
+    EXPECT_EQ(snapshot->total, 100u * 1000u * 1001u / 2u);
+    EXPECT_EQ(snapshot->min, 100u);
+    EXPECT_EQ(snapshot->max, 100000u);
+
+    // 分位数不小于真实值，且相对误差不超过 1/16
+    const double percentiles[] = { 50, 90, 99, 99.9, 100 };
+    for (double p : percentiles) {
+        double exact = p * 1000.0;
+        uint64_t value = snapshot->valueAt(p);
+        EXPECT_GE(value, exact) << p;
+        EXPECT_LE(value, exact * (1.0 + 1.0 / 16)) << p;
+    }
+
+    first->reset();
+    std::unique_ptr<LatencyHistogram::Snapshot> after(new LatencyHistogram::Snapshot());
+    first->snapshot(*after);
+    EXPECT_EQ(after->count, 0u);
+    EXPECT_EQ(after->valueAt(50), 0u);
+}
+
+static uint64_t samples(const StageRecorder& recorder, Stage stage) {
+    std::unique_ptr<LatencyHistogram::Snapshot> snapshot(new LatencyHistogram::Snapshot());
+    recorder.histogram(stage).snapshot(*snapshot);
+    return snapshot->count;
+}
+
+TEST(StageRecorderTest, RecordsOneSamplePerStagePerPacket) {
+    std::unique_ptr<StageRecorder> recorder(new StageRecorder());
+    const uint64_t expected = DNS_PARSER_STAGE_TIMING ? 1 : 0;
+
+    // 运行期未启用时不记录
+    recorder->begin(false, CycleClock::now());
+    recorder->lap(Stage::Intake);
+    recorder->finish();
+    EXPECT_EQ(samples(*recorder, Stage::Intake), 0u);
+
+    // 同一阶段多次出现时合并为一个样本
+    recorder->begin(true, CycleClock::now());
+    recorder->lap(Stage::Intake);
+    recorder->lap(Stage::Analytics);
+    recorder->lap(Stage::Output);
+    recorder->lap(Stage::Analytics);
+    recorder->finish();
+    EXPECT_EQ(samples(*recorder, Stage::Intake), expected);
+    EXPECT_EQ(samples(*recorder, Stage::Analytics), expected);
+    EXPECT_EQ(samples(*recorder, Stage::Header), 0u);
+
+    // 解析器按头部、问题区、资源记录分段计时
+    std::string response("\xAA\xAA\x81\x80\x00\x01\x00\x01\x00\x00\x00\x00"
+                         "\x03www\x07" "example\x03" "com\x00\x00\x01\x00\x01"
+                         "\xC0\x0C\x00\x01\x00\x01\x00\x00\x00\x3C\x00\x04\x5D\xB8\xD8\x22", 49);
+    ParseOptions options;
+    options.stages = recorder.get();
+    Message message;
+    recorder->begin(true, CycleClock::now());
+    ASSERT_TRUE(DNSParser::parseResponse(response, message, options));
+    recorder->finish();
+    EXPECT_EQ(samples(*recorder, Stage::Header), expected);
+    EXPECT_EQ(samples(*recorder, Stage::Question), expected);
+    EXPECT_EQ(samples(*recorder, Stage::Records), expected);
+
+    recorder->reset();
+    EXPECT_EQ(samples(*recorder, Stage::Records), 0u);
+    EXPECT_GT(CycleClock::nanosPerTick(), 0.0);
+}
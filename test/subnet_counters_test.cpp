@@ -0,0 +1,112 @@
+#include <gtest/gtest.h>
+#include "../include/analytics/subnet_counters.h"
+#include <cstring>
+#include <vector>
+
+using namespace dns_parser;
+
+static OPTData ipv4Subnet(uint8_t a, uint8_t b, uint8_t c, uint8_t d, uint8_t source) {
+    OPTData opt;
+    std::memset(&opt, 0, sizeof(opt));
+    opt.ecs_family = 1;
+    opt.ecs_source = source;
+    opt.ecs_address[0] = a;
+    opt.ecs_address[1] = b;
+    opt.ecs_address[2] = c;
+    opt.ecs_address[3] = d;
+    return opt;
+}
+
+TEST(SubnetCountersTest, AllocatesOnFirstClientSubnet) {
+    SubnetCounters counters(16);
+    OPTData none;
+    std::memset(&none, 0, sizeof(none));
+    EXPECT_FALSE(counters.record(none, true));
+
+    std::vector<SubnetCounters::Entry> entries;
+    counters.snapshot(entries);
+    EXPECT_TRUE(entries.empty());
+    EXPECT_EQ(counters.size(), 0u);
+}
+
+TEST(SubnetCountersTest, AggregatesToConfiguredPrefix) {
+    SubnetCounters counters(16, 24, 56);
+    EXPECT_TRUE(counters.record(ipv4Subnet(10, 1, 2, 3, 32), true));
+    EXPECT_TRUE(counters.record(ipv4Subnet(10, 1, 2, 200, 32), true));
+    EXPECT_TRUE(counters.record(ipv4Subnet(10, 1, 2, 0, 24), false));
+    // 源前缀比聚合前缀短时按源前缀计数
+    EXPECT_TRUE(counters.record(ipv4Subnet(10, 1, 0, 0, 16), true));
+
+    std::vector<SubnetCounters::Entry> entries;
+    counters.snapshot(entries);
+    SubnetCounters::top(entries, 10);
+    ASSERT_EQ(entries.size(), 2u);
+    EXPECT_EQ(entries[0].subnet.family, 4);
+    EXPECT_EQ(entries[0].subnet.prefix, 24);
+    EXPECT_EQ(entries[0].subnet.address[2], 2);
+    EXPECT_EQ(entries[0].subnet.address[3], 0);
+    EXPECT_EQ(entries[0].queries, 2u);
+    EXPECT_EQ(entries[0].responses, 1u);
+    EXPECT_EQ(entries[1].subnet.prefix, 16);
+    EXPECT_EQ(entries[1].queries, 1u);
+}
+
+TEST(SubnetCountersTest, AggregationChangeAppliesToNewRecords) {
+    SubnetCounters counters(16, 24, 56);
+    counters.setAggregation(20, 48);
+    EXPECT_TRUE(counters.record(ipv4Subnet(10, 1, 31, 9, 32), true));
+
+    OPTData v6;
+    std::memset(&v6, 0, sizeof(v6));
+    v6.ecs_family = 2;
+    v6.ecs_source = 64;
+    for (int i = 0; i < 8; ++i) {
+        v6.ecs_address[i] = 0xFF;
+    }
+    EXPECT_TRUE(counters.record(v6, true));
+
+    std::vector<SubnetCounters::Entry> entries;
+    counters.snapshot(entries);
+    ASSERT_EQ(entries.size(), 2u);
+    for (const SubnetCounters::Entry& entry : entries) {
+        if (entry.subnet.family == 4) {
+            EXPECT_EQ(entry.subnet.prefix, 20);
+            EXPECT_EQ(entry.subnet.address[2], 16);
+        } else {
+            EXPECT_EQ(entry.subnet.prefix, 48);
+            EXPECT_EQ(entry.subnet.address[5], 0xFF);
+            EXPECT_EQ(entry.subnet.address[6], 0);
+        }
+    }
+}
+
+TEST(SubnetCountersTest, CountsOverflowWhenFull) {
+    SubnetCounters counters(2);
+    EXPECT_TRUE(counters.record(ipv4Subnet(10, 0, 1, 0, 24), true));
+    EXPECT_TRUE(counters.record(ipv4Subnet(10, 0, 2, 0, 24), true));
+    EXPECT_FALSE(counters.record(ipv4Subnet(10, 0, 3, 0, 24), true));
+    // 已有子网仍然计数
+    EXPECT_TRUE(counters.record(ipv4Subnet(10, 0, 1, 0, 24), false));
+    EXPECT_EQ(counters.size(), 2u);
+    EXPECT_EQ(counters.overflows(), 1u);
+}
+
+TEST(SubnetCountersTest, TopMergesSnapshotsFromThreads) {
+    SubnetCounters first(16);
+    SubnetCounters second(16);
+    first.record(ipv4Subnet(10, 0, 1, 0, 24), true);
+    second.record(ipv4Subnet(10, 0, 1, 0, 24), true);
+    second.record(ipv4Subnet(10, 0, 1, 0, 24), false);
+    second.record(ipv4Subnet(10, 0, 2, 0, 24), true);
+    second.record(ipv4Subnet(10, 0, 3, 0, 24), true);
+
+    std::vector<SubnetCounters::Entry> entries;
+    first.snapshot(entries);
+    second.snapshot(entries);
+    SubnetCounters::top(entries, 2);
+    ASSERT_EQ(entries.size(), 2u);
+    EXPECT_EQ(entries[0].subnet.address[2], 1);
+    EXPECT_EQ(entries[0].queries, 2u);
+    EXPECT_EQ(entries[0].responses, 1u);
+    EXPECT_EQ(entries[1].queries, 1u);
+}
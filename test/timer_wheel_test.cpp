@@ -0,0 +1,136 @@
+#include <gtest/gtest.h>
+#include "../include/tools/timer_wheel.h"
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <random>
+#include <vector>
+
+using namespace dns_parser;
+
+TEST(TimerWheelTest, FiresInOrderAcrossLevels) {
+    TimerWheel wheel(0);
+    std::vector<uint64_t> fired;
+    const uint64_t expires[] = {5, 255, 256, 300, 70000, 16777300, 5};
+    for (size_t i = 0; i < sizeof(expires) / sizeof(expires[0]); ++i) {
+        wheel.schedule(expires[i], expires[i]);
+    }
+    EXPECT_EQ(wheel.size(), 7u);
+
+    wheel.advance(4, 100, [&fired](uint64_t data) { fired.push_back(data); });
+    EXPECT_TRUE(fired.empty());
+    wheel.advance(300, 100, [&fired](uint64_t data) { fired.push_back(data); });
+    EXPECT_EQ(fired, (std::vector<uint64_t>{5, 5, 255, 256, 300}));
+
+    // 空档期直接跳过，不逐刻度空转
+    wheel.advance(20000000, 100, [&fired](uint64_t data) { fired.push_back(data); });
+    EXPECT_EQ(fired.size(), 7u);
+    EXPECT_EQ(fired[5], 70000u);
+    EXPECT_EQ(fired[6], 16777300u);
+    EXPECT_EQ(wheel.size(), 0u);
+}
+
+TEST(TimerWheelTest, HandlesTimersBeyondOneRotation) {
+    const uint64_t start = (uint64_t(1) << 32) - 100;
+    TimerWheel wheel(start);
+    std::vector<uint64_t> fired;
+    wheel.schedule(start + 50, 1);
+    wheel.schedule(start + 200, 2);
+    wheel.schedule(start + (uint64_t(1) << 32) + 500, 3);
+
+    wheel.advance(start + 150, 100, [&fired](uint64_t data) { fired.push_back(data); });
+    EXPECT_EQ(fired, (std::vector<uint64_t>{1}));
+    wheel.advance(start + 200, 100, [&fired](uint64_t data) { fired.push_back(data); });
+    EXPECT_EQ(fired, (std::vector<uint64_t>{1, 2}));
+    wheel.advance(start + (uint64_t(1) << 32) + 499, 100, [&fired](uint64_t data) { fired.push_back(data); });
+    EXPECT_EQ(fired.size(), 2u);
+    wheel.advance(start + (uint64_t(1) << 32) + 500, 100, [&fired](uint64_t data) { fired.push_back(data); });
+    EXPECT_EQ(fired, (std::vector<uint64_t>{1, 2, 3}));
+}
+
+TEST(TimerWheelTest, CancelAndRescheduleAreConstantTime) {
+    TimerWheel wheel(1000);
+    std::vector<uint64_t> fired;
+    TimerWheel::Handle a = wheel.schedule(1100, 1);
+    TimerWheel::Handle b = wheel.schedule(1100, 2);
+    TimerWheel::Handle c = wheel.schedule(1200, 3);
+
+    EXPECT_TRUE(wheel.cancel(a));
+    EXPECT_FALSE(wheel.cancel(a));
+    EXPECT_TRUE(wheel.reschedule(c, 1050));
+    wheel.advance(1100, 100, [&fired](uint64_t data) { fired.push_back(data); });
+    EXPECT_EQ(fired, (std::vector<uint64_t>{3, 2}));
+
+    // 到期后句柄失效，复用的节点不会被旧句柄取消
+    TimerWheel::Handle d = wheel.schedule(1300, 4);
+    EXPECT_FALSE(wheel.cancel(b));
+    EXPECT_EQ(wheel.size(), 1u);
+    EXPECT_TRUE(wheel.cancel(d));
+    EXPECT_EQ(wheel.size(), 0u);
+}
+
+TEST(TimerWheelTest, BoundedWorkResumesOnNextAdvance) {
+    TimerWheel wheel(0);
+    for (uint64_t i = 0; i < 100; ++i) {
+        wheel.schedule(10, i);
+    }
+    size_t total = 0;
+    int calls = 0;
+    while (wheel.size() > 0) {
+        size_t fired = wheel.advance(10, 16, [](uint64_t) {});
+        EXPECT_LE(fired, 16u);
+        total += fired;
+        ++calls;
+    }
+    EXPECT_EQ(total, 100u);
+    EXPECT_EQ(calls, 7);
+
+    // 回调中新增的已到期定时器推迟到下一个刻度
+    std::vector<uint64_t> fired;
+    wheel.schedule(20, 1);
+    wheel.advance(20, 100, [&wheel, &fired](uint64_t data) {
+        fired.push_back(data);
+        if (data == 1) {
+            wheel.schedule(0, 2);
+        }
+    });
+    EXPECT_EQ(fired, (std::vector<uint64_t>{1}));
+    wheel.advance(21, 100, [&fired](uint64_t data) { fired.push_back(data); });
+    EXPECT_EQ(fired, (std::vector<uint64_t>{1, 2}));
+}
+
+TEST(TimerWheelTest, MatchesReferenceModelUnderRandomLoad) {
+    std::mt19937_64 rng(42);
+    TimerWheel wheel(123456);
+    std::multimap<uint64_t, uint64_t> reference;
+    std::vector<std::pair<uint64_t, uint64_t> > fired;
+    uint64_t now = 123456;
+
+    for (int round = 0; round < 2000; ++round) {
+        for (int i = 0; i < 5; ++i) {
+            uint64_t delay = rng() % (round % 3 == 0 ? 100000 : 1000);
+            uint64_t id = static_cast<uint64_t>(round) * 10 + i;
+            wheel.schedule(now + delay, id);
+            reference.insert(std::make_pair(now + delay, id));
+        }
+        now += rng() % 300;
+        wheel.advance(now, SIZE_MAX, [&fired, now](uint64_t data) { fired.push_back(std::make_pair(now, data)); });
+
+        // 所有到期时间不晚于 now 的定时器都已触发
+        std::vector<uint64_t> due;
+        while (!reference.empty() && reference.begin()->first <= now) {
+            due.push_back(reference.begin()->second);
+            reference.erase(reference.begin());
+        }
+        ASSERT_EQ(fired.size(), due.size());
+        std::vector<uint64_t> got;
+        for (size_t i = 0; i < fired.size(); ++i) {
+            got.push_back(fired[i].second);
+        }
+        std::sort(got.begin(), got.end());
+        std::sort(due.begin(), due.end());
+        ASSERT_EQ(got, due);
+        fired.clear();
+    }
+    EXPECT_EQ(wheel.size(), reference.size());
+}